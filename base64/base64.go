@@ -12,20 +12,24 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package base64
 
 import (
+	"bytes"
 	"encoding/base64"
+	"errors"
 	"fmt"
 	"io"
-	"io/ioutil"
-	"log"
 	"os"
-	"unicode"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("base64", run)
+}
+
 const (
 	Help = `
 Usage: base64 [OPTION]... [FILE]
@@ -58,107 +62,211 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	decode  = flag.BoolP("decode", "d", false, "")
-	ignore  = flag.BoolP("ignore-garbage", "i", false, "")
-	wrap    = flag.IntP("wrap", "w", 76, "")
-	version = flag.BoolP("version", "v", false, "")
+const (
+	// encBlock is how much input is encoded at once. It's a multiple of
+	// 3 so every block but the last encodes without padding.
+	encBlock = 3 * 32 * 1024
+
+	// decBlock is how much input is read at once when decoding.
+	decBlock = 4 * 32 * 1024
 )
 
-func base64Encode(src []byte) []byte {
-	return []byte(base64.StdEncoding.EncodeToString(src))
-}
+var errInvalid = errors.New("invalid input")
 
-func base64Decode(src []byte) ([]byte, error) {
-	return base64.StdEncoding.DecodeString(string(src))
-}
-
-func readData(reader io.Reader) ([]byte, error) {
-	return ioutil.ReadAll(reader)
-}
+// encodeStream encodes r to w a block at a time, breaking lines after wrap
+// columns. A wrap of 0 disables wrapping, and like GNU's base64 doesn't end
+// the output with a newline.
+func encodeStream(w io.Writer, r io.Reader, wrap int) error {
+	enc := make([]byte, base64.StdEncoding.EncodedLen(encBlock))
+	var out []byte
+	if wrap > 0 {
+		out = make([]byte, 0, len(enc)+len(enc)/wrap+1)
+	}
+	in := make([]byte, encBlock)
 
-func isAlpha(ch byte) bool {
-	return unicode.IsLetter(rune(ch))
+	col := 0 // column of the next encoded byte
+	for {
+		n, err := io.ReadFull(r, in)
+		if n > 0 {
+			p := enc[:base64.StdEncoding.EncodedLen(n)]
+			base64.StdEncoding.Encode(p, in[:n])
+			if wrap > 0 {
+				// Line breaks are added while the block is copied into
+				// the output buffer, so each block is a single write.
+				out = out[:0]
+				for len(p) > 0 {
+					k := wrap - col
+					if k > len(p) {
+						k = len(p)
+					}
+					out = append(out, p[:k]...)
+					p = p[k:]
+					if col += k; col == wrap {
+						out = append(out, '\n')
+						col = 0
+					}
+				}
+				p = out
+			}
+			if _, err := w.Write(p); err != nil {
+				return err
+			}
+		}
+		if err == io.EOF || err == io.ErrUnexpectedEOF {
+			break
+		}
+		if err != nil {
+			return err
+		}
+	}
+	if col > 0 {
+		_, err := w.Write([]byte{'\n'})
+		return err
+	}
+	return nil
 }
 
-func readAndHandle(reader io.Reader, decode *bool, ignore *bool, wrap *int) {
-	src, err := readData(reader)
-	if err != nil {
-		log.Fatal(err)
+// alphabet marks the bytes that make up base64, padding included.
+var alphabet = func() (t [256]bool) {
+	for _, c := range []byte("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=") {
+		t[c] = true
 	}
-	var toHandle []byte
-	if *ignore {
-		//It seems that the effect of "base64 -i" in *nix
-		//is not filter the non-alphabet charater.
-		//This flag cannot work as the original *nix command flag.
-		for i := 0; i < len(src); i++ {
-			if isAlpha(src[i]) {
-				toHandle = append(toHandle, src[i])
+	return t
+}()
+
+// filter removes the bytes decodeStream skips from p, in place: newlines,
+// or with ignore, everything outside the alphabet.
+func filter(p []byte, ignore bool) []byte {
+	if !ignore {
+		i := bytes.IndexByte(p, '\n')
+		if i < 0 {
+			return p
+		}
+		q := p[:i]
+		for p = p[i+1:]; len(p) > 0; {
+			i = bytes.IndexByte(p, '\n')
+			if i < 0 {
+				i = len(p)
 			}
+			q = append(q, p[:i]...)
+			if i < len(p) {
+				i++
+			}
+			p = p[i:]
 		}
-	} else {
-		toHandle = src
+		return q
 	}
-	if *decode {
-		decoded, err := base64Decode(toHandle)
-		if err != nil {
-			log.Fatal(err)
+	q := p[:0]
+	for _, c := range p {
+		if alphabet[c] {
+			q = append(q, c)
 		}
-		fmt.Printf("%s", string(decoded))
-	} else {
-		encoded := base64Encode(toHandle)
-		wrapPrint(encoded, *wrap)
 	}
+	return q
 }
 
-func wrapPrint(output []byte, wrap int) {
-	if wrap == 0 {
-		fmt.Printf("%s\n", string(output))
-		return
+// decodeStream decodes r to w as it's read. Input is filtered a block at a
+// time and decoded in runs of whole 4-byte groups, with the leftover bytes
+// carried over to the next block. Like GNU's base64, padding may end any
+// group, so concatenated encodings decode as one.
+//
+// Everything before the first invalid group is written before errInvalid
+// is returned.
+func decodeStream(w io.Writer, r io.Reader, ignore bool) error {
+	var (
+		buf = make([]byte, 4+decBlock)
+		out = make([]byte, base64.StdEncoding.DecodedLen(len(buf)))
+		off int // bytes carried over from the last block
+	)
+	for {
+		n, err := r.Read(buf[off:])
+		if err != nil && err != io.EOF {
+			return err
+		}
+		eof := err == io.EOF
+
+		p := append(buf[:off], filter(buf[off:off+n], ignore)...)
+		m := len(p) &^ 3
+		for q := p[:m]; len(q) > 0; {
+			// Decode up to the end of the first padded group.
+			g := len(q)
+			if i := bytes.IndexByte(q, '='); i >= 0 && i/4*4+4 < g {
+				g = i/4*4 + 4
+			}
+			dn, derr := base64.StdEncoding.Decode(out, q[:g])
+			if _, err := w.Write(out[:dn]); err != nil {
+				return err
+			}
+			if derr != nil {
+				return errInvalid
+			}
+			q = q[g:]
+		}
+		off = copy(buf, p[m:])
+		if eof {
+			if off == 0 {
+				return nil
+			}
+			// The input ended partway through a group. Write what can
+			// be decoded of it, but it's still invalid.
+			dn, _ := base64.RawStdEncoding.Decode(out, buf[:off])
+			if _, err := w.Write(out[:dn]); err != nil {
+				return err
+			}
+			return errInvalid
+		}
 	}
+}
 
-	length := len(output)
-	if length <= wrap {
-		fmt.Printf("%s\n", string(output))
-		return
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f              flag.FlagSet
+		decode, ignore bool
+		wrap           int
+		version        bool
+	)
+	f.BoolVarP(&decode, "decode", "d", false, "")
+	f.BoolVarP(&ignore, "ignore-garbage", "i", false, "")
+	f.IntVarP(&wrap, "wrap", "w", 76, "")
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
 
-	index, end := 0, 0
-	for index < length {
-		end += wrap
-		if end > length {
-			end = length
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "base64: %v\n", err)
 		}
-		fmt.Printf("%s\n", string(output[index:end]))
-		index += wrap
+	}()
+
+	if version {
+		fmt.Fprintf(ctx.Stdout, "%s", Version)
+		return nil
+	}
+	if wrap < 0 {
+		return fmt.Errorf("invalid wrap size: %d", wrap)
 	}
-}
 
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
+	handle := func(r io.Reader) error {
+		if decode {
+			return decodeStream(ctx.Stdout, r, ignore)
+		}
+		return encodeStream(ctx.Stdout, r, wrap)
 	}
-	flag.Parse()
-
-	switch {
-	case *version:
-		fmt.Fprintf(os.Stdout, "%s", Version)
-		os.Exit(0)
-	case *wrap < 0:
-		log.Fatalf("invalid wrap size: %d", *wrap)
-	default:
-		if len(flag.Args()) == 0 {
-			readAndHandle(os.Stdin, decode, ignore, wrap)
-		} else {
-			for i := 0; i < len(flag.Args()); i++ {
-				file, err := os.Open(flag.Args()[i])
-				if err != nil {
-					log.Fatal(err)
-				}
-				readAndHandle(file, decode, ignore, wrap)
-			}
+	if f.NArg() == 0 {
+		return handle(ctx.Stdin)
+	}
+	for _, name := range f.Args() {
+		file, err := os.Open(name)
+		if err != nil {
+			return err
+		}
+		err = handle(file)
+		file.Close()
+		if err != nil {
+			return err
 		}
 	}
-
+	return nil
 }
@@ -1,8 +1,14 @@
-package main
+package base64
 
 import (
-	"log"
+	"bytes"
+	"encoding/base64"
+	"io/ioutil"
+	"math/rand"
+	"os/exec"
+	"strings"
 	"testing"
+	"testing/iotest"
 )
 
 func TestBase64Decode(t *testing.T) {
@@ -16,11 +22,11 @@ func TestBase64Decode(t *testing.T) {
 
 	for _, c := range cases {
 
-		decodedBytes, err := base64Decode([]byte(c.in))
-		if err != nil {
-			log.Fatal(err)
+		var dec bytes.Buffer
+		if err := decodeStream(&dec, strings.NewReader(c.in), false); err != nil {
+			t.Fatal(err)
 		}
-		got := string(decodedBytes)
+		got := dec.String()
 
 		if got != c.want {
 			t.Errorf("base64 (%q) == %q, want %q", c.in, got, c.want)
@@ -32,14 +38,17 @@ func TestBase64Encode(t *testing.T) {
 	cases := []struct {
 		in, want string
 	}{
-		{"hello world\n", "aGVsbG8gd29ybGQK"},
-		{"please, decode me\n", "cGxlYXNlLCBkZWNvZGUgbWUK"},
+		{"hello world\n", "aGVsbG8gd29ybGQK\n"},
+		{"please, decode me\n", "cGxlYXNlLCBkZWNvZGUgbWUK\n"},
 	}
 
 	for _, c := range cases {
 
-		encodedBytes := base64Encode([]byte(c.in))
-		got := string(encodedBytes)
+		var enc bytes.Buffer
+		if err := encodeStream(&enc, strings.NewReader(c.in), 76); err != nil {
+			t.Fatal(err)
+		}
+		got := enc.String()
 
 		if got != c.want {
 			t.Errorf("base64 (%q) == %q, want %q", c.in, got, c.want)
@@ -47,4 +56,100 @@ func TestBase64Encode(t *testing.T) {
 	}
 }
 
-func main() {}
+func TestStream(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	for _, n := range []int{0, 1, 2, 3, 57, encBlock - 1, encBlock, 3*encBlock + 2} {
+		data := make([]byte, n)
+		rng.Read(data)
+		plain := base64.StdEncoding.EncodeToString(data)
+
+		for _, wrap := range []int{0, 1, 4, 76, 1000} {
+			var want bytes.Buffer
+			for i := 0; i < len(plain); i += wrap {
+				if wrap == 0 {
+					want.WriteString(plain)
+					break
+				}
+				end := i + wrap
+				if end > len(plain) {
+					end = len(plain)
+				}
+				want.WriteString(plain[i:end] + "\n")
+			}
+
+			var enc bytes.Buffer
+			if err := encodeStream(&enc, bytes.NewReader(data), wrap); err != nil {
+				t.Fatal(err)
+			}
+			if enc.String() != want.String() {
+				t.Fatalf("%d bytes, wrap %d: encoded output doesn't match", n, wrap)
+			}
+
+			var dec bytes.Buffer
+			r := iotest.OneByteReader(bytes.NewReader(enc.Bytes()))
+			if err := decodeStream(&dec, r, false); err != nil {
+				t.Fatalf("%d bytes, wrap %d: %v", n, wrap, err)
+			}
+			if !bytes.Equal(dec.Bytes(), data) {
+				t.Fatalf("%d bytes, wrap %d: decoded output doesn't match", n, wrap)
+			}
+		}
+	}
+}
+
+func benchData(b *testing.B) (data, encoded []byte) {
+	data = make([]byte, 16<<20)
+	rand.New(rand.NewSource(1)).Read(data)
+	var buf bytes.Buffer
+	if err := encodeStream(&buf, bytes.NewReader(data), 76); err != nil {
+		b.Fatal(err)
+	}
+	return data, buf.Bytes()
+}
+
+func BenchmarkEncode(b *testing.B) {
+	data, _ := benchData(b)
+	b.SetBytes(int64(len(data)))
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		encodeStream(ioutil.Discard, bytes.NewReader(data), 76)
+	}
+}
+
+func BenchmarkDecode(b *testing.B) {
+	_, encoded := benchData(b)
+	b.SetBytes(int64(len(encoded)))
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		decodeStream(ioutil.Discard, bytes.NewReader(encoded), false)
+	}
+}
+
+// The GNU benchmarks run the system's base64 over the same input, for
+// comparison. They include the cost of starting the process.
+func benchGNU(b *testing.B, in []byte, args ...string) {
+	path, err := exec.LookPath("base64")
+	if err != nil {
+		b.Skip("no base64 in $PATH")
+	}
+	b.SetBytes(int64(len(in)))
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		cmd := exec.Command(path, args...)
+		cmd.Stdin = bytes.NewReader(in)
+		cmd.Stdout = ioutil.Discard
+		if err := cmd.Run(); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkGNUEncode(b *testing.B) {
+	data, _ := benchData(b)
+	benchGNU(b, data)
+}
+
+func BenchmarkGNUDecode(b *testing.B) {
+	_, encoded := benchData(b)
+	benchGNU(b, encoded, "-d")
+}
@@ -12,17 +12,22 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package basename
 
 import (
+	"errors"
 	"fmt"
-	"os"
 	"path/filepath"
 	"strings"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("basename", run)
+}
+
 const (
 	Help = `
 Usage: basename NAME [SUFFIX]
@@ -54,13 +59,6 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	multiple = flag.BoolP("multiple", "a", false, "")
-	suffix   = flag.StringP("suffix", "s", "", "")
-	zero     = flag.BoolP("zero", "z", false, "")
-	version  = flag.BoolP("version", "v", false, "")
-)
-
 func baseName(path, suffix string, null bool) string {
 	dir := filepath.Base(path)
 
@@ -75,30 +73,53 @@ func baseName(path, suffix string, null bool) string {
 	return dir
 }
 
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f        flag.FlagSet
+		multiple bool
+		suffix   string
+		zero     bool
+		version  bool
+	)
+	f.BoolVarP(&multiple, "multiple", "a", false, "")
+	f.StringVarP(&suffix, "suffix", "s", "", "")
+	f.BoolVarP(&zero, "zero", "z", false, "")
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
-	flag.Parse()
-
-	switch {
-	case *version:
-		fmt.Fprintf(os.Stdout, "%s", Version)
-		os.Exit(0)
-	case *multiple:
-		for _, v := range flag.Args() {
-			dir := baseName(v, *suffix, *zero)
-			fmt.Print(dir)
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "basename: %v\n", err)
 		}
-	case *suffix != "":
-		// Implies --multiple/-a
-		for _, v := range flag.Args() {
-			dir := baseName(v, *suffix, *zero)
-			fmt.Print(dir)
+	}()
+
+	if version {
+		fmt.Fprintf(ctx.Stdout, "%s", Version)
+		return nil
+	}
+
+	names := f.Args()
+	if len(names) == 0 {
+		return errors.New("missing operand")
+	}
+	// --suffix implies --multiple.
+	if !multiple && suffix == "" {
+		switch len(names) {
+		case 2:
+			suffix = names[1]
+		case 1:
+		default:
+			return fmt.Errorf("extra operand '%s'", names[2])
 		}
-	default:
-		dir := baseName(flag.Args()[0], *suffix, *zero)
-		fmt.Print(dir)
+		names = names[:1]
+	}
+	var out []byte
+	for _, name := range names {
+		out = append(out, baseName(name, suffix, zero)...)
 	}
+	_, err = ctx.Stdout.Write(out)
+	return err
 }
@@ -1,10 +1,11 @@
-package main
+package basename
 
 import (
 	"bytes"
-	"log"
-	"os/exec"
+	"strings"
 	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
 )
 
 func TestPerformBasename(t *testing.T) {
@@ -19,7 +20,7 @@ func TestPerformBasename(t *testing.T) {
 	}
 
 	for _, c := range cases {
-		got := performBasename(c.in[0], c.in[1], false)
+		got := baseName(c.in[0], c.in[1], false)
 
 		if got != c.want {
 			t.Errorf("basename (%q) == %q, want %q", c.in, got, c.want)
@@ -37,6 +38,7 @@ func TestBasename(t *testing.T) {
 		{[]string{"-a", "any/str1 any/str2"}, "str1\nstr2\n"},
 		{[]string{"-a", "/a//b //a/b"}, "b\nb\n"},
 		{[]string{"-s", ".h", "include/stdio.h"}, "stdio\n"},
+		{[]string{"include/stdio.h", ".h"}, "stdio\n"},
 		{[]string{"-s", ".h", "-a", "any/lib.h any/lib2.h"}, "lib\nlib2\n"},
 		{[]string{"-z", "any/str1"}, "str1"},
 		{[]string{"-z", "-a", "any/str1 any/str2"}, "str1str2"},
@@ -45,11 +47,10 @@ func TestBasename(t *testing.T) {
 
 	for _, c := range cases {
 		var out bytes.Buffer
-		cmd := exec.Command("./basename", c.in...)
-		cmd.Stdout = &out
-		err := cmd.Run()
+		args := strings.Fields(strings.Join(c.in, " "))
+		err := run(coreutils.Context{Stdout: &out, Stderr: &out}, args...)
 		if err != nil {
-			log.Fatal(err)
+			t.Fatalf("basename %q: %v", args, err)
 		}
 
 		got := out.String()
@@ -59,5 +60,3 @@ func TestBasename(t *testing.T) {
 	}
 
 }
-
-func main() {}
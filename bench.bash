@@ -0,0 +1,204 @@
+#!/usr/bin/env bash
+
+# Copyright (c) 2015 Eric Lagergren
+# This is public domain.
+
+# Runs the benchmarks, and times the utilities against the system's own
+# (GNU's, on most Linux systems) on the same generated data. Every result
+# is written as a line of JSON:
+#
+#	{"suite":"go","name":"wc/BenchmarkCount/ascii/l","ns_per_op":519541,"mb_per_s":8073.1}
+#	{"suite":"cli","name":"wc -l/ascii","impl":"go","seconds":0.031,"mb_per_s":2064.5}
+#	{"suite":"cli","name":"wc -l/ascii","impl":"gnu","seconds":0.022,"mb_per_s":2909.1}
+#
+# Usage: bench.bash [-o RESULTS] [-b BASELINE] [-t PERCENT] [-n RUNS] [-s BYTES]
+#
+#	-o	where to write the results (default bench.jsonl)
+#	-b	results of an earlier run: anything that got more than PERCENT
+#		slower than it did there is reported, and bench.bash exits 1
+#	-t	how much slower counts as a regression (default 10)
+#	-n	how many times each utility is run; the fastest is kept (default 5)
+#	-s	size of each of the text files (default 64MB)
+#
+# BENCH=regexp picks the Go benchmarks to run (default all of them), and
+# BENCH=none skips them. The utilities are run with LC_ALL=C.UTF-8 so GNU's
+# count multibyte characters, like ours always do.
+
+set -uo pipefail
+
+out=bench.jsonl
+baseline=
+threshold=10
+runs=5
+size=$((64 << 20))
+while getopts o:b:t:n:s: opt; do
+	case "${opt}" in
+	o) out="${OPTARG}" ;;
+	b) baseline="${OPTARG}" ;;
+	t) threshold="${OPTARG}" ;;
+	n) runs="${OPTARG}" ;;
+	s) size="${OPTARG}" ;;
+	*) exit 2 ;;
+	esac
+done
+
+work="$(mktemp -d "${TMPDIR:-/tmp}/bench.XXXXXX")"
+trap 'rm -rf "${work}"' EXIT
+
+export LC_ALL=C.UTF-8
+
+go build -o "${work}/bin/coreutils" ./cmd/coreutils || exit 1
+go run ./cmd/benchdata --size "${size}" "${work}/data" || exit 1
+data="${work}/data"
+
+: > "${out}"
+
+# The Go benchmarks, one line of JSON each.
+if [ "${BENCH:-.}" != none ]; then
+	go test -run '^$' -bench "${BENCH:-.}" -benchmem \
+		./wc ./cat ./md5sum/checksum_common ./xxd ./tsort ./rm |
+		awk '
+		/^pkg: / { n = split($2, p, "/"); pkg = p[n] }
+		/^Benchmark/ {
+			name = $1
+			sub(/-[0-9]+$/, "", name)
+			line = "{\"suite\":\"go\",\"name\":\"" pkg "/" name "\""
+			for (i = 3; i < NF; i += 2) {
+				unit = $(i + 1)
+				gsub(/\//, "_per_", unit)
+				gsub(/[^A-Za-z0-9_]/, "_", unit)
+				line = line ",\"" tolower(unit) "\":" $i
+			}
+			print line "}"
+		}' >> "${out}"
+fi
+
+# fastest prints the fastest of ${runs} runs of a command, in seconds.
+fastest() {
+	local best= t i
+	for ((i = 0; i < runs; i++)); do
+		t="$( { TIMEFORMAT=%R; time "$@" > /dev/null 2>&1; } 2>&1 )"
+		if [ -z "${best}" ] || awk -v a="${t}" -v b="${best}" 'BEGIN { exit !(a < b) }'; then
+			best="${t}"
+		fi
+	done
+	echo "${best}"
+}
+
+# record writes the result of a run of a utility over n of something,
+# bytes unless a unit is given.
+record() {
+	local name="$1" impl="$2" seconds="$3" n="$4" unit="${5:-mb}"
+	awk -v name="${name}" -v impl="${impl}" -v s="${seconds}" -v n="${n}" -v unit="${unit}" 'BEGIN {
+		rate = s > 0 ? n / s : 0
+		if (unit == "mb") {
+			rate /= 1e6
+		}
+		printf "{\"suite\":\"cli\",\"name\":\"%s\",\"impl\":\"%s\",\"seconds\":%s,\"%s_per_s\":%.1f}\n", name, impl, s, unit, rate
+	}' >> "${out}"
+}
+
+# impl prints gnu if the system's tool is GNU's, or else system.
+impl() {
+	"$1" --version 2>&1 | grep -qs GNU && echo gnu || echo system
+}
+
+# compare times a utility and the system's, given as the name in the
+# results, the number of bytes it reads, the system's tool, and then the
+# commands to run ours and the system's, separated by --. The system's is
+# skipped if its tool isn't installed.
+compare() {
+	local name="$1" bytes="$2" tool="$3" go=()
+	shift 3
+	while [ "$1" != -- ]; do
+		go+=("$1")
+		shift
+	done
+	shift
+
+	record "${name}" go "$(fastest "${go[@]}")" "${bytes}"
+	if command -v "${tool}" > /dev/null; then
+		record "${name}" "$(impl "${tool}")" "$(fastest "$@")" "${bytes}"
+	fi
+}
+
+cu="${work}/bin/coreutils"
+for kind in ascii utf8 longlines; do
+	f="${data}/${kind}.txt"
+	n="$(stat -c %s "${f}" 2> /dev/null || stat -f %z "${f}")"
+	for opt in -l -w -m -c -L -lwc; do
+		compare "wc ${opt}/${kind}" "${n}" wc "${cu}" wc "${opt}" "${f}" -- wc "${opt}" "${f}"
+	done
+	compare "cat/${kind}" "${n}" cat "${cu}" cat "${f}" -- cat "${f}"
+	compare "cat -A/${kind}" "${n}" cat "${cu}" cat -A "${f}" -- cat -A "${f}"
+	compare "md5sum/${kind}" "${n}" md5sum "${cu}" md5sum "${f}" -- md5sum "${f}"
+	compare "sha256sum/${kind}" "${n}" sha256sum "${cu}" sha256sum "${f}" -- sha256sum "${f}"
+	compare "xxd/${kind}" "${n}" xxd "${cu}" xxd "${f}" -- xxd "${f}"
+done
+
+f="${data}/graph.txt"
+n="$(stat -c %s "${f}" 2> /dev/null || stat -f %z "${f}")"
+compare "tsort/graph" "${n}" tsort "${cu}" tsort "${f}" -- tsort "${f}"
+
+small="$(find "${data}/small" -type f | wc -l | tr -d ' ')"
+compare "cat/small" "$(cat "${data}"/small/*/* | wc -c)" cat \
+	sh -c "${cu} cat ${data}/small/*/*" -- sh -c "cat ${data}/small/*/*"
+
+# rm gets a fresh copy of the small files for every run, which isn't timed.
+rmtree() {
+	local best= t i
+	for ((i = 0; i < runs; i++)); do
+		cp -R "${data}/small" "${work}/tree"
+		t="$( { TIMEFORMAT=%R; time "$@" "${work}/tree" > /dev/null 2>&1; } 2>&1 )"
+		rm -rf "${work}/tree"
+		if [ -z "${best}" ] || awk -v a="${t}" -v b="${best}" 'BEGIN { exit !(a < b) }'; then
+			best="${t}"
+		fi
+	done
+	echo "${best}"
+}
+record "rm -r/small" go "$(rmtree "${cu}" rm -r)" "${small}" files
+record "rm -r/small" "$(impl rm)" "$(rmtree rm -r)" "${small}" files
+
+echo "results written to ${out}" >&2
+
+[ -n "${baseline}" ] || exit 0
+
+# A result is slower if its time, or a benchmark's time per op, went up.
+# Only our own results are compared, and not runs that took less than 10ms
+# both times, which are mostly starting the process.
+awk -v threshold="${threshold}" '
+function field(line, key,    m) {
+	if (match(line, "\"" key "\":[^,}]*")) {
+		m = substr(line, RSTART + length(key) + 3, RLENGTH - length(key) - 3)
+		gsub(/"/, "", m)
+		return m
+	}
+	return ""
+}
+{
+	if (field($0, "impl") != "" && field($0, "impl") != "go") {
+		next
+	}
+	key = field($0, "suite") " " field($0, "name")
+	cost = field($0, "seconds")
+	if (cost == "") {
+		cost = field($0, "ns_per_op")
+	}
+	if (FILENAME == ARGV[1]) {
+		base[key] = cost
+		next
+	}
+	if (!(key in base) || base[key] <= 0) {
+		next
+	}
+	if (field($0, "suite") == "cli" && base[key] < 0.01 && cost < 0.01) {
+		next
+	}
+	change = (cost - base[key]) / base[key] * 100
+	if (change > threshold) {
+		printf "regression: %s: %s -> %s (+%.1f%%)\n", key, base[key], cost, change
+		bad = 1
+	}
+}
+END { exit bad }' "${baseline}" "${out}" >&2
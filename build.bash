@@ -8,8 +8,21 @@ set -uo pipefail
 
 : > build.log
 
+bin="$(go env GOBIN)"
+if [ -z "${bin}" ]; then
+	bin="$(go env GOPATH)/bin"
+fi
+
+# The utilities that register themselves are all built into one binary,
+# which is linked to under each of their names.
+go install -v ./cmd/coreutils >> build.log 2>&1
+for name in $("${bin}/coreutils" --list); do
+	ln -sf coreutils "${bin}/${name}"
+done
+
+# The rest are still programs of their own.
 for d in *; do
-	if [ -d "${d}" ]; then
+	if [ -d "${d}" ] && grep -qs '^package main' "${d}"/*.go; then
 		
 		cd "${d}"
 		go generate >> ../build.log 2>&1
@@ -17,4 +30,4 @@ for d in *; do
 		cd ../
 		
 	fi
-done
\ No newline at end of file
+done
@@ -12,14 +12,21 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package cal
 
+import "bufio"
 import "fmt"
-import flag "github.com/ogier/pflag"
+import "io"
 import "strconv"
-import "log"
 import "time"
 
+import coreutils "github.com/ericlagergren/go-coreutils"
+import flag "github.com/spf13/pflag"
+
+func init() {
+	coreutils.Register("cal", run)
+}
+
 func leapyear(year int) int {
 	//Return 1 if leapyear, 0 if not
 	if year%4 == 0 && (year%100 != 0 || year%400 == 0) {
@@ -59,51 +66,63 @@ func monthlen(month int, year int) int {
 	return 0
 }
 
-func calendar(month int, year int) {
+func calendar(w io.Writer, month int, year int) {
 	weekday := int(time.Date(year, time.Month(month), 1, 0, 0, 0, 0, time.UTC).Weekday())
-	fmt.Printf("%s %d\n", time.Month(month).String(), year)
-	fmt.Printf("Su Mo Tu We Th Fr Sa\n")
+	fmt.Fprintf(w, "%s %d\n", time.Month(month).String(), year)
+	fmt.Fprintf(w, "Su Mo Tu We Th Fr Sa\n")
 	for i := 0; i < weekday; i++ {
-		fmt.Printf("   ")
+		fmt.Fprintf(w, "   ")
 	}
 	for day := 1; day <= monthlen(month, year); day++ {
 		if weekday == 6 {
-			fmt.Printf("%2d\n", day)
+			fmt.Fprintf(w, "%2d\n", day)
 			weekday = 0
 		} else {
-			fmt.Printf("%2d ", day)
+			fmt.Fprintf(w, "%2d ", day)
 			weekday++
 		}
 	}
 	if weekday != 6 {
-		fmt.Printf("\n")
+		fmt.Fprintf(w, "\n")
 	}
 }
 
-func main() {
-	flag.Parse()
-	if len(flag.Args()) == 0 {
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var f flag.FlagSet
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "cal: %v\n", err)
+		}
+	}()
+
+	w := bufio.NewWriter(ctx.Stdout)
+	if f.NArg() == 0 {
 		year := int(time.Now().Year())
 		month := int(time.Now().Month())
-		calendar(month, year)
-	} else if len(flag.Args()) == 1 {
-		year, err := strconv.Atoi(flag.Arg(0))
+		calendar(w, month, year)
+	} else if f.NArg() == 1 {
+		year, err := strconv.Atoi(f.Arg(0))
 		if err != nil {
-			log.Fatal(err)
+			return err
 		}
 		for month := 1; month <= 12; month++ {
-			calendar(month, year)
-			fmt.Println()
+			calendar(w, month, year)
+			fmt.Fprintln(w)
 		}
-	} else if len(flag.Args()) == 2 {
-		month, err := strconv.Atoi(flag.Arg(0))
+	} else if f.NArg() == 2 {
+		month, err := strconv.Atoi(f.Arg(0))
 		if err != nil {
-			log.Fatal(err)
+			return err
 		}
-		year, err := strconv.Atoi(flag.Arg(1))
+		year, err := strconv.Atoi(f.Arg(1))
 		if err != nil {
-			log.Fatal(err)
+			return err
 		}
-		calendar(month, year)
+		calendar(w, month, year)
 	}
+	return w.Flush()
 }
@@ -1,36 +1,44 @@
 // Copyright (c) 2014-2016 Eric Lagergren
 // Use of this source code is governed by the GPL v3 or later.
 
-package main
+package cat
 
 import (
 	"bufio"
 	"fmt"
 	"io"
-	"log"
 	"os"
 
-	"github.com/EricLagergren/go-coreutils/internal/flag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+	"github.com/ericlagergren/go-coreutils/internal/sys"
+	flag "github.com/spf13/pflag"
 )
 
-var (
-	all        = flag.BoolP("show-all", "A", false, "equivalent to -vET")
-	blank      = flag.BoolP("number-nonblank", "b", false, "number nonempty output lines, overrides -n")
-	npEnds     = flag.BoolP("ends", "e", false, "equivalent to -vE")
-	ends       = flag.BoolP("show-ends", "E", false, "display $ at end of each line")
-	number     = flag.BoolP("number", "n", false, "number all output lines")
-	squeeze    = flag.BoolP("squeeze-blank", "s", false, "suppress repeated empty output lines")
-	npTabs     = flag.BoolP("tabs", "t", false, "equivalent to -vT")
-	tabs       = flag.BoolP("show-tabs", "T", false, "display TAB characters as ^I")
-	nonPrint   = flag.BoolP("non-printing", "v", false, "use ^ and M- notation, except for LFD and TAB")
-	unbuffered = flag.BoolP("unbuffered", "u", false, "(ignored)")
+func init() {
+	coreutils.Register("cat", run)
+}
+
+// catter is one run of cat: the options it was given, and the line number,
+// which carries on from one file to the next.
+type catter struct {
+	blank, ends, number, squeeze, tabs bool
 
 	totalNewline    int64
 	showNonPrinting bool
 	simple          bool
 
-	fatal = log.New(os.Stderr, "", 0)
-)
+	lineBuf              [lineLen]byte
+	linePrint, lineStart int
+}
+
+func newCatter() *catter {
+	return &catter{
+		lineBuf:   lineBuf,
+		linePrint: lineLen - 7,
+		lineStart: lineLen - 2,
+	}
+}
 
 const caret = '^'
 
@@ -45,16 +53,13 @@ const (
 	lineEnd = lineLen - 2
 )
 
-var (
-	lineBuf = [...]byte{
-		' ', ' ', ' ', ' ', ' ',
-		' ', ' ', ' ', ' ', ' ',
-		' ', ' ', ' ', ' ', ' ',
-		' ', ' ', ' ', '0', '\t',
-	}
-	linePrint = lineLen - 7
-	lineStart = lineLen - 2
-)
+// lineBuf is what each catter's line number starts out as.
+var lineBuf = [lineLen]byte{
+	' ', ' ', ' ', ' ', ' ',
+	' ', ' ', ' ', ' ', ' ',
+	' ', ' ', ' ', ' ', ' ',
+	' ', ' ', ' ', '0', '\t',
+}
 
 func max(a, b int) int {
 	if a > b {
@@ -63,53 +68,49 @@ func max(a, b int) int {
 	return b
 }
 
-func nextLineNum() {
+func (c *catter) nextLineNum() {
 	ep := lineEnd
 	for {
 		// if it's possible, increment the line number
-		if lineBuf[ep] < '9' {
-			lineBuf[ep]++
+		if c.lineBuf[ep] < '9' {
+			c.lineBuf[ep]++
 			return
 		}
 
 		// otherwise, set it to 0 and move backwards
-		lineBuf[ep] = '0'
+		c.lineBuf[ep] = '0'
 		ep--
 
 		// stop when we've moved past our printing area
-		if ep < lineStart {
+		if ep < c.lineStart {
 			break
 		}
 	}
 
 	// who needs pointer arithmetic? ...said nobody ever
-	if lineStart < len(lineBuf) {
-		lineStart--
-		lineBuf[lineStart] = '1'
+	if c.lineStart < len(c.lineBuf) {
+		c.lineStart--
+		c.lineBuf[c.lineStart] = '1'
 	} else {
-		lineBuf[0] = '>'
+		c.lineBuf[0] = '>'
 	}
 
-	if lineStart < linePrint {
-		linePrint--
+	if c.lineStart < c.linePrint {
+		c.linePrint--
 	}
 }
 
 // simple cat, meaning no formatting -- just copy from input to stdout
-func simpleCat(r io.Reader, w io.Writer) int {
-	_, err := io.Copy(w, r)
-	if err != nil {
-		fatal.Fatalln(err)
-	}
-	return 0 // success! :-)
+func simpleCat(r io.Reader, w io.Writer) (int64, error) {
+	return io.Copy(w, r)
 }
 
-func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
-	newlines := totalNewline // total newlines across invocations
-	var eob int              // end of buffer
-	bpin := eob + 1          // beginning of buffer
-	var ch byte              // char in buffer
-	size := len(buf) - 1     // len of buffer with room for sentinel byte
+func (c *catter) cat(r io.Reader, buf []byte, w *bufio.Writer) int {
+	newlines := c.totalNewline // total newlines across invocations
+	var eob int                // end of buffer
+	bpin := eob + 1            // beginning of buffer
+	var ch byte                // char in buffer
+	size := len(buf) - 1       // len of buffer with room for sentinel byte
 
 	// When I first tried translating this from C the algorithm
 	// Torbjorn and rms used sort of confused me, so I'll try to explain
@@ -147,12 +148,12 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 			if bpin > eob {
 				n, err := r.Read(buf[:size])
 				if err == io.EOF {
-					totalNewline = newlines
+					c.totalNewline = newlines
 					w.Flush()
 					return 0
 				}
 				if err != nil {
-					totalNewline = newlines
+					c.totalNewline = newlines
 					w.Flush()
 					return 1
 				}
@@ -171,7 +172,7 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 						newlines = 2
 
 						// Multiple blank lines?
-						if *squeeze {
+						if c.squeeze {
 							ch = buf[bpin]
 							bpin++
 
@@ -181,14 +182,14 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 					}
 
 					// Line numbers for *empty* lines
-					if *number && !*blank {
-						nextLineNum()
-						w.Write(lineBuf[linePrint:])
+					if c.number && !c.blank {
+						c.nextLineNum()
+						w.Write(c.lineBuf[c.linePrint:])
 					}
 				}
 
 				// Add '$' at EOL if requested
-				if *ends {
+				if c.ends {
 					w.WriteByte('$')
 				}
 
@@ -213,9 +214,9 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 		}
 
 		// Beginning of a line with line numbers requested?
-		if newlines >= 0 && *number {
-			nextLineNum()
-			w.Write(lineBuf[linePrint:])
+		if newlines >= 0 && c.number {
+			c.nextLineNum()
+			w.Write(c.lineBuf[c.linePrint:])
 		}
 
 		// At this point ch will not be a newline, so we loop over
@@ -224,7 +225,7 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 		// than eob because our buffer is (usually) 4096 bytes, and
 		// newlines (usually) occur more often than once per 4096 bytes.
 
-		if showNonPrinting {
+		if c.showNonPrinting {
 			for {
 				if ch >= 32 {
 					if ch < 127 {
@@ -244,7 +245,7 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 							w.WriteByte(ch - 128 + 64)
 						}
 					}
-				} else if ch == 9 && !*tabs {
+				} else if ch == 9 && !c.tabs {
 					w.WriteByte(9)
 				} else if ch == 10 {
 					newlines = -1
@@ -262,7 +263,7 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 		} else {
 			// Not non-printing
 			for {
-				if ch == 9 && *tabs {
+				if ch == 9 && c.tabs {
 					w.Write(horizTab)
 				} else if ch != 10 {
 					w.WriteByte(ch)
@@ -279,37 +280,215 @@ func cat(r io.Reader, buf []byte, w *bufio.Writer) int {
 	}
 }
 
-func init() {
-	flag.Usage = func() {
-		fmt.Printf(`Usage: %s [OPTION]... [FILE]...
+func run(ctx coreutils.Context, args ...string) error {
+	var (
+		f                                       flag.FlagSet
+		c                                       = newCatter()
+		all, npEnds, npTabs, nonPrint, unbuffer bool
+		version                                 bool
+	)
+	f.BoolVarP(&all, "show-all", "A", false, "equivalent to -vET")
+	f.BoolVarP(&c.blank, "number-nonblank", "b", false, "number nonempty output lines, overrides -n")
+	f.BoolVarP(&npEnds, "ends", "e", false, "equivalent to -vE")
+	f.BoolVarP(&c.ends, "show-ends", "E", false, "display $ at end of each line")
+	f.BoolVarP(&c.number, "number", "n", false, "number all output lines")
+	f.BoolVarP(&c.squeeze, "squeeze-blank", "s", false, "suppress repeated empty output lines")
+	f.BoolVarP(&npTabs, "tabs", "t", false, "equivalent to -vT")
+	f.BoolVarP(&c.tabs, "show-tabs", "T", false, "display TAB characters as ^I")
+	f.BoolVarP(&nonPrint, "non-printing", "v", false, "use ^ and M- notation, except for LFD and TAB")
+	f.BoolVarP(&unbuffer, "unbuffered", "u", false, "(ignored)")
+	f.BoolVar(&version, "version", false, "output version information and exit")
+	f.Usage = func() {
+		fmt.Fprintf(ctx.Stdout, `Usage: cat [OPTION]... [FILE]...
 Concatenate FILE(s), or standard input, to standard output.
 
-`, flag.Program)
-		flag.DBE()
+`)
+		f.SetOutput(ctx.Stdout)
+		f.PrintDefaults()
+	}
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	if version {
+		fmt.Fprintln(ctx.Stdout, "cat (go-coreutils) 2.0")
+		return nil
 	}
-	flag.ProgVersion = "2.0"
-	flag.Parse()
 
 	// -vET
-	if *all {
-		*nonPrint = true
-		*npTabs = true
-		*npEnds = true
+	if all {
+		nonPrint = true
+		npTabs = true
+		npEnds = true
 	}
-	if *npEnds {
-		*ends = true
+	if npEnds {
+		c.ends = true
 	}
-	if *blank {
-		*number = true
+	if c.blank {
+		c.number = true
 	}
-	if *npTabs {
-		*tabs = true
+	if npTabs {
+		c.tabs = true
 	}
-	if *all || *npEnds || *npTabs || *nonPrint {
-		showNonPrinting = true
+	if all || npEnds || npTabs || nonPrint {
+		c.showNonPrinting = true
+	}
+	if !(c.number || c.ends || c.showNonPrinting ||
+		c.tabs || c.squeeze) {
+		c.simple = true
+	}
+
+	// catch (./cat) < /etc/group
+	names := f.Args()
+	if len(names) == 0 {
+		names = []string{"-"}
 	}
-	if !(*number || *ends || showNonPrinting ||
-		*tabs || *squeeze) {
-		simple = true
+	return c.catFiles(ctx, names)
+}
+
+// catFiles writes each of the named files to ctx.Stdout, in order. A file
+// that can't be read is reported, and the rest are still written.
+func (c *catter) catFiles(ctx coreutils.Context, names []string) error {
+	var (
+		status   error
+		out, _   = ctx.Stdout.(*os.File)
+		outStat  os.FileInfo
+		outBsize = coreutils.BufferSize
+		pageSize = os.Getpagesize()
+	)
+	report := func(format string, args ...interface{}) {
+		fmt.Fprintf(ctx.Stderr, "cat: "+format+"\n", args...)
+		status = coreutils.ExitCode(1)
+	}
+	if out != nil {
+		var err error
+		if outStat, err = out.Stat(); err != nil {
+			report("%v", err)
+			return status
+		}
+		outBsize = bsize(outStat)
+	}
+
+	for _, name := range names {
+		in := ctx.Stdin
+		file, _ := in.(*os.File)
+		if name != "-" {
+			var err error
+			if file, err = os.Open(name); err != nil {
+				report("%v", err)
+				continue
+			}
+			in = file
+		}
+		if err := c.catFile(ctx, in, file, out, outStat, outBsize, pageSize); err != nil {
+			report("%v", err)
+		}
+		if name != "-" {
+			file.Close()
+		}
+	}
+	return status
+}
+
+// catFile writes in to ctx.Stdout. file and out are in and ctx.Stdout when
+// they're files, which can be copied between in the kernel, or else nil.
+func (c *catter) catFile(ctx coreutils.Context, in io.Reader, file, out *os.File, outStat os.FileInfo, outBsize, pageSize int) error {
+	inBsize := coreutils.BufferSize
+	var inStat os.FileInfo
+	if file != nil {
+		var err error
+		if inStat, err = file.Stat(); err != nil {
+			return err
+		}
+		if inStat.IsDir() {
+			return fmt.Errorf("%s: Is a directory", file.Name())
+		}
+		inBsize = bsize(inStat)
+
+		// prefetch! prefetch! prefetch!
+		sys.Fadvise(int(file.Fd()))
+
+		// Make sure we're not catting a file to itself,
+		// provided it's a regular file. Catting a non-reg
+		// file to itself is cool.
+		// e.g. cat file > file
+		if out != nil && outStat.Mode().IsRegular() && os.SameFile(outStat, inStat) {
+			if n, _ := file.Seek(0, io.SeekCurrent); n < inStat.Size() {
+				return fmt.Errorf("%s: input file is output file", file.Name())
+			}
+		}
+	}
+
+	if !c.simple {
+		// If you want to know why, exactly, I chose
+		// outBsize -1 + inBsize*4 + 20, read GNU's cat
+		// source code. The tl;dr is the 20 is the counter
+		// buffer, inBsize*4 is from potentially prepending
+		// the control characters (M-^), and outBsize is
+		// due to new tests for newlines.
+		size := outBsize - 1 + inBsize*4 + 20
+		outBuf := bufio.NewWriterSize(ctx.Stats.Writer(ctx.Stdout), size)
+		var inBuf []byte
+		if inBsize < coreutils.BufferSize {
+			inBuf = ctx.Buffer()
+			defer ctx.PutBuffer(inBuf)
+		} else {
+			inBuf = make([]byte, inBsize+pageSize-1)
+		}
+		if c.cat(ctx.Stats.Reader(in), inBuf, outBuf) != 0 {
+			return coreutils.ExitCode(1)
+		}
+		return nil
+	}
+
+	if file == nil {
+		// Nothing to map or hand to the kernel, as when cat is run in
+		// a Pipeline: copy through a shared buffer.
+		buf := ctx.Buffer()
+		defer ctx.PutBuffer(buf)
+		_, err := io.CopyBuffer(ctx.Stats.Writer(ctx.Stdout), ctx.Stats.Reader(in), buf)
+		return err
+	}
+
+	if out != nil {
+		// Let the kernel move the data if it can. Nothing has
+		// been buffered for stdout yet, so it's safe to write
+		// to it directly.
+		done, err := zeroCopy(file, out, inStat, outStat, ctx.Stats)
+		if err != nil || done {
+			return err
+		}
+	}
+
+	// Select larger block size
+	size := max(inBsize, outBsize)
+	outBuf := bufio.NewWriterSize(ctx.Stats.Writer(ctx.Stdout), size+pageSize-1)
+
+	// Large regular files are written straight out of a
+	// mapping; bufio passes writes that big through without
+	// copying them.
+	// Close unmaps mr, so whether it was mapped is kept from before.
+	mr := mmap.NewReader(file)
+	mapped := mr.Mapped()
+	var r io.Reader = mr
+	if !mapped {
+		r = ctx.Stats.Reader(mr)
+	}
+	var n int64
+	err := mmap.Guard(file, func() (err error) {
+		n, err = simpleCat(r, outBuf)
+		return err
+	})
+	mr.Close()
+	if mapped {
+		ctx.Stats.Took("mmap")
+		ctx.Stats.AddMapped(n)
+	}
+
+	// Flush because we don't have a chance to in
+	// simpleCat() because we use io.Copy()
+	if ferr := outBuf.Flush(); err == nil {
+		err = ferr
 	}
+	return err
 }
@@ -1,15 +1,22 @@
 // +build linux
 
-package main
+package cat
 
 import (
 	"bufio"
 	"bytes"
 	"io"
+	"io/ioutil"
 	"os"
 	"os/exec"
+	"path/filepath"
+	"strings"
 	"syscall"
 	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
 )
 
 var flist = [...]string{
@@ -19,77 +26,324 @@ var flist = [...]string{
 	"test_files/coreutils_man_en.txt",
 }
 
-var buf bytes.Buffer
-
 func TestCat(t *testing.T) {
-
-	showNonPrinting = true
-	*nonPrint = true
-	*npEnds = true
-	*npTabs = true
-
-	for i, f := range flist {
-
-		// set up our capture of stdout
-		stdout := os.Stdout
-		r, w, err := os.Pipe()
-		if err != nil {
-			t.Fatal(err)
-		}
-		os.Stdout = w
+	for _, f := range flist {
+		// -A
+		c := newCatter()
+		c.showNonPrinting = true
+		c.ends = true
+		c.tabs = true
 
 		file, err := os.Open(f)
 		if err != nil {
-			t.Error(err)
+			t.Fatal(err)
 		}
 
 		inStat, err := file.Stat()
 		if err != nil {
-			t.Error(err)
+			t.Fatal(err)
 		}
 		if inStat.IsDir() {
-			t.Errorf("%s: is a directory\n", file.Name())
+			t.Fatalf("%s: is a directory\n", file.Name())
 		}
 
+		var out bytes.Buffer
 		inBsize := int(inStat.Sys().(*syscall.Stat_t).Blksize)
 		size := 20 + inBsize*4
-		outBuf := bufio.NewWriterSize(os.Stdout, size)
+		outBuf := bufio.NewWriterSize(&out, size)
 		inBuf := make([]byte, inBsize+1)
 
-		cat(file, inBuf, outBuf)
+		c.cat(file, inBuf, outBuf)
 		file.Close()
 
-		// capture the stdout
-		outC := make(chan string)
-		go func() {
-			var b bytes.Buffer
-			_, err := io.Copy(&b, r)
+		// now get stdout of native cat
+		want, err := exec.Command("cat", "-A", f).Output()
+		if err != nil {
+			t.Fatal(err)
+		}
+
+		// check strings
+		if out.String() != string(want) {
+			t.Fatalf("Got:\n%s\n\nExpected:\n%s\n", out.String(), want)
+		}
+	}
+}
 
-			r.Close()
-			if err != nil {
+// TestRun checks that files, and input that isn't a file, as in a Pipeline,
+// are copied with and without formatting.
+func TestRun(t *testing.T) {
+	want, err := ioutil.ReadFile(flist[2])
+	if err != nil {
+		t.Fatal(err)
+	}
+	numbered, err := exec.Command("cat", "-n", flist[2], flist[2]).Output()
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, tt := range []struct {
+		args  []string
+		stdin bool
+		want  string
+	}{
+		{[]string{flist[2]}, false, string(want)},
+		{[]string{"-", flist[2]}, true, string(want) + string(want)},
+		{[]string{"-n", flist[2], "-"}, true, string(numbered)},
+	} {
+		var stdout, stderr bytes.Buffer
+		var stdin io.Reader = strings.NewReader("")
+		if tt.stdin {
+			stdin = bytes.NewReader(want)
+		}
+		err := run(coreutils.Context{Stdin: stdin, Stdout: &stdout, Stderr: &stderr}, tt.args...)
+		if err != nil {
+			t.Fatalf("%q: %v: %s", tt.args, err, stderr.String())
+		}
+		if stdout.String() != tt.want {
+			t.Fatalf("%q: got %d bytes, want %d", tt.args, stdout.Len(), len(tt.want))
+		}
+	}
+
+	var stdout, stderr bytes.Buffer
+	err = run(coreutils.Context{Stdout: &stdout, Stderr: &stderr}, "nonexistent", flist[2])
+	if coreutils.Status(err) != 1 || stdout.String() != string(want) || !strings.HasPrefix(stderr.String(), "cat: ") {
+		t.Fatalf("missing file: got %v, %d bytes, %q", err, stdout.Len(), stderr.String())
+	}
+}
+
+// TestRunStats checks that a file cat maps is counted as read through the
+// mapping, and one it reads as read with calls.
+func TestRunStats(t *testing.T) {
+	defer func(n int64) { mmap.Threshold = n }(mmap.Threshold)
+	want, err := ioutil.ReadFile(flist[3])
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, tt := range []struct {
+		threshold int64
+		mapped    bool
+	}{
+		{1, true},
+		{1 << 62, false},
+	} {
+		mmap.Threshold = tt.threshold
+		var stdout, stderr bytes.Buffer
+		s := new(coreutils.Stats)
+		err := run(coreutils.Context{Stdout: &stdout, Stderr: &stderr, Stats: s}, flist[3])
+		if err != nil {
+			t.Fatalf("%v: %s", err, stderr.String())
+		}
+		if stdout.String() != string(want) {
+			t.Fatalf("mapped=%t: got %d bytes, want %d", tt.mapped, stdout.Len(), len(want))
+		}
+		if s.BytesRead != int64(len(want)) || s.BytesWritten != int64(len(want)) {
+			t.Errorf("mapped=%t: read %d bytes and wrote %d, want %d", tt.mapped, s.BytesRead, s.BytesWritten, len(want))
+		}
+		if got := s.FastPaths()["mmap"] == 1; got != tt.mapped || (s.Reads == 0) != tt.mapped {
+			t.Errorf("mapped=%t: %d reads, fast paths %v", tt.mapped, s.Reads, s.FastPaths())
+		}
+	}
+}
+
+func TestZeroCopy(t *testing.T) {
+	want, err := ioutil.ReadFile(flist[3])
+	if err != nil {
+		t.Fatal(err)
+	}
+	dir, err := ioutil.TempDir("", "cat")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	copyTo := func(in, out *os.File) {
+		inStat, err := in.Stat()
+		if err != nil {
+			t.Fatal(err)
+		}
+		outStat, err := out.Stat()
+		if err != nil {
+			t.Fatal(err)
+		}
+		ok, err := zeroCopy(in, out, inStat, outStat, nil)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if !ok {
+			// Fall back like cat does.
+			if _, err := io.Copy(out, in); err != nil {
 				t.Fatal(err)
 			}
-			outC <- b.String()
-		}()
-
-		// now get stdout of native cat
-		cat := exec.Command("cat", "-A", flist[i])
+		}
+	}
 
-		b, err := cat.Output()
+	// file to file, then a second time appending to it.
+	out, err := os.Create(dir + "/out")
+	if err != nil {
+		t.Fatal(err)
+	}
+	for i := 0; i < 2; i++ {
+		in, err := os.Open(flist[3])
 		if err != nil {
 			t.Fatal(err)
 		}
-		buf.Write(b)
+		copyTo(in, out)
+		in.Close()
+		out.Close()
+		out, err = os.OpenFile(dir+"/out", os.O_WRONLY|os.O_APPEND, 0)
+		if err != nil {
+			t.Fatal(err)
+		}
+	}
+	out.Close()
+	got, err := ioutil.ReadFile(dir + "/out")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(got, append(want[:len(want):len(want)], want...)) {
+		t.Fatal("file to file: output doesn't match input")
+	}
+
+	// file to pipe, and pipe to file.
+	r, w, err := os.Pipe()
+	if err != nil {
+		t.Fatal(err)
+	}
+	out, err = os.Create(dir + "/out")
+	if err != nil {
+		t.Fatal(err)
+	}
+	done := make(chan struct{})
+	go func() {
+		defer close(done)
+		copyTo(r, out)
+	}()
+	in, err := os.Open(flist[3])
+	if err != nil {
+		t.Fatal(err)
+	}
+	copyTo(in, w)
+	in.Close()
+	w.Close()
+	<-done
+	r.Close()
+	out.Close()
+	got, err = ioutil.ReadFile(dir + "/out")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(got, want) {
+		t.Fatal("file to pipe to file: output doesn't match input")
+	}
+}
 
-		// stop capturing of stdout
+// TestBrokenPipe checks that cat dies of SIGPIPE, like GNU's, when its
+// output is a pipe nobody reads, whether the kernel was moving the data with
+// sendfile, from a file, or splice, from a pipe. The runtime raises SIGPIPE
+// only for the process's own stdout, so cat is run in a child to see it.
+func TestBrokenPipe(t *testing.T) {
+	if os.Getenv("CAT_TEST_BROKEN_PIPE") != "" {
+		ctx := coreutils.Context{Stdin: os.Stdin, Stdout: os.Stdout, Stderr: os.Stderr}
+		err := run(ctx, os.Args[len(os.Args)-1])
+		os.Exit(coreutils.Status(err))
+	}
+	data, err := ioutil.ReadFile(flist[3])
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, name := range []string{flist[3], "-"} {
+		r, w, err := os.Pipe()
+		if err != nil {
+			t.Fatal(err)
+		}
+		r.Close()
+		var stderr bytes.Buffer
+		cmd := exec.Command(os.Args[0], "-test.run=^TestBrokenPipe$", "--", name)
+		cmd.Env = append(os.Environ(), "CAT_TEST_BROKEN_PIPE=1")
+		cmd.Stdin = bytes.NewReader(data)
+		cmd.Stdout = w
+		cmd.Stderr = &stderr
+		err = cmd.Run()
 		w.Close()
-		os.Stdout = stdout
-		out := <-outC
+		ee, ok := err.(*exec.ExitError)
+		if !ok {
+			t.Fatalf("%s: got %v, want SIGPIPE", name, err)
+		}
+		ws := ee.Sys().(syscall.WaitStatus)
+		if !ws.Signaled() || ws.Signal() != syscall.SIGPIPE || stderr.Len() > 0 {
+			t.Errorf("%s: got %v, %q, want SIGPIPE and no message", name, err, stderr.String())
+		}
+	}
+}
 
-		// check strings
-		if out != buf.String() {
-			t.Fatalf("Got:\n%s\n\nExpected:\n%s\n", out, buf.String())
+// BenchmarkCat runs cat on each kind of text: to a file, which can take the
+// kernel's fast paths, to a writer, from a mapping, and formatted.
+func BenchmarkCat(b *testing.B) {
+	dir, err := ioutil.TempDir("", "cat")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	if err := benchdata.Write(dir, 16<<20, 0); err != nil {
+		b.Fatal(err)
+	}
+	devNull, err := os.OpenFile(os.DevNull, os.O_WRONLY, 0)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer devNull.Close()
+
+	for _, k := range benchdata.Kinds {
+		name := filepath.Join(dir, string(k)+".txt")
+		fi, err := os.Stat(name)
+		if err != nil {
+			b.Fatal(err)
+		}
+		for _, bb := range []struct {
+			name   string
+			args   []string
+			stdout io.Writer
+		}{
+			{"file", nil, devNull},
+			{"writer", nil, ioutil.Discard},
+			{"n", []string{"-n"}, ioutil.Discard},
+			{"A", []string{"-A"}, ioutil.Discard},
+		} {
+			b.Run(string(k)+"/"+bb.name, func(b *testing.B) {
+				ctx := coreutils.Context{Stdout: bb.stdout, Stderr: ioutil.Discard}
+				args := append(bb.args[:len(bb.args):len(bb.args)], name)
+				b.SetBytes(fi.Size())
+				for i := 0; i < b.N; i++ {
+					if err := run(ctx, args...); err != nil {
+						b.Fatal(err)
+					}
+				}
+			})
 		}
 	}
+}
 
+// BenchmarkCatFiles runs cat on a lot of small files at once, which is
+// mostly opening and closing them.
+func BenchmarkCatFiles(b *testing.B) {
+	dir, err := ioutil.TempDir("", "cat")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	size, err := benchdata.WriteFiles(dir, 2000, 1<<10)
+	if err != nil {
+		b.Fatal(err)
+	}
+	names, err := filepath.Glob(filepath.Join(dir, "*", "*"))
+	if err != nil {
+		b.Fatal(err)
+	}
+	ctx := coreutils.Context{Stdout: ioutil.Discard, Stderr: ioutil.Discard}
+	b.SetBytes(size)
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := run(ctx, names...); err != nil {
+			b.Fatal(err)
+		}
+	}
 }
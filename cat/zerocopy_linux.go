@@ -0,0 +1,94 @@
+// Copyright (c) 2014-2016 Eric Lagergren
+// Use of this source code is governed by the GPL v3 or later.
+
+package cat
+
+import (
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"golang.org/x/sys/unix"
+)
+
+// maxChunk bounds each copy_file_range, sendfile or splice call. The kernel
+// won't move more than about 2GB per call anyway.
+const maxChunk = 1 << 30
+
+// zeroCopy copies in to out inside the kernel, without the data passing
+// through user space. It picks the syscall from the two files' modes:
+//
+//   - copy_file_range between regular files, which lets the filesystem share
+//     extents or copy server-side instead of moving any data at all,
+//   - sendfile from a regular file to anything else (sockets, pipes, ttys),
+//   - splice when either end is a pipe.
+//
+// It reports false if the kernel can't do the copy (cross-device before Linux
+// 5.3, filesystems or file types that don't support the call, old kernels),
+// in which case the caller should copy whatever is left the usual way. Every
+// call here uses and advances the files' own offsets, so that picks up right
+// where zeroCopy stopped, even if some of the data was already copied.
+//
+// Each call counts in stats as a write, and the call that did the copy as a
+// fast path.
+func zeroCopy(in, out *os.File, inStat, outStat os.FileInfo, stats *coreutils.Stats) (ok bool, err error) {
+	const pipe = os.ModeNamedPipe
+	var (
+		rfd = int(in.Fd())
+		wfd = int(out.Fd())
+	)
+
+	if inStat.Mode().IsRegular() {
+		if outStat.Mode().IsRegular() {
+			ok, err = copyLoop(stats, "copy_file_range", func() (int, error) {
+				return unix.CopyFileRange(rfd, nil, wfd, nil, maxChunk, 0)
+			})
+			if ok || err != nil {
+				return ok, err
+			}
+			// Linux 2.6.33 and later can sendfile to a regular file.
+		}
+		return copyLoop(stats, "sendfile", func() (int, error) {
+			return unix.Sendfile(wfd, rfd, nil, maxChunk)
+		})
+	}
+	if inStat.Mode()&pipe != 0 || outStat.Mode()&pipe != 0 {
+		return copyLoop(stats, "splice", func() (int, error) {
+			n, err := unix.Splice(rfd, nil, wfd, nil, maxChunk, unix.SPLICE_F_MOVE)
+			return int(n), err
+		})
+	}
+	return false, nil
+}
+
+// copyLoop calls fn until it reports the end of the input. It reports false
+// if fn fails in a way that means the kernel can't do this copy, but a
+// plain read/write loop can.
+func copyLoop(stats *coreutils.Stats, name string, fn func() (int, error)) (ok bool, err error) {
+	for {
+		start := stats.Start()
+		n, err := fn()
+		switch err {
+		case nil:
+			stats.AddWrite(n, start)
+			if n == 0 {
+				stats.Took(name)
+				return true, nil
+			}
+		case unix.EINTR:
+		case unix.EPIPE:
+			// The runtime only raises SIGPIPE for a write to a closed
+			// stdout when the write goes through the os package, not a
+			// raw syscall. Falling back makes the next write do that,
+			// so cat dies of SIGPIPE as it would have.
+			return false, nil
+		case unix.EXDEV, unix.EINVAL, unix.ENOSYS, unix.EOPNOTSUPP,
+			unix.EBADF, unix.EPERM, unix.EAGAIN:
+			// EBADF and EPERM come from files opened in a way the call
+			// doesn't support (O_APPEND, for one), and EAGAIN from a
+			// non-blocking output the runtime's poller can wait on.
+			return false, nil
+		default:
+			return false, err
+		}
+	}
+}
@@ -0,0 +1,18 @@
+// Copyright (c) 2014-2016 Eric Lagergren
+// Use of this source code is governed by the GPL v3 or later.
+
+// +build !linux
+
+package cat
+
+import (
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+// zeroCopy is only implemented on Linux. Elsewhere, cat always copies
+// through user space.
+func zeroCopy(in, out *os.File, inStat, outStat os.FileInfo, stats *coreutils.Stats) (ok bool, err error) {
+	return false, nil
+}
@@ -1,3 +1,119 @@
-package main
+// Copyright (c) 2014-2016 Eric Lagergren
+// Use of this source code is governed by the GPL v3 or later.
 
-func main() {}
+/*
+Cksum prints or checks checksums of any type md5sum and friends support, or
+that's been plugged in with checksum_common.RegisterHash, several of them at
+once if needed.
+
+Usage: cksum [OPTION]... [FILE]...
+
+With no FILE, or when FILE is -, read standard input. By default cksum prints
+the POSIX CRC and size of each FILE.
+
+  -a, --algorithm=TYPE[,TYPE]...  print these types of checksum instead, in
+                                  the "TYPE (FILE) = SUM" format. every type
+                                  is computed in a single read of each FILE
+  -c, --check   read tagged checksums from the FILEs and check them
+
+The following three options are useful only when verifying checksums:
+      --quiet    don't print OK for each successfully verified file
+      --status   don't output anything, status code shows success
+  -w, --warn     warn about improperly formated checksum lines
+
+      --help     show help and exit
+      --version  show version and exit
+*/
+package cksum
+
+import (
+	"fmt"
+	"strings"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	cc "github.com/ericlagergren/go-coreutils/md5sum/checksum_common"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("cksum", run)
+}
+
+const (
+	Help = `Usage: cksum [OPTION]... [FILE]...
+Print or check checksums.
+With no FILE, or when FILE is -, read standard input.
+By default, print the POSIX CRC and size of each FILE.
+
+  -a, --algorithm=TYPE[,TYPE]...  print these types of checksum instead, in
+                                  the "TYPE (FILE) = SUM" format. every type
+                                  is computed in a single read of each FILE
+  -c, --check   read tagged checksums from the FILEs and check them
+
+The following three options are useful only when verifying checksums:
+      --quiet    don't print OK for each successfully verified file
+      --status   don't output anything, status code shows success
+  -w, --warn     warn about improperly formated checksum lines
+
+      --help     show help and exit
+      --version  show version and exit
+
+TYPE is one of: %s
+`
+	Version = `cksum (Go coreutils) 0.1
+License GPLv3+: GNU GPL version 3 or later <http://gnu.org/licenses/gpl.html>.
+This is free software: you are free to change and redistribute it.
+There is NO WARRANTY, to the extent permitted by law.
+`
+)
+
+func run(ctx coreutils.Context, args ...string) error {
+	var (
+		f                                       flag.FlagSet
+		algorithm                               string
+		check_sum, no_output, status, show_warn bool
+		show_version                            bool
+	)
+	f.StringVarP(&algorithm, "algorithm", "a", "", "")
+	f.BoolVarP(&check_sum, "check", "c", false, "")
+	f.BoolVarP(&no_output, "quiet", "q", false, "")
+	f.BoolVar(&status, "status", false, "")
+	f.BoolVarP(&show_warn, "warn", "w", true, "")
+	f.BoolVarP(&show_version, "version", "v", false, "")
+	f.Usage = func() {
+		fmt.Fprintf(ctx.Stderr, Help, strings.Join(cc.HashTypes(), ", "))
+	}
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	/* trust --status and --quiet as the same */
+	o := cc.Options{Ctx: ctx, Quiet: no_output || status, Warn: show_warn}
+
+	file_lists := f.Args()
+
+	var ok bool
+	switch {
+	case show_version:
+		fmt.Fprintf(ctx.Stdout, "%s", Version)
+		return nil
+	case check_sum:
+		if len(file_lists) == 0 {
+			file_lists = append(file_lists, "-")
+		}
+		ok = cc.CompareTagged(o, file_lists)
+	case algorithm != "":
+		if len(file_lists) == 0 {
+			file_lists = append(file_lists, "-")
+		}
+		types := strings.Split(strings.ToLower(algorithm), ",")
+		ok = cc.GenerateTagged(o, file_lists, types)
+	default:
+		ok = crc_files(ctx, file_lists)
+	}
+
+	if !ok {
+		return coreutils.ExitCode(1)
+	}
+	return nil
+}
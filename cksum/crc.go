@@ -0,0 +1,108 @@
+// Copyright (c) 2014-2016 Eric Lagergren
+// Use of this source code is governed by the GPL v3 or later.
+
+package cksum
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+// crcTable is the CRC-32 table for POSIX cksum's polynomial, 0x04c11db7.
+// Unlike hash/crc32's tables it's for the unreflected, most significant
+// bit first form of the CRC.
+var crcTable = func() (t [256]uint32) {
+	for i := range t {
+		c := uint32(i) << 24
+		for j := 0; j < 8; j++ {
+			if c&(1<<31) != 0 {
+				c = c<<1 ^ 0x04c11db7
+			} else {
+				c <<= 1
+			}
+		}
+		t[i] = c
+	}
+	return t
+}()
+
+func crcUpdate(crc uint32, p []byte) uint32 {
+	for _, b := range p {
+		crc = crc<<8 ^ crcTable[byte(crc>>24)^b]
+	}
+	return crc
+}
+
+// crc returns the POSIX cksum CRC and size of r's contents. Its reads are
+// counted in stats.
+func crc(r io.Reader, buf []byte, stats *coreutils.Stats) (sum uint32, n int64, err error) {
+	for {
+		start := stats.Start()
+		m, err := r.Read(buf)
+		stats.AddRead(m, start)
+		sum = crcUpdate(sum, buf[:m])
+		n += int64(m)
+		if err == io.EOF {
+			break
+		}
+		if err != nil {
+			return 0, n, err
+		}
+	}
+	// The length goes into the CRC as well, least significant byte first
+	// and without trailing zero bytes.
+	for l := n; l != 0; l >>= 8 {
+		sum = crcUpdate(sum, []byte{byte(l)})
+	}
+	return ^sum, n, nil
+}
+
+// crc_files prints the CRC and size of every file in names, or of ctx.Stdin
+// if there are none.
+func crc_files(ctx coreutils.Context, names []string) bool {
+	var (
+		ok  = true
+		buf = ctx.Buffer()
+		out = bufio.NewWriter(ctx.Stdout)
+	)
+	defer ctx.PutBuffer(buf)
+	defer out.Flush()
+
+	if len(names) == 0 {
+		sum, n, err := crc(ctx.Stdin, buf, ctx.Stats)
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "cksum: %s\n", err)
+			return false
+		}
+		fmt.Fprintf(out, "%d %d\n", sum, n)
+		return true
+	}
+	for _, name := range names {
+		in := ctx.Stdin
+		var file *os.File
+		if name != "-" {
+			var err error
+			if file, err = os.Open(name); err != nil {
+				fmt.Fprintf(ctx.Stderr, "cksum: %s\n", err)
+				ok = false
+				continue
+			}
+			in = file
+		}
+		sum, n, err := crc(in, buf, ctx.Stats)
+		if file != nil {
+			file.Close()
+		}
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "cksum: %s: %s\n", name, err)
+			ok = false
+			continue
+		}
+		fmt.Fprintf(out, "%d %d %s\n", sum, n, name)
+	}
+	return ok
+}
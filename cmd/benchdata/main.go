@@ -0,0 +1,38 @@
+// Command benchdata writes the inputs bench.bash runs the utilities on:
+//
+//	benchdata [--size BYTES] [--files N] [--nodes N] DIR
+//
+// DIR gets ascii.txt, utf8.txt and longlines.txt, each of BYTES bytes, the
+// same each time; graph.txt, for tsort; and in small/, N files of ASCII text
+// of about a kilobyte each.
+package main
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
+	flag "github.com/spf13/pflag"
+)
+
+func main() {
+	size := flag.Int("size", 64<<20, "size of each text file, in bytes")
+	files := flag.Int("files", 10000, "number of small files")
+	nodes := flag.Int("nodes", 200000, "number of nodes in the graph")
+	flag.Parse()
+	if flag.NArg() != 1 {
+		fmt.Fprintln(os.Stderr, "usage: benchdata [--size BYTES] [--files N] [--nodes N] DIR")
+		os.Exit(2)
+	}
+	dir := flag.Arg(0)
+
+	if err := benchdata.Write(dir, *size, *nodes); err != nil {
+		fmt.Fprintf(os.Stderr, "benchdata: %v\n", err)
+		os.Exit(1)
+	}
+	if _, err := benchdata.WriteFiles(filepath.Join(dir, "small"), *files, 1<<10); err != nil {
+		fmt.Fprintf(os.Stderr, "benchdata: %v\n", err)
+		os.Exit(1)
+	}
+}
@@ -0,0 +1,141 @@
+// Command coreutils is all of the utilities in one binary.
+//
+// It runs the utility it's invoked as, so that a link to it named cat runs
+// cat, or else the one named by its first argument:
+//
+//	coreutils cat FILE...
+//
+// One binary is paged in once and shared by every utility, instead of each
+// being a binary of its own to load. 'coreutils --list' prints the names of
+// the utilities, one per line, for making the links; build.bash does that.
+//
+// 'coreutils --stats UTILITY ...' reports on standard error, once the
+// utility exits, what it read and wrote, how long it was blocked doing so,
+// and the fast paths it took; --stats=json reports it as a line of JSON.
+// Through a link, COREUTILS_STATS=text or COREUTILS_STATS=json does the same.
+package main
+
+import (
+	"context"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"time"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+
+	_ "github.com/ericlagergren/go-coreutils/base64"
+	_ "github.com/ericlagergren/go-coreutils/basename"
+	_ "github.com/ericlagergren/go-coreutils/cal"
+	_ "github.com/ericlagergren/go-coreutils/cat"
+	_ "github.com/ericlagergren/go-coreutils/cksum"
+	_ "github.com/ericlagergren/go-coreutils/comm"
+	_ "github.com/ericlagergren/go-coreutils/cp"
+	_ "github.com/ericlagergren/go-coreutils/csplit"
+	_ "github.com/ericlagergren/go-coreutils/cut"
+	_ "github.com/ericlagergren/go-coreutils/dd"
+	_ "github.com/ericlagergren/go-coreutils/du"
+	_ "github.com/ericlagergren/go-coreutils/env"
+	_ "github.com/ericlagergren/go-coreutils/factor"
+	_ "github.com/ericlagergren/go-coreutils/false"
+	_ "github.com/ericlagergren/go-coreutils/md5sum"
+	_ "github.com/ericlagergren/go-coreutils/nl"
+	_ "github.com/ericlagergren/go-coreutils/pwd"
+	_ "github.com/ericlagergren/go-coreutils/rm"
+	_ "github.com/ericlagergren/go-coreutils/seq"
+	_ "github.com/ericlagergren/go-coreutils/sha1sum"
+	_ "github.com/ericlagergren/go-coreutils/sha224sum"
+	_ "github.com/ericlagergren/go-coreutils/sha256sum"
+	_ "github.com/ericlagergren/go-coreutils/sha384sum"
+	_ "github.com/ericlagergren/go-coreutils/sha512sum"
+	_ "github.com/ericlagergren/go-coreutils/shuf"
+	_ "github.com/ericlagergren/go-coreutils/sleep"
+	_ "github.com/ericlagergren/go-coreutils/sort"
+	_ "github.com/ericlagergren/go-coreutils/split"
+	_ "github.com/ericlagergren/go-coreutils/sync"
+	_ "github.com/ericlagergren/go-coreutils/tac"
+	_ "github.com/ericlagergren/go-coreutils/tail"
+	_ "github.com/ericlagergren/go-coreutils/tee"
+	_ "github.com/ericlagergren/go-coreutils/touch"
+	_ "github.com/ericlagergren/go-coreutils/tr"
+	_ "github.com/ericlagergren/go-coreutils/true"
+	_ "github.com/ericlagergren/go-coreutils/tsort"
+	_ "github.com/ericlagergren/go-coreutils/uniq"
+	_ "github.com/ericlagergren/go-coreutils/wc"
+	_ "github.com/ericlagergren/go-coreutils/whoami"
+	_ "github.com/ericlagergren/go-coreutils/xxd"
+	_ "github.com/ericlagergren/go-coreutils/yes"
+)
+
+const usage = `Usage: coreutils UTILITY [ARGUMENT]...
+  or:  UTILITY [ARGUMENT]...  (through a link named UTILITY)
+  or:  coreutils --list
+  or:  coreutils --stats[=FORMAT] UTILITY [ARGUMENT]...
+Run one of the utilities built into this binary.
+
+With --stats, report what UTILITY read and wrote, and how long it waited to,
+on standard error when it exits. FORMAT is text, the default, or json.
+`
+
+func main() {
+	name := strings.TrimSuffix(filepath.Base(os.Args[0]), ".exe")
+	args := os.Args[1:]
+	stats := os.Getenv(coreutils.StatsEnv)
+	if _, ok := coreutils.Lookup(name); !ok {
+		if len(args) > 0 && (args[0] == "--stats" || strings.HasPrefix(args[0], "--stats=")) {
+			stats = "text"
+			if i := strings.IndexByte(args[0], '='); i >= 0 {
+				stats = args[0][i+1:]
+			}
+			args = args[1:]
+		}
+		if len(args) == 0 {
+			fmt.Fprint(os.Stderr, usage)
+			os.Exit(1)
+		}
+		switch args[0] {
+		case "--list":
+			for _, name := range coreutils.Commands() {
+				fmt.Println(name)
+			}
+			return
+		case "--help":
+			fmt.Print(usage)
+			return
+		}
+		name, args = args[0], args[1:]
+		if _, ok := coreutils.Lookup(name); !ok {
+			fmt.Fprintf(os.Stderr, "coreutils: %s: no such utility\n", name)
+			os.Exit(127)
+		}
+	}
+
+	ctx := coreutils.Context{
+		Context: context.Background(),
+		GetEnv:  os.Getenv,
+		Stdin:   os.Stdin,
+		Stdout:  os.Stdout,
+		Stderr:  os.Stderr,
+	}
+	switch stats {
+	case "":
+	case "text", "json":
+		ctx.Stats = new(coreutils.Stats)
+	default:
+		fmt.Fprintf(os.Stderr, "coreutils: unknown stats format '%s'\n", stats)
+		os.Exit(1)
+	}
+
+	start := time.Now()
+	err := coreutils.Run(ctx, name, args...)
+	if ctx.Stats != nil {
+		ctx.Stats.Elapsed = time.Since(start)
+		ctx.Stats.Report(os.Stderr, name, stats)
+	}
+	if err == flag.ErrHelp {
+		return
+	}
+	os.Exit(coreutils.Status(err))
+}
@@ -0,0 +1,132 @@
+package comm
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("comm", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -1 but not --1.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+	bad2       = string(rune(uniNonChar + 2))
+	bad3       = string(rune(uniNonChar + 3))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.hide[0], bad1, "1", false, "suppress column 1 (lines unique to FILE1)")
+	c.f.BoolVarP(&c.hide[1], bad2, "2", false, "suppress column 2 (lines unique to FILE2)")
+	c.f.BoolVarP(&c.hide[2], bad3, "3", false, "suppress column 3 (lines that appear in both files)")
+	c.f.BoolVar(&c.checkOrder, "check-order", false, "check that the input is correctly sorted, even if all input lines are pairable")
+	c.f.BoolVar(&c.noCheckOrder, "nocheck-order", false, "do not check that the input is correctly sorted")
+	c.f.StringVar(&c.delimiter, "output-delimiter", "\t", "separate columns with STR")
+	c.f.BoolVar(&c.total, "total", false, "output a summary")
+	c.f.BoolVarP(&c.zero, "zero-terminated", "z", false, "line delimiter is NUL, not newline")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f            flag.FlagSet
+	hide         [3]bool
+	checkOrder   bool
+	noCheckOrder bool
+	delimiter    string
+	total        bool
+	zero         bool
+	version      bool
+}
+
+// errUnsorted is returned when the input turned out not to be sorted, but
+// the comparison was finished anyway.
+var errUnsorted = errors.New("input is not in sorted order")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "comm (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "comm: %v\n", err)
+		}
+	}()
+
+	switch names := c.f.Args(); {
+	case len(names) < 2:
+		if len(names) == 0 {
+			return errors.New("missing operand")
+		}
+		return fmt.Errorf("missing operand after '%s'", names[0])
+	case len(names) > 2:
+		return fmt.Errorf("extra operand '%s'", names[2])
+	}
+
+	cm := &Comm{
+		Hide:           c.hide,
+		Delimiter:      c.delimiter,
+		Total:          c.total,
+		ZeroTerminated: c.zero,
+	}
+	if c.delimiter == "" {
+		// As in GNU comm, an empty delimiter is a NUL.
+		cm.Delimiter = "\x00"
+	}
+	switch {
+	case c.checkOrder:
+		cm.Order = Check
+	case c.noCheckOrder:
+		cm.Order = NoCheck
+	}
+	warned := false
+	cm.Disorder = func(file int) {
+		fmt.Fprintf(ctx.Stderr, "comm: file %d is not in sorted order\n", file)
+		warned = true
+	}
+
+	var in [2]io.Reader
+	for i, name := range c.f.Args() {
+		if name == "-" {
+			in[i] = ctx.Stdin
+			continue
+		}
+		f, err := os.Open(name)
+		if err != nil {
+			return fmt.Errorf("%s: %v", name, unwrap(err))
+		}
+		defer f.Close()
+		in[i] = f
+	}
+
+	if err := cm.Run(ctx.Stdout, in[0], in[1]); err != nil {
+		return unwrap(err)
+	}
+	if warned {
+		return errUnsorted
+	}
+	return nil
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
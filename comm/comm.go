@@ -1,3 +1,215 @@
-package main
+// Package comm compares two sorted files line by line.
+//
+// Both files are read with internal/lines, which keeps the previous line of
+// each valid while the next is read, so lines are compared, including
+// against the line before them to check the order, without being copied.
+package comm
 
-func main() {}
+import (
+	"bufio"
+	"bytes"
+	"fmt"
+	"io"
+	"strconv"
+
+	"github.com/ericlagergren/go-coreutils/internal/lines"
+)
+
+// Order says when Comm checks that its inputs are sorted.
+type Order int
+
+const (
+	// CheckDefault checks the order once a line that isn't in both
+	// files has been seen, and reports disorder without stopping.
+	CheckDefault Order = iota
+	Check              // check every line, and stop at disorder
+	NoCheck
+)
+
+// Comm compares two sorted inputs.
+type Comm struct {
+	// Hide suppresses the columns of lines only in the first input, only
+	// in the second, and in both.
+	Hide [3]bool
+
+	Delimiter      string // between columns; a tab if it's empty
+	Order          Order
+	Total          bool // finish with the number of lines in each column
+	ZeroTerminated bool
+
+	// Compare orders lines. If it's nil lines are compared byte by byte,
+	// as in the C locale.
+	Compare func(a, b []byte) int
+
+	// Disorder, if not nil, is called the first time either input is
+	// found to be out of order, with CheckDefault: 1 for the first input
+	// and 2 for the second.
+	Disorder func(file int)
+}
+
+// DisorderError is returned by Run for an input that's out of order, with
+// Check.
+type DisorderError struct {
+	File int // 1 or 2
+}
+
+func (e *DisorderError) Error() string {
+	return fmt.Sprintf("file %d is not in sorted order", e.File)
+}
+
+func (c *Comm) delim() byte {
+	if c.ZeroTerminated {
+		return 0
+	}
+	return '\n'
+}
+
+// Run writes the lines of a and b to w in three columns: lines only in a,
+// lines only in b, and lines in both.
+func (c *Comm) Run(w io.Writer, a, b io.Reader) error {
+	out := bufio.NewWriterSize(w, 64*1024)
+	delim := c.delim()
+	cmp := c.Compare
+	if cmp == nil {
+		cmp = bytes.Compare
+	}
+	sep := c.Delimiter
+	if sep == "" {
+		sep = "\t"
+	}
+	// What goes before the lines of each column.
+	var prefix [3]string
+	prefix[1] = sepIf(!c.Hide[0], sep)
+	prefix[2] = prefix[1] + sepIf(!c.Hide[1], sep)
+
+	type input struct {
+		r         *lines.Reader
+		line      []byte
+		prev      []byte
+		ok        bool // line is valid
+		warned    bool
+		checked   bool // prev is valid
+		unchecked bool // line was read before the order was checked
+	}
+	ins := [2]*input{
+		{r: lines.NewReader(a, delim)},
+		{r: lines.NewReader(b, delim)},
+	}
+	var (
+		totals     [3]int64
+		unpairable bool
+	)
+	disorder := func(i int) error {
+		in := ins[i]
+		if c.Order == Check {
+			return &DisorderError{File: i + 1}
+		}
+		in.warned = true
+		if c.Disorder != nil {
+			out.Flush()
+			c.Disorder(i + 1)
+		}
+		return nil
+	}
+	advance := func(i int) error {
+		in := ins[i]
+		// As in GNU comm, a last line read before the order was being
+		// checked is checked once it's known to be last. Its previous
+		// line may not outlive the next read, so it's compared now.
+		late := in.ok && in.unchecked && unpairable && !in.warned &&
+			c.Order != NoCheck && cmp(in.prev, in.line) > 0
+		if in.ok {
+			in.prev, in.checked = in.line, true
+		}
+		line, err := in.r.Next()
+		if err == io.EOF {
+			in.ok = false
+			if late {
+				return disorder(i)
+			}
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+		in.line, in.ok, in.unchecked = line, true, false
+		if c.Order == NoCheck || in.warned || !in.checked {
+			return nil
+		}
+		if c.Order != Check && !unpairable {
+			in.unchecked = true
+			return nil
+		}
+		if cmp(in.prev, in.line) > 0 {
+			return disorder(i)
+		}
+		return nil
+	}
+	put := func(col int, line []byte) {
+		totals[col]++
+		if c.Hide[col] {
+			return
+		}
+		out.WriteString(prefix[col])
+		out.Write(line)
+		out.WriteByte(delim)
+	}
+
+	for i := range ins {
+		if err := advance(i); err != nil {
+			out.Flush()
+			return err
+		}
+	}
+	for ins[0].ok || ins[1].ok {
+		var order int
+		switch {
+		case !ins[0].ok:
+			order = 1
+		case !ins[1].ok:
+			order = -1
+		default:
+			order = cmp(ins[0].line, ins[1].line)
+		}
+
+		var err error
+		switch {
+		case order < 0:
+			unpairable = true
+			put(0, ins[0].line)
+			err = advance(0)
+		case order > 0:
+			unpairable = true
+			put(1, ins[1].line)
+			err = advance(1)
+		default:
+			put(2, ins[0].line)
+			if err = advance(0); err == nil {
+				err = advance(1)
+			}
+		}
+		if err != nil {
+			out.Flush()
+			return err
+		}
+	}
+
+	if c.Total {
+		var num []byte
+		for _, n := range totals {
+			num = strconv.AppendInt(num, n, 10)
+			num = append(num, sep...)
+		}
+		out.Write(num)
+		out.WriteString("total")
+		out.WriteByte(delim)
+	}
+	return out.Flush()
+}
+
+func sepIf(ok bool, sep string) string {
+	if ok {
+		return sep
+	}
+	return ""
+}
@@ -0,0 +1,78 @@
+package comm
+
+import (
+	"bytes"
+	"context"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+func TestComm(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "comm")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	write := func(name, data string) string {
+		name = filepath.Join(tmp, name)
+		if err := ioutil.WriteFile(name, []byte(data), 0644); err != nil {
+			t.Fatal(err)
+		}
+		return name
+	}
+	f1 := write("1", "a\nb\nd\ne\n")
+	f2 := write("2", "b\nc\ne\nf\n")
+	unsorted := write("3", "b\na\n")
+	// Out of order before anything is unpairable, and not last, so GNU
+	// comm never notices.
+	unnoticed := write("4", "b\na\nd\n")
+
+	commRun := func(args ...string) (string, string, error) {
+		var stdout, stderr bytes.Buffer
+		err := run(coreutils.Context{
+			Context: context.Background(),
+			Stdin:   strings.NewReader("b\nc\ne\nf\n"),
+			Stdout:  &stdout,
+			Stderr:  &stderr,
+		}, args...)
+		return stdout.String(), stderr.String(), err
+	}
+
+	for _, tc := range []struct {
+		args []string
+		want string
+	}{
+		{[]string{f1, f2}, "a\n\t\tb\n\tc\nd\n\t\te\n\tf\n"},
+		{[]string{f1, "-"}, "a\n\t\tb\n\tc\nd\n\t\te\n\tf\n"},
+		{[]string{"-12", f1, f2}, "b\ne\n"},
+		{[]string{"-3", f1, f2}, "a\n\tc\nd\n\tf\n"},
+		{[]string{"--total", f1, f2}, "a\n\t\tb\n\tc\nd\n\t\te\n\tf\n2\t2\t2\ttotal\n"},
+		{[]string{"--output-delimiter=|", f1, f2}, "a\n||b\n|c\nd\n||e\n|f\n"},
+	} {
+		got, _, err := commRun(tc.args...)
+		if err != nil || got != tc.want {
+			t.Errorf("%q: got %q, %v, want %q", tc.args, got, err, tc.want)
+		}
+	}
+
+	// Disorder is reported once there's a line that isn't in both files,
+	// and the comparison finished, unless it's asked to be checked.
+	got, stderr, err := commRun(unsorted, f2)
+	if err != errUnsorted || got != "\t\tb\na\n\tc\n\te\n\tf\n" || !strings.Contains(stderr, "file 1 is not in sorted order") {
+		t.Errorf("unsorted: got %q, %q, %v", got, stderr, err)
+	}
+	if _, _, err := commRun("--check-order", unsorted, f2); err == nil || err == errUnsorted {
+		t.Errorf("--check-order: got %v", err)
+	}
+	if _, _, err := commRun("--nocheck-order", unsorted, f2); err != nil {
+		t.Errorf("--nocheck-order: got %v", err)
+	}
+	if got, stderr, err := commRun(unnoticed, f2); err != nil || got != "\t\tb\na\n\tc\nd\n\te\n\tf\n" || stderr != "" {
+		t.Errorf("unnoticed: got %q, %q, %v", got, stderr, err)
+	}
+}
@@ -1,15 +1,22 @@
+// Package coreutils is a registry of the utilities, so they can all be run
+// in one process: from the single coreutils binary, which runs the one it's
+// invoked as, or from Go, without starting a process at all.
 package coreutils
 
 import (
 	"context"
-	"errors"
+	"fmt"
 	"io"
+	"sort"
+	"strconv"
 	"sync"
 )
 
 var cmdsMu sync.Mutex
 var cmds = make(map[string]Runnable)
 
+// Register makes r available as name. It's called from the init functions
+// of the utilities' packages, so importing a package registers it.
 func Register(name string, r Runnable) {
 	cmdsMu.Lock()
 	defer cmdsMu.Unlock()
@@ -19,8 +26,32 @@ func Register(name string, r Runnable) {
 	cmds[name] = r
 }
 
+// Lookup returns the utility registered as name.
+func Lookup(name string) (Runnable, bool) {
+	cmdsMu.Lock()
+	fn, ok := cmds[name]
+	cmdsMu.Unlock()
+	return fn, ok
+}
+
+// Commands returns the names of the registered utilities, sorted.
+func Commands() []string {
+	cmdsMu.Lock()
+	names := make([]string, 0, len(cmds))
+	for name := range cmds {
+		names = append(names, name)
+	}
+	cmdsMu.Unlock()
+	sort.Strings(names)
+	return names
+}
+
+// Runnable runs a utility with its arguments, not including its name. It
+// reports its own errors on ctx.Stderr; the error it returns only says
+// that it failed, and how.
 type Runnable func(ctx Context, args ...string) error
 
+// Context is what a utility would get from its process.
 type Context struct {
 	context.Context
 	Dir    string
@@ -28,14 +59,122 @@ type Context struct {
 	Stdin  io.Reader
 	Stdout io.Writer
 	Stderr io.Writer
+
+	// Stats, if non-nil, counts the utility's I/O.
+	Stats *Stats
+}
+
+// BufferSize is the size of the buffers handed out by Context.Buffer.
+const BufferSize = 128 << 10
+
+// buffers is shared by everything running in the process, so a short-lived
+// utility, run many times over, doesn't allocate its large buffers each
+// time.
+var buffers = sync.Pool{
+	New: func() interface{} {
+		b := make([]byte, BufferSize)
+		return &b
+	},
+}
+
+// Buffer returns a BufferSize buffer for I/O. It should be given back with
+// PutBuffer once it's no longer used, and nothing may use it after that.
+func (ctx Context) Buffer() []byte {
+	return *buffers.Get().(*[]byte)
+}
+
+// PutBuffer gives back a buffer from Buffer.
+func (ctx Context) PutBuffer(b []byte) {
+	if cap(b) != BufferSize {
+		return
+	}
+	b = b[:BufferSize]
+	buffers.Put(&b)
+}
+
+// ExitCode is returned by a utility that exits with a status other than 1,
+// or without a message.
+type ExitCode int
+
+func (e ExitCode) Error() string { return "exit status " + strconv.Itoa(int(e)) }
+
+// Status returns the exit status for a utility's error.
+func Status(err error) int {
+	switch e := err.(type) {
+	case nil:
+		return 0
+	case ExitCode:
+		return int(e)
+	}
+	return 1
 }
 
+// Run runs the utility registered as name.
 func Run(ctx Context, name string, args ...string) error {
-	cmdsMu.Lock()
-	fn := cmds[name]
-	cmdsMu.Unlock()
-	if fn == nil {
-		return errors.New("invalid function ...")
+	fn, ok := Lookup(name)
+	if !ok {
+		return fmt.Errorf("%s: command not found", name)
 	}
 	return fn(ctx, args...)
 }
+
+// Command is one stage of a Pipeline.
+type Command struct {
+	Name string
+	Args []string
+
+	// Stats, if non-nil, counts this command's I/O instead of the
+	// Pipeline's ctx.Stats.
+	Stats *Stats
+}
+
+// Pipeline runs cmds at once, each one's standard output connected to the
+// next one's standard input, as a shell would. The first reads ctx.Stdin
+// and the last writes ctx.Stdout. They all share ctx.Stderr, which needs to
+// be safe to write to from several goroutines.
+//
+// The commands are connected with io.Pipe, so each write is handed straight
+// to the read waiting for it, without being copied to a buffer in between.
+// A command that stops reading early, as head does, closes its end, and the
+// one writing to it then fails to write, as it would on EPIPE. As in a shell
+// without pipefail, Pipeline returns the error of the last command; the
+// others report their own on Stderr.
+func Pipeline(ctx Context, cmds ...Command) error {
+	if len(cmds) == 0 {
+		return nil
+	}
+	var (
+		errs = make([]error, len(cmds))
+		wg   sync.WaitGroup
+		prev *io.PipeReader
+	)
+	for i, c := range cmds {
+		stage := ctx
+		if c.Stats != nil {
+			stage.Stats = c.Stats
+		}
+		if prev != nil {
+			stage.Stdin = prev
+		}
+		var r *io.PipeReader
+		var w *io.PipeWriter
+		if i < len(cmds)-1 {
+			r, w = io.Pipe()
+			stage.Stdout = w
+		}
+		wg.Add(1)
+		go func(i int, c Command, stage Context, in *io.PipeReader, out *io.PipeWriter) {
+			defer wg.Done()
+			errs[i] = Run(stage, c.Name, c.Args...)
+			if out != nil {
+				out.Close()
+			}
+			if in != nil {
+				in.Close()
+			}
+		}(i, c, stage, prev, w)
+		prev = r
+	}
+	wg.Wait()
+	return errs[len(errs)-1]
+}
@@ -0,0 +1,144 @@
+package coreutils
+
+import (
+	"bufio"
+	"bytes"
+	"errors"
+	"fmt"
+	"io"
+	"strings"
+	"testing"
+)
+
+func init() {
+	Register("test-upper", func(ctx Context, args ...string) error {
+		buf := ctx.Buffer()
+		defer ctx.PutBuffer(buf)
+		for {
+			n, err := ctx.Stdin.Read(buf)
+			if _, werr := ctx.Stdout.Write(bytes.ToUpper(buf[:n])); werr != nil {
+				return werr
+			}
+			if err == io.EOF {
+				return nil
+			}
+			if err != nil {
+				return err
+			}
+		}
+	})
+	// test-head copies the first line and stops reading.
+	Register("test-head", func(ctx Context, args ...string) error {
+		line, err := bufio.NewReader(ctx.Stdin).ReadString('\n')
+		if err != nil && err != io.EOF {
+			return err
+		}
+		_, err = io.WriteString(ctx.Stdout, line)
+		return err
+	})
+	// test-stats counts that it ran.
+	Register("test-stats", func(ctx Context, args ...string) error {
+		ctx.Stats.Took("ran")
+		return nil
+	})
+	// test-loop writes until it's told to stop.
+	Register("test-loop", func(ctx Context, args ...string) error {
+		for {
+			if _, err := io.WriteString(ctx.Stdout, "loop\n"); err != nil {
+				return err
+			}
+		}
+	})
+	Register("test-exit", func(ctx Context, args ...string) error {
+		return ExitCode(len(args))
+	})
+}
+
+func TestPipeline(t *testing.T) {
+	var out bytes.Buffer
+	ctx := Context{Stdin: strings.NewReader("a\nb\n"), Stdout: &out}
+	err := Pipeline(ctx,
+		Command{Name: "test-upper"},
+		Command{Name: "test-head"},
+	)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if out.String() != "A\n" {
+		t.Fatalf("got %q", out.String())
+	}
+
+	// The first command fails to write once the last stops reading,
+	// rather than writing forever.
+	out.Reset()
+	err = Pipeline(ctx,
+		Command{Name: "test-loop"},
+		Command{Name: "test-upper"},
+		Command{Name: "test-head"},
+	)
+	if err != nil || out.String() != "LOOP\n" {
+		t.Fatalf("got %v, %q", err, out.String())
+	}
+
+	// Like a shell, the status is the last command's.
+	if err := Pipeline(ctx, Command{Name: "test-exit", Args: []string{"a", "b"}}, Command{Name: "test-upper"}); err != nil {
+		t.Fatalf("got %v", err)
+	}
+	if err := Pipeline(ctx, Command{Name: "test-upper"}, Command{Name: "test-exit", Args: []string{"a", "b"}}); Status(err) != 2 {
+		t.Fatalf("got %v", err)
+	}
+	if err := Pipeline(ctx, Command{Name: "test-upper"}, Command{Name: "nope"}); err == nil {
+		t.Fatal("expected an error")
+	}
+}
+
+func TestStatus(t *testing.T) {
+	for _, tt := range []struct {
+		err  error
+		want int
+	}{
+		{nil, 0},
+		{errors.New("x"), 1},
+		{ExitCode(3), 3},
+	} {
+		if got := Status(tt.err); got != tt.want {
+			t.Errorf("%v: got %d, want %d", tt.err, got, tt.want)
+		}
+	}
+}
+
+func TestBuffer(t *testing.T) {
+	var ctx Context
+	b := ctx.Buffer()
+	if len(b) != BufferSize {
+		t.Fatalf("got %d bytes", len(b))
+	}
+	ctx.PutBuffer(b[:10])
+	if b := ctx.Buffer(); len(b) != BufferSize {
+		t.Fatalf("got %d bytes after a short buffer was given back", len(b))
+	}
+	// Buffers that didn't come from Buffer aren't kept.
+	ctx.PutBuffer(make([]byte, 10))
+}
+
+func TestCommands(t *testing.T) {
+	var found int
+	for _, name := range Commands() {
+		if strings.HasPrefix(name, "test-") {
+			found++
+		}
+	}
+	if found != 5 {
+		t.Fatalf("found %d of the test commands", found)
+	}
+	if _, ok := Lookup("test-head"); !ok {
+		t.Fatal("test-head isn't registered")
+	}
+	if _, ok := Lookup("nope"); ok {
+		t.Fatal("found nope")
+	}
+	err := Run(Context{}, "nope")
+	if want := fmt.Sprintf("%s: command not found", "nope"); err == nil || err.Error() != want {
+		t.Fatalf("got %v, want %q", err, want)
+	}
+}
@@ -0,0 +1,458 @@
+package cp
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+// copyBufSize is the size of each worker's buffer for copies the kernel
+// can't do itself.
+const copyBufSize = 1 << 20
+
+// copier copies files and directory trees. Directories are walked, and
+// created, by the calling goroutine; regular files are handed to a bounded
+// pool of workers, so many small files are copied at once while a large one
+// doesn't hold up the walk. Metadata for directories is applied once every
+// file under them has been copied, since copying a file into a directory
+// changes its timestamps and a read-only mode would keep us from copying into
+// it at all.
+type copier struct {
+	o *Options
+
+	jobs chan copyJob
+	wg   sync.WaitGroup
+
+	failed int32 // set after the first error, so main can exit 1
+
+	// dirs whose metadata is set once the pool is done, in the order
+	// they were created.
+	dirs []dirMeta
+
+	// PreserveLinks: the first copy made of each multiply linked file,
+	// and the links to make to them once they've been copied.
+	links   map[fileID]string
+	pending []hardLink
+
+	outMu  sync.Mutex // for out and stderr
+	out    *bufio.Writer
+	stderr io.Writer
+	stdin  io.Reader
+}
+
+type copyJob struct {
+	src, dst string
+	info     os.FileInfo
+	exists   bool // dst existed, and isn't being replaced
+}
+
+type hardLink struct {
+	target, dst string
+	exists      bool
+}
+
+type dirMeta struct {
+	dst     string
+	info    os.FileInfo
+	created bool
+}
+
+type fileID struct {
+	dev, ino uint64
+}
+
+func newCopier(ctx coreutils.Context, o *Options) *copier {
+	n := runtime.NumCPU()
+	if n < 4 {
+		// Copies spend most of their time waiting on the disk, so a
+		// few more workers than CPUs keeps more requests in flight.
+		n = 4
+	}
+	c := &copier{
+		o:      o,
+		jobs:   make(chan copyJob, 2*n),
+		links:  make(map[fileID]string),
+		out:    bufio.NewWriter(ctx.Stdout),
+		stderr: ctx.Stderr,
+		stdin:  ctx.Stdin,
+	}
+	c.wg.Add(n)
+	for i := 0; i < n; i++ {
+		go func() {
+			defer c.wg.Done()
+			buf := make([]byte, copyBufSize)
+			for j := range c.jobs {
+				if err := c.copyRegular(j, buf); err != nil {
+					c.error(err)
+				}
+			}
+		}()
+	}
+	return c
+}
+
+func (c *copier) error(err error) {
+	atomic.StoreInt32(&c.failed, 1)
+	c.outMu.Lock()
+	fmt.Fprintf(c.stderr, "cp: %v\n", err)
+	c.outMu.Unlock()
+}
+
+func (c *copier) errorf(format string, args ...interface{}) {
+	c.error(fmt.Errorf(format, args...))
+}
+
+func (c *copier) verbose(src, dst string) {
+	if !c.o.Verbose {
+		return
+	}
+	c.outMu.Lock()
+	fmt.Fprintf(c.out, "'%s' -> '%s'\n", src, dst)
+	c.outMu.Unlock()
+}
+
+// wait waits for the pool to finish, then sets the metadata of the
+// directories, deepest first. It reports whether everything was copied.
+func (c *copier) wait() bool {
+	close(c.jobs)
+	c.wg.Wait()
+	for _, l := range c.pending {
+		if l.exists {
+			os.Remove(l.dst)
+		}
+		if err := os.Link(l.target, l.dst); err != nil {
+			c.errorf("cannot create hard link '%s' to '%s': %v", l.dst, l.target, pathErr(err))
+		}
+	}
+	for i := len(c.dirs) - 1; i >= 0; i-- {
+		d := c.dirs[i]
+		if err := c.setMeta(d.dst, d.info, d.created); err != nil {
+			c.error(err)
+		}
+	}
+	c.out.Flush()
+	return atomic.LoadInt32(&c.failed) == 0
+}
+
+// copy copies src to dst. top says whether src was named on the command
+// line, for -H.
+func (c *copier) copy(src, dst string, top bool, rootDev uint64) {
+	o := c.o
+	info, err := os.Lstat(src)
+	if err != nil {
+		c.errorf("cannot stat '%s': %v", src, pathErr(err))
+		return
+	}
+	if info.Mode()&os.ModeSymlink != 0 &&
+		(o.Dereference == derefAlways || o.Dereference == derefArgs && top) {
+		if info, err = os.Stat(src); err != nil {
+			c.errorf("cannot stat '%s': %v", src, pathErr(err))
+			return
+		}
+	}
+	if top {
+		rootDev = devOf(info)
+	}
+
+	dinfo, derr := os.Lstat(dst)
+	exists := derr == nil
+	if exists && os.SameFile(info, dinfo) {
+		c.errorf("'%s' and '%s' are the same file", src, dst)
+		return
+	}
+
+	if info.IsDir() {
+		c.copyDir(src, dst, info, dinfo, exists, rootDev)
+		return
+	}
+
+	if exists {
+		if dinfo.IsDir() {
+			c.errorf("cannot overwrite directory '%s' with non-directory", dst)
+			return
+		}
+		switch o.Interactive {
+		case alwaysNo:
+			return
+		case alwaysAsk:
+			c.outMu.Lock()
+			c.out.Flush()
+			fmt.Fprintf(c.stderr, "cp: overwrite '%s'? ", dst)
+			ok := c.yes()
+			c.outMu.Unlock()
+			if !ok {
+				return
+			}
+		}
+		if o.Update && !dinfo.ModTime().Before(info.ModTime()) {
+			return
+		}
+		if o.BackupOpts != noBackups {
+			if err := backupFile(dst, o.BackupSuffix, o.BackupOpts); err != nil {
+				c.errorf("cannot backup '%s': %v", dst, pathErr(err))
+				return
+			}
+			exists = false
+		} else if o.UnlinkBefore || info.Mode()&os.ModeType != 0 || o.HardLink || o.SymbolicLink {
+			if err := os.Remove(dst); err != nil {
+				c.errorf("cannot remove '%s': %v", dst, pathErr(err))
+				return
+			}
+			exists = false
+		}
+	}
+
+	c.verbose(src, dst)
+
+	switch {
+	case o.SymbolicLink:
+		if err := os.Symlink(src, dst); err != nil {
+			c.errorf("cannot create symbolic link '%s': %v", dst, pathErr(err))
+		}
+		return
+	case o.HardLink:
+		if err := os.Link(src, dst); err != nil {
+			c.errorf("cannot create hard link '%s' to '%s': %v", dst, src, pathErr(err))
+		}
+		return
+	}
+
+	if o.PreserveLinks && !info.IsDir() && nlinkOf(info) > 1 {
+		id := idOf(info)
+		first, ok := c.links[id]
+		if ok {
+			// The first copy may still be in the pool.
+			c.pending = append(c.pending, hardLink{target: first, dst: dst, exists: exists})
+			return
+		}
+		c.links[id] = dst
+	}
+
+	switch mode := info.Mode(); {
+	case mode.IsRegular() || o.AsRegular && mode&os.ModeSymlink == 0:
+		c.jobs <- copyJob{src: src, dst: dst, info: info, exists: exists}
+	case mode&os.ModeSymlink != 0:
+		target, err := os.Readlink(src)
+		if err == nil {
+			err = os.Symlink(target, dst)
+		}
+		if err != nil {
+			c.errorf("cannot create symbolic link '%s': %v", dst, pathErr(err))
+			return
+		}
+		if err := c.setMeta(dst, info, true); err != nil {
+			c.error(err)
+		}
+	default:
+		if err := makeSpecial(dst, info); err != nil {
+			c.errorf("cannot create special file '%s': %v", dst, pathErr(err))
+			return
+		}
+		if err := c.setMeta(dst, info, true); err != nil {
+			c.error(err)
+		}
+	}
+}
+
+func (c *copier) copyDir(src, dst string, info, dinfo os.FileInfo, exists bool, rootDev uint64) {
+	o := c.o
+	if !o.Recursive {
+		c.errorf("-r not specified; omitting directory '%s'", src)
+		return
+	}
+	if within(dst, src) {
+		c.errorf("cannot copy a directory, '%s', into itself, '%s'", src, dst)
+		return
+	}
+	if exists && !dinfo.IsDir() {
+		c.errorf("cannot overwrite non-directory '%s' with directory '%s'", dst, src)
+		return
+	}
+
+	if !exists {
+		// Make sure we can fill it in; the real mode is set at the end.
+		if err := os.Mkdir(dst, info.Mode().Perm()|0700); err != nil {
+			c.errorf("cannot create directory '%s': %v", dst, pathErr(err))
+			return
+		}
+		c.verbose(src, dst)
+	}
+	c.dirs = append(c.dirs, dirMeta{dst: dst, info: info, created: !exists})
+
+	if o.OneFS && devOf(info) != rootDev {
+		return
+	}
+
+	dir, err := os.Open(src)
+	if err != nil {
+		c.errorf("cannot access '%s': %v", src, pathErr(err))
+		return
+	}
+	defer dir.Close()
+	for {
+		names, err := dir.Readdirnames(1024)
+		for _, name := range names {
+			c.copy(filepath.Join(src, name), filepath.Join(dst, name), false, rootDev)
+		}
+		if err == io.EOF {
+			return
+		}
+		if err != nil {
+			c.errorf("cannot read directory '%s': %v", src, pathErr(err))
+			return
+		}
+	}
+}
+
+// copyRegular copies the data of a file (or, with --copy-contents, whatever
+// can be read from it) and then its metadata.
+func (c *copier) copyRegular(j copyJob, buf []byte) error {
+	o := c.o
+	in, err := os.Open(j.src)
+	if err != nil {
+		return fmt.Errorf("cannot open '%s' for reading: %v", j.src, pathErr(err))
+	}
+	defer in.Close()
+
+	flags := os.O_WRONLY | os.O_CREATE
+	if o.DataCopyRequired {
+		flags |= os.O_TRUNC
+	}
+	if !j.exists {
+		flags |= os.O_EXCL
+	}
+	out, err := os.OpenFile(j.dst, flags, j.info.Mode().Perm())
+	if err != nil && j.exists && o.UnlinkAfterFailed {
+		if os.Remove(j.dst) == nil {
+			j.exists = false
+			out, err = os.OpenFile(j.dst, flags|os.O_EXCL, j.info.Mode().Perm())
+		}
+	}
+	if err != nil {
+		return fmt.Errorf("cannot create regular file '%s': %v", j.dst, pathErr(err))
+	}
+
+	if o.DataCopyRequired {
+		if err := copyData(out, in, j.info, o, buf); err != nil {
+			out.Close()
+			return fmt.Errorf("error copying '%s' to '%s': %v", j.src, j.dst, pathErr(err))
+		}
+	}
+	if err := out.Close(); err != nil {
+		return fmt.Errorf("error writing '%s': %v", j.dst, pathErr(err))
+	}
+	return c.setMeta(j.dst, j.info, !j.exists)
+}
+
+// setMeta applies what --preserve asked for to dst. created says whether cp
+// made dst, in which case a directory's mode is always set, since it was
+// created writable.
+func (c *copier) setMeta(dst string, info os.FileInfo, created bool) error {
+	o := c.o
+	link := info.Mode()&os.ModeSymlink != 0
+	if o.PreserveOwnership {
+		uid, gid := ownerOf(info)
+		if err := os.Lchown(dst, uid, gid); err != nil && o.RequirePreserve && !os.IsPermission(err) {
+			return fmt.Errorf("failed to preserve ownership for '%s': %v", dst, pathErr(err))
+		}
+	}
+	if link {
+		if o.PreserveTimestamps {
+			if err := lutimes(dst, info); err != nil && o.RequirePreserve {
+				return fmt.Errorf("failed to preserve times for '%s': %v", dst, pathErr(err))
+			}
+		}
+		return nil
+	}
+	switch {
+	case o.PreserveMode:
+		if err := os.Chmod(dst, info.Mode()&(os.ModePerm|os.ModeSetuid|os.ModeSetgid|os.ModeSticky)); err != nil {
+			return fmt.Errorf("failed to preserve permissions for '%s': %v", dst, pathErr(err))
+		}
+	case created && info.IsDir():
+		if err := os.Chmod(dst, info.Mode().Perm()&^umask); err != nil {
+			return fmt.Errorf("failed to set permissions for '%s': %v", dst, pathErr(err))
+		}
+	}
+	if o.PreserveTimestamps {
+		if err := os.Chtimes(dst, atimeOf(info), info.ModTime()); err != nil {
+			return fmt.Errorf("failed to preserve times for '%s': %v", dst, pathErr(err))
+		}
+	}
+	return nil
+}
+
+// within reports whether dst is src or somewhere under it.
+func within(dst, src string) bool {
+	d, err1 := filepath.Abs(dst)
+	s, err2 := filepath.Abs(src)
+	if err1 != nil || err2 != nil {
+		return false
+	}
+	return d == s || strings.HasPrefix(d, s+string(filepath.Separator))
+}
+
+// backupFile moves name out of the way, following the --backup control.
+func backupFile(name, suffix string, control int) error {
+	backup := name + suffix
+	if control == numberedBackups || control == numberedExistingBackups {
+		n := highestBackup(name)
+		if n > 0 || control == numberedBackups {
+			backup = name + ".~" + strconv.Itoa(n+1) + "~"
+		}
+	}
+	return os.Rename(name, backup)
+}
+
+// highestBackup returns the highest N of the name.~N~ backups that exist.
+func highestBackup(name string) int {
+	dir, base := filepath.Split(name)
+	if dir == "" {
+		dir = "."
+	}
+	f, err := os.Open(dir)
+	if err != nil {
+		return 0
+	}
+	defer f.Close()
+	names, _ := f.Readdirnames(-1)
+	max := 0
+	prefix := base + ".~"
+	for _, n := range names {
+		if strings.HasPrefix(n, prefix) && strings.HasSuffix(n, "~") {
+			if v, err := strconv.Atoi(n[len(prefix) : len(n)-1]); err == nil && v > max {
+				max = v
+			}
+		}
+	}
+	return max
+}
+
+func (c *copier) yes() bool {
+	var resp string
+	if c.stdin != nil {
+		fmt.Fscanln(c.stdin, &resp)
+	}
+	return len(resp) > 0 && (resp[0] == 'y' || resp[0] == 'Y')
+}
+
+// pathErr strips the operation and path from err, since cp's messages name
+// the file themselves.
+func pathErr(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	if le, ok := err.(*os.LinkError); ok {
+		return le.Err
+	}
+	return err
+}
@@ -0,0 +1,244 @@
+package cp
+
+import (
+	"errors"
+	"io"
+	"os"
+	"syscall"
+	"time"
+
+	"golang.org/x/sys/unix"
+)
+
+// maxChunk bounds each copy_file_range call.
+const maxChunk = 1 << 30
+
+var umask = func() os.FileMode {
+	m := unix.Umask(0)
+	unix.Umask(m)
+	return os.FileMode(m)
+}()
+
+// copyData copies the contents of in, described by info, to the empty file
+// out, doing as little of the work itself as it can:
+//
+//  1. FICLONE shares all of in's extents with out, so the copy takes no
+//     time or space at all on filesystems with reflinks (btrfs, XFS, ...).
+//  2. Otherwise, unless --sparse=always asks us to look for zeros, the
+//     data is copied with copy_file_range, which keeps it inside the
+//     kernel and lets filesystems and NFS servers copy it themselves.
+//     Sparse files are copied one SEEK_DATA/SEEK_HOLE extent at a time,
+//     so their holes stay holes.
+//  3. What the kernel can't copy is copied with pread/pwrite through buf.
+//
+// If out isn't a regular file (/dev/null, a fifo, a terminal) it has no
+// offsets to write at or size to set, so in is just written to it.
+func copyData(out, in *os.File, info os.FileInfo, o *Options, buf []byte) error {
+	outInfo, err := out.Stat()
+	if err != nil {
+		return err
+	}
+	if !outInfo.Mode().IsRegular() {
+		// Hiding out's ReadFrom keeps this to read(2) and write(2)
+		// through buf.
+		_, err := io.CopyBuffer(struct{ io.Writer }{out}, in, buf)
+		return err
+	}
+
+	rfd, wfd := int(in.Fd()), int(out.Fd())
+	size := info.Size()
+
+	if o.RefLinkMode != reflinkNever && info.Mode().IsRegular() {
+		err := unix.IoctlFileClone(wfd, rfd)
+		if err == nil {
+			return nil
+		}
+		if o.RefLinkMode == reflinkAlways {
+			return &os.PathError{Op: "clone", Path: out.Name(), Err: err}
+		}
+	}
+
+	// Files that claim to be empty (those in /proc, for one) or aren't
+	// regular files are read until EOF.
+	if size == 0 || !info.Mode().IsRegular() {
+		return readWrite(wfd, rfd, 0, -1, false, buf)
+	}
+
+	zeros := o.SparseMode == sparseAlways
+	kernel := o.RefLinkMode != reflinkNever && !zeros
+	if o.SparseMode == sparseNever || !isSparse(info) {
+		if err := copyRange(wfd, rfd, 0, size, kernel, zeros, buf); err != nil {
+			return err
+		}
+	} else {
+		for off := int64(0); off < size; {
+			data, err := unix.Seek(rfd, off, unix.SEEK_DATA)
+			if err == unix.ENXIO {
+				break // a hole up to the end
+			}
+			if err != nil {
+				// No SEEK_DATA; fall back to copying (and maybe
+				// scanning) everything.
+				if err := copyRange(wfd, rfd, off, size-off, kernel, true, buf); err != nil {
+					return err
+				}
+				break
+			}
+			hole, err := unix.Seek(rfd, data, unix.SEEK_HOLE)
+			if err != nil {
+				hole = size
+			}
+			if hole > size {
+				hole = size
+			}
+			if err := copyRange(wfd, rfd, data, hole-data, kernel, zeros, buf); err != nil {
+				return err
+			}
+			off = hole
+		}
+	}
+	// Holes, at the end of the file or where zeros weren't written, need the
+	// size set explicitly.
+	return unix.Ftruncate(wfd, size)
+}
+
+// isSparse reports whether info's file has fewer blocks than its size needs.
+func isSparse(info os.FileInfo) bool {
+	st, ok := info.Sys().(*syscall.Stat_t)
+	return ok && st.Blocks*512 < st.Size
+}
+
+// copyRange copies n bytes at off from rfd to the same offset in wfd.
+func copyRange(wfd, rfd int, off, n int64, kernel, zeros bool, buf []byte) error {
+	if kernel {
+		roff, woff := off, off
+		for n > 0 {
+			chunk := n
+			if chunk > maxChunk {
+				chunk = maxChunk
+			}
+			m, err := unix.CopyFileRange(rfd, &roff, wfd, &woff, int(chunk), 0)
+			if err == unix.EINTR {
+				continue
+			}
+			if err != nil || m == 0 {
+				// EXDEV before Linux 5.3, EINVAL or EOPNOTSUPP
+				// from filesystems that can't, ENOSYS before 4.5.
+				// The rest is copied the slow way, and any real
+				// I/O error shows up there again.
+				break
+			}
+			n -= int64(m)
+		}
+		off = roff
+	}
+	if n <= 0 {
+		return nil
+	}
+	return readWrite(wfd, rfd, off, n, zeros, buf)
+}
+
+// readWrite copies n bytes at off from rfd to wfd with pread and pwrite, or
+// up to EOF if n is negative. With zeros, blocks of nul bytes are skipped
+// instead of written, leaving holes.
+func readWrite(wfd, rfd int, off, n int64, zeros bool, buf []byte) error {
+	const block = 4096
+	for n != 0 {
+		p := buf
+		if n > 0 && int64(len(p)) > n {
+			p = p[:n]
+		}
+		m, err := unix.Pread(rfd, p, off)
+		if err == unix.EINTR {
+			continue
+		}
+		if err != nil {
+			return err
+		}
+		if m == 0 {
+			if n > 0 {
+				return io.ErrUnexpectedEOF
+			}
+			return nil
+		}
+		p = p[:m]
+
+		for len(p) > 0 {
+			// With zeros, leading blocks of nuls are skipped, and the
+			// rest is written up to the next one.
+			skip, end := 0, len(p)
+			if zeros {
+				for skip < len(p) && allZero(p[skip:minInt(skip+block, len(p))]) {
+					skip += block
+				}
+				skip = minInt(skip, len(p))
+				for end = skip; end < len(p) && !allZero(p[end:minInt(end+block, len(p))]); end += block {
+				}
+				end = minInt(end, len(p))
+			}
+			if end == skip {
+				off += int64(skip)
+				p = p[skip:]
+				continue
+			}
+			k, err := unix.Pwrite(wfd, p[skip:end], off+int64(skip))
+			if err == unix.EINTR {
+				continue
+			}
+			if err != nil {
+				return err
+			}
+			if k == 0 {
+				return io.ErrShortWrite
+			}
+			off += int64(skip + k)
+			p = p[skip+k:]
+		}
+		if n > 0 {
+			n -= int64(m)
+		}
+	}
+	return nil
+}
+
+func allZero(p []byte) bool {
+	for _, c := range p {
+		if c != 0 {
+			return false
+		}
+	}
+	return true
+}
+
+func minInt(a, b int) int {
+	if a < b {
+		return a
+	}
+	return b
+}
+
+func makeSpecial(dst string, info os.FileInfo) error {
+	st, ok := info.Sys().(*syscall.Stat_t)
+	if !ok {
+		return errors.New("unknown file type")
+	}
+	mode := st.Mode &^ uint32(umask)
+	return unix.Mknod(dst, mode, int(st.Rdev))
+}
+
+func atimeOf(info os.FileInfo) time.Time {
+	st, ok := info.Sys().(*syscall.Stat_t)
+	if !ok {
+		return info.ModTime()
+	}
+	return time.Unix(st.Atim.Unix())
+}
+
+// lutimes sets the times of a symbolic link itself.
+func lutimes(dst string, info os.FileInfo) error {
+	ts := []unix.Timespec{
+		unix.NsecToTimespec(atimeOf(info).UnixNano()),
+		unix.NsecToTimespec(info.ModTime().UnixNano()),
+	}
+	return unix.UtimesNanoAt(unix.AT_FDCWD, dst, ts, unix.AT_SYMLINK_NOFOLLOW)
+}
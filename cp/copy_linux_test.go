@@ -0,0 +1,105 @@
+package cp
+
+import (
+	"bytes"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"syscall"
+	"testing"
+)
+
+// TestCopySparse checks that holes in a file stay holes in its copy.
+func TestCopySparse(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "cp")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	// A hole in the middle, and one at the end.
+	src := filepath.Join(tmp, "holes")
+	f, err := os.Create(src)
+	if err != nil {
+		t.Fatal(err)
+	}
+	block := bytes.Repeat([]byte("0123456789abcdef"), 256)
+	f.Write(block)
+	f.WriteAt(block, 8<<20)
+	f.Truncate(16 << 20)
+	f.Close()
+
+	dst := filepath.Join(tmp, "copy")
+	c := newCopier(testContext, &Options{
+		DataCopyRequired: true,
+		RefLinkMode:      reflinkAuto,
+		SparseMode:       sparseAuto,
+	})
+	c.copy(src, dst, true, 0)
+	if !c.wait() {
+		t.Fatal("copy failed")
+	}
+	want, _ := ioutil.ReadFile(src)
+	got, err := ioutil.ReadFile(dst)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(got, want) {
+		t.Error("contents differ")
+	}
+	sinfo, _ := os.Stat(src)
+	dinfo, err := os.Stat(dst)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if isSparse(sinfo) && !isSparse(dinfo) {
+		t.Errorf("copy isn't sparse (%d blocks)", dinfo.Sys().(*syscall.Stat_t).Blocks)
+	}
+}
+
+// TestCopyToSpecial checks copies to destinations that aren't regular files,
+// which can't be seeked, truncated or handed to copy_file_range.
+func TestCopyToSpecial(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "cp")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	src := filepath.Join(tmp, "src")
+	data := bytes.Repeat([]byte("0123456789abcdef"), 1<<16)
+	if err := ioutil.WriteFile(src, data, 0644); err != nil {
+		t.Fatal(err)
+	}
+	fifo := filepath.Join(tmp, "fifo")
+	if err := syscall.Mkfifo(fifo, 0644); err != nil {
+		t.Fatal(err)
+	}
+
+	for _, tc := range []struct {
+		dst  string
+		opts Options
+	}{
+		{os.DevNull, Options{DataCopyRequired: true, RefLinkMode: reflinkAuto, SparseMode: sparseAuto}},
+		{os.DevNull, Options{DataCopyRequired: true, SparseMode: sparseAlways}},
+		{fifo, Options{DataCopyRequired: true, RefLinkMode: reflinkAuto, SparseMode: sparseAuto}},
+	} {
+		got := make(chan []byte)
+		if tc.dst == fifo {
+			go func() {
+				b, _ := ioutil.ReadFile(fifo)
+				got <- b
+			}()
+		}
+		c := newCopier(testContext, &tc.opts)
+		c.copy(src, tc.dst, true, 0)
+		if !c.wait() {
+			t.Fatalf("%s: copy failed", tc.dst)
+		}
+		if tc.dst == fifo {
+			if b := <-got; !bytes.Equal(b, data) {
+				t.Errorf("%s: got %d bytes, want %d", tc.dst, len(b), len(data))
+			}
+		}
+	}
+}
@@ -0,0 +1,29 @@
+// +build !linux
+
+package cp
+
+import (
+	"errors"
+	"io"
+	"os"
+	"time"
+)
+
+const umask os.FileMode = 022
+
+// copyData copies the contents of in to the empty file out.
+func copyData(out, in *os.File, info os.FileInfo, o *Options, buf []byte) error {
+	if o.RefLinkMode == reflinkAlways {
+		return errors.New("reflinks aren't supported on this system")
+	}
+	_, err := io.CopyBuffer(out, in, buf)
+	return err
+}
+
+func makeSpecial(dst string, info os.FileInfo) error {
+	return errors.New("copying special files isn't supported on this system")
+}
+
+func atimeOf(info os.FileInfo) time.Time { return info.ModTime() }
+
+func lutimes(dst string, info os.FileInfo) error { return nil }
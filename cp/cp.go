@@ -1,17 +1,22 @@
-package main
+package cp
 
 import (
 	"bytes"
+	"errors"
 	"fmt"
-	"log"
 	"os"
-	"path"
+	"path/filepath"
 	"strings"
 	"syscall"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("cp", run)
+}
+
 const (
 	HELP    = `HELP`
 	VERSION = `VERSION`
@@ -56,51 +61,16 @@ const (
 	numberedBackups
 )
 
-var (
-	archive           = flag.BoolP("archive", "a", false, "")
-	attrOnly          = flag.Bool("attributes-only", false, "")
-	backup            = flag.String("backup", "", "")
-	backup2           = flag.Bool("b", false, "")
-	copyContents      = flag.Bool("copy-contents", false, "")
-	ndrpl             = flag.Bool("d", false, "")
-	dereference       = flag.BoolP("dereference", "L", false, "")
-	force             = flag.BoolP("force", "f", false, "")
-	hopt              = flag.Bool("H", false, "")
-	interactive       = flag.BoolP("interactive", "i", false, "")
-	link              = flag.BoolP("link", "l", false, "")
-	noClobber         = flag.BoolP("no-clobber", "n", false, "")
-	noDereference     = flag.BoolP("no-dereference", "P", false, "")
-	noPreserve        = flag.String("no-preserve", "", "")
-	noTargetDir       = flag.BoolP("no-target-directory", "T", false, "")
-	oneFS             = flag.BoolP("one-file-system", "x", false, "")
-	parents           = flag.Bool("parents", false, "")
-	path              = flag.Bool("path", false, "")
-	pmot              = flag.Bool("p", false, "")
-	preserve          = flag.String("preserve", "", "")
-	recursive         = flag.BoolP("recursive", "R", false, "")
-	recursive2        = flag.Bool("r", false, "")
-	removeDestination = flag.Bool("remove-destination", false, "")
-	sparse            = flag.String("sparse", "界", "")
-	reflink           = flag.String("reflink", "世", "")
-	selinux           = flag.Bool("Z", false, "")
-	stripTrailSlash   = flag.Bool("strip-trailing-slashes", false, "")
-	suffix            = flag.StringP("suffix", "S", "", "")
-	symLink           = flag.BoolP("symbolic-link", "s", false, "")
-	targetDir         = flag.StringP("target-directory", "t", "", "")
-	update            = flag.BoolP("update", "u", false, "")
-	verbose           = flag.BoolP("verbose", "v", false, "")
-	version           = flag.Bool("version", false, "")
-)
-
-var (
-	makeBackups      bool
-	copyConts        bool
-	parentsOpt       bool
-	removeTrailSlash bool
-	noTargDir        bool
-	targDir          string
-	versControl      string
-	suffixString     string
+// Sentinel names for flags with single-character options and without
+// multi-character options. (e.g., if we want -r but not --r.)
+const (
+	uniNonChar = 0xFDD0
+	short1     = string(rune(uniNonChar + 1))
+	short2     = string(rune(uniNonChar + 2))
+	short3     = string(rune(uniNonChar + 3))
+	short4     = string(rune(uniNonChar + 4))
+	short5     = string(rune(uniNonChar + 5))
+	short6     = string(rune(uniNonChar + 6))
 )
 
 type Options struct {
@@ -137,6 +107,10 @@ type Options struct {
 
 	Update  bool
 	Verbose bool
+
+	BackupSuffix         string // --suffix, when BackupOpts isn't noBackups
+	Parents              bool   // --parents
+	StripTrailingSlashes bool   // --strip-trailing-slashes
 }
 
 // sparse argument list
@@ -148,6 +122,7 @@ var sparseArgList = []string{
 
 // reflink argument list
 var reflinkArgList = []string{
+	"never",
 	"auto",
 	"always",
 }
@@ -171,18 +146,18 @@ func stripSlash(str string) string {
 
 // returns true if `file` is a directory as well as a pointer to
 // a os.FileInfo struct
-func isDir(file string) (bool, *os.FileInfo) {
+func isDir(file string) (bool, *os.FileInfo, error) {
 	info, err := os.Stat(file)
 	if err != nil {
 		if err.(*os.PathError).Err != syscall.ENOENT {
-			log.Fatalf("%s failed to access %s", err, file)
+			return false, nil, fmt.Errorf("failed to access %s: %v", file, pathErr(err))
 		}
-		return false, nil
+		return false, nil, nil
 	}
-	return info.Mode().IsDir(), &info
+	return info.Mode().IsDir(), &info, nil
 }
 
-func getVersion(version string) int {
+func getVersion(version string, getenv func(string) string) (int, error) {
 
 	argList := []string{
 		"none", "off", // 0
@@ -191,15 +166,17 @@ func getVersion(version string) int {
 		"numbered", "t", // 3
 	}
 
-	if version != "" {
-		return argmatch(version, argList)
-	} else {
-		if version == "" {
-			return numberedExistingBackups
-		}
-		return argmatch(os.Getenv("VERSION_CONTROL"), argList)
+	if version == "" {
+		version = getenv("VERSION_CONTROL")
 	}
-
+	if version == "" {
+		return numberedExistingBackups, nil
+	}
+	v := argmatch(version, argList)
+	if v < 0 {
+		return 0, fmt.Errorf("invalid argument %s for backup type", version)
+	}
+	return v / 2, nil
 }
 
 // check to see if the given context argument is valid
@@ -218,7 +195,7 @@ func argmatch(arg string, list []string) int {
 }
 
 // set struct Options members' values depending on given string, `args`
-func (o *Options) decodePreserve(args *string, dep bool) {
+func (o *Options) decodePreserve(args string, dep bool) error {
 	// file attr enum
 	const (
 		mode = iota
@@ -240,11 +217,11 @@ func (o *Options) decodePreserve(args *string, dep bool) {
 		"all",
 	}
 
-	l := strings.Split(*args, ",")
+	l := strings.Split(args, ",")
 	for _, v := range l {
 		switch argmatch(v, argList) {
 		case -1:
-			log.Printf("invalid argument %s\n", v)
+			return fmt.Errorf("invalid argument %s", v)
 		case mode:
 			o.PreserveMode = dep
 			o.ExplicitNoPreserve = !dep
@@ -270,70 +247,158 @@ func (o *Options) decodePreserve(args *string, dep bool) {
 			o.PreserveXattr = dep
 		}
 	}
-
+	return nil
 }
 
-func cp(n int, files []string, dir string, noDir bool, options *Options) bool {
-	var dest string
-
+// cp copies files to dir, or with one file and no dir, to the second file.
+// It returns an error for a misuse of the operands, before anything is
+// copied; otherwise it reports whether everything was.
+func cp(ctx coreutils.Context, files []string, dir string, noDir bool, options *Options) (bool, error) {
+	n := len(files)
 	if n <= 0 {
-		log.Fatalln("missing files operand")
+		return false, errors.New("missing file operand")
 	}
 
 	if noDir {
 		if dir != "" {
-			log.Fatalln("cannot combine --target-directory (-t) and --no-target-directory (-T)")
+			return false, errors.New("cannot combine --target-directory (-t) and --no-target-directory (-T)")
 		}
 
 		if 2 < n {
-			log.Fatalf("extra operand %s\n", files[2])
+			return false, fmt.Errorf("extra operand %s", files[2])
 		}
 	} else if dir == "" {
 		if 2 <= n {
-			if ok, _ := isDir(files[n-1]); ok {
+			ok, _, err := isDir(files[n-1])
+			if err != nil {
+				return false, err
+			}
+			if ok {
 				dir = files[n-1]
+				files = files[:n-1]
+			} else if 2 < n {
+				return false, fmt.Errorf("target %s is not a directory", files[n-1])
 			}
-		} else if 2 < n {
-			log.Fatalf("target %s is not a directory", files[n-1])
 		}
 	}
 
-	if dir != "" {
-		for _, v := range files {
-			if removeTrailSlash {
-				v = stripSlash(v)
-			}
+	if dir == "" {
+		if n < 2 {
+			return false, fmt.Errorf("missing destination file operand after %s", files[0])
+		}
+		if options.Parents {
+			return false, errors.New("with --parents, the destination must be a directory")
+		}
+	}
 
-			if parentsOpt {
-				dest = path.Join(targDir, v)
+	c := newCopier(ctx, options)
+	if dir == "" {
+		src := files[0]
+		if options.StripTrailingSlashes {
+			src = stripSlash(src)
+		}
+		c.copy(src, files[1], true, 0)
+		return c.wait(), nil
+	}
+
+	for _, v := range files {
+		if options.StripTrailingSlashes {
+			v = stripSlash(v)
+		}
+
+		var dest string
+		if options.Parents {
+			dest = filepath.Join(dir, v)
+			if err := os.MkdirAll(filepath.Dir(dest), 0777); err != nil {
+				c.error(err)
+				continue
 			}
+		} else {
+			dest = filepath.Join(dir, filepath.Base(v))
 		}
+		c.copy(v, dest, true, 0)
 	}
-	return true
+	return c.wait(), nil
 }
 
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s\n", HELP)
-		return
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f                 flag.FlagSet
+		archive           = f.BoolP("archive", "a", false, "")
+		attrOnly          = f.Bool("attributes-only", false, "")
+		backup            = f.String("backup", "", "")
+		backup2           = f.BoolP(short1, "b", false, "")
+		copyContents      = f.Bool("copy-contents", false, "")
+		ndrpl             = f.BoolP(short2, "d", false, "")
+		dereference       = f.BoolP("dereference", "L", false, "")
+		force             = f.BoolP("force", "f", false, "")
+		hopt              = f.BoolP(short3, "H", false, "")
+		interactive       = f.BoolP("interactive", "i", false, "")
+		link              = f.BoolP("link", "l", false, "")
+		noClobber         = f.BoolP("no-clobber", "n", false, "")
+		noDereference     = f.BoolP("no-dereference", "P", false, "")
+		noPreserve        = f.String("no-preserve", "", "")
+		noTargetDir       = f.BoolP("no-target-directory", "T", false, "")
+		oneFS             = f.BoolP("one-file-system", "x", false, "")
+		parents           = f.Bool("parents", false, "")
+		_                 = f.Bool("path", false, "")
+		pmot              = f.BoolP(short4, "p", false, "")
+		preserve          = f.String("preserve", "", "")
+		recursive         = f.BoolP("recursive", "R", false, "")
+		recursive2        = f.BoolP(short5, "r", false, "")
+		removeDestination = f.Bool("remove-destination", false, "")
+		sparse            = f.String("sparse", "界", "")
+		reflink           = f.String("reflink", "世", "")
+		selinux           = f.BoolP(short6, "Z", false, "")
+		stripTrailSlash   = f.Bool("strip-trailing-slashes", false, "")
+		suffix            = f.StringP("suffix", "S", "", "")
+		symLink           = f.BoolP("symbolic-link", "s", false, "")
+		targetDir         = f.StringP("target-directory", "t", "", "")
+		update            = f.BoolP("update", "u", false, "")
+		verbose           = f.BoolP("verbose", "v", false, "")
+		version           = f.Bool("version", false, "")
+
+		makeBackups bool
+		copyConts   bool
+		targDir     string
+		versControl string
+	)
+	f.Usage = func() {
+		fmt.Fprintf(ctx.Stderr, "%s\n", HELP)
 	}
-	flag.Parse()
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	defer func() {
+		if _, ok := err.(coreutils.ExitCode); err != nil && !ok {
+			fmt.Fprintf(ctx.Stderr, "cp: %v\n", err)
+		}
+	}()
 
 	if *version {
-		fmt.Printf("%s\n", VERSION)
-		return
+		fmt.Fprintf(ctx.Stdout, "%s\n", VERSION)
+		return nil
+	}
+
+	getenv := ctx.GetEnv
+	if getenv == nil {
+		getenv = os.Getenv
 	}
 
 	o := &Options{
-		AsRegular:   true,
-		Dereference: derefUndefined,
+		AsRegular:        true,
+		Dereference:      derefUndefined,
+		DataCopyRequired: true,
+		RefLinkMode:      reflinkAuto,
+		SparseMode:       sparseAuto,
 	}
 
 	if *sparse != "界" {
 		if v := argmatch(*sparse, sparseArgList); v >= 0 {
-			o.SparseMode = v
+			o.SparseMode = sparseNever + v
 		} else {
-			log.Fatalf("invalid agument %s\n", *sparse)
+			return fmt.Errorf("invalid agument %s", *sparse)
 		}
 	}
 
@@ -344,7 +409,7 @@ func main() {
 			if v := argmatch(*reflink, reflinkArgList); v >= 0 {
 				o.RefLinkMode = v
 			} else {
-				log.Fatalf("invalid agument %s\n", *reflink)
+				return fmt.Errorf("invalid agument %s", *reflink)
 			}
 		}
 	}
@@ -357,7 +422,7 @@ func main() {
 		o.PreserveTimestamps = true
 		o.RequirePreserve = true
 		//if selinux is enabled o.PreserveSecurity = true
-		log.Println("unable to preserve security context at the moment")
+		fmt.Fprintln(ctx.Stderr, "cp: unable to preserve security context at the moment")
 		o.PreserveXattr = true
 		o.ReduceDiagnostics = true
 		o.Recursive = true
@@ -412,7 +477,9 @@ func main() {
 	}
 
 	if *noPreserve != "" {
-		o.decodePreserve(noPreserve, false)
+		if err := o.decodePreserve(*noPreserve, false); err != nil {
+			return err
+		}
 	}
 
 	if *preserve == "" && *pmot {
@@ -421,7 +488,9 @@ func main() {
 		o.PreserveTimestamps = true
 		o.RequirePreserve = true
 	} else if *preserve != "" {
-		o.decodePreserve(preserve, true)
+		if err := o.decodePreserve(*preserve, true); err != nil {
+			return err
+		}
 	}
 
 	if *pmot {
@@ -432,7 +501,7 @@ func main() {
 	}
 
 	if *parents {
-		parentsOpt = true
+		o.Parents = true
 	}
 
 	if *recursive || *recursive2 {
@@ -444,7 +513,7 @@ func main() {
 	}
 
 	if *stripTrailSlash {
-		removeTrailSlash = true
+		o.StripTrailingSlashes = true
 	}
 
 	if *symLink {
@@ -453,19 +522,15 @@ func main() {
 
 	if *targetDir != "" {
 		if s, err := os.Stat(*targetDir); err != nil {
-			log.Fatalf("failed to acces %s\n", *targetDir)
+			return fmt.Errorf("failed to acces %s", *targetDir)
 		} else {
 			if !s.Mode().IsDir() {
-				log.Fatalf("target %s is not a directory\n", *targetDir)
+				return fmt.Errorf("target %s is not a directory", *targetDir)
 			}
 			targDir = *targetDir
 		}
 	}
 
-	if *noTargetDir {
-		noTargDir = true
-	}
-
 	if *update {
 		o.Update = true
 	}
@@ -479,31 +544,35 @@ func main() {
 	}
 
 	if *selinux {
-		log.Fatalln("no current way to detect SELinux yet, sorry")
+		return errors.New("no current way to detect SELinux yet, sorry")
 	}
 
 	if *suffix != "" {
 		makeBackups = true
-		suffixString = *suffix
+		o.BackupSuffix = *suffix
 	}
 
 	if o.HardLink && o.SymbolicLink {
-		log.Fatal("cannot make both hard and symbolic links")
+		return errors.New("cannot make both hard and symbolic links")
 	}
 
 	if makeBackups && o.Interactive == alwaysNo {
-		log.Fatalln("options --backup and --no-clobber are mutually exclusive")
+		return errors.New("options --backup and --no-clobber are mutually exclusive")
 	}
 
 	if o.RefLinkMode == reflinkAlways && o.SparseMode != sparseAuto {
-		log.Fatalln("--reflink can only be used with --sparse=auto")
+		return errors.New("--reflink can only be used with --sparse=auto")
 	}
 
-	if suffixString != "" {
-		if makeBackups {
-			o.BackupOpts = getVersion(versControl)
-		} else {
-			o.BackupOpts = noBackups
+	if makeBackups {
+		if o.BackupSuffix == "" {
+			o.BackupSuffix = getenv("SIMPLE_BACKUP_SUFFIX")
+		}
+		if o.BackupSuffix == "" {
+			o.BackupSuffix = "~"
+		}
+		if o.BackupOpts, err = getVersion(versControl, getenv); err != nil {
+			return err
 		}
 	}
 
@@ -523,8 +592,13 @@ func main() {
 		o.UnlinkBefore = true
 	}
 
-	if cp(flag.NArg()-1, flag.Args(), targDir, noTargDir, o) {
-		return
+	ok, err := cp(ctx, f.Args(), targDir, *noTargetDir, o)
+	if err != nil {
+		return err
+	}
+	if !ok {
+		// Each failure was reported as it happened.
+		return coreutils.ExitCode(1)
 	}
-	os.Exit(1)
+	return nil
 }
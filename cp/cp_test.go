@@ -0,0 +1,131 @@
+package cp
+
+import (
+	"bytes"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+var testContext = coreutils.Context{Stdout: ioutil.Discard, Stderr: os.Stderr}
+
+func TestCopyTree(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "cp")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	src := filepath.Join(tmp, "src")
+	sub := filepath.Join(src, "sub")
+	if err := os.MkdirAll(sub, 0755); err != nil {
+		t.Fatal(err)
+	}
+	big := bytes.Repeat([]byte("0123456789abcdef"), 1<<16)
+	files := map[string][]byte{
+		"empty":   nil,
+		"small":   []byte("small\n"),
+		"sub/big": big,
+	}
+	for name, data := range files {
+		if err := ioutil.WriteFile(filepath.Join(src, name), data, 0640); err != nil {
+			t.Fatal(err)
+		}
+	}
+
+	// A file with a hole in the middle, and one at the end.
+	holes := filepath.Join(src, "holes")
+	f, err := os.Create(holes)
+	if err != nil {
+		t.Fatal(err)
+	}
+	f.Write(big[:4096])
+	f.WriteAt(big[:4096], 8<<20)
+	f.Truncate(16 << 20)
+	f.Close()
+
+	if err := os.Symlink("small", filepath.Join(src, "link")); err != nil {
+		t.Fatal(err)
+	}
+	if err := os.Link(filepath.Join(src, "small"), filepath.Join(sub, "hard")); err != nil {
+		t.Fatal(err)
+	}
+	if err := os.Chmod(sub, 0700); err != nil {
+		t.Fatal(err)
+	}
+
+	dst := filepath.Join(tmp, "dst")
+	c := newCopier(testContext, &Options{
+		Dereference:        derefNever,
+		Recursive:          true,
+		PreserveLinks:      true,
+		PreserveMode:       true,
+		PreserveTimestamps: true,
+		DataCopyRequired:   true,
+		RefLinkMode:        reflinkAuto,
+		SparseMode:         sparseAuto,
+	})
+	c.copy(src, dst, true, 0)
+	if !c.wait() {
+		t.Fatal("copy failed")
+	}
+
+	for name, data := range files {
+		got, err := ioutil.ReadFile(filepath.Join(dst, name))
+		if err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(got, data) {
+			t.Errorf("%s: got %d bytes, want %d", name, len(got), len(data))
+		}
+	}
+
+	want, _ := ioutil.ReadFile(holes)
+	got, err := ioutil.ReadFile(filepath.Join(dst, "holes"))
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(got, want) {
+		t.Error("holes: contents differ")
+	}
+
+	if l, err := os.Readlink(filepath.Join(dst, "link")); err != nil || l != "small" {
+		t.Errorf("link: got %q, %v", l, err)
+	}
+	a, _ := os.Stat(filepath.Join(dst, "small"))
+	b, err := os.Stat(filepath.Join(dst, "sub", "hard"))
+	if err != nil || !os.SameFile(a, b) {
+		t.Errorf("hard link wasn't preserved: %v", err)
+	}
+
+	for _, name := range []string{"sub", "sub/big"} {
+		s, _ := os.Stat(filepath.Join(src, name))
+		d, err := os.Stat(filepath.Join(dst, name))
+		if err != nil {
+			t.Fatal(err)
+		}
+		if s.Mode() != d.Mode() {
+			t.Errorf("%s: mode %v, want %v", name, d.Mode(), s.Mode())
+		}
+		if !s.ModTime().Equal(d.ModTime()) {
+			t.Errorf("%s: mtime %v, want %v", name, d.ModTime(), s.ModTime())
+		}
+	}
+}
+
+func TestCopyIntoItself(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "cp")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	c := newCopier(testContext, &Options{Recursive: true, DataCopyRequired: true})
+	c.copy(tmp, filepath.Join(tmp, "sub"), true, 0)
+	if c.wait() {
+		t.Fatal("copied a directory into itself")
+	}
+}
@@ -1,45 +1,118 @@
-package main
+package csplit
 
-var BuffSize = 7
+import "bytes"
 
-func main() {
-	pattern := "eric"
-	test := "america"
+// boyerMoore finds a fixed string with the Boyer-Moore algorithm, which looks
+// at the end of the pattern first and, on a mismatch, skips ahead by as much
+// as either the mismatched byte or the part that did match allows. Most of
+// the input is never looked at for long patterns.
+type boyerMoore struct {
+	pat  []byte
+	bad  [256]int
+	good []int
 }
 
-func preBad(x string, m int, badChar []int) {
-	for i := 0; i < BuffSize; i++ {
-		badChar[i] = m
+func newBoyerMoore(pat []byte) *boyerMoore {
+	m := len(pat)
+	b := &boyerMoore{pat: pat, good: make([]int, m)}
+	if m == 0 {
+		return b
 	}
+	preBad(pat, &b.bad)
+	preGood(pat, b.good)
+	return b
+}
 
+// preBad fills in, for each byte, how far the pattern can move when that byte
+// is under its last position: up to the byte's last occurrence before that.
+func preBad(x []byte, bad *[256]int) {
+	m := len(x)
+	for i := range bad {
+		bad[i] = m
+	}
 	for i := 0; i < m-1; i++ {
-		badChar[x[i]] = m - i - 1
+		bad[x[i]] = m - i - 1
 	}
 }
 
-func suffix(x string, m int, suff []int) {
-	var f int
-
+// suffixes fills in, for each position of x, the length of the longest
+// string ending there that's also a suffix of x.
+func suffixes(x []byte, suff []int) {
+	m := len(x)
 	suff[m-1] = m
-	g := m - 1
-
+	f, g := 0, m-1
 	for i := m - 2; i >= 0; i-- {
 		if i > g && suff[i+m-1-f] < i-g {
 			suff[i] = suff[i+m-1-f]
-		} else {
-			if i > g {
-				g = i
-			}
-			f = i
-			for g >= 0 && x[g] == x[g+m-1-f] {
-				g--
+			continue
+		}
+		if i < g {
+			g = i
+		}
+		f = i
+		for g >= 0 && x[g] == x[g+m-1-f] {
+			g--
+		}
+		suff[i] = f - g
+	}
+}
+
+// preGood fills in, for each position, how far the pattern can move when the
+// byte there mismatches after everything to its right matched: to the next
+// place that suffix occurs, or where a prefix of the pattern lines up with
+// its end.
+func preGood(x []byte, good []int) {
+	m := len(x)
+	suff := make([]int, m)
+	suffixes(x, suff)
+	for i := range good {
+		good[i] = m
+	}
+	j := 0
+	for i := m - 1; i >= 0; i-- {
+		if suff[i] == i+1 {
+			for ; j < m-1-i; j++ {
+				if good[j] == m {
+					good[j] = m - 1 - i
+				}
 			}
-			suff[i] = f - g
 		}
 	}
+	for i := 0; i <= m-2; i++ {
+		good[m-1-suff[i]] = m - 1 - i
+	}
 }
 
-func preGood(x string, m int, goodChar []int) {
-	suff := make([]int, BuffSize)
-	suffix(x, m, suff)
+// index returns the offset of the pattern's first occurrence in s, or -1.
+func (b *boyerMoore) index(s []byte) int {
+	m := len(b.pat)
+	switch m {
+	case 0:
+		return 0
+	case 1:
+		return bytes.IndexByte(s, b.pat[0])
+	}
+	last := b.pat[m-1]
+	for j := 0; j <= len(s)-m; {
+		// Most windows fail on their last byte, so skip those on the
+		// bad character rule alone before comparing the rest.
+		c := s[j+m-1]
+		if c != last {
+			j += b.bad[c]
+			continue
+		}
+		i := m - 2
+		for i >= 0 && b.pat[i] == s[i+j] {
+			i--
+		}
+		if i < 0 {
+			return j
+		}
+		shift := b.good[i]
+		if bs := b.bad[s[i+j]] - m + 1 + i; bs > shift {
+			shift = bs
+		}
+		j += shift
+	}
+	return -1
 }
@@ -0,0 +1,213 @@
+package csplit
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"strconv"
+	"strings"
+	"unicode"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("csplit", run)
+}
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.StringVarP(&c.format, "suffix-format", "b", "", "use sprintf FORMAT instead of %02d")
+	c.f.StringVarP(&c.prefix, "prefix", "f", "xx", "use PREFIX instead of 'xx'")
+	c.f.BoolVarP(&c.keep, "keep-files", "k", false, "do not remove output files on errors")
+	c.f.BoolVar(&c.suppress, "suppress-matched", false, "suppress the lines matching PATTERN")
+	c.f.StringVarP(&c.digits, "digits", "n", "", "use specified number of digits instead of 2")
+	c.f.BoolVarP(&c.quiet, "quiet", "s", false, "do not print counts of output file sizes")
+	c.f.BoolVar(&c.quiet, "silent", false, "same as --quiet")
+	c.f.BoolVarP(&c.elide, "elide-empty-files", "z", false, "remove empty output files")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f        flag.FlagSet
+	format   string
+	prefix   string
+	keep     bool
+	suppress bool
+	digits   string
+	quiet    bool
+	elide    bool
+	version  bool
+}
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "csplit (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "csplit: %v\n", err)
+		}
+	}()
+
+	s := NewSplitter()
+	s.Prefix = c.prefix
+	s.Keep = c.keep
+	s.SuppressMatched = c.suppress
+	s.Elide = c.elide
+	if !c.quiet {
+		s.Report = func(size int64) { fmt.Fprintf(ctx.Stdout, "%d\n", size) }
+	}
+	if c.f.Changed("digits") {
+		n, err := strconv.ParseInt(strings.TrimLeft(c.digits, " \t\n\v\f\r"), 10, 32)
+		if err != nil || n < 0 {
+			return fmt.Errorf("invalid number: '%s'", c.digits)
+		}
+		format := fmt.Sprintf("%%0%dd", n)
+		s.Suffix = func(i int) string { return fmt.Sprintf(format, i) }
+	}
+	if c.f.Changed("suffix-format") {
+		if s.Suffix, err = parseFormat(c.format); err != nil {
+			return err
+		}
+	}
+
+	ops := c.f.Args()
+	switch len(ops) {
+	case 0:
+		return errors.New("missing operand")
+	case 1:
+		return fmt.Errorf("missing operand after '%s'", ops[0])
+	}
+	pats, err := ParsePatterns(ops[1:], func(msg string) {
+		fmt.Fprintf(ctx.Stderr, "csplit: %s\n", msg)
+	})
+	if err != nil {
+		return err
+	}
+
+	var in io.Reader = ctx.Stdin
+	if name := ops[0]; name != "-" {
+		f, err := os.Open(name)
+		if err != nil {
+			return fmt.Errorf("cannot open '%s' for reading: %v", name, unwrap(err))
+		}
+		defer f.Close()
+		in = f
+	}
+	data, release, err := Load(in)
+	if err != nil {
+		return fmt.Errorf("read error: %v", unwrap(err))
+	}
+	defer release()
+
+	if f, ok := in.(*os.File); ok {
+		err = mmap.Guard(f, func() error { return s.Split(data, pats) })
+	} else {
+		err = s.Split(data, pats)
+	}
+	if pe, ok := err.(*os.PathError); ok {
+		return fmt.Errorf("%s: %v", pe.Path, pe.Err)
+	}
+	return err
+}
+
+// parseFormat turns a printf format with one integer conversion, as given to
+// -b, into a function that formats the number of a file.
+func parseFormat(format string) (func(int) string, error) {
+	var (
+		b    strings.Builder
+		spec = -1
+		conv = -1
+		alt  bool
+	)
+	for i := 0; i < len(format); i++ {
+		b.WriteByte(format[i])
+		if format[i] != '%' {
+			continue
+		}
+		if i+1 < len(format) && format[i+1] == '%' {
+			b.WriteByte('%')
+			i++
+			continue
+		}
+		if conv >= 0 {
+			return nil, errors.New("too many % conversion specifications in suffix")
+		}
+		i++
+		spec = b.Len()
+		// C's ' flag, for grouping thousands, does nothing in the
+		// C locale, and Go's fmt doesn't have it.
+		var group bool
+		for ; i < len(format) && strings.IndexByte("'-+ #0", format[i]) >= 0; i++ {
+			switch format[i] {
+			case '\'':
+				group = true
+				continue
+			case '#':
+				alt = true
+			}
+			b.WriteByte(format[i])
+		}
+		for ; i < len(format) && (isDigit(format[i]) || format[i] == '.'); i++ {
+			b.WriteByte(format[i])
+		}
+		if i == len(format) {
+			return nil, errors.New("missing conversion specifier in suffix")
+		}
+		ch := format[i]
+		switch ch {
+		case 'd', 'i', 'u':
+			if alt {
+				return nil, fmt.Errorf("invalid flags in conversion specification: %%#%c", ch)
+			}
+			b.WriteByte('d')
+		case 'o', 'x', 'X':
+			if group {
+				return nil, fmt.Errorf("invalid flags in conversion specification: %%'%c", ch)
+			}
+			b.WriteByte(ch)
+		default:
+			if ch < unicode.MaxASCII && unicode.IsPrint(rune(ch)) {
+				return nil, fmt.Errorf("invalid conversion specifier in suffix: %c", ch)
+			}
+			return nil, fmt.Errorf("invalid conversion specifier in suffix: \\%.3o", ch)
+		}
+		conv = b.Len() - 1
+	}
+	if conv < 0 {
+		return nil, errors.New("missing % conversion specification in suffix")
+	}
+	f := b.String()
+	// C prints 0 without its 0x prefix, and Go doesn't.
+	zero := f
+	if alt {
+		zero = f[:spec] + strings.Replace(f[spec:conv], "#", "", -1) + f[conv:]
+	}
+	return func(n int) string {
+		if n == 0 {
+			return fmt.Sprintf(zero, n)
+		}
+		return fmt.Sprintf(f, n)
+	}, nil
+}
+
+func isDigit(c byte) bool { return c >= '0' && c <= '9' }
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
@@ -1 +1,526 @@
-package main
+// Package csplit splits a file into pieces at lines given by number or found
+// by regular expressions.
+//
+// The whole input is held in memory, mapped when it's a large regular file,
+// and each piece is written to its file straight from there, as one write
+// rather than a line at a time. Lines are only counted, never copied. A
+// pattern that's a plain string is found with Boyer-Moore over the rest of
+// the input instead of being matched against each line in turn.
+//
+// Regular expressions are Go's, as with tac's, not POSIX basic ones.
+package csplit
+
+import (
+	"bytes"
+	"errors"
+	"fmt"
+	"os"
+	"regexp"
+	"strconv"
+	"strings"
+)
+
+// Pattern says where to split the input.
+type Pattern struct {
+	arg string
+
+	// line, for a line number, is where the piece after this one starts.
+	line int64
+
+	re  *regexp.Regexp
+	lit *boyerMoore
+
+	// skip is set for %REGEXP%, which skips to the line instead of
+	// writing everything before it to a file.
+	skip   bool
+	offset int64
+
+	// repeat is how many more times the pattern is used, or -1 for as
+	// many times as it matches.
+	repeat int64
+}
+
+// ParsePatterns parses csplit's PATTERN arguments. warn, if not nil, is given
+// anything that's suspect but not wrong.
+func ParsePatterns(args []string, warn func(string)) ([]*Pattern, error) {
+	var (
+		pats []*Pattern
+		last int64
+	)
+	for i := 0; i < len(args); i++ {
+		arg := args[i]
+		var p *Pattern
+		if arg != "" && (arg[0] == '/' || arg[0] == '%') {
+			var err error
+			if p, err = parseRegexp(arg); err != nil {
+				return nil, err
+			}
+		} else {
+			n, err := strconv.ParseInt(strings.TrimLeft(arg, " \t\n\v\f\r"), 10, 64)
+			if err != nil || n < 0 || strings.HasPrefix(strings.TrimLeft(arg, " \t\n\v\f\r"), "-") {
+				return nil, fmt.Errorf("'%s': invalid pattern", arg)
+			}
+			if n == 0 {
+				return nil, fmt.Errorf("%s: line number must be greater than zero", arg)
+			}
+			if n < last {
+				return nil, fmt.Errorf("line number '%s' is smaller than preceding line number, %d", arg, last)
+			}
+			if n == last && warn != nil {
+				warn(fmt.Sprintf("warning: line number '%s' is the same as preceding line number", arg))
+			}
+			last = n
+			p = &Pattern{arg: arg, line: n}
+		}
+		if i+1 < len(args) && strings.HasPrefix(args[i+1], "{") {
+			i++
+			if err := p.parseRepeat(args[i]); err != nil {
+				return nil, err
+			}
+		}
+		pats = append(pats, p)
+	}
+	return pats, nil
+}
+
+// parseRegexp parses /REGEXP/[OFFSET] and %REGEXP%[OFFSET]. The regular
+// expression runs to the last delimiter, so it can contain the delimiter.
+func parseRegexp(arg string) (*Pattern, error) {
+	delim := arg[0]
+	end := strings.LastIndexByte(arg[1:], delim)
+	if end < 0 {
+		return nil, fmt.Errorf("%s: closing delimiter '%c' missing", arg, delim)
+	}
+	end++
+	expr := arg[1:end]
+	re, err := regexp.Compile(expr)
+	if err != nil {
+		return nil, fmt.Errorf("'%s': invalid regular expression: %v", arg, err)
+	}
+	p := &Pattern{arg: arg, re: re, skip: delim == '%'}
+	if off := arg[end+1:]; off != "" {
+		s := strings.TrimLeft(off, " \t\n\v\f\r")
+		if p.offset, err = strconv.ParseInt(s, 10, 64); err != nil {
+			return nil, fmt.Errorf("'%s': integer expected after delimiter", arg)
+		}
+	}
+	// A line that contains a string that's in no other part of any line
+	// is the line the string is in, so a plain string can be searched
+	// for in the whole input at once.
+	if prefix, complete := re.LiteralPrefix(); complete && strings.IndexByte(prefix, '\n') < 0 {
+		p.lit = newBoyerMoore([]byte(prefix))
+	}
+	return p, nil
+}
+
+// parseRepeat parses {N} or {*}.
+func (p *Pattern) parseRepeat(arg string) error {
+	if !strings.HasSuffix(arg, "}") {
+		return fmt.Errorf("'%s': '}' is required in repeat count", arg)
+	}
+	n := arg[1 : len(arg)-1]
+	if n == "*" {
+		p.repeat = -1
+		return nil
+	}
+	s := strings.TrimLeft(n, " \t\n\v\f\r")
+	v, err := strconv.ParseInt(s, 10, 64)
+	if err != nil || v < 0 || strings.HasPrefix(s, "-") {
+		return fmt.Errorf("'%s'}: integer required between '{' and '}'", arg[:len(arg)-1])
+	}
+	p.repeat = v
+	return nil
+}
+
+// ErrDisappeared is returned when a line number needs input but there's none
+// left at all.
+var ErrDisappeared = errors.New("input disappeared")
+
+// Splitter splits its input.
+type Splitter struct {
+	// Prefix starts each file's name, and Suffix returns the rest of the
+	// name of the nth file, counting from 0.
+	Prefix string
+	Suffix func(n int) string
+
+	// Keep keeps the files written so far after an error, which
+	// otherwise removes them.
+	Keep bool
+
+	// SuppressMatched leaves out the lines that match, or whose number is
+	// given.
+	SuppressMatched bool
+
+	// Elide removes files that end up empty.
+	Elide bool
+
+	// Report, if not nil, is given the size of each file as it's
+	// finished.
+	Report func(size int64)
+}
+
+// NewSplitter returns a Splitter that writes xx00, xx01 and so on.
+func NewSplitter() *Splitter {
+	return &Splitter{
+		Prefix: "xx",
+		Suffix: func(n int) string { return fmt.Sprintf("%02d", n) },
+	}
+}
+
+// Split writes data to files, splitting it before each pattern.
+func (s *Splitter) Split(data []byte, patterns []*Pattern) error {
+	c := &splitter{Splitter: s, data: data, hn: 1, sn: 1}
+	err := c.split(patterns)
+	if err == errDone {
+		err = nil
+	}
+	if err != nil && err != ErrDisappeared {
+		c.cleanup()
+	}
+	if c.out != nil {
+		c.out.Close()
+	}
+	return err
+}
+
+// errDone stops splitting once {*} runs out of matches.
+var errDone = errors.New("done")
+
+// splitter works the way GNU csplit does, so the same patterns split at the
+// same lines. Lines are numbered from 1. Everything before head has been
+// written or skipped. Searches start after current, the last line looked at,
+// which can be past head when a regular expression has a negative offset.
+type splitter struct {
+	*Splitter
+	data []byte
+
+	hn      int64 // head's line number
+	ho      int   // and its offset
+	current int64
+
+	// sn is a line near where the last search left off, at so, so the
+	// next one needn't count lines from head.
+	sn int64
+	so int
+
+	out     *os.File
+	name    string
+	size    int64
+	created []string
+}
+
+func (c *splitter) split(patterns []*Pattern) error {
+	for _, p := range patterns {
+		for rep := int64(0); p.repeat < 0 || rep <= p.repeat; rep++ {
+			var err error
+			if p.re != nil {
+				err = c.regexp(p, rep)
+			} else {
+				err = c.lines(p, rep)
+			}
+			if err != nil {
+				return err
+			}
+		}
+	}
+	if err := c.create(); err != nil {
+		return err
+	}
+	if err := c.remove(-1, true); err != nil {
+		return err
+	}
+	return c.close()
+}
+
+// lines writes up to a line number.
+func (c *splitter) lines(p *Pattern, rep int64) error {
+	last := p.line * (rep + 1)
+	if err := c.create(); err != nil {
+		return err
+	}
+	if c.SuppressMatched && c.noMore() {
+		return lineError(p, rep)
+	}
+	if c.ho >= len(c.data) {
+		return ErrDisappeared
+	}
+	if k := last - c.hn; k > 0 {
+		if n, err := c.removeN(k, true); err != nil {
+			return err
+		} else if n < k {
+			return lineError(p, rep)
+		}
+	}
+	if err := c.close(); err != nil {
+		return err
+	}
+	if c.SuppressMatched {
+		return c.remove(1, false)
+	}
+	if c.noMore() {
+		return lineError(p, rep)
+	}
+	return nil
+}
+
+func lineError(p *Pattern, rep int64) error {
+	if rep > 0 {
+		return fmt.Errorf("'%s': line number out of range on repetition %d", p.arg, rep)
+	}
+	return fmt.Errorf("'%s': line number out of range", p.arg)
+}
+
+// regexp writes, or skips, up to a line that matches, give or take the
+// pattern's offset.
+func (c *splitter) regexp(p *Pattern, rep int64) error {
+	if !p.skip {
+		if err := c.create(); err != nil {
+			return err
+		}
+	}
+	// With a negative offset some of the lines before the match are
+	// left for the next file, so nothing's written until it's found.
+	line, ok, err := c.search(p, p.offset >= 0)
+	if err != nil {
+		return err
+	}
+	if !ok {
+		if !p.skip {
+			if err := c.remove(-1, true); err != nil {
+				return err
+			}
+			if err := c.close(); err != nil {
+				return err
+			}
+		}
+		if p.repeat < 0 {
+			return errDone
+		}
+		if rep > 0 {
+			return fmt.Errorf("'%s': match not found on repetition %d", p.arg, rep)
+		}
+		return fmt.Errorf("'%s': match not found", p.arg)
+	}
+
+	at := line + p.offset
+	if c.ho >= len(c.data) {
+		return ErrDisappeared
+	}
+	if c.hn > at {
+		return fmt.Errorf("'%s': line number out of range", p.arg)
+	}
+	if k := at - c.hn; k > 0 {
+		if n, err := c.removeN(k, !p.skip); err != nil {
+			return err
+		} else if n < k {
+			return fmt.Errorf("'%s': line number out of range", p.arg)
+		}
+	}
+	if !p.skip {
+		if err := c.close(); err != nil {
+			return err
+		}
+	}
+	if p.offset > 0 {
+		c.current = at
+	}
+	if c.SuppressMatched {
+		return c.remove(1, false)
+	}
+	return nil
+}
+
+// search finds the first line after current that matches, and makes it
+// current. With consume, the lines that don't match are written or skipped
+// along the way.
+func (c *splitter) search(p *Pattern, consume bool) (line int64, ok bool, err error) {
+	from := c.current + 1
+	off, ok := c.find(from)
+	if !ok {
+		return 0, false, nil
+	}
+	at, ok := p.next(c.data, off)
+	if !ok {
+		at = len(c.data)
+	}
+	// The lines in [off, at) didn't match.
+	k := int64(bytes.Count(c.data[off:at], newline))
+	if at == len(c.data) && at > off && c.data[at-1] != '\n' {
+		k++
+	}
+	c.current = from + k - 1
+	if consume {
+		if _, err := c.removeN(k, !p.skip); err != nil {
+			return 0, false, err
+		}
+	}
+	if !ok {
+		return 0, false, nil
+	}
+	c.current++
+	c.sn, c.so = c.current, at
+	return c.current, true, nil
+}
+
+var newline = []byte{'\n'}
+
+// next returns the offset of the first line at or after off that p matches.
+func (p *Pattern) next(data []byte, off int) (int, bool) {
+	if p.lit != nil {
+		i := p.lit.index(data[off:])
+		if i < 0 {
+			return 0, false
+		}
+		return off + bytes.LastIndexByte(data[off:off+i], '\n') + 1, true
+	}
+	for off < len(data) {
+		end := bytes.IndexByte(data[off:], '\n')
+		if end < 0 {
+			end = len(data)
+		} else {
+			end += off
+		}
+		if p.re.Match(data[off:end]) {
+			return off, true
+		}
+		off = end + 1
+	}
+	return 0, false
+}
+
+// find returns the offset of line n, if there is one. n is never before head.
+func (c *splitter) find(n int64) (int, bool) {
+	if n < c.sn || c.sn < c.hn {
+		c.sn, c.so = c.hn, c.ho
+	}
+	var k int64
+	c.so, k = c.forward(c.so, n-c.sn)
+	c.sn += k
+	return c.so, c.sn == n && c.so < len(c.data)
+}
+
+// noMore reports whether there's no line after current.
+func (c *splitter) noMore() bool {
+	_, ok := c.find(c.current + 1)
+	return !ok
+}
+
+// forward skips up to k lines from off, and returns where it got to and how
+// many it skipped.
+func (c *splitter) forward(off int, k int64) (int, int64) {
+	const block = 64 << 10
+	var n int64
+	for n < k && off < len(c.data) {
+		// Whole blocks are skipped by counting their lines, which is
+		// much quicker than finding each one.
+		if end := off + block; end <= len(c.data) {
+			if m := int64(bytes.Count(c.data[off:end], newline)); n+m < k {
+				off, n = end, n+m
+				continue
+			}
+		}
+		i := bytes.IndexByte(c.data[off:], '\n')
+		if i < 0 {
+			off = len(c.data)
+		} else {
+			off += i + 1
+		}
+		n++
+	}
+	return off, n
+}
+
+// removeN moves head on by up to k lines, writing them to the current file
+// with write, and returns how many there were.
+func (c *splitter) removeN(k int64, write bool) (int64, error) {
+	off, n := c.forward(c.ho, k)
+	if n == 0 {
+		return 0, nil
+	}
+	if write {
+		if err := c.write(c.data[c.ho:off]); err != nil {
+			return n, err
+		}
+	}
+	c.ho, c.hn = off, c.hn+n
+	if c.current < c.hn-1 {
+		c.current = c.hn - 1
+	}
+	return n, nil
+}
+
+// remove removes k lines, or every line that's left if k is negative.
+func (c *splitter) remove(k int, write bool) error {
+	if k < 0 {
+		if c.ho >= len(c.data) {
+			return nil
+		}
+		if write {
+			if err := c.write(c.data[c.ho:]); err != nil {
+				return err
+			}
+		}
+		c.hn += int64(bytes.Count(c.data[c.ho:], newline))
+		if c.data[len(c.data)-1] != '\n' {
+			c.hn++
+		}
+		c.ho = len(c.data)
+		if c.current < c.hn-1 {
+			c.current = c.hn - 1
+		}
+		return nil
+	}
+	_, err := c.removeN(int64(k), write)
+	return err
+}
+
+func (c *splitter) create() error {
+	name := c.Prefix + c.Suffix(len(c.created))
+	f, err := os.Create(name)
+	if err != nil {
+		return err
+	}
+	c.out, c.name, c.size = f, name, 0
+	c.created = append(c.created, name)
+	return nil
+}
+
+func (c *splitter) write(p []byte) error {
+	n, err := c.out.Write(p)
+	c.size += int64(n)
+	return err
+}
+
+// close finishes the current file, if there is one.
+func (c *splitter) close() error {
+	if c.out == nil {
+		return nil
+	}
+	err := c.out.Close()
+	c.out = nil
+	if err != nil {
+		return err
+	}
+	if c.Elide && c.size == 0 {
+		c.created = c.created[:len(c.created)-1]
+		if err := os.Remove(c.name); err != nil {
+			return err
+		}
+		return nil
+	}
+	if c.Report != nil {
+		c.Report(c.size)
+	}
+	return nil
+}
+
+// cleanup removes the files written so far, unless they're to be kept.
+func (c *splitter) cleanup() {
+	c.close()
+	if c.Keep {
+		return
+	}
+	for _, name := range c.created {
+		os.Remove(name)
+	}
+}
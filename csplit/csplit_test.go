@@ -0,0 +1,296 @@
+package csplit
+
+import (
+	"bytes"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+// split splits data in dir and returns the files and their reported sizes.
+func split(t testing.TB, dir string, s *Splitter, data []byte, args ...string) ([]string, []int64, error) {
+	pats, err := ParsePatterns(args, nil)
+	if err != nil {
+		t.Fatal(err)
+	}
+	return splitWith(dir, s, data, pats)
+}
+
+func splitWith(dir string, s *Splitter, data []byte, pats []*Pattern) ([]string, []int64, error) {
+	var sizes []int64
+	s.Prefix = filepath.Join(dir, "xx")
+	s.Report = func(n int64) { sizes = append(sizes, n) }
+	err := s.Split(data, pats)
+
+	names, _ := filepath.Glob(filepath.Join(dir, "xx*"))
+	var files []string
+	for _, name := range names {
+		b, _ := ioutil.ReadFile(name)
+		files = append(files, string(b))
+		os.Remove(name)
+	}
+	return files, sizes, err
+}
+
+func TestSplit(t *testing.T) {
+	dir, err := ioutil.TempDir("", "csplit")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	data, err := ioutil.ReadFile("test.txt")
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	// What GNU csplit does with the same input.
+	tests := []struct {
+		args     []string
+		suppress bool
+		elide    bool
+		want     []string
+	}{
+		{[]string{"/II/"}, false, false, []string{"I. HELLO\n", "II. THIS\nIII. IS\nIV. A\nV. TEST"}},
+		{[]string{"/II/", "{*}"}, false, false, []string{"I. HELLO\n", "II. THIS\n", "III. IS\nIV. A\nV. TEST"}},
+		{[]string{"%III%"}, false, false, []string{"III. IS\nIV. A\nV. TEST"}},
+		{[]string{"/^I/", "{*}"}, false, false, []string{"", "I. HELLO\n", "II. THIS\n", "III. IS\n", "IV. A\nV. TEST"}},
+		{[]string{"/^I/", "{*}"}, false, true, []string{"I. HELLO\n", "II. THIS\n", "III. IS\n", "IV. A\nV. TEST"}},
+		{[]string{"/A/-1"}, false, false, []string{"I. HELLO\nII. THIS\n", "III. IS\nIV. A\nV. TEST"}},
+		{[]string{`/V\./+1`}, false, false, []string{"I. HELLO\nII. THIS\nIII. IS\nIV. A\n", "V. TEST"}},
+		{[]string{"2", "{1}"}, false, false, []string{"I. HELLO\n", "II. THIS\nIII. IS\n", "IV. A\nV. TEST"}},
+		{[]string{`/I\./`}, true, false, []string{"", "II. THIS\nIII. IS\nIV. A\nV. TEST"}},
+		{[]string{"3", "/TEST/"}, false, false, []string{"I. HELLO\nII. THIS\n", "III. IS\nIV. A\n", "V. TEST"}},
+		{[]string{"4", "/I/"}, false, false, []string{"I. HELLO\nII. THIS\nIII. IS\n", "", "IV. A\nV. TEST"}},
+	}
+	for _, tt := range tests {
+		s := NewSplitter()
+		s.SuppressMatched = tt.suppress
+		s.Elide = tt.elide
+		got, sizes, err := split(t, dir, s, data, tt.args...)
+		if err != nil {
+			t.Fatalf("%q: %v", tt.args, err)
+		}
+		if strings.Join(got, "|") != strings.Join(tt.want, "|") {
+			t.Fatalf("%q: got %q, want %q", tt.args, got, tt.want)
+		}
+		for i, n := range sizes {
+			if int(n) != len(got[i]) {
+				t.Fatalf("%q: file %d is %d bytes, reported %d", tt.args, i, len(got[i]), n)
+			}
+		}
+	}
+
+	for _, tt := range []struct {
+		args []string
+		keep bool
+		want string
+	}{
+		{[]string{"/nope/"}, false, "'/nope/': match not found"},
+		{[]string{"/nope/"}, true, "'/nope/': match not found"},
+		{[]string{"/II/", "{5}"}, false, "'/II/': match not found on repetition 2"},
+		{[]string{"9"}, false, "'9': line number out of range"},
+		{[]string{"/II/-5"}, false, "'/II/-5': line number out of range"},
+	} {
+		s := NewSplitter()
+		s.Keep = tt.keep
+		got, _, err := split(t, dir, s, data, tt.args...)
+		if err == nil || err.Error() != tt.want {
+			t.Fatalf("%q: got %v, want %q", tt.args, err, tt.want)
+		}
+		if tt.keep != (len(got) > 0) {
+			t.Fatalf("%q, keep=%t: %d files left", tt.args, tt.keep, len(got))
+		}
+	}
+}
+
+func TestParsePatterns(t *testing.T) {
+	for _, tt := range []struct {
+		args []string
+		want string
+	}{
+		{[]string{"0"}, "0: line number must be greater than zero"},
+		{[]string{"x"}, "'x': invalid pattern"},
+		{[]string{"-3"}, "'-3': invalid pattern"},
+		{[]string{"/x"}, "/x: closing delimiter '/' missing"},
+		{[]string{"/x/y"}, "'/x/y': integer expected after delimiter"},
+		{[]string{"5", "{x}"}, "'{x'}: integer required between '{' and '}'"},
+		{[]string{"5", "{"}, "'{': '}' is required in repeat count"},
+		{[]string{"5", "3"}, "line number '3' is smaller than preceding line number, 5"},
+		{[]string{"{3}"}, "'{3}': invalid pattern"},
+	} {
+		_, err := ParsePatterns(tt.args, nil)
+		if err == nil || err.Error() != tt.want {
+			t.Errorf("%q: got %v, want %q", tt.args, err, tt.want)
+		}
+	}
+
+	var warned bool
+	if _, err := ParsePatterns([]string{"5", "5"}, func(string) { warned = true }); err != nil || !warned {
+		t.Errorf("5 5: got %v, warned %t", err, warned)
+	}
+
+	pats, err := ParsePatterns([]string{"/a/b/", "%c.d%", "/e+/-2", "/x/", "{*}"}, nil)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if pats[0].re.String() != "a/b" || pats[0].lit == nil {
+		t.Errorf("/a/b/: got %q, literal %t", pats[0].re, pats[0].lit != nil)
+	}
+	if !pats[1].skip || pats[1].lit != nil {
+		t.Errorf("%%c.d%%: got %+v", pats[1])
+	}
+	if pats[2].offset != -2 {
+		t.Errorf("/e+/-2: got offset %d", pats[2].offset)
+	}
+	if pats[3].repeat != -1 {
+		t.Errorf("/x/ {*}: got repeat %d", pats[3].repeat)
+	}
+}
+
+// TestLiteral checks that plain strings, found with Boyer-Moore, split at the
+// same lines as when they're matched against each line.
+func TestLiteral(t *testing.T) {
+	dir, err := ioutil.TempDir("", "csplit")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	rng := rand.New(rand.NewSource(1))
+	var b bytes.Buffer
+	for i := 0; i < 1000; i++ {
+		for j := rng.Intn(30); j > 0; j-- {
+			b.WriteByte("abc "[rng.Intn(4)])
+		}
+		b.WriteByte('\n')
+	}
+	data := b.Bytes()
+
+	for _, args := range [][]string{
+		{"/abca/", "{*}"},
+		{"/cab/+1", "{*}"},
+		{"/bbb/-2", "{*}"},
+		{"%aaaa%", "/cc/", "{20}"},
+		{"/a b c/", "{*}"},
+		{"/c/", "{*}"},
+	} {
+		want, _, werr := split(t, dir, NewSplitter(), data, args...)
+		if len(want) < 3 {
+			t.Fatalf("%q: only %d files", args, len(want))
+		}
+		pats, _ := ParsePatterns(args, nil)
+		if pats[0].lit == nil {
+			t.Fatalf("%q: not a literal", args)
+		}
+		for _, p := range pats {
+			p.lit = nil
+		}
+		got, _, gerr := splitWith(dir, NewSplitter(), data, pats)
+		if (werr == nil) != (gerr == nil) {
+			t.Fatalf("%q: got %v, want %v", args, gerr, werr)
+		}
+		if strings.Join(got, "|") != strings.Join(want, "|") {
+			t.Fatalf("%q: got %d files, want %d", args, len(got), len(want))
+		}
+	}
+}
+
+func TestBoyerMoore(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	text := make([]byte, 10000)
+	for i := range text {
+		text[i] = "ab"[rng.Intn(2)]
+	}
+	for i := 0; i < 2000; i++ {
+		n := rng.Intn(12)
+		at := rng.Intn(len(text) - n)
+		pat := append([]byte(nil), text[at:at+n]...)
+		if rng.Intn(4) == 0 && n > 0 {
+			pat[rng.Intn(n)] = 'c'
+		}
+		s := text[rng.Intn(len(text)):]
+		if got, want := newBoyerMoore(pat).index(s), bytes.Index(s, pat); got != want {
+			t.Fatalf("%q in %d bytes: got %d, want %d", pat, len(s), got, want)
+		}
+	}
+}
+
+func TestFormat(t *testing.T) {
+	for _, tt := range []struct {
+		format string
+		n      int
+		want   string
+	}{
+		{"%03d", 7, "007"},
+		{"%x.txt", 255, "ff.txt"},
+		{"%#x", 0, "0"},
+		{"%#X", 1, "0X1"},
+		{"%#o", 8, "010"},
+		{"%'d", 12, "12"},
+		{"%i", 3, "3"},
+		{"%u", 3, "3"},
+		{"%-4d|", 5, "5   |"},
+		{"%%%d", 5, "%5"},
+		{"%5.3d", 5, "  005"},
+	} {
+		f, err := parseFormat(tt.format)
+		if err != nil {
+			t.Errorf("%s: %v", tt.format, err)
+			continue
+		}
+		if got := f(tt.n); got != tt.want {
+			t.Errorf("%s of %d: got %q, want %q", tt.format, tt.n, got, tt.want)
+		}
+	}
+	for _, tt := range []struct{ format, want string }{
+		{"abc", "missing % conversion specification in suffix"},
+		{"%d%d", "too many % conversion specifications in suffix"},
+		{"%s", "invalid conversion specifier in suffix: s"},
+		{"%5", "missing conversion specifier in suffix"},
+		{"%#d", "invalid flags in conversion specification: %#d"},
+		{"%'x", "invalid flags in conversion specification: %'x"},
+	} {
+		if _, err := parseFormat(tt.format); err == nil || err.Error() != tt.want {
+			t.Errorf("%s: got %v, want %q", tt.format, err, tt.want)
+		}
+	}
+}
+
+func BenchmarkSplit(b *testing.B) {
+	dir, err := ioutil.TempDir("", "csplit")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	var buf bytes.Buffer
+	for i := 0; i < 1000000; i++ {
+		if i%100000 == 0 {
+			buf.WriteString("== chapter ==\n")
+		}
+		buf.WriteString("a line of the journal\n")
+	}
+	data := buf.Bytes()
+	b.SetBytes(int64(len(data)))
+
+	for _, bb := range []struct{ name, pat string }{
+		{"literal", "/== chapter/"},
+		{"regexp", "/^==+ [a-z]+/"},
+	} {
+		b.Run(bb.name, func(b *testing.B) {
+			pats, err := ParsePatterns([]string{bb.pat, "{*}"}, nil)
+			if err != nil {
+				b.Fatal(err)
+			}
+			s := NewSplitter()
+			s.Prefix = filepath.Join(dir, "xx")
+			for i := 0; i < b.N; i++ {
+				if err := s.Split(data, pats); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
@@ -1 +1,30 @@
-package main
+package csplit
+
+import (
+	"io"
+	"os"
+
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+// mapFile maps the rest of f, if it's a regular file big enough for that to
+// be worth it. release unmaps it again.
+func mapFile(f *os.File) (data []byte, release func() error, ok bool) {
+	info, err := f.Stat()
+	if err != nil || !info.Mode().IsRegular() {
+		return nil, nil, false
+	}
+	off, err := f.Seek(0, io.SeekCurrent)
+	if err != nil {
+		return nil, nil, false
+	}
+	n := info.Size() - off
+	if n < mmap.Threshold || int64(int(n)) != n {
+		return nil, nil, false
+	}
+	m, err := mmap.Map(f, off, int(n))
+	if err != nil {
+		return nil, nil, false
+	}
+	return m.Bytes(), m.Close, true
+}
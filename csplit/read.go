@@ -1 +1,19 @@
-package main
+package csplit
+
+import (
+	"io"
+	"io/ioutil"
+	"os"
+)
+
+// Load returns everything left in r. A large file is mapped instead of read;
+// release, which is never nil, unmaps it once it's no longer needed.
+func Load(r io.Reader) (data []byte, release func() error, err error) {
+	if f, ok := r.(*os.File); ok {
+		if data, release, ok := mapFile(f); ok {
+			return data, release, nil
+		}
+	}
+	data, err = ioutil.ReadAll(r)
+	return data, func() error { return nil }, err
+}
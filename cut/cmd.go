@@ -0,0 +1,169 @@
+package cut
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("cut", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -n but not --n.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.StringVarP(&c.bytes, "bytes", "b", "", "select only these bytes")
+	c.f.StringVarP(&c.chars, "characters", "c", "", "select only these characters")
+	c.f.StringVarP(&c.delimiter, "delimiter", "d", "\t", "use DELIM instead of TAB for field delimiter")
+	c.f.StringVarP(&c.fields, "fields", "f", "", `select only these fields;  also print any line
+                            that contains no delimiter character, unless
+                            the -s option is specified`)
+	c.f.BoolVarP(&c.n, bad1, "n", false, "(ignored)")
+	c.f.BoolVar(&c.complement, "complement", false, `complement the set of selected bytes, characters
+                            or fields`)
+	c.f.BoolVarP(&c.onlyDelimited, "only-delimited", "s", false, "do not print lines not containing delimiters")
+	c.f.StringVar(&c.outputDelimiter, "output-delimiter", "", `use STRING as the output delimiter
+                            the default is to use the input delimiter`)
+	c.f.BoolVarP(&c.zero, "zero-terminated", "z", false, "line delimiter is NUL, not newline")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f               flag.FlagSet
+	bytes           string
+	chars           string
+	delimiter       string
+	fields          string
+	n               bool
+	complement      bool
+	onlyDelimited   bool
+	outputDelimiter string
+	zero            bool
+	version         bool
+}
+
+var errNonFatal = errors.New("at least one non-fatal error occurred")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "cut (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errNonFatal {
+			fmt.Fprintf(ctx.Stderr, "cut: %v\n", err)
+		}
+	}()
+
+	var (
+		mode  Mode
+		list  string
+		lists int
+	)
+	for _, l := range []struct {
+		name string
+		mode Mode
+		list string
+	}{
+		{"bytes", Bytes, c.bytes},
+		{"characters", Bytes, c.chars},
+		{"fields", Fields, c.fields},
+	} {
+		if c.f.Changed(l.name) {
+			mode, list = l.mode, l.list
+			lists++
+		}
+	}
+	switch {
+	case lists == 0:
+		return errors.New("you must specify a list of bytes, characters, or fields")
+	case lists > 1:
+		return errors.New("only one list may be specified")
+	case mode != Fields && c.f.Changed("delimiter"):
+		return errors.New("an input delimiter may be specified only when operating on fields")
+	case mode != Fields && c.onlyDelimited:
+		return errors.New("suppressing non-delimited lines makes sense\n\tonly when operating on fields")
+	case len(c.delimiter) > 1:
+		return errors.New("the delimiter must be a single character")
+	}
+	ranges, err := ParseList(list, mode == Fields)
+	if err != nil {
+		return err
+	}
+
+	// Characters are bytes, as in the C locale.
+	cu := NewCutter(mode, ranges)
+	cu.Complement = c.complement
+	cu.OnlyDelimited = c.onlyDelimited
+	cu.ZeroTerminated = c.zero
+	if mode == Fields {
+		// As in GNU cut, an empty delimiter is a NUL.
+		cu.Delimiter = 0
+		if c.delimiter != "" {
+			cu.Delimiter = c.delimiter[0]
+		}
+		cu.OutputDelimiter = string(cu.Delimiter)
+	}
+	if c.f.Changed("output-delimiter") {
+		cu.OutputDelimiter = c.outputDelimiter
+		if cu.OutputDelimiter == "" {
+			// As is an empty output delimiter.
+			cu.OutputDelimiter = "\x00"
+		}
+	}
+
+	names := c.f.Args()
+	if len(names) == 0 {
+		names = []string{"-"}
+	}
+	var nerrs int
+	for _, name := range names {
+		var in io.Reader = ctx.Stdin
+		if name != "-" {
+			f, err := os.Open(name)
+			if err != nil {
+				fmt.Fprintf(ctx.Stderr, "cut: %s: %v\n", name, unwrap(err))
+				nerrs++
+				continue
+			}
+			in = f
+		}
+		err := cu.Cut(ctx.Stdout, in)
+		if f, ok := in.(*os.File); ok && name != "-" {
+			f.Close()
+		}
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "cut: %s: %v\n", name, unwrap(err))
+			nerrs++
+		}
+	}
+	if nerrs > 0 {
+		return errNonFatal
+	}
+	return nil
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
@@ -1,3 +1,193 @@
-package main
+// Package cut writes selected parts of lines.
+//
+// Lines are read with internal/lines, so each is a slice of a large read
+// buffer, found with bytes.IndexByte. The list of fields or bytes is sorted
+// and merged into ranges once, and each line is walked along it: with
+// fields, delimiters are found with bytes.IndexByte too, the selected fields
+// are written straight from the buffer, and once the last field wanted is
+// written the rest of the line isn't looked at. Nothing is allocated per
+// line.
+package cut
 
-func main() {}
+import (
+	"bufio"
+	"bytes"
+	"io"
+	"math"
+
+	"github.com/ericlagergren/go-coreutils/internal/lines"
+)
+
+// Mode is what a Cutter selects.
+type Mode int
+
+const (
+	Bytes Mode = iota
+	Fields
+)
+
+// Cutter selects parts of lines.
+type Cutter struct {
+	Mode Mode
+	List []Range
+
+	// Complement selects what List doesn't.
+	Complement bool
+
+	// Delimiter separates fields.
+	Delimiter byte
+
+	// OutputDelimiter goes between the fields written, or between the
+	// ranges of bytes written.
+	OutputDelimiter string
+
+	// OnlyDelimited leaves out lines without a delimiter, which are
+	// otherwise written whole, with Fields.
+	OnlyDelimited bool
+
+	ZeroTerminated bool
+}
+
+// NewCutter returns a Cutter for list, with fields separated by tabs.
+func NewCutter(mode Mode, list []Range) *Cutter {
+	c := &Cutter{Mode: mode, List: list, Delimiter: '\t'}
+	if mode == Fields {
+		c.OutputDelimiter = "\t"
+	}
+	return c
+}
+
+// Cut writes the selected parts of each line of r to w.
+func (c *Cutter) Cut(w io.Writer, r io.Reader) error {
+	eol := byte('\n')
+	if c.ZeroTerminated {
+		eol = 0
+	}
+	out := bufio.NewWriterSize(w, 64*1024)
+	in := lines.NewReader(r, eol)
+	ranges := compile(c.List, c.Complement)
+
+	cut := c.cutBytes
+	if c.Mode == Fields {
+		cut = c.cutFields
+		if c.Delimiter == eol {
+			// Then, as in GNU cut, the whole input is one line, and
+			// every delimiter in it is between fields, except one at
+			// the very end, which still makes it a delimited line. It's
+			// only useful for small inputs, so it's read whole.
+			data, err := io.ReadAll(r)
+			if n := len(data); n > 0 {
+				line := bytes.TrimSuffix(data, []byte{eol})
+				if len(line) == n || bytes.IndexByte(line, eol) >= 0 {
+					cut(out, line, ranges, eol)
+				} else {
+					if len(ranges) > 0 && ranges[0].Lo == 1 {
+						out.Write(line)
+					}
+					out.WriteByte(eol)
+				}
+			}
+			if err != nil {
+				out.Flush()
+				return err
+			}
+			return out.Flush()
+		}
+	}
+	for {
+		line, err := in.Next()
+		if err != nil {
+			if err == io.EOF {
+				return out.Flush()
+			}
+			out.Flush()
+			return err
+		}
+		cut(out, line, ranges, eol)
+	}
+}
+
+func (c *Cutter) cutBytes(out *bufio.Writer, line []byte, ranges []Range, eol byte) {
+	for i, r := range ranges {
+		if r.Lo > len(line) {
+			break
+		}
+		if i > 0 {
+			out.WriteString(c.OutputDelimiter)
+		}
+		hi := r.Hi
+		if hi > len(line) {
+			hi = len(line)
+		}
+		out.Write(line[r.Lo-1 : hi])
+	}
+	out.WriteByte(eol)
+}
+
+func (c *Cutter) cutFields(out *bufio.Writer, line []byte, ranges []Range, eol byte) {
+	d := c.Delimiter
+	i := bytes.IndexByte(line, d)
+	if i < 0 {
+		if !c.OnlyDelimited {
+			out.Write(line)
+			out.WriteByte(eol)
+		}
+		return
+	}
+
+	var (
+		k     int  // the range the field is in, or the next one
+		wrote bool // a field
+	)
+	for n, start := 1, 0; ; n++ {
+		for k < len(ranges) && ranges[k].Hi < n {
+			k++
+		}
+		if k == len(ranges) {
+			// Past the last field wanted.
+			break
+		}
+		end := len(line)
+		if i >= 0 {
+			end = start + i
+		}
+		if ranges[k].Lo <= n {
+			if wrote {
+				out.WriteString(c.OutputDelimiter)
+			}
+			out.Write(line[start:end])
+			wrote = true
+		}
+		if i < 0 || ranges[k].Hi == math.MaxInt && ranges[k].Lo <= n && k == len(ranges)-1 {
+			if i >= 0 {
+				// The rest of the line is wanted, fields and all, so
+				// only the delimiters need replacing.
+				c.rest(out, line[end:])
+			}
+			break
+		}
+		start = end + 1
+		i = bytes.IndexByte(line[start:], d)
+	}
+	out.WriteByte(eol)
+}
+
+// rest writes the end of a line, from a delimiter on, wanting every field in
+// it.
+func (c *Cutter) rest(out *bufio.Writer, tail []byte) {
+	if len(c.OutputDelimiter) == 1 && c.OutputDelimiter[0] == c.Delimiter {
+		out.Write(tail)
+		return
+	}
+	for len(tail) > 0 {
+		out.WriteString(c.OutputDelimiter)
+		tail = tail[1:]
+		i := bytes.IndexByte(tail, c.Delimiter)
+		if i < 0 {
+			out.Write(tail)
+			return
+		}
+		out.Write(tail[:i])
+		tail = tail[i:]
+	}
+}
@@ -0,0 +1,109 @@
+package cut
+
+import (
+	"bytes"
+	"fmt"
+	"io/ioutil"
+	"math"
+	"reflect"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+func TestCut(t *testing.T) {
+	const in = "a,b,c,d\nnodelim\n1,2\n,\n"
+	for _, tc := range []struct {
+		args []string
+		want string
+	}{
+		{[]string{"-d,", "-f2"}, "b\nnodelim\n2\n\n"},
+		{[]string{"-d,", "-f3,1"}, "a,c\nnodelim\n1\n\n"},
+		{[]string{"-d,", "-f2-"}, "b,c,d\nnodelim\n2\n\n"},
+		{[]string{"-d,", "-f-2", "--output-delimiter=::"}, "a::b\nnodelim\n1::2\n::\n"},
+		{[]string{"-d,", "-f2", "-s"}, "b\n2\n\n"},
+		{[]string{"-d,", "-f2", "--complement"}, "a,c,d\nnodelim\n1\n\n"},
+		{[]string{"-b2-3,5"}, ",bc\nodl\n,2\n\n"},
+		{[]string{"-c-2", "--output-delimiter=|"}, "a,\nno\n1,\n,\n"},
+		{[]string{"-b3-", "--complement"}, "a,\nno\n1,\n,\n"},
+		{[]string{"-b1,3", "--output-delimiter=:"}, "a:b\nn:d\n1:2\n,\n"},
+		{[]string{"-f1"}, in},
+	} {
+		got, _, err := cmdtest.Run(run, in, tc.args...)
+		if err != nil || got != tc.want {
+			t.Errorf("%q: got %q, %v, want %q", tc.args, got, err, tc.want)
+		}
+	}
+
+	got, _, err := cmdtest.Run(run, "a,b\x00c\x00", "-zd,", "-f2")
+	if err != nil || got != "b\x00c\x00" {
+		t.Errorf("-z: got %q, %v", got, err)
+	}
+	for _, args := range [][]string{{}, {"-b1", "-f1"}, {"-b1", "-d,"}, {"-b1", "-s"}, {"-f1", "-d,,"}, {"-f0"}} {
+		if _, _, err := cmdtest.Run(run, in, args...); err == nil {
+			t.Errorf("%q: no error", args)
+		}
+	}
+}
+
+func TestParseList(t *testing.T) {
+	for _, tc := range []struct {
+		list string
+		want []Range
+		err  string
+	}{
+		{"3", []Range{{3, 3}}, ""},
+		{"1-2,4-", []Range{{1, 2}, {4, math.MaxInt}}, ""},
+		{"-3 5", []Range{{1, 3}, {5, 5}}, ""},
+		{"1  2", []Range{{1, 1}, {2, 2}}, ""},
+		{"0", nil, "fields are numbered from 1"},
+		{"1,,2", nil, "fields are numbered from 1"},
+		{" 1", nil, "fields are numbered from 1"},
+		{"3-2", nil, "invalid decreasing range"},
+		{"x", nil, "invalid field value 'x'"},
+		{"-", nil, "invalid range with no endpoint: -"},
+		{"1-2-3", nil, "invalid field range"},
+		{"99999999999999999999", nil, "field number '99999999999999999999' is too large"},
+	} {
+		got, err := ParseList(tc.list, true)
+		if tc.err != "" {
+			if err == nil || err.Error() != tc.err {
+				t.Errorf("%q: got %v, want %q", tc.list, err, tc.err)
+			}
+			continue
+		}
+		if err != nil || !reflect.DeepEqual(got, tc.want) {
+			t.Errorf("%q: got %v, %v, want %v", tc.list, got, err, tc.want)
+		}
+	}
+
+	for _, tc := range []struct {
+		in         []Range
+		complement bool
+		want       []Range
+	}{
+		{[]Range{{5, 6}, {1, 3}, {2, 4}}, false, []Range{{1, 4}, {5, 6}}},
+		{[]Range{{2, 3}, {5, math.MaxInt}}, true, []Range{{1, 1}, {4, 4}}},
+		{[]Range{{1, math.MaxInt}}, true, nil},
+		{[]Range{{3, 3}}, true, []Range{{1, 2}, {4, math.MaxInt}}},
+	} {
+		if got := compile(tc.in, tc.complement); !reflect.DeepEqual(got, tc.want) {
+			t.Errorf("compile(%v, %t): got %v, want %v", tc.in, tc.complement, got, tc.want)
+		}
+	}
+}
+
+func BenchmarkCutFields(b *testing.B) {
+	var buf bytes.Buffer
+	for i := 0; buf.Len() < 10<<20; i++ {
+		fmt.Fprintf(&buf, "%d,%d,user%d,%x,,%d,%d,%d,x\n", i, i*7, i%1000, i*31, i%3, i*i, i%17)
+	}
+	b.SetBytes(int64(buf.Len()))
+	c := NewCutter(Fields, []Range{{3, 3}, {7, 7}})
+	c.Delimiter, c.OutputDelimiter = ',', ","
+	for i := 0; i < b.N; i++ {
+		if err := c.Cut(ioutil.Discard, bytes.NewReader(buf.Bytes())); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
@@ -0,0 +1,142 @@
+package cut
+
+import (
+	"errors"
+	"fmt"
+	"math"
+	"sort"
+	"strconv"
+	"strings"
+)
+
+// Range is the fields, or bytes, from Lo to Hi, counted from 1. A Hi of
+// math.MaxInt means the rest of the line.
+type Range struct {
+	Lo, Hi int
+}
+
+// ParseList parses a LIST argument: ranges separated by commas or blanks,
+// each N, N-, N-M or -M. fields is whether it's a list of fields, which
+// only changes the error messages.
+func ParseList(list string, fields bool) ([]Range, error) {
+	what := "byte/character position"
+	if fields {
+		what = "field value"
+	}
+	from1 := errors.New("byte/character positions are numbered from 1")
+	if fields {
+		from1 = errors.New("fields are numbered from 1")
+	}
+	num := func(s string) (int, error) {
+		for i := 0; i < len(s); i++ {
+			if s[i] < '0' || s[i] > '9' {
+				return 0, fmt.Errorf("invalid %s '%s'", what, s)
+			}
+		}
+		n, err := strconv.ParseUint(s, 10, 62)
+		if err != nil {
+			if fields {
+				return 0, fmt.Errorf("field number '%s' is too large", s)
+			}
+			return 0, fmt.Errorf("byte/character offset '%s' is too large", s)
+		}
+		if n == 0 {
+			return 0, from1
+		}
+		return int(n), nil
+	}
+
+	var ranges []Range
+	for _, item := range split(list) {
+		var (
+			r   Range
+			err error
+		)
+		switch lo, hi, ok := strings.Cut(item, "-"); {
+		case item == "":
+			// As in "1,,2", or "".
+			return nil, from1
+		case !ok:
+			if r.Lo, err = num(item); err != nil {
+				return nil, err
+			}
+			r.Hi = r.Lo
+		case strings.Contains(hi, "-"):
+			if fields {
+				return nil, errors.New("invalid field range")
+			}
+			return nil, errors.New("invalid byte or character range")
+		case lo == "" && hi == "":
+			return nil, errors.New("invalid range with no endpoint: -")
+		default:
+			r.Lo, r.Hi = 1, math.MaxInt
+			if lo != "" {
+				if r.Lo, err = num(lo); err != nil {
+					return nil, err
+				}
+			}
+			if hi != "" {
+				if r.Hi, err = num(hi); err != nil {
+					return nil, err
+				}
+			}
+			if r.Hi < r.Lo {
+				return nil, errors.New("invalid decreasing range")
+			}
+		}
+		ranges = append(ranges, r)
+	}
+	return ranges, nil
+}
+
+// split splits a list at each comma, and each run of blanks.
+func split(list string) []string {
+	var items []string
+	for i := 0; ; {
+		j := strings.IndexAny(list[i:], ", \t")
+		if j < 0 {
+			return append(items, list[i:])
+		}
+		items = append(items, list[i:i+j])
+		i += j + 1
+		if list[i-1] != ',' {
+			for i < len(list) && (list[i] == ' ' || list[i] == '\t') {
+				i++
+			}
+		}
+	}
+}
+
+// compile sorts ranges and merges those that overlap, so they can be walked
+// along a line in order. Ranges that only touch are kept apart, since with
+// bytes an output delimiter goes between them.
+func compile(ranges []Range, complement bool) []Range {
+	rs := append([]Range(nil), ranges...)
+	sort.Slice(rs, func(i, j int) bool { return rs[i].Lo < rs[j].Lo })
+	var out []Range
+	for _, r := range rs {
+		if n := len(out); n > 0 && r.Lo <= out[n-1].Hi {
+			if r.Hi > out[n-1].Hi {
+				out[n-1].Hi = r.Hi
+			}
+			continue
+		}
+		out = append(out, r)
+	}
+	if !complement {
+		return out
+	}
+
+	var inv []Range
+	next := 1
+	for _, r := range out {
+		if r.Lo > next {
+			inv = append(inv, Range{next, r.Lo - 1})
+		}
+		if r.Hi == math.MaxInt {
+			return inv
+		}
+		next = r.Hi + 1
+	}
+	return append(inv, Range{next, math.MaxInt})
+}
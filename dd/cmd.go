@@ -0,0 +1,460 @@
+package dd
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("dd", run)
+}
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f       flag.FlagSet
+	version bool
+}
+
+// operands are the KEY=VALUE arguments.
+type operands struct {
+	in, out        string
+	ibs, obs, bs   int64
+	count          int64
+	skip, seek     int64
+	conv           map[string]bool
+	iflags, oflags map[string]bool
+	iopen, oopen   int // open(2) flags
+	status         string
+}
+
+var errNonFatal = errors.New("at least one non-fatal error occurred")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "dd (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errNonFatal {
+			fmt.Fprintf(ctx.Stderr, "dd: %v\n", err)
+		}
+	}()
+
+	op, err := parseOperands(c.f.Args())
+	if err != nil {
+		return err
+	}
+
+	cp := &Copier{
+		IBS:        int(op.ibs),
+		OBS:        int(op.obs),
+		Reblock:    op.bs == 0 || op.conv["swab"], // which changes block sizes
+		Count:      op.count,
+		CountBytes: op.iflags["count_bytes"],
+		FullBlock:  op.iflags["fullblock"],
+		Sync:       op.conv["sync"],
+		NoError:    op.conv["noerror"],
+		Sparse:     op.conv["sparse"],
+		Swab:       op.conv["swab"],
+		Direct:     op.oflags["direct"],
+	}
+	switch {
+	case op.conv["ucase"]:
+		cp.Case = Upper
+	case op.conv["lcase"]:
+		cp.Case = Lower
+	}
+
+	inName, outName := "standard input", "standard output"
+	var (
+		in  io.Reader = ctx.Stdin
+		out io.Writer = ctx.Stdout
+	)
+	if op.in != "" {
+		inName = op.in
+		f, err := os.OpenFile(op.in, os.O_RDONLY|op.iopen, 0)
+		if err != nil {
+			return fmt.Errorf("failed to open '%s': %v", op.in, unwrap(err))
+		}
+		defer f.Close()
+		in = f
+	}
+	seek := op.seek
+	if !op.oflags["seek_bytes"] {
+		seek = mul(seek, op.obs)
+	}
+	if op.out != "" {
+		outName = op.out
+		flags := os.O_WRONLY | op.oopen
+		if !op.conv["nocreat"] {
+			flags |= os.O_CREATE
+		}
+		if op.conv["excl"] {
+			flags |= os.O_EXCL
+		}
+		f, err := os.OpenFile(op.out, flags, 0666)
+		if err != nil {
+			return fmt.Errorf("failed to open '%s': %v", op.out, unwrap(err))
+		}
+		defer f.Close()
+		if !op.conv["notrunc"] && !op.oflags["append"] {
+			// As in GNU dd, the output's truncated to where the
+			// seek ends up, as long as that's at least a block in.
+			size := seek
+			if seek < op.obs {
+				size = 0
+			}
+			if info, err := f.Stat(); err == nil && info.Mode().IsRegular() {
+				if err := f.Truncate(size); err != nil {
+					return fmt.Errorf("failed to truncate to %d bytes in output file '%s': %v",
+						size, op.out, unwrap(err))
+				}
+			}
+		}
+		out = f
+	}
+
+	// stderr is written to by the reader, with iflag=noerror, and by the
+	// progress reports, as well as here.
+	var mu sync.Mutex
+	start := time.Now()
+	xfer := op.status != "noxfer"
+	stats := func() {
+		if op.status != "none" {
+			WriteStats(ctx.Stderr, cp.Progress(), time.Since(start), xfer)
+		}
+	}
+	cp.Warn = func(err error) {
+		mu.Lock()
+		defer mu.Unlock()
+		fmt.Fprintf(ctx.Stderr, "dd: error reading '%s': %v\n", inName, unwrap(err))
+		stats()
+	}
+
+	skip := op.skip
+	if !op.iflags["skip_bytes"] {
+		skip = mul(skip, op.ibs)
+	}
+	// As GNU dd does, short reads are warned about when they'd make a
+	// count of blocks come out wrong.
+	if !cp.Reblock && !cp.FullBlock && op.status != "none" &&
+		(skip >= op.ibs || op.count > 0 && (!cp.CountBytes || op.count >= op.ibs) ||
+			op.iflags["direct"] || op.oflags["direct"]) {
+		cp.PartialRead = func(n int) {
+			mu.Lock()
+			defer mu.Unlock()
+			s := "s"
+			if n == 1 {
+				s = ""
+			}
+			fmt.Fprintf(ctx.Stderr, "dd: warning: partial read (%d byte%s); suggest iflag=fullblock\n", n, s)
+		}
+	}
+	if skip > 0 {
+		if err := cp.Skip(in, skip); err != nil && op.status != "none" {
+			fmt.Fprintf(ctx.Stderr, "dd: %s: cannot skip to specified offset\n", quote(inName))
+		}
+	}
+	if seek > 0 {
+		if err := seekOutput(out, seek); err != nil {
+			return fmt.Errorf("%s: cannot seek: %v", outName, unwrap(err))
+		}
+	}
+
+	var (
+		wg       sync.WaitGroup
+		done     = make(chan struct{})
+		reported bool
+	)
+	if op.status == "progress" {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			t := time.NewTicker(time.Second)
+			defer t.Stop()
+			width := 0
+			for {
+				select {
+				case <-t.C:
+				case <-done:
+					return
+				}
+				line := transfer(cp.Progress().Bytes, time.Since(start), true)
+				pad := ""
+				if len(line) < width {
+					pad = strings.Repeat(" ", width-len(line))
+				}
+				width = len(line)
+				mu.Lock()
+				fmt.Fprintf(ctx.Stderr, "\r%s%s", line, pad)
+				reported = true
+				mu.Unlock()
+			}
+		}()
+	}
+
+	err = cp.Copy(out, in)
+	close(done)
+	wg.Wait()
+	if err == nil {
+		if f, ok := out.(*os.File); ok {
+			switch {
+			case op.conv["fsync"]:
+				err = f.Sync()
+			case op.conv["fdatasync"]:
+				err = fdatasync(f)
+			}
+			if err != nil {
+				err = &OpError{Op: "writing", Err: err}
+			}
+		}
+	}
+
+	mu.Lock()
+	defer mu.Unlock()
+	if reported {
+		fmt.Fprintln(ctx.Stderr)
+	}
+	switch e := err.(type) {
+	case nil:
+	case *OpError:
+		name := inName
+		if e.Op == "writing" {
+			name = outName
+		}
+		fmt.Fprintf(ctx.Stderr, "dd: error %s '%s': %v\n", e.Op, name, unwrap(e.Err))
+		err = errNonFatal
+	default:
+		fmt.Fprintf(ctx.Stderr, "dd: %v\n", unwrap(err))
+		err = errNonFatal
+	}
+	stats()
+	return err
+}
+
+// parseOperands parses the KEY=VALUE arguments.
+func parseOperands(args []string) (*operands, error) {
+	op := &operands{
+		ibs:    512,
+		obs:    512,
+		count:  -1,
+		conv:   make(map[string]bool),
+		iflags: make(map[string]bool),
+		oflags: make(map[string]bool),
+	}
+	for _, arg := range args {
+		key, val, ok := strings.Cut(arg, "=")
+		if !ok {
+			return nil, fmt.Errorf("unrecognized operand '%s'", arg)
+		}
+		var err error
+		switch key {
+		case "if":
+			op.in = val
+		case "of":
+			op.out = val
+		case "bs", "ibs", "obs", "cbs":
+			var n int64
+			if n, err = parseSize(val); err == nil && (n == 0 || n > math.MaxInt32) {
+				err = fmt.Errorf("invalid number: '%s'", val)
+			}
+			switch key {
+			case "bs":
+				op.bs = n
+			case "ibs":
+				op.ibs = n
+			case "obs":
+				op.obs = n
+			}
+		case "count":
+			op.count, err = parseSize(val)
+		case "skip", "iseek":
+			op.skip, err = parseSize(val)
+		case "seek", "oseek":
+			op.seek, err = parseSize(val)
+		case "conv":
+			err = parseList(val, op.conv, conversions, nil, "invalid conversion")
+		case "iflag":
+			err = parseList(val, op.iflags, inputFlags, openFlags, "invalid input flag")
+		case "oflag":
+			err = parseList(val, op.oflags, outputFlags, openFlags, "invalid output flag")
+		case "status":
+			switch val {
+			case "none", "noxfer", "progress":
+				op.status = val
+			default:
+				err = fmt.Errorf("invalid status level: '%s'", val)
+			}
+		default:
+			return nil, fmt.Errorf("unrecognized operand '%s'", arg)
+		}
+		if err != nil {
+			return nil, err
+		}
+	}
+	if op.bs != 0 {
+		op.ibs, op.obs = op.bs, op.bs
+	}
+
+	for _, pair := range [][2]string{
+		{"excl", "nocreat"}, {"ucase", "lcase"},
+	} {
+		if op.conv[pair[0]] && op.conv[pair[1]] {
+			return nil, fmt.Errorf("cannot combine %s and %s", pair[0], pair[1])
+		}
+	}
+	for name := range op.iflags {
+		op.iopen |= openFlags[name]
+	}
+	for name := range op.oflags {
+		op.oopen |= openFlags[name]
+	}
+	return op, nil
+}
+
+// conversions are the conversions of conv= that are supported.
+var conversions = map[string]bool{
+	"excl": true, "fdatasync": true, "fsync": true, "lcase": true,
+	"nocreat": true, "noerror": true, "notrunc": true, "sparse": true,
+	"swab": true, "sync": true, "ucase": true,
+}
+
+// inputFlags and outputFlags are the flags of iflag= and oflag=, besides
+// openFlags.
+var (
+	inputFlags  = map[string]bool{"fullblock": true, "count_bytes": true, "skip_bytes": true}
+	outputFlags = map[string]bool{"seek_bytes": true}
+)
+
+// parseList parses a comma-separated list of names in valid or open into
+// set.
+func parseList(list string, set, valid map[string]bool, open map[string]int, msg string) error {
+	for _, name := range strings.Split(list, ",") {
+		if _, ok := open[name]; !ok && !valid[name] {
+			if name == "ascii" || name == "ebcdic" || name == "ibm" ||
+				name == "block" || name == "unblock" {
+				return fmt.Errorf("conversion '%s' is not supported", name)
+			}
+			return fmt.Errorf("%s: '%s'", msg, name)
+		}
+		set[name] = true
+	}
+	return nil
+}
+
+var multipliers = map[string]int64{
+	"":    1,
+	"c":   1,
+	"w":   2,
+	"b":   512,
+	"kB":  1000,
+	"KB":  1000,
+	"k":   1 << 10,
+	"K":   1 << 10,
+	"KiB": 1 << 10,
+	"MB":  1000 * 1000,
+	"M":   1 << 20,
+	"MiB": 1 << 20,
+	"GB":  1000 * 1000 * 1000,
+	"G":   1 << 30,
+	"GiB": 1 << 30,
+	"TB":  1000 * 1000 * 1000 * 1000,
+	"T":   1 << 40,
+	"TiB": 1 << 40,
+	"PB":  1000 * 1000 * 1000 * 1000 * 1000,
+	"P":   1 << 50,
+	"PiB": 1 << 50,
+	"EB":  1000 * 1000 * 1000 * 1000 * 1000 * 1000,
+	"E":   1 << 60,
+	"EiB": 1 << 60,
+}
+
+// parseSize parses a number with an optional multiplier suffix, or numbers
+// like that joined by x, which are multiplied.
+func parseSize(arg string) (int64, error) {
+	bad := fmt.Errorf("invalid number: '%s'", arg)
+	n := int64(1)
+	for _, s := range strings.Split(arg, "x") {
+		i := 0
+		for i < len(s) && '0' <= s[i] && s[i] <= '9' {
+			i++
+		}
+		mult, ok := multipliers[s[i:]]
+		if i == 0 || !ok {
+			return 0, bad
+		}
+		v, err := strconv.ParseInt(s[:i], 10, 64)
+		if err != nil || v > math.MaxInt64/mult {
+			return 0, bad
+		}
+		if n = mul(n, v*mult); n == math.MaxInt64 {
+			return 0, bad
+		}
+	}
+	return n, nil
+}
+
+// mul returns a*b, or math.MaxInt64 if that's too large.
+func mul(a, b int64) int64 {
+	if b != 0 && a > math.MaxInt64/b {
+		return math.MaxInt64
+	}
+	return a * b
+}
+
+// seekOutput seeks n bytes into w, or writes that many NULs if it can't.
+func seekOutput(w io.Writer, n int64) error {
+	if s, ok := w.(io.Seeker); ok {
+		if _, err := s.Seek(n, io.SeekCurrent); err == nil {
+			return nil
+		}
+	}
+	_, err := io.CopyN(w, zeroReader{}, n)
+	return err
+}
+
+type zeroReader struct{}
+
+func (zeroReader) Read(p []byte) (int, error) {
+	for i := range p {
+		p[i] = 0
+	}
+	return len(p), nil
+}
+
+// quote quotes a name only if the shell would need it to be, as GNU's
+// quotef does.
+func quote(name string) string {
+	if name == "" || strings.ContainsAny(name, " \t\n'\"\\$*?[]{}()<>|&;~#`!") {
+		return "'" + strings.Replace(name, "'", `'\''`, -1) + "'"
+	}
+	return name
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
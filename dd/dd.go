@@ -1,3 +1,543 @@
-package main
+// Package dd copies and converts blocks of data.
+//
+// With blocks large enough for it to matter, a Copier reads and writes at
+// the same time: a goroutine reads input blocks into a ring of buffers and
+// hands them to another, which writes them, so a slow disk on one side
+// doesn't leave the other idle. Buffers are aligned to the page size, so
+// they can be used with O_DIRECT. Smaller blocks are copied in one
+// goroutine, where handing blocks over would cost more than it saves.
+package dd
 
-func main() {}
+import (
+	"bytes"
+	"io"
+	"os"
+	"sync/atomic"
+	"unsafe"
+)
+
+// Align is what buffers are aligned to, enough for O_DIRECT.
+const Align = 4096
+
+// pipelineMin is the smallest block that's read and written concurrently.
+const pipelineMin = 64 * 1024
+
+// ringSize is how many blocks can be in flight between the reader and the
+// writer.
+const ringSize = 2
+
+// Case is a case conversion.
+type Case int
+
+const (
+	NoCase Case = iota
+	Upper
+	Lower
+)
+
+// Copier copies blocks of its input to its output.
+type Copier struct {
+	IBS, OBS int // block sizes
+
+	// Reblock collects the input into OBS-sized blocks for writing. If
+	// it's false each input block is written as it was read.
+	Reblock bool
+
+	// Count is how many input blocks are copied, or bytes with
+	// CountBytes. A negative Count copies everything.
+	Count      int64
+	CountBytes bool
+
+	FullBlock bool // fill input blocks with as many reads as it takes
+	Sync      bool // pad short input blocks with NULs
+	NoError   bool // go on after read errors
+	Sparse    bool // seek over output blocks of NULs rather than write them
+	Swab      bool // swap each pair of input bytes
+	Case      Case
+
+	// Direct is whether the output was opened with O_DIRECT, which
+	// can't write a short final block.
+	Direct bool
+
+	// Warn, if not nil, is called with each read error NoError goes on
+	// after. As in GNU dd, they don't make Copy fail.
+	Warn func(err error)
+
+	// PartialRead, if not nil, is called the first time a read follows
+	// a short one, with how short it was, as a sign that FullBlock was
+	// wanted.
+	PartialRead func(n int)
+
+	stats stats
+
+	lastRead      int  // how much the last read read
+	warnedPartial bool // PartialRead has been called
+}
+
+// Stats are the counts of a copy.
+type Stats struct {
+	InFull, InPartial   int64 // input blocks
+	OutFull, OutPartial int64 // output blocks
+	Bytes               int64 // written
+}
+
+// stats are Stats, updated as the copy goes and read, by Progress, from
+// elsewhere.
+type stats struct {
+	inFull, inPartial   int64
+	outFull, outPartial int64
+	bytes               int64
+}
+
+// Progress returns the counts so far. It's safe to call while Copy runs.
+func (c *Copier) Progress() Stats {
+	s := &c.stats
+	return Stats{
+		InFull:     atomic.LoadInt64(&s.inFull),
+		InPartial:  atomic.LoadInt64(&s.inPartial),
+		OutFull:    atomic.LoadInt64(&s.outFull),
+		OutPartial: atomic.LoadInt64(&s.outPartial),
+		Bytes:      atomic.LoadInt64(&s.bytes),
+	}
+}
+
+// OpError is an error reading the input or writing the output.
+type OpError struct {
+	Op  string // "reading" or "writing"
+	Err error
+}
+
+func (e *OpError) Error() string {
+	return "error " + e.Op + ": " + e.Err.Error()
+}
+
+// block is an input block. It's read into data after some room, for Swab to
+// put the last byte of the previous block before it, and what's to be
+// written of it is data[off:end].
+type block struct {
+	data     []byte
+	off, end int
+	err      error // with the last block, why it's last
+}
+
+func (b *block) bytes() []byte {
+	return b.data[b.off:b.end]
+}
+
+// Copy copies r to w.
+func (c *Copier) Copy(w io.Writer, r io.Reader) error {
+	c.stats = stats{}
+	wr := newWriter(c, w)
+	rd := newReader(c, r)
+	var err error
+	if c.IBS >= pipelineMin {
+		err = c.pipeline(rd, wr)
+	} else {
+		b := &block{data: alignedBuf(rd.head + c.IBS)}
+		for err == nil {
+			done := rd.read(b)
+			if b.end > b.off {
+				err = wr.write(b.bytes())
+			}
+			if done {
+				if err == nil {
+					err = b.err
+				}
+				break
+			}
+		}
+	}
+	if ferr := wr.flush(); err == nil && ferr != nil {
+		err = &OpError{Op: "writing", Err: ferr}
+	}
+	return err
+}
+
+// pipeline reads with one goroutine and, at the same time, writes with
+// this one.
+func (c *Copier) pipeline(rd *reader, wr *writer) error {
+	free := make(chan *block, ringSize)
+	full := make(chan *block, ringSize)
+	stop := make(chan struct{})
+	for i := 0; i < ringSize; i++ {
+		free <- &block{data: alignedBuf(rd.head + c.IBS)}
+	}
+	go func() {
+		defer close(full)
+		for {
+			var b *block
+			select {
+			case b = <-free:
+			case <-stop:
+				return
+			}
+			done := rd.read(b)
+			full <- b
+			if done {
+				return
+			}
+		}
+	}()
+
+	var err error
+	for b := range full {
+		if err == nil && b.end > b.off {
+			err = wr.write(b.bytes())
+		}
+		if err == nil && b.err != nil {
+			err = b.err
+		}
+		if err != nil {
+			close(stop)
+			for range full {
+			}
+			return err
+		}
+		free <- b
+	}
+	return nil
+}
+
+// reader reads input blocks.
+type reader struct {
+	c    *Copier
+	r    io.Reader
+	head int // room before each block, for Swab
+	left int64
+
+	// For Swab: the odd byte at the end of the last block, which goes
+	// at the start of the next.
+	saved    byte
+	hasSaved bool
+}
+
+func newReader(c *Copier, r io.Reader) *reader {
+	rd := &reader{c: c, r: r, left: c.Count}
+	if c.Swab {
+		rd.head = Align
+	}
+	return rd
+}
+
+// read reads the next block into b, and reports whether it's the last.
+func (rd *reader) read(b *block) bool {
+	c := rd.c
+	b.off, b.end, b.err = rd.head, rd.head, nil
+	if rd.left == 0 {
+		return rd.finish(b)
+	}
+	size := c.IBS
+	if c.CountBytes && rd.left >= 0 && rd.left < int64(size) {
+		size = int(rd.left)
+	}
+	buf := b.data[rd.head : rd.head+size]
+
+	var n int
+	for {
+		var err error
+		n, err = c.readSome(rd.r, buf)
+		for c.FullBlock && err == nil && n > 0 && n < size {
+			var m int
+			m, err = rd.r.Read(buf[n:])
+			n += m
+		}
+		if err == io.EOF {
+			if n == 0 {
+				return rd.finish(b)
+			}
+			err = nil
+		}
+		if err == nil {
+			break
+		}
+		if !c.NoError {
+			rd.convert(b, n)
+			b.err = &OpError{Op: "reading", Err: err}
+			return true
+		}
+
+		if c.Warn != nil {
+			c.Warn(err)
+		}
+		// As in GNU dd, the rest of the block is skipped, so what
+		// follows a damaged part of a device stays where it was, and
+		// with Sync the block is all NULs. Otherwise it's dropped.
+		if s, ok := rd.r.(io.Seeker); ok && n < size {
+			s.Seek(int64(size-n), io.SeekCurrent)
+		}
+		if c.Sync {
+			n = 0
+			break
+		}
+	}
+
+	if n == c.IBS {
+		atomic.AddInt64(&c.stats.inFull, 1)
+	} else {
+		atomic.AddInt64(&c.stats.inPartial, 1)
+	}
+	if rd.left > 0 {
+		if c.CountBytes {
+			rd.left -= int64(n)
+		} else {
+			rd.left--
+		}
+	}
+	if c.Sync && n < c.IBS {
+		buf = b.data[rd.head : rd.head+c.IBS]
+		for i := n; i < len(buf); i++ {
+			buf[i] = 0
+		}
+		n = len(buf)
+	}
+	rd.convert(b, n)
+	return false
+}
+
+// readSome reads into p once, watching for partial reads.
+func (c *Copier) readSome(r io.Reader, p []byte) (int, error) {
+	n, err := r.Read(p)
+	if n > 0 && c.PartialRead != nil && !c.warnedPartial {
+		if c.lastRead > 0 && c.lastRead < len(p) {
+			c.PartialRead(c.lastRead)
+			c.warnedPartial = true
+		}
+		c.lastRead = n
+	}
+	return n, err
+}
+
+// Skip skips n bytes of r, before Copy. It seeks if it can, and otherwise
+// reads, as GNU dd does, a block at a time with a read each, however much
+// it reads, and then what's left. It reports io.ErrUnexpectedEOF if less
+// than n was skipped.
+func (c *Copier) Skip(r io.Reader, n int64) error {
+	if f, ok := r.(*os.File); ok {
+		if info, err := f.Stat(); err == nil && info.Mode().IsRegular() {
+			off, err := f.Seek(n, io.SeekCurrent)
+			if err != nil {
+				return err
+			}
+			if off > info.Size() {
+				return io.ErrUnexpectedEOF
+			}
+			return nil
+		}
+	} else if s, ok := r.(io.Seeker); ok {
+		_, err := s.Seek(n, io.SeekCurrent)
+		return err
+	}
+
+	buf := make([]byte, c.IBS)
+	records, rest := n/int64(c.IBS), int(n%int64(c.IBS))
+	var skipped int64
+	for records > 0 || rest > 0 {
+		p := buf
+		if records == 0 {
+			p = buf[:rest]
+		}
+		m, err := c.readSome(r, p)
+		if m == 0 {
+			if err == nil || err == io.EOF {
+				err = io.ErrUnexpectedEOF
+			}
+			return err
+		}
+		skipped += int64(m)
+		if records > 0 {
+			records--
+		} else {
+			rest = 0
+		}
+	}
+	if skipped < n {
+		// Short reads still count as blocks.
+		return io.ErrUnexpectedEOF
+	}
+	return nil
+}
+
+// finish makes b the last block: empty, or the byte Swab kept back.
+func (rd *reader) finish(b *block) bool {
+	if rd.hasSaved {
+		b.data[b.off] = rd.saved
+		b.end++
+		rd.hasSaved = false
+	}
+	return true
+}
+
+// convert converts the n bytes read into b.
+func (rd *reader) convert(b *block, n int) {
+	b.end = b.off + n
+	buf := b.bytes()
+	switch rd.c.Case {
+	case Upper:
+		for i, c := range buf {
+			if 'a' <= c && c <= 'z' {
+				buf[i] = c - ('a' - 'A')
+			}
+		}
+	case Lower:
+		for i, c := range buf {
+			if 'A' <= c && c <= 'Z' {
+				buf[i] = c + ('a' - 'A')
+			}
+		}
+	}
+	if !rd.c.Swab {
+		return
+	}
+
+	// Pairs can span blocks, as in GNU dd: the byte kept back from the
+	// last block goes before this one, and an odd one at the end of this
+	// one is kept back for the next.
+	if rd.hasSaved {
+		b.off--
+		b.data[b.off] = rd.saved
+		rd.hasSaved = false
+	}
+	if (b.end-b.off)%2 != 0 {
+		b.end--
+		rd.saved, rd.hasSaved = b.data[b.end], true
+	}
+	buf = b.bytes()
+	for i := 0; i+1 < len(buf); i += 2 {
+		buf[i], buf[i+1] = buf[i+1], buf[i]
+	}
+}
+
+// writer writes output blocks.
+type writer struct {
+	c    *Copier
+	w    io.Writer
+	f    *os.File // w, if it's a file that can be seeked over
+	obuf []byte   // with Reblock, the output block being filled
+	n    int      // of obuf
+
+	// seeked is whether the last output block was seeked over, so the
+	// output must be made longer at the end.
+	seeked bool
+}
+
+func newWriter(c *Copier, w io.Writer) *writer {
+	wr := &writer{c: c, w: w}
+	if c.Reblock {
+		wr.obuf = alignedBuf(c.OBS)
+	}
+	if f, ok := w.(*os.File); ok && c.Sparse {
+		if info, err := f.Stat(); err == nil && info.Mode().IsRegular() {
+			wr.f = f
+		}
+	}
+	return wr
+}
+
+// write writes the data of an input block.
+func (wr *writer) write(data []byte) error {
+	if err := wr.reblock(data); err != nil {
+		return &OpError{Op: "writing", Err: err}
+	}
+	return nil
+}
+
+func (wr *writer) reblock(data []byte) error {
+	if !wr.c.Reblock {
+		return wr.put(data)
+	}
+	for len(data) > 0 {
+		n := copy(wr.obuf[wr.n:], data)
+		wr.n += n
+		data = data[n:]
+		if wr.n == len(wr.obuf) {
+			wr.n = 0
+			if err := wr.put(wr.obuf); err != nil {
+				return err
+			}
+		}
+	}
+	return nil
+}
+
+// put writes an output block.
+func (wr *writer) put(b []byte) error {
+	c := wr.c
+	if len(b) == c.OBS {
+		atomic.AddInt64(&c.stats.outFull, 1)
+	} else {
+		atomic.AddInt64(&c.stats.outPartial, 1)
+	}
+	if wr.f != nil && isZero(b) {
+		if _, err := wr.f.Seek(int64(len(b)), io.SeekCurrent); err != nil {
+			return err
+		}
+		wr.seeked = true
+		atomic.AddInt64(&c.stats.bytes, int64(len(b)))
+		return nil
+	}
+	wr.seeked = false
+	if c.Direct && len(b)%512 != 0 {
+		// O_DIRECT can only write whole sectors, so a short last
+		// block is written without it, as GNU dd does.
+		if f, ok := wr.w.(*os.File); ok {
+			dropDirect(f)
+		}
+	}
+	n, err := wr.w.Write(b)
+	atomic.AddInt64(&c.stats.bytes, int64(n))
+	return err
+}
+
+// flush writes what's left of the output.
+func (wr *writer) flush() error {
+	if wr.n > 0 {
+		n := wr.n
+		wr.n = 0
+		if err := wr.put(wr.obuf[:n]); err != nil {
+			return err
+		}
+	}
+	if wr.seeked {
+		// The last block was a hole, which isn't part of the file
+		// until something's written after it.
+		off, err := wr.f.Seek(0, io.SeekCurrent)
+		if err != nil {
+			return err
+		}
+		info, err := wr.f.Stat()
+		if err != nil {
+			return err
+		}
+		if info.Size() < off {
+			return wr.f.Truncate(off)
+		}
+	}
+	return nil
+}
+
+// zeros is compared with blocks to find those that are all NULs.
+var zeros [64 * 1024]byte
+
+func isZero(b []byte) bool {
+	for len(b) > 0 {
+		n := len(b)
+		if n > len(zeros) {
+			n = len(zeros)
+		}
+		if !bytes.Equal(b[:n], zeros[:n]) {
+			return false
+		}
+		b = b[n:]
+	}
+	return true
+}
+
+// alignedBuf returns a buffer of n bytes starting at a multiple of Align.
+func alignedBuf(n int) []byte {
+	b := make([]byte, n+Align)
+	off := 0
+	if r := int(uintptr(unsafe.Pointer(&b[0])) & (Align - 1)); r != 0 {
+		off = Align - r
+	}
+	return b[off : off+n : off+n]
+}
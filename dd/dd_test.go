@@ -0,0 +1,187 @@
+package dd
+
+import (
+	"bytes"
+	"context"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+	"testing/iotest"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+func TestCopy(t *testing.T) {
+	for _, tc := range []struct {
+		c    Copier
+		in   string
+		want string
+		st   Stats
+	}{
+		{Copier{IBS: 3, OBS: 3, Count: -1}, "abcdefgh", "abcdefgh", Stats{2, 1, 2, 1, 8}},
+		{Copier{IBS: 4, OBS: 3, Count: -1, Reblock: true}, "abcdef", "abcdef", Stats{1, 1, 2, 0, 6}},
+		{Copier{IBS: 3, OBS: 3, Count: 2}, "abcdefgh", "abcdef", Stats{2, 0, 2, 0, 6}},
+		{Copier{IBS: 3, OBS: 3, Count: 4, CountBytes: true}, "abcdefgh", "abcd", Stats{1, 1, 1, 1, 4}},
+		{Copier{IBS: 8, OBS: 8, Count: -1, Sync: true}, "abc", "abc\x00\x00\x00\x00\x00", Stats{0, 1, 1, 0, 8}},
+		{Copier{IBS: 3, OBS: 3, Count: -1, Swab: true, Reblock: true}, "abcdefg", "badcfeg", Stats{2, 1, 2, 1, 7}},
+		{Copier{IBS: 1, OBS: 1, Count: -1, Swab: true, Reblock: true}, "abcde", "badce", Stats{5, 0, 5, 0, 5}},
+		{Copier{IBS: 4, OBS: 4, Count: -1, Case: Upper}, "abC1", "ABC1", Stats{1, 0, 1, 0, 4}},
+		{Copier{IBS: 4, OBS: 4, Count: -1, Case: Lower}, "abC1", "abc1", Stats{1, 0, 1, 0, 4}},
+	} {
+		var out bytes.Buffer
+		c := tc.c
+		err := c.Copy(&out, strings.NewReader(tc.in))
+		if err != nil || out.String() != tc.want || c.Progress() != tc.st {
+			t.Errorf("%+v: got %q, %+v, %v, want %q, %+v", tc.c, out.String(), c.Progress(), err, tc.want, tc.st)
+		}
+	}
+}
+
+func TestPipeline(t *testing.T) {
+	data := make([]byte, 5<<20+123)
+	rand.New(rand.NewSource(1)).Read(data)
+	for _, c := range []*Copier{
+		{IBS: 1 << 20, OBS: 1 << 20, Count: -1},
+		{IBS: 1 << 20, OBS: 4096, Count: -1, Reblock: true},
+		{IBS: 100000, OBS: 65536, Count: -1, Reblock: true, Swab: true},
+	} {
+		var out bytes.Buffer
+		// One byte at a time would take too long; half reads will do.
+		err := c.Copy(&out, iotest.HalfReader(bytes.NewReader(data)))
+		want := data
+		if c.Swab {
+			want = append([]byte(nil), data...)
+			for i := 0; i+1 < len(want); i += 2 {
+				want[i], want[i+1] = want[i+1], want[i]
+			}
+		}
+		if err != nil || !bytes.Equal(out.Bytes(), want) {
+			t.Errorf("%+v: got %d bytes, %v", c, out.Len(), err)
+		}
+		if got := c.Progress().Bytes; got != int64(len(data)) {
+			t.Errorf("%+v: counted %d bytes", c, got)
+		}
+	}
+}
+
+func TestSparse(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "dd")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	data := make([]byte, 64<<10)
+	copy(data[4096:], "x")
+	f, err := os.Create(filepath.Join(tmp, "out"))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer f.Close()
+	c := &Copier{IBS: 4096, OBS: 4096, Count: -1, Sparse: true}
+	if err := c.Copy(f, bytes.NewReader(data)); err != nil {
+		t.Fatal(err)
+	}
+	got, err := ioutil.ReadFile(f.Name())
+	if err != nil || !bytes.Equal(got, data) {
+		t.Fatalf("got %d bytes, %v, want %d", len(got), err, len(data))
+	}
+}
+
+func TestParseSize(t *testing.T) {
+	for _, tc := range []struct {
+		s    string
+		want int64
+	}{
+		{"1", 1}, {"1c", 1}, {"2w", 4}, {"1b", 512}, {"1k", 1024}, {"1K", 1024},
+		{"1kB", 1000}, {"1KB", 1000}, {"2M", 2 << 20}, {"1GB", 1e9}, {"2x3", 6}, {"2x1k", 2048},
+	} {
+		if got, err := parseSize(tc.s); err != nil || got != tc.want {
+			t.Errorf("%q: got %d, %v, want %d", tc.s, got, err, tc.want)
+		}
+	}
+	for _, s := range []string{"", "x", "1e", "-1", "1xx2", "99999999999999999999", "9E"} {
+		if _, err := parseSize(s); err == nil {
+			t.Errorf("%q: no error", s)
+		}
+	}
+}
+
+func TestHuman(t *testing.T) {
+	for _, tc := range []struct {
+		n    int64
+		base int
+		want string
+	}{
+		{6, 1000, "6 B"},
+		{1024, 1000, "1.0 kB"},
+		{1024, 1024, "1.0 KiB"},
+		{2450, 1000, "2.4 kB"}, // a tie goes to even
+		{2850, 1000, "2.8 kB"},
+		{2909, 1000, "2.9 kB"},
+		{1000000, 1024, "977 KiB"},
+		{1048576000, 1024, "1000 MiB"},
+		{1048576000, 1000, "1.0 GB"},
+		{999999, 1000, "1.0 MB"},
+		{70000, 1000, "70 kB"},
+	} {
+		if got := human(tc.n, tc.base); got != tc.want {
+			t.Errorf("human(%d, %d): got %q, want %q", tc.n, tc.base, got, tc.want)
+		}
+	}
+	for v, want := range map[float64]string{
+		0: "0.0 kB", 192381: "192 kB", 64.7e6: "64.7 MB", 2.4e9: "2.4 GB",
+	} {
+		if got := humanRate(v); got != want {
+			t.Errorf("humanRate(%g): got %q, want %q", v, got, want)
+		}
+	}
+}
+
+func TestRun(t *testing.T) {
+	dd := func(stdin string, args ...string) (string, string, error) {
+		var stdout, stderr bytes.Buffer
+		err := run(coreutils.Context{
+			Context: context.Background(),
+			Stdin:   strings.NewReader(stdin),
+			Stdout:  &stdout,
+			Stderr:  &stderr,
+		}, args...)
+		return stdout.String(), stderr.String(), err
+	}
+
+	out, stderr, err := dd("hello, world", "bs=5", "skip=1", "count=1", "status=noxfer", "conv=ucase")
+	if err != nil || out != ", WOR" || stderr != "1+0 records in\n1+0 records out\n" {
+		t.Errorf("got %q, %q, %v", out, stderr, err)
+	}
+	out, stderr, err = dd("abc", "status=none")
+	if err != nil || out != "abc" || stderr != "" {
+		t.Errorf("status=none: got %q, %q, %v", out, stderr, err)
+	}
+	if _, stderr, _ := dd("abc"); !strings.HasPrefix(stderr, "0+1 records in\n0+1 records out\n3 bytes copied, ") {
+		t.Errorf("stats: got %q", stderr)
+	}
+	for _, args := range [][]string{{"foo=1"}, {"bs=0"}, {"bs=x"}, {"conv=bar"}, {"iflag=bar"}, {"status=bar"}, {"conv=ucase,lcase"}} {
+		if _, _, err := dd("", args...); err == nil {
+			t.Errorf("%q: no error", args)
+		}
+	}
+}
+
+func BenchmarkCopy(b *testing.B) {
+	data := make([]byte, 16<<20)
+	for _, bs := range []int{4096, 1 << 20} {
+		b.Run(strings.Replace(human(int64(bs), 1024), " ", "", -1), func(b *testing.B) {
+			b.SetBytes(int64(len(data)))
+			for i := 0; i < b.N; i++ {
+				c := &Copier{IBS: bs, OBS: bs, Count: -1}
+				if err := c.Copy(ioutil.Discard, bytes.NewReader(data)); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
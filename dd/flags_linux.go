@@ -0,0 +1,50 @@
+// +build linux
+
+package dd
+
+import (
+	"os"
+
+	"golang.org/x/sys/unix"
+)
+
+// openFlags are the iflag= and oflag= flags that are flags to open(2).
+var openFlags = map[string]int{
+	"append":    os.O_APPEND,
+	"direct":    unix.O_DIRECT,
+	"directory": unix.O_DIRECTORY,
+	"dsync":     unix.O_DSYNC,
+	"sync":      unix.O_SYNC,
+	"noatime":   unix.O_NOATIME,
+	"noctty":    unix.O_NOCTTY,
+	"nofollow":  unix.O_NOFOLLOW,
+	"nonblock":  unix.O_NONBLOCK,
+}
+
+// dropDirect turns off O_DIRECT for f.
+func dropDirect(f *os.File) {
+	rc, err := f.SyscallConn()
+	if err != nil {
+		return
+	}
+	rc.Control(func(fd uintptr) {
+		if fl, err := unix.FcntlInt(fd, unix.F_GETFL, 0); err == nil {
+			unix.FcntlInt(fd, unix.F_SETFL, fl&^unix.O_DIRECT)
+		}
+	})
+}
+
+// fdatasync flushes f's data, but not necessarily its metadata, to disk.
+func fdatasync(f *os.File) error {
+	rc, err := f.SyscallConn()
+	if err != nil {
+		return err
+	}
+	var serr error
+	if err := rc.Control(func(fd uintptr) {
+		serr = unix.Fdatasync(int(fd))
+	}); err != nil {
+		return err
+	}
+	return serr
+}
@@ -0,0 +1,18 @@
+// +build !linux
+
+package dd
+
+import "os"
+
+// openFlags are the iflag= and oflag= flags that are flags to open(2), of
+// those that are portable.
+var openFlags = map[string]int{
+	"append": os.O_APPEND,
+	"sync":   os.O_SYNC,
+}
+
+func dropDirect(f *os.File) {}
+
+func fdatasync(f *os.File) error {
+	return f.Sync()
+}
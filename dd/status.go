@@ -0,0 +1,133 @@
+package dd
+
+import (
+	"fmt"
+	"io"
+	"strconv"
+	"time"
+)
+
+// WriteStats writes s as GNU dd does at the end. Unless xfer is false the
+// number of bytes copied, and how fast, follows the number of blocks.
+func WriteStats(w io.Writer, s Stats, elapsed time.Duration, xfer bool) {
+	fmt.Fprintf(w, "%d+%d records in\n%d+%d records out\n",
+		s.InFull, s.InPartial, s.OutFull, s.OutPartial)
+	if xfer {
+		fmt.Fprintf(w, "%s\n", transfer(s.Bytes, elapsed, false))
+	}
+}
+
+// transfer describes n bytes copied in elapsed. For status=progress the
+// time is in whole seconds.
+func transfer(n int64, elapsed time.Duration, progress bool) string {
+	var b []byte
+	b = strconv.AppendInt(b, n, 10)
+	si, iec := human(n, 1000), human(n, 1024)
+	switch {
+	case n == 1:
+		b = append(b, " byte"...)
+	case n < 1000:
+		b = append(b, " bytes"...)
+	case n < 1024:
+		b = append(b, " bytes ("+si+")"...)
+	default:
+		b = append(b, " bytes ("+si+", "+iec+")"...)
+	}
+
+	secs := elapsed.Seconds()
+	rate := "Infinity B/s"
+	if elapsed > 0 {
+		rate = humanRate(float64(n)/secs) + "/s"
+	}
+	format := "%.6g"
+	if progress {
+		format = "%.0f"
+	}
+	return fmt.Sprintf("%s copied, "+format+" s, %s", b, secs, rate)
+}
+
+var (
+	siUnits  = []string{"B", "kB", "MB", "GB", "TB", "PB", "EB"}
+	iecUnits = []string{"B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"}
+)
+
+// human formats n bytes with a unit that's a power of base, as GNU's
+// human_readable does: with one decimal below 10, rounded to the nearest,
+// and to even on a tie.
+func human(n int64, base int) string {
+	units := siUnits
+	if base == 1024 {
+		units = iecUnits
+	}
+	b := uint64(base)
+	amount := uint64(n)
+	// tenths is the first digit after the point, and rounding what's
+	// after that: 0 for nothing, 1 for less than half, 2 for half and 3
+	// for more.
+	var tenths, rounding uint64
+	e := 0
+	for amount >= b && e < len(units)-1 {
+		r10 := amount%b*10 + tenths
+		r2 := r10%b*2 + rounding>>1
+		amount /= b
+		tenths = r10 / b
+		switch {
+		case r2 == 0:
+			rounding = 0
+		case r2 < b:
+			rounding = 1
+		case r2 == b:
+			rounding = 2
+		default:
+			rounding = 3
+		}
+		e++
+	}
+	point := false
+	if e > 0 && amount < 10 {
+		if rounding+tenths&1 > 2 {
+			tenths++
+			rounding = 0
+			if tenths == 10 {
+				amount++
+				tenths = 0
+			}
+		}
+		if amount < 10 {
+			point = true
+		}
+	}
+	if !point {
+		odd := uint64(0)
+		if rounding+amount&1 > 0 {
+			odd = 1
+		}
+		if tenths+odd > 5 {
+			amount++
+			if amount == b && e < len(units)-1 {
+				e++
+				amount, tenths, point = 1, 0, true
+			}
+		}
+	}
+	s := strconv.FormatUint(amount, 10)
+	if point {
+		s += "." + strconv.FormatUint(tenths, 10)
+	}
+	return s + " " + units[e]
+}
+
+// humanRate formats a number of bytes per second, in decimal units no
+// smaller than kB, as GNU dd does.
+func humanRate(v float64) string {
+	d, e := 1000.0, 1
+	for d*1000 <= v && e < len(siUnits)-1 {
+		d *= 1000
+		e++
+	}
+	s := strconv.FormatFloat(v/d, 'f', 1, 64)
+	if len(s) > 4 {
+		s = strconv.FormatFloat(v/d, 'f', 0, 64)
+	}
+	return s + " " + siUnits[e]
+}
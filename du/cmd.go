@@ -0,0 +1,348 @@
+package du
+
+import (
+	"bufio"
+	"errors"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path"
+	"strconv"
+	"strings"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("du", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -k but not --k.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+	bad2       = string(rune(uniNonChar + 2))
+	bad3       = string(rune(uniNonChar + 3))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.null, "null", "0", false, "end each output line with NUL, not newline")
+	c.f.BoolVarP(&c.all, "all", "a", false, "write counts for all files, not just directories")
+	c.f.BoolVar(&c.apparent, "apparent-size", false, `print apparent sizes, rather than disk usage; although
+                          the apparent size is usually smaller, it may be
+                          larger due to holes in ('sparse') files, internal
+                          fragmentation, indirect blocks, and the like`)
+	c.f.StringVarP(&c.blockSize, "block-size", "B", "", `scale sizes by SIZE before printing them; e.g.,
+                          '-BM' prints sizes in units of 1,048,576 bytes`)
+	c.f.BoolVarP(&c.bytes, "bytes", "b", false, "equivalent to '--apparent-size --block-size=1'")
+	c.f.BoolVarP(&c.total, "total", "c", false, "produce a grand total")
+	c.f.BoolVarP(&c.derefArgs, "dereference-args", "D", false, "dereference only symlinks that are listed on the command line")
+	c.f.BoolVarP(&c.derefArgs, bad1, "H", false, "equivalent to --dereference-args (-D)")
+	c.f.StringVarP(&c.maxDepth, "max-depth", "d", "", `print the total for a directory (or file, with --all)
+                          only if it is N or fewer levels below the command
+                          line argument;  --max-depth=0 is the same as
+                          --summarize`)
+	c.f.BoolVarP(&c.human, "human-readable", "h", false, "print sizes in human readable format (e.g., 1K 234M 2G)")
+	c.f.BoolVar(&c.inodes, "inodes", false, "list inode usage information instead of block usage")
+	c.f.BoolVarP(&c.k, bad2, "k", false, "like --block-size=1K")
+	c.f.BoolVarP(&c.deref, "dereference", "L", false, "dereference all symbolic links")
+	c.f.BoolVarP(&c.countLinks, "count-links", "l", false, "count sizes many times if hard linked")
+	c.f.BoolVarP(&c.m, bad3, "m", false, "like --block-size=1M")
+	c.f.BoolVarP(&c.noDeref, "no-dereference", "P", false, "don't follow any symbolic links (this is the default)")
+	c.f.BoolVarP(&c.separateDirs, "separate-dirs", "S", false, "for directories do not include size of subdirectories")
+	c.f.BoolVar(&c.si, "si", false, "like -h, but use powers of 1000 not 1024")
+	c.f.BoolVarP(&c.summarize, "summarize", "s", false, "display only a total for each argument")
+	c.f.StringVarP(&c.threshold, "threshold", "t", "", `exclude entries smaller than SIZE if positive,
+                          or entries greater than SIZE if negative`)
+	c.f.BoolVarP(&c.oneFileSystem, "one-file-system", "x", false, "skip directories on different file systems")
+	c.f.StringArrayVar(&c.exclude, "exclude", nil, "exclude files that match PATTERN")
+	c.f.StringArrayVarP(&c.excludeFrom, "exclude-from", "X", nil, "exclude files that match any pattern in FILE")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+
+	// GNU du lets the last of these win, and pflag sets flags in the
+	// order they're given.
+	for name, group := range map[string]*string{
+		"block-size":     &c.lastFormat,
+		"bytes":          &c.lastFormat,
+		"human-readable": &c.lastFormat,
+		bad2:             &c.lastFormat,
+		bad3:             &c.lastFormat,
+		"si":             &c.lastFormat,
+		"dereference":    &c.lastDeref,
+		"no-dereference": &c.lastDeref,
+	} {
+		f := c.f.Lookup(name)
+		f.Value = lastValue{f.Value, name, group}
+	}
+	return &c
+}
+
+type cmd struct {
+	f              flag.FlagSet
+	null           bool
+	all            bool
+	apparent       bool
+	blockSize      string
+	bytes          bool
+	total          bool
+	derefArgs      bool
+	maxDepth       string
+	human          bool
+	inodes         bool
+	k, m           bool
+	deref, noDeref bool
+	countLinks     bool
+	separateDirs   bool
+	si             bool
+	summarize      bool
+	threshold      string
+	oneFileSystem  bool
+	exclude        []string
+	excludeFrom    []string
+	version        bool
+	lastFormat     string
+	lastDeref      string
+}
+
+// lastValue is a flag's value that also records the flag as the last of its
+// group to be set.
+type lastValue struct {
+	flag.Value
+	name string
+	last *string
+}
+
+func (v lastValue) Set(s string) error {
+	*v.last = v.name
+	return v.Value.Set(s)
+}
+
+var errNonFatal = errors.New("at least one non-fatal error occurred")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "du (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errNonFatal {
+			fmt.Fprintf(ctx.Stderr, "du: %v\n", err)
+		}
+	}()
+
+	w := &Walker{
+		Apparent:      c.apparent || c.bytes,
+		Inodes:        c.inodes,
+		CountLinks:    c.countLinks,
+		SeparateDirs:  c.separateDirs,
+		All:           c.all,
+		OneFileSystem: c.oneFileSystem,
+		MaxDepth:      -1,
+	}
+	if c.derefArgs {
+		w.Deref = DerefArgs
+	}
+	if c.lastDeref == "dereference" {
+		w.Deref = DerefAll
+	}
+
+	if c.f.Changed("max-depth") {
+		n, err := strconv.Atoi(c.maxDepth)
+		if err != nil || n < 0 {
+			return fmt.Errorf("invalid maximum depth '%s'", c.maxDepth)
+		}
+		w.MaxDepth = n
+	}
+	if c.summarize {
+		switch {
+		case c.all:
+			return errors.New("cannot both summarize and show all entries")
+		case w.MaxDepth > 0:
+			return fmt.Errorf("warning: summarizing conflicts with --max-depth=%d", w.MaxDepth)
+		case w.MaxDepth == 0:
+			fmt.Fprintf(ctx.Stderr, "du: warning: summarizing is the same as using --max-depth=0\n")
+		}
+		w.MaxDepth = 0
+	}
+
+	fm, err := c.format(ctx)
+	if err != nil {
+		return err
+	}
+	if c.inodes {
+		if w.Apparent {
+			fmt.Fprintf(ctx.Stderr, "du: warning: options --apparent-size and -b are ineffective with --inodes\n")
+		}
+		fm.block, fm.unit = 1, ""
+	}
+
+	var threshold int64
+	if c.f.Changed("threshold") {
+		s := strings.TrimPrefix(c.threshold, "-")
+		n, _, err := parseSize(s)
+		if err != nil || n == 0 && s != c.threshold {
+			return fmt.Errorf("invalid --threshold argument '%s'", c.threshold)
+		}
+		threshold = n
+		if s != c.threshold {
+			threshold = -n
+		}
+	}
+
+	patterns := c.exclude
+	for _, name := range c.excludeFrom {
+		b, err := ioutil.ReadFile(name)
+		if err != nil {
+			return fmt.Errorf("%s: %v", name, unwrap(err))
+		}
+		for _, p := range strings.Split(string(b), "\n") {
+			if p != "" {
+				patterns = append(patterns, p)
+			}
+		}
+	}
+	if len(patterns) > 0 {
+		w.Exclude = func(name string) bool {
+			return excluded(patterns, name)
+		}
+	}
+
+	term := byte('\n')
+	if c.null {
+		term = 0
+	}
+	out := bufio.NewWriterSize(ctx.Stdout, 64*1024)
+	var buf []byte
+	print := func(size int64, name string) {
+		buf = fm.append(buf[:0], size)
+		buf = append(buf, '\t')
+		buf = append(buf, name...)
+		buf = append(buf, term)
+		out.Write(buf)
+	}
+	w.Report = func(size int64, name string) {
+		if threshold >= 0 && size >= threshold || threshold < 0 && size <= -threshold {
+			print(size, name)
+		}
+	}
+	var nerrs int
+	w.Error = func(err error) {
+		nerrs++
+		pe, ok := err.(*os.PathError)
+		switch {
+		case !ok:
+			fmt.Fprintf(ctx.Stderr, "du: %v\n", err)
+		case pe.Op == "stat" || pe.Op == "lstat":
+			fmt.Fprintf(ctx.Stderr, "du: cannot access '%s': %v\n", pe.Path, pe.Err)
+		default:
+			fmt.Fprintf(ctx.Stderr, "du: cannot read directory '%s': %v\n", pe.Path, pe.Err)
+		}
+	}
+
+	names := c.f.Args()
+	if len(names) == 0 {
+		names = []string{"."}
+	}
+	w.HashAll = len(names) > 1 || w.Deref == DerefAll
+	var total int64
+	for _, name := range names {
+		n, err := w.Walk(name)
+		if err != nil {
+			w.Error(err)
+		}
+		total += n
+	}
+	if c.total {
+		print(total, "total")
+	}
+	if err := out.Flush(); err != nil {
+		return err
+	}
+	if nerrs > 0 {
+		return errNonFatal
+	}
+	return nil
+}
+
+// format returns how sizes are written: as the flags say or, failing that,
+// as the environment does.
+func (c *cmd) format(ctx coreutils.Context) (format, error) {
+	switch c.lastFormat {
+	case "block-size":
+		f, err := parseBlockSize(c.blockSize)
+		switch err {
+		case nil:
+			return f, nil
+		case errRange:
+			return f, fmt.Errorf("-B argument '%s' too large", c.blockSize)
+		case errSuffix:
+			return f, fmt.Errorf("invalid suffix in -B argument '%s'", c.blockSize)
+		default:
+			return f, fmt.Errorf("invalid -B argument '%s'", c.blockSize)
+		}
+	case "bytes":
+		return format{block: 1}, nil
+	case "human-readable":
+		return format{block: 1, human: 1024}, nil
+	case "si":
+		return format{block: 1, human: 1000}, nil
+	case bad2:
+		return format{block: 1024}, nil
+	case bad3:
+		return format{block: 1 << 20}, nil
+	}
+	for _, key := range []string{"DU_BLOCK_SIZE", "BLOCK_SIZE", "BLOCKSIZE"} {
+		if s := getEnv(ctx, key); s != "" {
+			if f, err := parseBlockSize(s); err == nil {
+				return f, nil
+			}
+			break
+		}
+	}
+	if getEnv(ctx, "POSIXLY_CORRECT") != "" {
+		return format{block: 512}, nil
+	}
+	return format{block: 1024}, nil
+}
+
+// excluded reports whether name matches one of patterns, or would if
+// some of its leading directories were left out, like an unanchored
+// pattern in GNU du.
+func excluded(patterns []string, name string) bool {
+	for _, p := range patterns {
+		for s := name; ; {
+			if ok, _ := path.Match(p, s); ok {
+				return true
+			}
+			i := strings.IndexByte(s, '/')
+			if i < 0 {
+				break
+			}
+			s = s[i+1:]
+		}
+	}
+	return false
+}
+
+func getEnv(ctx coreutils.Context, key string) string {
+	if ctx.GetEnv != nil {
+		return ctx.GetEnv(key)
+	}
+	return os.Getenv(key)
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
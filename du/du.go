@@ -1,3 +1,169 @@
-package main
+// Package du estimates file space usage.
+package du
 
-func main() {}
+import (
+	"os"
+	"sync"
+)
+
+// Deref says which symbolic links a Walker follows.
+type Deref uint8
+
+const (
+	// DerefNone follows no symbolic links.
+	DerefNone Deref = iota
+	// DerefArgs follows symbolic links given to Walk, but not those found
+	// underneath them.
+	DerefArgs
+	// DerefAll follows every symbolic link.
+	DerefAll
+)
+
+// Walker adds up the space used by directory trees.
+type Walker struct {
+	// Apparent counts the size of each file rather than the space
+	// allocated to it.
+	Apparent bool
+	// Inodes counts files instead of bytes.
+	Inodes bool
+	// CountLinks counts a file with several hard links once for each
+	// link found, instead of once. Otherwise, which of its links is
+	// counted depends on which the workers find first.
+	CountLinks bool
+	// SeparateDirs leaves subdirectories out of each directory's size.
+	// What Walk returns still includes them.
+	SeparateDirs bool
+	// All reports files as well as directories.
+	All bool
+	// OneFileSystem skips anything on a different filesystem from the
+	// path given to Walk.
+	OneFileSystem bool
+	// Deref says which symbolic links are followed.
+	Deref Deref
+	// MaxDepth is how far below the path given to Walk anything is
+	// reported. Negative means no limit. Everything is counted whatever
+	// its depth.
+	MaxDepth int
+	// HashAll remembers every file and directory seen, not just files with
+	// several links, so nothing is counted twice across calls to Walk.
+	// It's needed when walking more than one path, or following links.
+	HashAll bool
+	// Workers is the number of goroutines reading directories. Zero means
+	// four for each CPU: most of the time goes to waiting on the
+	// filesystem, all the more so when it's on the network.
+	Workers int
+
+	// Exclude, if non-nil, is called with the path of everything found;
+	// if it returns true, the file isn't counted or reported.
+	Exclude func(path string) bool
+	// Report is called with the size of each directory and, for All, each
+	// file. Directories are reported after everything in them, in the
+	// order the filesystem lists them, like GNU du. Report is never
+	// called concurrently.
+	Report func(size int64, path string)
+	// Error, if non-nil, is called with the errors met under the path
+	// given to Walk, which doesn't stop. Its calls are serialized, too.
+	Error func(err error)
+
+	seen inodeSet
+}
+
+// Walk reports the usage under path, and returns the total. The only error
+// returned is from looking up path itself; the rest go to Error.
+func (w *Walker) Walk(path string) (int64, error) {
+	var (
+		info os.FileInfo
+		err  error
+	)
+	if w.Deref == DerefNone {
+		info, err = os.Lstat(path)
+	} else {
+		info, err = os.Stat(path)
+	}
+	if err != nil {
+		return 0, err
+	}
+	st := fileStat(info)
+	if w.skip(&st) || w.Exclude != nil && w.Exclude(path) {
+		return 0, nil
+	}
+	if !st.dir {
+		n := w.size(&st)
+		w.report(n, path)
+		return n, nil
+	}
+	return w.walk(path, &st), nil
+}
+
+func (w *Walker) report(size int64, path string) {
+	if w.Report != nil {
+		w.Report(size, path)
+	}
+}
+
+// stat is what a Walker needs to know about a file.
+type stat struct {
+	dev, ino uint64
+	nlink    uint64
+	size     int64
+	blocks   int64 // in units of 512 bytes
+	dir      bool
+}
+
+func (w *Walker) size(st *stat) int64 {
+	switch {
+	case w.Inodes:
+		return 1
+	case w.Apparent:
+		return st.size
+	default:
+		return st.blocks * 512
+	}
+}
+
+// skip reports whether st has been counted already.
+func (w *Walker) skip(st *stat) bool {
+	if w.CountLinks || !w.HashAll && (st.dir || st.nlink <= 1) || st.ino == 0 {
+		return false // or it's a file that couldn't be told apart
+	}
+	return !w.seen.add(devIno{st.dev, st.ino})
+}
+
+// lines reports whether anything at depth is reported.
+func (w *Walker) lines(depth int) bool {
+	return w.MaxDepth < 0 || depth <= w.MaxDepth
+}
+
+type devIno struct {
+	dev, ino uint64
+}
+
+// inodeShards is the number of independently locked parts of an inodeSet.
+const inodeShards = 64
+
+// inodeSet is a set of files safe for concurrent use. It's split into
+// shards by inode number, so that workers adding different files rarely
+// wait for each other.
+type inodeSet struct {
+	shards [inodeShards]struct {
+		mu sync.Mutex
+		m  map[devIno]struct{}
+		_  [48]byte // keep shards on their own cache lines
+	}
+}
+
+// add adds k to the set, and reports whether it wasn't already there.
+func (s *inodeSet) add(k devIno) bool {
+	h := k.ino ^ k.dev*0x9e3779b97f4a7c15
+	sh := &s.shards[(h^h>>32)%inodeShards]
+	sh.mu.Lock()
+	defer sh.mu.Unlock()
+	if _, ok := sh.m[k]; ok {
+		return false
+	}
+	if sh.m == nil {
+		sh.m = make(map[devIno]struct{})
+	}
+	sh.m[k] = struct{}{}
+	return true
+}
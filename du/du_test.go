@@ -0,0 +1,250 @@
+package du
+
+import (
+	"bytes"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+// makeTree creates a tree under root that's wide in places and deep in
+// others, with a hard link and a symlink.
+func makeTree(t testing.TB, root string) {
+	mkdir := func(path string) {
+		if err := os.Mkdir(path, 0755); err != nil {
+			t.Fatal(err)
+		}
+	}
+	write := func(path string, n int) {
+		if err := ioutil.WriteFile(path, bytes.Repeat([]byte{'x'}, n), 0644); err != nil {
+			t.Fatal(err)
+		}
+	}
+
+	mkdir(root)
+	wide := filepath.Join(root, "wide")
+	mkdir(wide)
+	for i := 0; i < 1500; i++ {
+		write(filepath.Join(wide, fmt.Sprintf("%s%05d", strings.Repeat("f", 40), i)), i%7)
+	}
+	deep := root
+	for i := 0; i < 30; i++ {
+		deep = filepath.Join(deep, "d")
+		mkdir(deep)
+		write(filepath.Join(deep, "file"), 100*i)
+	}
+	for i := 0; i < 20; i++ {
+		sub := filepath.Join(root, fmt.Sprintf("sub%d", i))
+		mkdir(sub)
+		mkdir(filepath.Join(sub, "empty"))
+		for j := 0; j < 10; j++ {
+			write(filepath.Join(sub, fmt.Sprintf("f%d", j)), 5000*j)
+		}
+	}
+	if err := os.Link(filepath.Join(root, "sub3", "f9"), filepath.Join(root, "sub7", "link")); err != nil {
+		t.Fatal(err)
+	}
+	if err := os.Symlink("..", filepath.Join(root, "up")); err != nil {
+		t.Fatal(err)
+	}
+}
+
+// serial is what Walk should report for All: sizes in the order the
+// directories list their entries, each directory after what's in it.
+func serial(t *testing.T, path string, apparent bool, out *[]string) int64 {
+	info, err := os.Lstat(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	st := fileStat(info)
+	n := st.blocks * 512
+	if apparent {
+		n = st.size
+	}
+	if info.IsDir() {
+		f, err := os.Open(path)
+		if err != nil {
+			t.Fatal(err)
+		}
+		names, err := f.Readdirnames(-1)
+		f.Close()
+		if err != nil {
+			t.Fatal(err)
+		}
+		for _, name := range names {
+			n += serial(t, path+"/"+name, apparent, out)
+		}
+	}
+	*out = append(*out, fmt.Sprintf("%d %s", n, path))
+	return n
+}
+
+func TestWalk(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "du")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	root := filepath.Join(tmp, "tree")
+	makeTree(t, root)
+
+	var want []string
+	wantTotal := serial(t, root, true, &want)
+
+	for _, workers := range []int{1, 4, 16} {
+		var got []string
+		w := &Walker{
+			Apparent:   true,
+			CountLinks: true,
+			All:        true,
+			MaxDepth:   -1,
+			Workers:    workers,
+			Report: func(size int64, path string) {
+				got = append(got, fmt.Sprintf("%d %s", size, path))
+			},
+			Error: func(err error) { t.Error(err) },
+		}
+		total, err := w.Walk(root)
+		if err != nil || total != wantTotal {
+			t.Fatalf("%d workers: got %d, %v, want %d", workers, total, err, wantTotal)
+		}
+		if strings.Join(got, "\n") != strings.Join(want, "\n") {
+			t.Fatalf("%d workers: reports out of order", workers)
+		}
+
+		// Nothing's reported too deep down, but it's all counted.
+		got = nil
+		w.MaxDepth = 1
+		w.All = false
+		if total, _ := w.Walk(root); total != wantTotal || len(got) != 23 || got[22] != want[len(want)-1] {
+			t.Fatalf("%d workers: got %d for %q", workers, total, got)
+		}
+	}
+
+	// The hard link is counted once, unless links are.
+	w := &Walker{Apparent: true, MaxDepth: 0}
+	if total, err := w.Walk(root); err != nil || total != wantTotal-45000 {
+		t.Fatalf("got %d, %v, want %d", total, err, wantTotal-45000)
+	}
+
+	// So is everything, across calls, with HashAll.
+	w = &Walker{Apparent: true, MaxDepth: 0, HashAll: true}
+	w.Walk(root)
+	if total, err := w.Walk(filepath.Join(root, "sub3")); err != nil || total != 0 {
+		t.Fatalf("repeated: got %d, %v", total, err)
+	}
+}
+
+func TestRun(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "du")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	a := filepath.Join(tmp, "a")
+	if err := os.MkdirAll(filepath.Join(a, "b"), 0755); err != nil {
+		t.Fatal(err)
+	}
+	if err := ioutil.WriteFile(filepath.Join(a, "b", "f"), make([]byte, 3000), 0644); err != nil {
+		t.Fatal(err)
+	}
+	info, err := os.Stat(a)
+	if err != nil {
+		t.Fatal(err)
+	}
+	dir := info.Size() // the same for both directories, in practice
+
+	for _, tc := range []struct {
+		args []string
+		want string
+	}{
+		{[]string{"-b", a}, fmt.Sprintf("%d\t%s/b\n%d\t%s\n", dir+3000, a, 2*dir+3000, a)},
+		{[]string{"-bs", a}, fmt.Sprintf("%d\t%s\n", 2*dir+3000, a)},
+		{[]string{"--inodes", "-a", a}, fmt.Sprintf("1\t%s/b/f\n2\t%[1]s/b\n3\t%[1]s\n", a)},
+		{[]string{"--inodes", "-S0", a}, fmt.Sprintf("2\t%s/b\x001\t%[1]s\x00", a)},
+		{[]string{"--inodes", "-sc", a, a + "/b"}, fmt.Sprintf("3\t%s\n3\ttotal\n", a)},
+		{[]string{"--apparent-size", "-sBK", "-t", "3K", a}, fmt.Sprintf("%dK\t%s\n", (2*dir+3000+1023)/1024, a)},
+		{[]string{"-b", "-t", "-1", a}, ""},
+	} {
+		got, _, err := cmdtest.Run(run, "", tc.args...)
+		if err != nil || got != tc.want {
+			t.Errorf("%q: got %q, %v, want %q", tc.args, got, err, tc.want)
+		}
+	}
+
+	_, stderr, err := cmdtest.Run(run, "", "-s", filepath.Join(tmp, "nonexistent"), a)
+	if err != errNonFatal || !strings.HasPrefix(stderr, "du: cannot access '") {
+		t.Errorf("missing file: got %q, %v", stderr, err)
+	}
+	for _, args := range [][]string{{"-sa"}, {"-s", "-d1"}, {"-d", "x"}, {"-B0"}, {"-B1x"}, {"-t", "-0"}} {
+		if _, _, err := cmdtest.Run(run, "", append(args, a)...); err == nil {
+			t.Errorf("%q: no error", args)
+		}
+	}
+}
+
+func TestFormat(t *testing.T) {
+	for _, tc := range []struct {
+		spec string
+		n    int64
+		want string
+	}{
+		{"1", 12345, "12345"},
+		{"1K", 12345, "13"},
+		{"K", 12345, "13K"},
+		{"KB", 12345, "13kB"},
+		{"kiB", 12345, "13KiB"},
+		{"MB", 1, "1MB"},
+		{"3", 8192, "2731"},
+		{"'1", 5, "5"},
+		{"human-readable", 0, "0"},
+		{"human-readable", 1023, "1023"},
+		{"human-readable", 1024, "1.0K"},
+		{"human-readable", 1025, "1.1K"},
+		{"human-readable", 8192, "8.0K"},
+		{"human-readable", 10 << 10, "10K"},
+		{"human-readable", 10<<10 + 1, "11K"},
+		{"human-readable", 1024<<10 - 1, "1.0M"},
+		{"human-readable", 3031040, "2.9M"},
+		{"si", 8192, "8.2k"},
+		{"si", 999999, "1.0M"},
+	} {
+		f, err := parseBlockSize(tc.spec)
+		if err != nil {
+			t.Errorf("%q: %v", tc.spec, err)
+			continue
+		}
+		if got := string(f.append(nil, tc.n)); got != tc.want {
+			t.Errorf("%q, %d: got %q, want %q", tc.spec, tc.n, got, tc.want)
+		}
+	}
+	for spec, want := range map[string]error{
+		"x": errInvalid, "0": errInvalid, "1x": errSuffix, "1KX": errSuffix, "99999999999999999999": errRange, "9Y": errRange,
+	} {
+		if _, err := parseBlockSize(spec); err != want {
+			t.Errorf("%q: got %v, want %v", spec, err, want)
+		}
+	}
+}
+
+func BenchmarkWalk(b *testing.B) {
+	tmp, err := ioutil.TempDir("", "du")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	root := filepath.Join(tmp, "tree")
+	makeTree(b, root)
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		w := &Walker{All: true, MaxDepth: -1, Report: func(int64, string) {}}
+		if _, err := w.Walk(root); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
@@ -0,0 +1,167 @@
+package du
+
+import (
+	"errors"
+	"math"
+	"strconv"
+	"strings"
+)
+
+var (
+	errInvalid = errors.New("invalid")
+	errSuffix  = errors.New("invalid suffix")
+	errRange   = errors.New("too large")
+)
+
+// units are the prefixes of each power of 1000 or 1024.
+const units = "KMGTPEZY"
+
+// parseSize parses a size like GNU's xstrtoumax with the suffixes du
+// accepts: a number followed by an optional K, M, G, ... for a power of
+// 1024, or KB, MB, GB, ... for one of 1000 (and KiB, MiB, ... for 1024
+// again). Either the number or the suffix can be left out. unit is the
+// suffix if the number was.
+func parseSize(s string) (n int64, unit string, err error) {
+	i := 0
+	for i < len(s) && '0' <= s[i] && s[i] <= '9' {
+		i++
+	}
+	n = 1
+	if i > 0 {
+		if n, err = strconv.ParseInt(s[:i], 10, 64); err != nil {
+			return 0, "", errRange
+		}
+	}
+	suffix := s[i:]
+	if suffix == "" {
+		return n, "", nil
+	}
+	p := strings.IndexByte(units, suffix[0]&^0x20)
+	if p < 0 {
+		if i == 0 {
+			return 0, "", errInvalid
+		}
+		return 0, "", errSuffix
+	}
+	base := int64(1024)
+	switch suffix[1:] {
+	case "":
+	case "B":
+		base = 1000
+	case "iB":
+	default:
+		return 0, "", errSuffix
+	}
+	for ; p >= 0; p-- {
+		if n > math.MaxInt64/base {
+			return 0, "", errRange
+		}
+		n *= base
+	}
+	if i == 0 {
+		unit = suffix
+	}
+	return n, unit, nil
+}
+
+// format is how sizes are written out.
+type format struct {
+	block int64  // what a size is divided by
+	unit  string // written after a size, for -BM and so on
+	human int    // the base of the unit picked for each size, or zero
+}
+
+// parseBlockSize parses the argument to -B or one of the variables that
+// set the default.
+func parseBlockSize(s string) (format, error) {
+	switch s {
+	case "human-readable":
+		return format{block: 1, human: 1024}, nil
+	case "si":
+		return format{block: 1, human: 1000}, nil
+	}
+	// Thousands separators are never used in the C locale.
+	n, unit, err := parseSize(strings.TrimPrefix(s, "'"))
+	if err == nil && n == 0 {
+		err = errInvalid
+	}
+	if err != nil {
+		return format{}, err
+	}
+	f := format{block: n}
+	if unit != "" {
+		// As GNU writes them: "k" only for 1000.
+		f.unit = strings.ToUpper(unit[:1]) + unit[1:]
+		if unit[1:] == "B" && f.unit[0] == 'K' {
+			f.unit = "k" + unit[1:]
+		}
+	}
+	return f, nil
+}
+
+// append appends n, rounded up to the nearest unit.
+func (f format) append(b []byte, n int64) []byte {
+	if f.human != 0 {
+		return append(b, human(n, f.human)...)
+	}
+	q := n / f.block
+	if n%f.block != 0 {
+		q++
+	}
+	b = strconv.AppendInt(b, q, 10)
+	return append(b, f.unit...)
+}
+
+// human formats n with a unit that's a power of base, as GNU's
+// human_readable does for du -h: with one decimal below 10, and always
+// rounded up.
+func human(n int64, base int) string {
+	b := uint64(base)
+	amount := uint64(n)
+	// tenths is the first digit after the point, and rounding says whether
+	// anything's after that.
+	var tenths, rounding uint64
+	e := 0
+	for amount >= b && e < len(units) {
+		r10 := amount%b*10 + tenths
+		if r10%b != 0 {
+			rounding = 1
+		}
+		amount /= b
+		tenths = r10 / b
+		e++
+	}
+	point := false
+	if e > 0 && amount < 10 {
+		if rounding > 0 {
+			tenths++
+			rounding = 0
+			if tenths == 10 {
+				amount++
+				tenths = 0
+			}
+		}
+		if amount < 10 {
+			point = true
+		}
+	}
+	if !point && tenths+rounding > 0 {
+		amount++
+		if amount == b && e < len(units) {
+			e++
+			amount, tenths, point = 1, 0, true
+		}
+	}
+	s := strconv.FormatUint(amount, 10)
+	if point {
+		s += "." + strconv.FormatUint(tenths, 10)
+	}
+	if e > 0 {
+		if base == 1000 && e == 1 {
+			s += "k"
+		} else {
+			s += units[e-1 : e]
+		}
+	}
+	return s
+}
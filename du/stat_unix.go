@@ -0,0 +1,19 @@
+// +build !windows
+
+package du
+
+import (
+	"os"
+	"syscall"
+)
+
+func fileStat(info os.FileInfo) stat {
+	st := stat{size: info.Size(), nlink: 1, dir: info.IsDir()}
+	if s, ok := info.Sys().(*syscall.Stat_t); ok {
+		st.dev = uint64(s.Dev)
+		st.ino = uint64(s.Ino)
+		st.nlink = uint64(s.Nlink)
+		st.blocks = int64(s.Blocks)
+	}
+	return st
+}
@@ -0,0 +1,17 @@
+// +build windows
+
+package du
+
+import "os"
+
+// fileStat can't tell files apart without opening them, so nothing is
+// recognized as having been counted already, and the space used is the
+// size rounded up to whole blocks.
+func fileStat(info os.FileInfo) stat {
+	return stat{
+		size:   info.Size(),
+		nlink:  1,
+		blocks: (info.Size() + 511) / 512,
+		dir:    info.IsDir(),
+	}
+}
@@ -0,0 +1,326 @@
+package du
+
+import (
+	"runtime"
+	"sync"
+	"sync/atomic"
+
+	"github.com/ericlagergren/go-coreutils/internal/walk"
+)
+
+// walk adds up the directory tree rooted at path.
+//
+// Directories are read by a walk.Pool of workers, as rm removes them. How
+// entries are read and stat'ed is up to scan, which is written for each
+// platform.
+//
+// Nothing is kept for a directory once it's been finished: its total is
+// added to its parent's, which is finished in turn once its last
+// subdirectory is. So, apart from the set of hard links, memory grows with
+// the number of directories being read and waiting on their subdirectories,
+// not with the size of the tree.
+//
+// Reports have to come out in the order a serial walk would make them.
+// Whichever directory the next report is due from "streams": its reports go
+// to Report as soon as they're ready. Any other directory that finishes
+// keeps its reports, and those of its subdirectories, in a list that's
+// spliced into its parent's when that finishes in turn, and given to Report
+// once the walk gets to it. Nothing is kept for directories too deep to be
+// reported, which for -s is all of them.
+func (w *Walker) walk(path string, st *stat) int64 {
+	n := w.Workers
+	if n < 1 {
+		n = 4 * runtime.NumCPU()
+	}
+	e := &engine{
+		w:       w,
+		workers: make([]worker, n),
+		dev:     st.dev,
+	}
+	e.pool = walk.NewPool(n, func(i int, job interface{}) {
+		d := job.(*dir)
+		e.scan(&e.workers[i], d)
+		e.scanned(d)
+	})
+	for i := range e.workers {
+		e.workers[i].id = i
+	}
+
+	root := &dir{name: path, path: path, own: w.size(st), fd: -1, streaming: true}
+	e.push(&e.workers[0], root)
+	e.pool.Run()
+	return e.total
+}
+
+// dir is a directory being counted.
+type dir struct {
+	parent *dir
+	name   string // relative to parent, or the path given to Walk
+	path   string
+	depth  int
+	fd     int
+
+	// left counts what must finish before the directory's total is known:
+	// reading its entries, and each subdirectory found so far.
+	left int32
+	// opens counts what still needs fd, where directories are opened
+	// relative to their parent's: reading the entries, and opening each
+	// subdirectory found so far.
+	opens int32
+
+	own   int64 // the directory itself
+	files int64 // everything in it but subdirectories; only scan adds to it
+	sub   int64 // the totals of its subdirectories, added atomically
+
+	// build is what the directory will report, in order, as scan finds it.
+	// Only scan uses it until it's done, when it becomes parts.
+	build []part
+
+	// Guarded by engine.out.
+	parts     []part
+	next      int // the first of parts not reported yet, when streaming
+	line      line
+	done      bool
+	streaming bool
+	reports   lineList // once done, if not streaming
+}
+
+func (d *dir) join(name string) string {
+	if len(d.path) > 0 && d.path[len(d.path)-1] == '/' {
+		return d.path + name
+	}
+	return d.path + "/" + name
+}
+
+// part is a run of file reports from a directory, or a subdirectory whose
+// reports come next.
+type part struct {
+	lines []line
+	child *dir
+}
+
+type line struct {
+	size int64
+	path string
+}
+
+type chunk struct {
+	lines []line
+	next  *chunk
+}
+
+// lineList is a list of reports that can be joined to another in constant
+// time, however many it holds.
+type lineList struct {
+	head, tail *chunk
+}
+
+func (l *lineList) add(lines []line) {
+	c := &chunk{lines: lines}
+	if l.tail == nil {
+		l.head = c
+	} else {
+		l.tail.next = c
+	}
+	l.tail = c
+}
+
+func (l *lineList) join(m *lineList) {
+	if m.head == nil {
+		return
+	}
+	if l.tail == nil {
+		l.head = m.head
+	} else {
+		l.tail.next = m.head
+	}
+	l.tail = m.tail
+	*m = lineList{}
+}
+
+type worker struct {
+	id    int
+	buf   []byte
+	found []*dir
+}
+
+type engine struct {
+	w       *Walker
+	pool    *walk.Pool
+	workers []worker
+	dev     uint64 // the filesystem of the path given to Walk
+	total   int64
+
+	out sync.Mutex // serializes reports and errors
+}
+
+func (e *engine) fail(err error) {
+	if e.w.Error == nil {
+		return
+	}
+	e.out.Lock()
+	e.w.Error(err)
+	e.out.Unlock()
+}
+
+// add counts an entry of d's, and returns it if it's a directory that needs
+// reading.
+func (e *engine) add(d *dir, name string, st *stat) *dir {
+	w := e.w
+	var path string
+	if w.Exclude != nil {
+		path = d.join(name)
+		if w.Exclude(path) {
+			return nil
+		}
+	}
+	if w.OneFileSystem && st.dev != e.dev || w.skip(st) {
+		return nil
+	}
+	n := w.size(st)
+
+	if st.dir {
+		if path == "" {
+			path = d.join(name)
+		}
+		c := &dir{parent: d, name: name, path: path, depth: d.depth + 1, own: n, fd: -1}
+		if w.lines(c.depth) {
+			d.build = append(d.build, part{child: c})
+		}
+		return c
+	}
+
+	d.files += n
+	if w.All && w.lines(d.depth+1) {
+		if path == "" {
+			path = d.join(name)
+		}
+		l := line{n, path}
+		if k := len(d.build) - 1; k >= 0 && d.build[k].child == nil {
+			d.build[k].lines = append(d.build[k].lines, l)
+		} else {
+			d.build = append(d.build, part{lines: []line{l}})
+		}
+	}
+	return nil
+}
+
+func (e *engine) push(w *worker, d *dir) {
+	atomic.AddInt32(&d.left, 1) // reading its entries
+	if d.parent != nil {
+		atomic.AddInt32(&d.parent.left, 1)
+	}
+	e.pool.Push(w.id, d)
+}
+
+// pushFound queues the subdirectories of d's that scan has found since it
+// last did. They're queued last first, so that the first is read first, as
+// it would be by a serial walk. Which of a file's hard links is counted
+// depends on which is found first and, with one worker, this makes it the
+// same one as GNU du's.
+func (e *engine) pushFound(w *worker, d *dir) {
+	atomic.AddInt32(&d.opens, int32(len(w.found)))
+	for i := len(w.found) - 1; i >= 0; i-- {
+		e.push(w, w.found[i])
+		w.found[i] = nil
+	}
+	w.found = w.found[:0]
+}
+
+// scanned is called once all of d's entries have been read.
+func (e *engine) scanned(d *dir) {
+	if e.w.lines(d.depth) {
+		e.out.Lock()
+		d.parts, d.build = d.build, nil
+		if d.streaming {
+			e.advance(d)
+		}
+		e.out.Unlock()
+	}
+	e.finish(d)
+}
+
+// finish marks one of the things d was waiting for as done and, if it was
+// the last, adds d's total to its parent's, which may in turn finish it.
+func (e *engine) finish(d *dir) {
+	for d != nil && atomic.AddInt32(&d.left, -1) == 0 {
+		size := d.own + d.files
+		total := size + atomic.LoadInt64(&d.sub)
+		if !e.w.SeparateDirs {
+			size = total
+		}
+		if d.parent != nil {
+			atomic.AddInt64(&d.parent.sub, total)
+		} else {
+			e.total = total
+		}
+		if e.w.lines(d.depth) {
+			e.done(d, size)
+		}
+		d = d.parent
+	}
+}
+
+// done reports d, which has just finished, or keeps its reports for later.
+func (e *engine) done(d *dir, size int64) {
+	e.out.Lock()
+	defer e.out.Unlock()
+	d.line = line{size, d.path}
+	d.done = true
+	if d.streaming {
+		e.advance(d)
+		return
+	}
+	for _, p := range d.parts {
+		if p.child != nil {
+			d.reports.join(&p.child.reports)
+		} else {
+			d.reports.add(p.lines)
+		}
+	}
+	d.reports.add([]line{d.line})
+	d.parts = nil
+}
+
+// advance reports as much as it can, starting from d, which is streaming.
+// Each directory's reports are made as its parts become ready; once
+// they're all made, and the directory itself is done, its parent streams
+// again. The caller holds e.out.
+func (e *engine) advance(d *dir) {
+	for d != nil {
+		if d.next < len(d.parts) {
+			p := &d.parts[d.next]
+			switch c := p.child; {
+			case c == nil:
+				e.report(p.lines)
+			case c.done:
+				for k := c.reports.head; k != nil; k = k.next {
+					e.report(k.lines)
+				}
+				c.reports = lineList{}
+			default:
+				c.streaming = true
+				d = c
+				continue
+			}
+			*p = part{}
+			d.next++
+			continue
+		}
+		if !d.done {
+			return
+		}
+		e.w.report(d.line.size, d.line.path)
+		d.parts = nil
+		if d = d.parent; d != nil {
+			d.parts[d.next] = part{}
+			d.next++
+		}
+	}
+}
+
+func (e *engine) report(lines []line) {
+	for _, l := range lines {
+		e.w.report(l.size, l.path)
+	}
+}
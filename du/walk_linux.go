@@ -0,0 +1,83 @@
+package du
+
+import (
+	"os"
+	"sync/atomic"
+
+	"github.com/ericlagergren/go-coreutils/internal/walk"
+	"golang.org/x/sys/unix"
+)
+
+func (d *dir) dirfd() int {
+	if d.parent == nil {
+		return unix.AT_FDCWD
+	}
+	return d.parent.fd
+}
+
+// scan opens d relative to its parent's descriptor, reads its entries with
+// getdents(2) and stats each relative to its own with fstatat(2). Paths are
+// never resolved from the root, which on a network filesystem saves a
+// lookup for every component of every path.
+//
+// A directory's descriptor is closed as soon as every subdirectory found in
+// it has been opened, rather than when they've been read, so descriptors
+// are held by directories with subdirectories still queued, not by every
+// directory on the way down.
+func (e *engine) scan(w *worker, d *dir) {
+	follow := e.w.Deref == DerefAll || e.w.Deref == DerefArgs && d.parent == nil
+	flags := unix.O_RDONLY | unix.O_DIRECTORY | unix.O_CLOEXEC
+	if !follow {
+		flags |= unix.O_NOFOLLOW
+	}
+	fd, err := unix.Openat(d.dirfd(), d.name, flags, 0)
+	if d.parent != nil {
+		e.release(d.parent)
+	}
+	if err != nil {
+		e.fail(&os.PathError{Op: "open", Path: d.path, Err: err})
+		return
+	}
+	d.fd = fd
+	atomic.AddInt32(&d.opens, 1)
+
+	if w.buf == nil {
+		w.buf = make([]byte, walk.BufSize)
+	}
+	statFlags := unix.AT_SYMLINK_NOFOLLOW
+	if e.w.Deref == DerefAll {
+		statFlags = 0
+	}
+	err = walk.ReadDir(fd, w.buf, func(name []byte, _ uint8) bool {
+		s := string(name)
+		var st unix.Stat_t
+		if err := unix.Fstatat(d.fd, s, &st, statFlags); err != nil {
+			e.fail(&os.PathError{Op: "stat", Path: d.join(s), Err: err})
+			return true
+		}
+		if c := e.add(d, s, &stat{
+			dev:    uint64(st.Dev),
+			ino:    uint64(st.Ino),
+			nlink:  uint64(st.Nlink),
+			size:   int64(st.Size),
+			blocks: int64(st.Blocks),
+			dir:    st.Mode&unix.S_IFMT == unix.S_IFDIR,
+		}); c != nil {
+			w.found = append(w.found, c)
+		}
+		return true
+	})
+	if err != nil {
+		e.fail(&os.PathError{Op: "readdirent", Path: d.path, Err: err})
+	}
+	e.pushFound(w, d)
+	e.release(d)
+}
+
+// release marks one of the things that need d's descriptor as done, and
+// closes it if that was the last.
+func (e *engine) release(d *dir) {
+	if atomic.AddInt32(&d.opens, -1) == 0 {
+		unix.Close(d.fd)
+	}
+}
@@ -0,0 +1,48 @@
+// +build !linux
+
+package du
+
+import (
+	"io"
+	"os"
+)
+
+// readdirBatch is how many entries scan reads at a time.
+const readdirBatch = 1024
+
+// scan reads d's entries and stats each by its path.
+func (e *engine) scan(w *worker, d *dir) {
+	f, err := os.Open(d.path)
+	if err != nil {
+		e.fail(err)
+		return
+	}
+	defer f.Close()
+
+	lookup := os.Lstat
+	if e.w.Deref == DerefAll {
+		lookup = os.Stat
+	}
+	for {
+		names, err := f.Readdirnames(readdirBatch)
+		for _, name := range names {
+			info, err := lookup(d.join(name))
+			if err != nil {
+				e.fail(err)
+				continue
+			}
+			st := fileStat(info)
+			if c := e.add(d, name, &st); c != nil {
+				w.found = append(w.found, c)
+			}
+		}
+		e.pushFound(w, d)
+		if err == io.EOF {
+			return
+		}
+		if err != nil {
+			e.fail(err)
+			return
+		}
+	}
+}
@@ -16,18 +16,22 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package env
 
 import (
+	"errors"
 	"fmt"
-	"log"
 	"os"
 	"os/exec"
 	"strings"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
 )
 
+func init() {
+	coreutils.Register("env", run)
+}
+
 const (
 	help = `
 	Usage: env [OPTION]... [-] [NAME=VALUE]... [COMMAND [ARG]...]
@@ -54,21 +58,9 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	unset   string
-	set     string
-	nullEol bool
-	ignore  bool
-
-	// fatal = log.New(os.Stderr, "", log.Lshortfile)
-	fatal = log.New(os.Stderr, "", 0)
-
-	env = os.Environ()
-)
-
 // Run a command, waiting for it to finish. Will first run CMD's path;
 // failing that, will lookup the path and attempt to do the same.
-func execvp(cmd exec.Cmd) error {
+func execvp(cmd *exec.Cmd) error {
 	if err := cmd.Start(); err == nil {
 
 		// Wait for command to finish
@@ -92,76 +84,116 @@ func execvp(cmd exec.Cmd) error {
 	return cmd.Wait()
 }
 
-func parseFlags(argv []string) (args []string) {
-	for i := 1; i < len(argv); i++ {
+type options struct {
+	unset   []string
+	nullEol bool
+	ignore  bool
+}
+
+// parseFlags parses the options up to the first NAME=VALUE or COMMAND,
+// which, with everything after, is returned.
+func parseFlags(ctx coreutils.Context, argv []string) (opts options, args []string, err error) {
+	for i := 0; i < len(argv); i++ {
 		switch v := argv[i]; v {
-		case "-i", "--ignore-environment":
-			ignore = true
+		case "-i", "--ignore-environment", "-":
+			opts.ignore = true
 		case "-0", "--null":
-			nullEol = true
+			opts.nullEol = true
 		case "-u", "--unset":
 			i++
-			unset = argv[i]
-		case "-s", "--set":
-			i++
-			set = argv[i]
+			if i == len(argv) {
+				return opts, nil, fmt.Errorf("option requires an argument -- '%s'", v)
+			}
+			opts.unset = append(opts.unset, argv[i])
 		case "--help":
-			fmt.Fprintf(os.Stderr, "%s", help)
-			os.Exit(1)
+			fmt.Fprintf(ctx.Stdout, "%s", help)
+			return opts, nil, errHelp
 		case "--version":
-			fmt.Printf("%s", version)
-			os.Exit(0)
+			fmt.Fprintf(ctx.Stdout, "%s", version)
+			return opts, nil, errHelp
 		default:
-			args = append(args, v)
+			if strings.HasPrefix(v, "--unset=") {
+				opts.unset = append(opts.unset, v[len("--unset="):])
+				continue
+			}
+			return opts, argv[i:], nil
 		}
 	}
-	return args
+	return opts, nil, nil
 }
 
-func main() {
-	args := parseFlags(os.Args)
+// errHelp stops env after it's printed its help or version.
+var errHelp = errors.New("help requested")
 
-	if unset != "" {
-		os.Unsetenv(unset)
-	}
+func run(ctx coreutils.Context, argv ...string) (err error) {
+	defer func() {
+		if err != nil && err != errHelp {
+			if _, ok := err.(coreutils.ExitCode); !ok {
+				fmt.Fprintf(ctx.Stderr, "env: %v\n", err)
+			}
+		}
+		if err == errHelp {
+			err = nil
+		}
+	}()
 
-	cmd := exec.Cmd{Env: env}
+	opts, args, err := parseFlags(ctx, argv)
+	if err != nil {
+		return err
+	}
 
-	// Check for "-" as an argument, because it means the same as "-i"
-	if flag.Arg(0) == "-" {
-		cmd.Env = []string{}
+	var env []string
+	if !opts.ignore {
+		env = os.Environ()
+	}
+	for _, name := range opts.unset {
+		for i := 0; i < len(env); i++ {
+			if strings.HasPrefix(env[i], name+"=") {
+				env = append(env[:i], env[i+1:]...)
+				i--
+			}
+		}
 	}
 
 	for i, arg := range args {
 		if strings.Index(arg, "=") > 0 {
-			cmd.Env = append(cmd.Env, arg)
-		} else if arg != "-" {
-			if nullEol {
-				fatal.Fatalln("cannot specify --null (-0) with command")
-			}
-
-			cmd.Path = arg
-
-			cmd.Args = append(cmd.Args, args[i:]...)
-			cmd.Stdin = os.Stdin
-			cmd.Stdout = os.Stdout
-			cmd.Stderr = os.Stderr
+			env = append(env, arg)
+			continue
+		}
+		if opts.nullEol {
+			return errors.New("cannot specify --null (-0) with command")
+		}
 
-			if err := execvp(cmd); err != nil {
-				fatal.Fatalln(err)
+		cmd := &exec.Cmd{
+			Path:   arg,
+			Args:   args[i:],
+			Env:    env,
+			Dir:    ctx.Dir,
+			Stdin:  ctx.Stdin,
+			Stdout: ctx.Stdout,
+			Stderr: ctx.Stderr,
+		}
+		if cmd.Env == nil {
+			cmd.Env = []string{}
+		}
+		err := execvp(cmd)
+		if e, ok := err.(*exec.ExitError); ok {
+			if code := e.ExitCode(); code > 0 {
+				return coreutils.ExitCode(code)
 			}
-			return
 		}
+		return err
 	}
 
-	eol := '\n'
-	if nullEol {
-		eol = '\x00'
+	eol := "\n"
+	if opts.nullEol {
+		eol = "\x00"
 	}
-
+	var out []byte
 	for _, e := range env {
-		fmt.Printf("%s%c", e, eol)
+		out = append(out, e...)
+		out = append(out, eol...)
 	}
-
-	return
+	_, err = ctx.Stdout.Write(out)
+	return err
 }
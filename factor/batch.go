@@ -0,0 +1,293 @@
+package factor
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"math/big"
+	"runtime"
+	"strconv"
+)
+
+// Factorer writes the prime factors of numbers read as text, one line for
+// each, as in "12: 2 2 3".
+type Factorer struct {
+	// Workers is how many numbers are factored at once. Zero means one for
+	// each CPU.
+	Workers int
+	// Error, if not nil, is called with each number that can't be parsed,
+	// in order with the lines written for the others. Otherwise they're
+	// skipped.
+	Error func(error)
+}
+
+// SyntaxError is a number that isn't a valid positive integer.
+type SyntaxError struct {
+	Num string
+}
+
+func (e *SyntaxError) Error() string {
+	return quote(e.Num) + " is not a valid positive integer"
+}
+
+// chunkSize is how much input is read for each batch of numbers a worker
+// factors.
+const chunkSize = 16 * 1024
+
+// batch is a chunk of input and the lines written for it.
+type batch struct {
+	in   []byte
+	out  []byte
+	errs []badNum
+	err  error // from reading, after in
+	done chan struct{}
+}
+
+// badNum is a number that couldn't be parsed, which goes before out[off:].
+type badNum struct {
+	off int
+	err error
+}
+
+// Factor writes the factors of each of the numbers in r, which are
+// separated by spaces, tabs or newlines, to w, in order.
+//
+// Numbers are read in chunks, which are handed out to the workers as
+// they're read, and written as they're finished, in the same order, with
+// as many in flight at once as there are workers, and as many more.
+func (f *Factorer) Factor(w io.Writer, r io.Reader) error {
+	n := f.Workers
+	if n < 1 {
+		n = runtime.NumCPU()
+	}
+	c := &chunker{r: r}
+	if n == 1 {
+		b := &batch{in: make([]byte, 0, chunkSize)}
+		for {
+			done := c.next(b)
+			b.factor()
+			if err := f.write(w, b); err != nil || done {
+				return err
+			}
+		}
+	}
+
+	free := make(chan *batch, 2*n)
+	full := make(chan *batch, 2*n)
+	jobs := make(chan *batch, 2*n)
+	stop := make(chan struct{})
+	for i := 0; i < 2*n; i++ {
+		free <- &batch{in: make([]byte, 0, chunkSize), done: make(chan struct{}, 1)}
+	}
+	for i := 0; i < n; i++ {
+		go func() {
+			for b := range jobs {
+				b.factor()
+				b.done <- struct{}{}
+			}
+		}()
+	}
+	go func() {
+		defer close(full)
+		defer close(jobs)
+		for {
+			var b *batch
+			select {
+			case b = <-free:
+			case <-stop:
+				return
+			}
+			done := c.next(b)
+			jobs <- b
+			full <- b
+			if done {
+				return
+			}
+		}
+	}()
+
+	for b := range full {
+		<-b.done
+		if err := f.write(w, b); err != nil {
+			close(stop)
+			for b := range full {
+				<-b.done
+			}
+			return err
+		}
+		free <- b
+	}
+	return nil
+}
+
+// write writes the lines for b and reports the numbers in it that weren't.
+func (f *Factorer) write(w io.Writer, b *batch) error {
+	off := 0
+	for _, e := range b.errs {
+		if f.Error == nil {
+			continue
+		}
+		if _, err := w.Write(b.out[off:e.off]); err != nil {
+			return err
+		}
+		off = e.off
+		f.Error(e.err)
+	}
+	if _, err := w.Write(b.out[off:]); err != nil {
+		return err
+	}
+	return b.err
+}
+
+// chunker reads input in chunks that end between numbers.
+type chunker struct {
+	r    io.Reader
+	rest []byte // the start of a number the last chunk cut off
+	err  error
+}
+
+// next reads the next chunk into b.in, and reports whether it's the last.
+func (c *chunker) next(b *batch) bool {
+	b.in = append(b.in[:0], c.rest...)
+	c.rest = c.rest[:0]
+	for c.err == nil && (len(b.in) < cap(b.in)/2 || lastSep(b.in) < 0) {
+		if len(b.in) == cap(b.in) {
+			// A very long number; make room for the rest of it.
+			b.in = append(b.in, 0)[:len(b.in)]
+		}
+		n, err := c.r.Read(b.in[len(b.in):cap(b.in)])
+		b.in = b.in[:len(b.in)+n]
+		c.err = err
+	}
+	if c.err == nil {
+		i := lastSep(b.in) + 1
+		c.rest = append(c.rest, b.in[i:]...)
+		b.in = b.in[:i]
+		return false
+	}
+	if c.err != io.EOF {
+		b.err = c.err
+	}
+	return true
+}
+
+func isSep(c byte) bool {
+	return c == ' ' || c == '\t' || c == '\n'
+}
+
+func lastSep(p []byte) int {
+	for i := len(p) - 1; i >= 0; i-- {
+		if isSep(p[i]) {
+			return i
+		}
+	}
+	return -1
+}
+
+// factor factors each number in b.in.
+func (b *batch) factor() {
+	b.out, b.errs = b.out[:0], b.errs[:0]
+	var fs []uint64
+	in := b.in
+	for len(in) > 0 {
+		i := 0
+		for i < len(in) && isSep(in[i]) {
+			i++
+		}
+		in = in[i:]
+		if len(in) == 0 {
+			break
+		}
+		i = 0
+		for i < len(in) && !isSep(in[i]) {
+			i++
+		}
+		var ok bool
+		if b.out, fs, ok = appendLine(b.out, fs, in[:i]); !ok {
+			b.errs = append(b.errs, badNum{len(b.out), &SyntaxError{string(in[:i])}})
+		}
+		in = in[i:]
+	}
+}
+
+// AppendLine appends the line for num to dst, or reports that it isn't a
+// number. Leading spaces and a plus sign are ignored.
+func AppendLine(dst []byte, num string) ([]byte, bool) {
+	dst, _, ok := appendLine(dst, nil, []byte(num))
+	return dst, ok
+}
+
+// appendLine is AppendLine, with a buffer for the factors.
+func appendLine(dst []byte, fs []uint64, num []byte) ([]byte, []uint64, bool) {
+	num = bytes.TrimLeft(num, " ")
+	if len(num) > 0 && num[0] == '+' {
+		num = num[1:]
+	}
+	if len(num) == 0 {
+		return dst, fs, false
+	}
+	for _, c := range num {
+		if c < '0' || c > '9' {
+			return dst, fs, false
+		}
+	}
+	for len(num) > 1 && num[0] == '0' {
+		num = num[1:]
+	}
+
+	if len(num) <= 20 {
+		if n, err := strconv.ParseUint(string(num), 10, 64); err == nil {
+			dst = strconv.AppendUint(dst, n, 10)
+			dst = append(dst, ':')
+			fs = appendFactors(fs[:0], n)
+			for _, p := range fs {
+				dst = append(dst, ' ')
+				dst = strconv.AppendUint(dst, p, 10)
+			}
+			return append(dst, '\n'), fs, true
+		}
+	}
+	n, _ := new(big.Int).SetString(string(num), 10)
+	dst = append(dst, num...)
+	dst = append(dst, ':')
+	for _, p := range FactorBig(n) {
+		dst = append(dst, ' ')
+		dst = p.Append(dst, 10)
+	}
+	return append(dst, '\n'), fs, true
+}
+
+// quote quotes s as GNU coreutils does in messages: in single quotes,
+// with anything unprintable escaped as in C.
+func quote(s string) string {
+	var b bytes.Buffer
+	b.WriteByte('\'')
+	for i := 0; i < len(s); i++ {
+		switch c := s[i]; c {
+		case '\a':
+			b.WriteString(`\a`)
+		case '\b':
+			b.WriteString(`\b`)
+		case '\f':
+			b.WriteString(`\f`)
+		case '\n':
+			b.WriteString(`\n`)
+		case '\r':
+			b.WriteString(`\r`)
+		case '\t':
+			b.WriteString(`\t`)
+		case '\v':
+			b.WriteString(`\v`)
+		case '\'':
+			b.WriteString(`'\''`)
+		default:
+			if c < ' ' || c >= 0x7f {
+				fmt.Fprintf(&b, `\%03o`, c)
+			} else {
+				b.WriteByte(c)
+			}
+		}
+	}
+	b.WriteByte('\'')
+	return b.String()
+}
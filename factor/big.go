@@ -0,0 +1,117 @@
+package factor
+
+import (
+	"math/big"
+	"sort"
+)
+
+// FactorBig returns the prime factors of n, smallest first. Numbers that
+// fit in 64 bits are factored by Factor; larger ones by trial division
+// and then Pollard's rho with math/big, which is much slower, down to
+// cofactors that fit.
+func FactorBig(n *big.Int) []*big.Int {
+	if n.Sign() <= 0 {
+		return nil
+	}
+	if n.IsUint64() {
+		return toBig(nil, Factor(n.Uint64()))
+	}
+
+	n = new(big.Int).Set(n)
+	var small []uint64
+	if k := n.TrailingZeroBits(); k > 0 {
+		for i := uint(0); i < k; i++ {
+			small = append(small, 2)
+		}
+		n.Rsh(n, k)
+	}
+	var q, r, p big.Int
+	for i := range primes {
+		p.SetUint64(primes[i].p)
+		for !n.IsUint64() {
+			if q.QuoRem(n, &p, &r); r.Sign() != 0 {
+				break
+			}
+			small = append(small, primes[i].p)
+			n.Set(&q)
+		}
+	}
+
+	f := factorBig(nil, n)
+	sort.Slice(f, func(i, j int) bool { return f[i].Cmp(f[j]) < 0 })
+	s := toBig(nil, small)
+	out := make([]*big.Int, 0, len(s)+len(f))
+	for len(s) > 0 && len(f) > 0 {
+		if s[0].Cmp(f[0]) <= 0 {
+			out, s = append(out, s[0]), s[1:]
+		} else {
+			out, f = append(out, f[0]), f[1:]
+		}
+	}
+	return append(append(out, s...), f...)
+}
+
+func toBig(dst []*big.Int, f []uint64) []*big.Int {
+	for _, p := range f {
+		dst = append(dst, new(big.Int).SetUint64(p))
+	}
+	return dst
+}
+
+// factorBig appends the prime factors of n, which is odd, to dst, in no
+// particular order.
+func factorBig(dst []*big.Int, n *big.Int) []*big.Int {
+	switch {
+	case n.IsUint64():
+		return toBig(dst, Factor(n.Uint64()))
+	case n.ProbablyPrime(20):
+		return append(dst, n)
+	}
+	d := rhoBig(n)
+	dst = factorBig(dst, d)
+	return factorBig(dst, new(big.Int).Quo(n, d))
+}
+
+// rhoBig is rho with math/big.
+func rhoBig(n *big.Int) *big.Int {
+	var (
+		one = big.NewInt(1)
+		x   = new(big.Int)
+		ys  = new(big.Int)
+		t   = new(big.Int)
+		g   = new(big.Int)
+	)
+	f := func(y, c *big.Int) {
+		y.Mul(y, y).Add(y, c).Mod(y, n)
+	}
+	diff := func(a, b *big.Int) *big.Int {
+		return t.Sub(a, b).Abs(t)
+	}
+	for c := big.NewInt(1); ; c.Add(c, one) {
+		y, q := big.NewInt(2), big.NewInt(1)
+		g.SetInt64(1)
+		for r := 1; g.Cmp(one) == 0; r *= 2 {
+			x.Set(y)
+			for i := 0; i < r; i++ {
+				f(y, c)
+			}
+			for k := 0; k < r && g.Cmp(one) == 0; k += rhoBatch {
+				ys.Set(y)
+				for i := 0; i < rhoBatch && i < r-k; i++ {
+					f(y, c)
+					q.Mul(q, diff(x, y)).Mod(q, n)
+				}
+				g.GCD(nil, nil, q, n)
+			}
+		}
+		if g.Cmp(n) == 0 {
+			for g.SetInt64(1); g.Cmp(one) == 0; {
+				f(ys, c)
+				g.GCD(nil, nil, diff(x, ys), n)
+			}
+		}
+		if g.Cmp(n) != 0 {
+			return g
+		}
+	}
+}
@@ -0,0 +1,92 @@
+package factor
+
+import (
+	"bufio"
+	"errors"
+	"fmt"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("factor", run)
+}
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f       flag.FlagSet
+	version bool
+}
+
+var errNonFatal = errors.New("at least one non-fatal error occurred")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "factor (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errNonFatal {
+			fmt.Fprintf(ctx.Stderr, "factor: %v\n", err)
+		}
+	}()
+
+	bad := false
+	report := func(err error) {
+		fmt.Fprintf(ctx.Stderr, "factor: %v\n", err)
+		bad = true
+	}
+
+	if nums := c.f.Args(); len(nums) > 0 {
+		w := bufio.NewWriter(ctx.Stdout)
+		var line []byte
+		for _, num := range nums {
+			var ok bool
+			if line, ok = AppendLine(line[:0], num); !ok {
+				if err := w.Flush(); err != nil {
+					return writeError(err)
+				}
+				report(&SyntaxError{num})
+				continue
+			}
+			w.Write(line)
+		}
+		if err := w.Flush(); err != nil {
+			return writeError(err)
+		}
+	} else {
+		f := &Factorer{Error: report}
+		if err := f.Factor(ctx.Stdout, ctx.Stdin); err != nil {
+			return writeError(err)
+		}
+	}
+	if bad {
+		return errNonFatal
+	}
+	return nil
+}
+
+func writeError(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		switch pe.Op {
+		case "write":
+			return fmt.Errorf("write error: %v", pe.Err)
+		case "read":
+			return fmt.Errorf("-: %v", pe.Err)
+		}
+	}
+	return err
+}
@@ -1,3 +1,284 @@
-package main
+// Package factor finds the prime factors of numbers.
+//
+// Numbers that fit in 64 bits are factored without allocating: small
+// factors are found by trial division by a table of primes, using each
+// prime's inverse modulo 2⁶⁴ so that each division is a multiplication
+// and a comparison; what's left is tested with a deterministic
+// Miller-Rabin test and split with Brent's variant of Pollard's rho, both
+// in Montgomery form with math/bits. Larger numbers fall back to
+// math/big; see FactorBig.
+package factor
 
-func main() {}
+import (
+	"math"
+	"math/bits"
+)
+
+// Factor returns the prime factors of n, smallest first, each as many
+// times as it divides n. 0 and 1 have none.
+func Factor(n uint64) []uint64 {
+	return appendFactors(nil, n)
+}
+
+// appendFactors appends the prime factors of n to dst, smallest first.
+func appendFactors(dst []uint64, n uint64) []uint64 {
+	if n < 2 {
+		return dst
+	}
+	start := len(dst)
+	k := bits.TrailingZeros64(n)
+	for i := 0; i < k; i++ {
+		dst = append(dst, 2)
+	}
+	n >>= uint(k)
+	dst, n = trialDivide(dst, n)
+	if n > 1 {
+		dst = factorOdd(dst, n)
+		sortFrom(dst, start)
+	}
+	return dst
+}
+
+// maxTrial bounds the primes trial division is done with.
+const maxTrial = 1 << 12
+
+// primes are the odd primes below maxTrial, each with what's needed to
+// test whether it divides a number with a multiplication.
+var primes []prime
+
+type prime struct {
+	p   uint64
+	inv uint64 // p⁻¹ mod 2⁶⁴
+	lim uint64 // the largest multiple of p, divided by p
+}
+
+func init() {
+	composite := make([]bool, maxTrial)
+	for p := 3; p < maxTrial; p += 2 {
+		if composite[p] {
+			continue
+		}
+		for q := p * p; q < maxTrial; q += 2 * p {
+			composite[q] = true
+		}
+		primes = append(primes, prime{
+			p:   uint64(p),
+			inv: inverse(uint64(p)),
+			lim: math.MaxUint64 / uint64(p),
+		})
+	}
+}
+
+// inverse returns n⁻¹ mod 2⁶⁴, for odd n, by Newton's method: each step
+// doubles the number of correct bits, and n is its own inverse modulo 8.
+func inverse(n uint64) uint64 {
+	x := n
+	for i := 0; i < 5; i++ {
+		x *= 2 - n*x
+	}
+	return x
+}
+
+// trialDivide appends the factors of n, which is odd, below maxTrial to
+// dst and returns what's left. p divides n exactly when n·p⁻¹ mod 2⁶⁴,
+// which is then n/p, is at most MaxUint64/p.
+func trialDivide(dst []uint64, n uint64) ([]uint64, uint64) {
+	for i := range primes {
+		p := &primes[i]
+		if p.p*p.p > n {
+			if n > 1 {
+				dst = append(dst, n)
+			}
+			return dst, 1
+		}
+		for q := n * p.inv; q <= p.lim; q = n * p.inv {
+			dst = append(dst, p.p)
+			n = q
+		}
+	}
+	return dst, n
+}
+
+// factorOdd appends the prime factors of n, which is odd and has none
+// below maxTrial, to dst, in no particular order.
+func factorOdd(dst []uint64, n uint64) []uint64 {
+	for n > 1 {
+		if n < maxTrial*maxTrial {
+			return append(dst, n)
+		}
+		m := newMonty(n)
+		if m.isPrime() {
+			return append(dst, n)
+		}
+		d := m.rho()
+		// Take out all of d, which is either prime or is factored on
+		// its own, before going on with the rest.
+		k := 0
+		for n%d == 0 {
+			n /= d
+			k++
+		}
+		if m := newMonty(d); d < maxTrial*maxTrial || m.isPrime() {
+			for ; k > 0; k-- {
+				dst = append(dst, d)
+			}
+			continue
+		}
+		start := len(dst)
+		dst = factorOdd(dst, d)
+		sub := dst[start:]
+		for ; k > 1; k-- {
+			dst = append(dst, sub...)
+			sub = dst[start : start+len(sub)]
+		}
+	}
+	return dst
+}
+
+// sortFrom sorts dst[start:], which is short.
+func sortFrom(dst []uint64, start int) {
+	for i := start + 1; i < len(dst); i++ {
+		for j := i; j > start && dst[j] < dst[j-1]; j-- {
+			dst[j], dst[j-1] = dst[j-1], dst[j]
+		}
+	}
+}
+
+// monty does arithmetic modulo an odd n in Montgomery form, where x is
+// kept as xR mod n with R = 2⁶⁴, so that a product can be reduced with
+// multiplications instead of a division.
+type monty struct {
+	n    uint64
+	ninv uint64 // n⁻¹ mod 2⁶⁴
+	one  uint64 // R mod n
+}
+
+func newMonty(n uint64) *monty {
+	return &monty{n: n, ninv: inverse(n), one: -n % n}
+}
+
+// mul returns abR⁻¹ mod n. With ab = hi·R + lo and q = lo·n⁻¹ mod R, qn
+// has the same low word as ab, so (ab - qn)/R is hi less the high word of
+// qn, which is within n of abR⁻¹.
+func (m *monty) mul(a, b uint64) uint64 {
+	hi, lo := bits.Mul64(a, b)
+	qhi, _ := bits.Mul64(lo*m.ninv, m.n)
+	r, b := bits.Sub64(hi, qhi, 0)
+	return r + m.n&-b
+}
+
+// add returns a+b mod n. It computes a - (n - b), which doesn't overflow.
+func (m *monty) add(a, b uint64) uint64 {
+	return m.sub(a, m.n-b)
+}
+
+func (m *monty) sub(a, b uint64) uint64 {
+	d, borrow := bits.Sub64(a, b, 0)
+	return d + m.n&-borrow
+}
+
+// to returns x, which is less than n, in Montgomery form.
+func (m *monty) to(x uint64) uint64 {
+	_, r := bits.Div64(x, 0, m.n)
+	return r
+}
+
+// pow returns a to the e, with a in Montgomery form.
+func (m *monty) pow(a, e uint64) uint64 {
+	r := m.one
+	for ; e > 0; e >>= 1 {
+		if e&1 != 0 {
+			r = m.mul(r, a)
+		}
+		a = m.mul(a, a)
+	}
+	return r
+}
+
+// bases make the Miller-Rabin test exact for every 64-bit number (Jim
+// Sinclair's set): no composite is a strong pseudoprime to all of them.
+var bases = [...]uint64{2, 325, 9375, 28178, 450775, 9780504, 1795265022}
+
+// isPrime reports whether n, which is odd and above 2, is prime.
+func (m *monty) isPrime() bool {
+	d := m.n - 1
+	s := bits.TrailingZeros64(d)
+	d >>= uint(s)
+	minusOne := m.n - m.one
+	for _, a := range bases {
+		a %= m.n
+		if a == 0 {
+			continue
+		}
+		x := m.pow(m.to(a), d)
+		if x == m.one || x == minusOne {
+			continue
+		}
+		i := 1
+		for ; i < s; i++ {
+			if x = m.mul(x, x); x == minusOne {
+				break
+			}
+		}
+		if i == s {
+			return false
+		}
+	}
+	return true
+}
+
+// rhoBatch is how many differences rho multiplies together before taking
+// a gcd of them with n.
+const rhoBatch = 128
+
+// rho returns a nontrivial factor of n, which is odd and composite, with
+// Brent's variant of Pollard's rho: x ↦ x² + c, with the differences
+// gcd'ed with n in batches, going back over the last batch one at a time
+// if it had all of n in it, and trying another c if that doesn't help.
+func (m *monty) rho() uint64 {
+	for c := m.one; ; c = m.add(c, m.one) {
+		y, q := m.add(m.one, m.one), m.one
+		var x, ys uint64
+		g := uint64(1)
+		for r := 1; g == 1; r *= 2 {
+			x = y
+			for i := 0; i < r; i++ {
+				y = m.add(m.mul(y, y), c)
+			}
+			for k := 0; k < r && g == 1; k += rhoBatch {
+				ys = y
+				for i := 0; i < rhoBatch && i < r-k; i++ {
+					y = m.add(m.mul(y, y), c)
+					q = m.mul(q, m.sub(x, y))
+				}
+				g = gcd(q, m.n)
+			}
+		}
+		if g == m.n {
+			for g = 1; g == 1; {
+				ys = m.add(m.mul(ys, ys), c)
+				g = gcd(m.sub(x, ys), m.n)
+			}
+		}
+		if g != m.n {
+			return g
+		}
+	}
+}
+
+// gcd returns the greatest common divisor of a and b, which is odd, with
+// Stein's algorithm.
+func gcd(a, b uint64) uint64 {
+	if a == 0 {
+		return b
+	}
+	a >>= uint(bits.TrailingZeros64(a))
+	for a != b {
+		if a > b {
+			a, b = b, a
+		}
+		b -= a
+		b >>= uint(bits.TrailingZeros64(b))
+	}
+	return a
+}
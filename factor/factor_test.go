@@ -0,0 +1,155 @@
+package factor
+
+import (
+	"bytes"
+	"fmt"
+	"math"
+	"math/big"
+	"math/rand"
+	"reflect"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+// check checks that f is the factorization of n.
+func check(t *testing.T, n uint64, f []uint64) {
+	p := new(big.Int).SetInt64(1)
+	for i, q := range f {
+		if i > 0 && q < f[i-1] || !new(big.Int).SetUint64(q).ProbablyPrime(0) {
+			t.Fatalf("%d: bad factors %d", n, f)
+		}
+		p.Mul(p, new(big.Int).SetUint64(q))
+	}
+	if n > 1 && (!p.IsUint64() || p.Uint64() != n) || n < 2 && len(f) > 0 {
+		t.Fatalf("%d: bad factors %d", n, f)
+	}
+}
+
+func TestFactor(t *testing.T) {
+	for n, want := range map[uint64][]uint64{
+		0:                       nil,
+		1:                       nil,
+		2:                       {2},
+		12:                      {2, 2, 3},
+		4093 * 4093:             {4093, 4093},
+		4099 * 4099:             {4099, 4099},
+		4099 * 4099 * 4099:      {4099, 4099, 4099},
+		math.MaxUint64:          {3, 5, 17, 257, 641, 65537, 6700417},
+		18446744073709551557:    {18446744073709551557},
+		4294967291 * 4294967279: {4294967279, 4294967291},
+		// Strong pseudoprimes to many bases.
+		3825123056546413051: {149491, 747451, 34233211},
+		3215031751:          {151, 751, 28351},
+	} {
+		got := Factor(n)
+		if want == nil {
+			check(t, n, got)
+			continue
+		}
+		if !reflect.DeepEqual(got, want) {
+			t.Errorf("%d: got %d, want %d", n, got, want)
+		}
+	}
+
+	r := rand.New(rand.NewSource(1))
+	for i := 0; i < 20000; i++ {
+		n := r.Uint64() >> uint(r.Intn(64))
+		check(t, n, Factor(n))
+	}
+	for i := uint64(0); i < 100000; i++ {
+		check(t, i, Factor(i))
+	}
+}
+
+func TestFactorBig(t *testing.T) {
+	for s, want := range map[string]string{
+		"18446744073709551616":           strings.Repeat(" 2", 64),
+		"18446744073709551617":           " 274177 67280421310721",
+		"36893488147419103231":           " 31 8191 145295143558111",
+		"1237940039285380274899124223":   " 3 3 3 7 11 19 31 73 151 331 631 23311 18837001",
+		"1208925819614629174706189":      " 1208925819614629174706189",
+		"340282366920938463463374607431": " 3 3 3 2029 7821888421 794112472752517",
+	} {
+		n, _ := new(big.Int).SetString(s, 10)
+		var got string
+		for _, p := range FactorBig(n) {
+			got += " " + p.String()
+		}
+		if got != want {
+			t.Errorf("%s: got %q, want %q", s, got, want)
+		}
+	}
+}
+
+func TestFactorer(t *testing.T) {
+	var in, want bytes.Buffer
+	r := rand.New(rand.NewSource(1))
+	for i := 0; i < 5000; i++ {
+		n := r.Uint64() >> uint(r.Intn(64))
+		fmt.Fprintf(&in, "%d%s", n, []string{" ", "\t", "\n", "  \n"}[i%4])
+		want.WriteString(fmt.Sprint(n, ":"))
+		for _, p := range Factor(n) {
+			want.WriteString(fmt.Sprint(" ", p))
+		}
+		want.WriteByte('\n')
+		if i%1000 == 0 {
+			// A bad number, long enough to be read in pieces.
+			fmt.Fprintf(&in, "+%s\n", strings.Repeat("9x", chunkSize))
+			want.WriteString("!\n")
+		}
+	}
+	in.WriteString("+0012") // no newline
+	want.WriteString("12: 2 2 3\n")
+
+	for _, workers := range []int{1, 3, 8} {
+		var out bytes.Buffer
+		f := &Factorer{
+			Workers: workers,
+			Error: func(err error) {
+				if _, ok := err.(*SyntaxError); !ok {
+					t.Fatal(err)
+				}
+				out.WriteString("!\n")
+			},
+		}
+		if err := f.Factor(&out, bytes.NewReader(in.Bytes())); err != nil {
+			t.Fatal(err)
+		}
+		if out.String() != want.String() {
+			t.Fatalf("%d workers: wrong output", workers)
+		}
+	}
+}
+
+func TestRun(t *testing.T) {
+	for _, tc := range []struct {
+		stdin string
+		args  []string
+		want  string
+		err   string
+	}{
+		{"", []string{"0", "1", "+12", " 012"}, "0:\n1:\n12: 2 2 3\n12: 2 2 3\n", ""},
+		{"", []string{"--", "4", "12 ", "-1", "9"}, "4: 2 2\n9: 3 3\n", "factor: '12 ' is not a valid positive integer\nfactor: '-1' is not a valid positive integer\n"},
+		{" 12\n\t+15 x\r 9", nil, "12: 2 2 3\n15: 3 5\n9: 3 3\n", "factor: 'x\\r' is not a valid positive integer\n"},
+	} {
+		got, stderr, err := cmdtest.Run(run, tc.stdin, tc.args...)
+		if got != tc.want || stderr != tc.err || (err != nil) != (tc.err != "") {
+			t.Errorf("%q: got %q, %q, %v, want %q, %q", tc.args, got, stderr, err, tc.want, tc.err)
+		}
+	}
+}
+
+func BenchmarkFactor(b *testing.B) {
+	r := rand.New(rand.NewSource(1))
+	nums := make([]uint64, 1024)
+	for i := range nums {
+		nums[i] = r.Uint64()
+	}
+	var f []uint64
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		f = appendFactors(f[:0], nums[i%len(nums)])
+	}
+}
@@ -0,0 +1,153 @@
+// Package benchdata generates the inputs the benchmarks, and bench.bash, are
+// run on. The data is made from a fixed seed, so it's the same from one run
+// to the next and the results of two runs can be compared.
+package benchdata
+
+import (
+	"bytes"
+	"fmt"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"unicode/utf8"
+)
+
+// Kind is a kind of text.
+type Kind string
+
+const (
+	// ASCII is English-like text: short words, spaces and tabs, and lines
+	// of about 60 bytes.
+	ASCII Kind = "ascii"
+	// UTF8 is text that's mostly multibyte runes, from Cyrillic, Greek,
+	// CJK and the emoji, with a few wide spaces, so counting it can't take
+	// the ASCII fast paths.
+	UTF8 Kind = "utf8"
+	// LongLines is ASCII text in lines of 16KB to 1MB, which don't fit a
+	// read buffer.
+	LongLines Kind = "longlines"
+)
+
+// Kinds is every Kind.
+var Kinds = []Kind{ASCII, UTF8, LongLines}
+
+var (
+	asciiWords = []string{
+		"the", "of", "and", "a", "to", "in", "is", "file", "line", "byte",
+		"count", "standard", "input", "output", "print", "newline", "with",
+		"GNU", "coreutils", "option", "-n", "--help", "2015", "x",
+	}
+	utf8Words = []string{
+		"привет", "файл", "строка", "αβγ", "λόγος", "日本語", "文字列", "한국어",
+		"ü", "café", "naïve", "😀", "🚀", "mixed",
+	}
+	// spaces are what separate words, weighted toward a single space.
+	asciiSpaces = []string{" ", " ", " ", " ", "  ", "\t"}
+	utf8Spaces  = []string{" ", " ", " ", "　", " "}
+)
+
+// Text returns size bytes of kind text, or a few less, so that it doesn't
+// end partway through a rune. Every line but possibly the last ends in a
+// newline.
+func Text(kind Kind, size int) []byte {
+	rng := rand.New(rand.NewSource(1))
+	words, spaces, line := asciiWords, asciiSpaces, 60
+	switch kind {
+	case UTF8:
+		words, spaces = utf8Words, utf8Spaces
+	case LongLines:
+		line = 16 << 10
+	}
+
+	var b bytes.Buffer
+	b.Grow(size + 64)
+	for b.Len() < size {
+		n := line/2 + rng.Intn(line)
+		if kind == LongLines {
+			n = line << uint(rng.Intn(7))
+		}
+		for start := b.Len(); b.Len()-start < n; {
+			b.WriteString(words[rng.Intn(len(words))])
+			b.WriteString(spaces[rng.Intn(len(spaces))])
+		}
+		b.WriteByte('\n')
+	}
+	data := b.Bytes()[:size]
+	for len(data) > 0 && !utf8.FullRune(data[lastStart(data):]) {
+		data = data[:lastStart(data)]
+	}
+	return data
+}
+
+// lastStart returns the index of the byte the last rune in data starts at.
+func lastStart(data []byte) int {
+	i := len(data) - 1
+	for i > 0 && !utf8.RuneStart(data[i]) {
+		i--
+	}
+	return i
+}
+
+// Graph returns the input to tsort for a graph of n nodes: each one comes
+// after one or two of the nodes before it, so it has no loops.
+func Graph(n int) []byte {
+	rng := rand.New(rand.NewSource(1))
+	var b bytes.Buffer
+	for i := 1; i < n; i++ {
+		fmt.Fprintf(&b, "node%d node%d\n", rng.Intn(i), i)
+		if i > 1 && rng.Intn(2) == 0 {
+			fmt.Fprintf(&b, "node%d node%d\n", rng.Intn(i), i)
+		}
+	}
+	return b.Bytes()
+}
+
+// WriteFiles creates dir, and n files in it of ASCII text, in directories of
+// at most 100 files each, like a source tree. The files are between 1 and
+// 2*size bytes long. It returns the total of their sizes.
+func WriteFiles(dir string, n, size int) (int64, error) {
+	rng := rand.New(rand.NewSource(1))
+	text := Text(ASCII, 2*size)
+	var total int64
+	for i := 0; i < n; i++ {
+		sub := filepath.Join(dir, fmt.Sprintf("d%03d", i/100))
+		if i%100 == 0 {
+			if err := os.MkdirAll(sub, 0755); err != nil {
+				return total, err
+			}
+		}
+		data := text[:1+rng.Intn(2*size)]
+		if err := writeFile(filepath.Join(sub, fmt.Sprintf("f%05d.txt", i)), data); err != nil {
+			return total, err
+		}
+		total += int64(len(data))
+	}
+	return total, nil
+}
+
+// Write creates dir and writes a file of size bytes for each Kind to it,
+// named for the Kind with a .txt extension, and the input to tsort for a
+// graph of nodes nodes, as graph.txt.
+func Write(dir string, size, nodes int) error {
+	if err := os.MkdirAll(dir, 0755); err != nil {
+		return err
+	}
+	for _, k := range Kinds {
+		if err := writeFile(filepath.Join(dir, string(k)+".txt"), Text(k, size)); err != nil {
+			return err
+		}
+	}
+	return writeFile(filepath.Join(dir, "graph.txt"), Graph(nodes))
+}
+
+func writeFile(name string, data []byte) error {
+	f, err := os.Create(name)
+	if err != nil {
+		return err
+	}
+	if _, err := f.Write(data); err != nil {
+		f.Close()
+		return err
+	}
+	return f.Close()
+}
@@ -0,0 +1,64 @@
+package benchdata
+
+import (
+	"bytes"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"testing"
+	"unicode/utf8"
+)
+
+func TestText(t *testing.T) {
+	for _, k := range Kinds {
+		for _, size := range []int{0, 1, 1000, 3 << 20} {
+			data := Text(k, size)
+			if len(data) > size || len(data) < size-utf8.UTFMax {
+				t.Fatalf("%s: %d bytes, want %d", k, len(data), size)
+			}
+			if !utf8.Valid(data) {
+				t.Fatalf("%s, %d bytes: not valid UTF-8", k, size)
+			}
+			if !bytes.Equal(data, Text(k, size)) {
+				t.Fatalf("%s, %d bytes: not the same twice", k, size)
+			}
+		}
+	}
+	var ascii int
+	for _, c := range Text(UTF8, 1<<16) {
+		if c < utf8.RuneSelf {
+			ascii++
+		}
+	}
+	if ascii > 1<<16/4 {
+		t.Fatalf("utf8: %d ASCII bytes in %d", ascii, 1<<16)
+	}
+	if n := bytes.Count(Text(LongLines, 8<<20), []byte{'\n'}); n > 8<<20/(16<<10) {
+		t.Fatalf("longlines: %d lines", n)
+	}
+}
+
+func TestWriteFiles(t *testing.T) {
+	dir, err := ioutil.TempDir("", "benchdata")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	total, err := WriteFiles(dir, 250, 100)
+	if err != nil {
+		t.Fatal(err)
+	}
+	var files int
+	var size int64
+	filepath.Walk(dir, func(path string, fi os.FileInfo, err error) error {
+		if err == nil && fi.Mode().IsRegular() {
+			files++
+			size += fi.Size()
+		}
+		return err
+	})
+	if files != 250 || size != total {
+		t.Fatalf("got %d files of %d bytes, want 250 of %d", files, size, total)
+	}
+}
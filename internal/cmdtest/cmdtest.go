@@ -0,0 +1,25 @@
+// Package cmdtest runs a utility from its tests: on a given stdin, with an
+// empty environment, and with what it writes collected.
+package cmdtest
+
+import (
+	"bytes"
+	"context"
+	"strings"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+// Run calls fn with args, reading stdin, and returns what it wrote to
+// stdout and stderr.
+func Run(fn coreutils.Runnable, stdin string, args ...string) (stdout, stderr string, err error) {
+	var out, errs bytes.Buffer
+	err = fn(coreutils.Context{
+		Context: context.Background(),
+		GetEnv:  func(string) string { return "" },
+		Stdin:   strings.NewReader(stdin),
+		Stdout:  &out,
+		Stderr:  &errs,
+	}, args...)
+	return out.String(), errs.String(), err
+}
@@ -0,0 +1,108 @@
+// Package lines reads delimited lines from a stream into buffers that are
+// reused, so that reading a line neither allocates nor copies it.
+//
+// Tools that compare each line with the one before it, such as uniq and
+// comm, need the previous line to stay put while the next is read. A Reader
+// has two buffers for that: when one runs out, what's left of it, starting
+// at the last line handed out, is moved to the other, so the last line's
+// bytes are never overwritten while the line is still in use. A line longer
+// than the buffers grows them, once, rather than being allocated on its own.
+package lines
+
+import (
+	"bytes"
+	"io"
+)
+
+// DefaultSize is the size of each buffer to begin with.
+const DefaultSize = 256 * 1024
+
+// Reader reads lines.
+type Reader struct {
+	r     io.Reader
+	delim byte
+	buf   []byte
+	spare []byte // the other buffer
+	last  int    // start of the last line returned
+	pos   int    // start of the next line
+	scan  int    // how far buf has been searched for the delimiter
+	end   int    // end of the data in buf
+	err   error
+}
+
+// NewReader returns a Reader for lines of r ending in delim.
+func NewReader(r io.Reader, delim byte) *Reader {
+	return NewReaderSize(r, delim, DefaultSize)
+}
+
+// NewReaderSize is NewReader with buffers size bytes long.
+func NewReaderSize(r io.Reader, delim byte, size int) *Reader {
+	if size < 16 {
+		size = 16
+	}
+	return &Reader{r: r, delim: delim, buf: make([]byte, size)}
+}
+
+// Next returns the next line, without its delimiter. The last line needn't
+// have one. At the end Next returns nil and io.EOF, and if reading fails it
+// returns the error.
+//
+// The line is valid until the second call to Next after this one, so it can
+// be compared with the line that follows it. It must not be modified.
+func (r *Reader) Next() ([]byte, error) {
+	for {
+		if i := bytes.IndexByte(r.buf[r.scan:r.end], r.delim); i >= 0 {
+			j := r.scan + i
+			line := r.buf[r.pos:j]
+			r.last, r.pos, r.scan = r.pos, j+1, j+1
+			return line, nil
+		}
+		r.scan = r.end
+		if r.err != nil {
+			if r.pos < r.end {
+				line := r.buf[r.pos:r.end]
+				r.last, r.pos = r.pos, r.end
+				return line, nil
+			}
+			return nil, r.err
+		}
+		r.fill()
+	}
+}
+
+// fill reads more into the buffer, first moving the unread part of it, and
+// the last line returned, to the spare one.
+func (r *Reader) fill() {
+	if r.end == len(r.buf) {
+		keep := r.buf[r.last:r.end]
+		if len(keep) >= len(r.buf)/2 || len(r.spare) < len(r.buf) {
+			// Half full of one line, or more, is too small to be
+			// sure of reading a whole line into.
+			size := len(r.buf)
+			if len(keep) >= size/2 {
+				size *= 2
+			}
+			r.spare = make([]byte, size)
+		}
+		copy(r.spare, keep)
+		r.buf, r.spare = r.spare, r.buf
+		r.pos -= r.last
+		r.scan -= r.last
+		r.end -= r.last
+		r.last = 0
+	}
+	// A reader that keeps returning nothing is treated as a failure, as
+	// it is by bufio.
+	for i := 0; i < 100; i++ {
+		n, err := r.r.Read(r.buf[r.end:])
+		r.end += n
+		if err != nil {
+			r.err = err
+			return
+		}
+		if n > 0 {
+			return
+		}
+	}
+	r.err = io.ErrNoProgress
+}
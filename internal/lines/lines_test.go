@@ -0,0 +1,69 @@
+package lines
+
+import (
+	"bytes"
+	"io"
+	"math/rand"
+	"strings"
+	"testing"
+	"testing/iotest"
+)
+
+func TestReader(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	var want []string
+	for i := 0; i < 5000; i++ {
+		n := rng.Intn(40)
+		if rng.Intn(100) == 0 {
+			n = rng.Intn(5000) // longer than the buffers
+		}
+		want = append(want, strings.Repeat(string(rune('a'+i%26)), n))
+	}
+	in := strings.Join(want, "\n")
+
+	for _, r := range []io.Reader{
+		strings.NewReader(in),
+		iotest.OneByteReader(strings.NewReader(in)),
+		iotest.HalfReader(strings.NewReader(in)),
+		iotest.DataErrReader(strings.NewReader(in + "\n")),
+	} {
+		lr := NewReaderSize(r, '\n', 64)
+		var prev []byte
+		for i := 0; ; i++ {
+			line, err := lr.Next()
+			if err == io.EOF {
+				if i != len(want) {
+					t.Fatalf("got %d lines, want %d", i, len(want))
+				}
+				break
+			}
+			if err != nil {
+				t.Fatal(err)
+			}
+			if string(line) != want[i] {
+				t.Fatalf("line %d: got %q, want %q", i, line, want[i])
+			}
+			// The line before is still valid.
+			if i > 0 && string(prev) != want[i-1] {
+				t.Fatalf("line %d: previous line is now %q", i, prev)
+			}
+			prev = line
+		}
+	}
+}
+
+func BenchmarkReader(b *testing.B) {
+	var buf bytes.Buffer
+	for buf.Len() < 10<<20 {
+		buf.WriteString("a line of some typical length\n")
+	}
+	b.SetBytes(int64(buf.Len()))
+	for i := 0; i < b.N; i++ {
+		lr := NewReader(bytes.NewReader(buf.Bytes()), '\n')
+		for {
+			if _, err := lr.Next(); err != nil {
+				break
+			}
+		}
+	}
+}
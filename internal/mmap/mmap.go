@@ -0,0 +1,239 @@
+// Package mmap provides a sequential reader that hands out a file's contents
+// straight from memory-mapped windows instead of copying them through read(2).
+//
+// Files that can't be mapped (pipes, terminals, anything on a platform
+// without mmap) and small files, for which setting up a mapping costs more
+// than it saves, are read normally, so callers can use a Reader for every
+// input without checking what it is first.
+//
+// Touching a page of a mapping that's past the end of its file, because the
+// file was truncated after being mapped, raises SIGBUS. Code that reads
+// mapped bytes runs under Guard, which turns that into ErrTruncated rather
+// than letting it kill the program.
+package mmap
+
+import (
+	"errors"
+	"io"
+	"os"
+	"runtime/debug"
+)
+
+// Threshold is the smallest file NewReader will map.
+var Threshold int64 = 1 << 20
+
+// WindowSize is how much of a file is mapped at once. Only one window is
+// mapped at a time, so this bounds the address space a Reader uses.
+var WindowSize = 64 << 20
+
+// bufSize is the read buffer size used when a file isn't mapped.
+const bufSize = 128 * 1024
+
+// ErrTruncated is the error in the *os.PathError Guard returns when a mapped
+// file was truncated while it was being read.
+var ErrTruncated = errors.New("file truncated while being read")
+
+// Guard calls fn and returns its error, or ErrTruncated if fn touched a page
+// of a mapping of f that f no longer reaches. Only faults on the calling
+// goroutine are caught, so fn mustn't hand mapped bytes to other goroutines.
+func Guard(f *os.File, fn func() error) (err error) {
+	defer debug.SetPanicOnFault(debug.SetPanicOnFault(true))
+	defer func() {
+		e := recover()
+		if e == nil {
+			return
+		}
+		// A nil pointer is still a bug, not a truncated file.
+		if fe, ok := e.(interface{ Addr() uintptr }); ok && fe.Addr() >= uintptr(os.Getpagesize()) {
+			err = &os.PathError{Op: "read", Path: f.Name(), Err: ErrTruncated}
+			return
+		}
+		panic(e)
+	}()
+	return fn()
+}
+
+// Reader reads a file sequentially, from a mapping if possible.
+type Reader struct {
+	f *os.File
+
+	mapped bool
+	off    int64 // offset of the next unmapped byte
+	end    int64 // size of the file when it was last checked
+	win    []byte
+	data   []byte // unread part of win or buf
+
+	buf []byte
+	err error
+}
+
+// NewReader returns a Reader for the rest of f, starting at its current
+// offset. f is mapped if it's a regular file with at least Threshold bytes
+// left. Like read(2), a mapped Reader sees whatever is appended to f before
+// it gets to the end.
+func NewReader(f *os.File) *Reader {
+	r := &Reader{f: f}
+	stat, err := f.Stat()
+	if err != nil || !stat.Mode().IsRegular() || !canMap {
+		return r
+	}
+	off, err := f.Seek(0, io.SeekCurrent)
+	if err != nil || stat.Size()-off < Threshold {
+		return r
+	}
+	r.mapped = true
+	r.off = off
+	r.end = stat.Size()
+	return r
+}
+
+// Mapped reports whether r reads from a mapping.
+func (r *Reader) Mapped() bool { return r.mapped }
+
+// Next returns the next chunk of the file. The chunk is only valid until the
+// next call to Next, Read, WriteTo or Close, and must not be modified. At the
+// end of the file Next returns a nil slice and io.EOF.
+func (r *Reader) Next() ([]byte, error) {
+	if len(r.data) == 0 {
+		if err := r.fill(); err != nil {
+			return nil, err
+		}
+	}
+	p := r.data
+	r.data = nil
+	return p, nil
+}
+
+// Read implements io.Reader. When r is mapped it's a copy from memory rather
+// than a system call, but Next and WriteTo avoid the copy entirely.
+func (r *Reader) Read(p []byte) (int, error) {
+	if len(r.data) == 0 {
+		if err := r.fill(); err != nil {
+			return 0, err
+		}
+	}
+	n := copy(p, r.data)
+	r.data = r.data[n:]
+	return n, nil
+}
+
+// WriteTo implements io.WriterTo, so io.Copy hands each chunk straight to w.
+func (r *Reader) WriteTo(w io.Writer) (n int64, err error) {
+	for {
+		p, err := r.Next()
+		if err != nil {
+			if err == io.EOF {
+				err = nil
+			}
+			return n, err
+		}
+		m, err := w.Write(p)
+		n += int64(m)
+		if err != nil {
+			return n, err
+		}
+	}
+}
+
+// Close releases the current mapping, if any, and leaves the underlying
+// file's offset just past what has been read. It doesn't close the file.
+func (r *Reader) Close() error {
+	if !r.mapped {
+		return nil
+	}
+	err := r.unmap()
+	if _, serr := r.f.Seek(r.off-int64(len(r.data)), io.SeekStart); err == nil {
+		err = serr
+	}
+	r.data = nil
+	r.mapped = false
+	return err
+}
+
+func (r *Reader) fill() error {
+	if r.err != nil {
+		return r.err
+	}
+	if r.mapped {
+		if err := r.unmap(); err != nil {
+			r.err = err
+			return err
+		}
+		if r.off >= r.end {
+			if stat, err := r.f.Stat(); err == nil && stat.Size() > r.end {
+				r.end = stat.Size()
+			} else {
+				r.err = io.EOF
+				return r.err
+			}
+		}
+		n := int64(WindowSize)
+		if r.end-r.off < n {
+			n = r.end - r.off
+		}
+		win, data, err := mapWindow(r.f, r.off, int(n))
+		if err != nil {
+			r.err = err
+			return err
+		}
+		r.win, r.data = win, data
+		r.off += n
+		return nil
+	}
+	if r.buf == nil {
+		r.buf = make([]byte, bufSize)
+	}
+	for {
+		n, err := r.f.Read(r.buf)
+		r.data = r.buf[:n]
+		if n > 0 {
+			return nil
+		}
+		if err != nil {
+			r.err = err
+			return err
+		}
+	}
+}
+
+func (r *Reader) unmap() error {
+	if r.win == nil {
+		return nil
+	}
+	err := unmapWindow(r.win)
+	r.win = nil
+	return err
+}
+
+// Mapping is a read-only mapping of part of a file, for callers that don't
+// read front to back.
+type Mapping struct {
+	win  []byte
+	data []byte
+}
+
+// Map maps n bytes of f starting at off, which doesn't need to be
+// page-aligned. It fails on platforms without mmap, so callers need a way
+// to read the file without it. The mapping never grows, so anything
+// appended to f afterwards isn't seen.
+func Map(f *os.File, off int64, n int) (*Mapping, error) {
+	win, data, err := mapWindow(f, off, n)
+	if err != nil {
+		return nil, err
+	}
+	return &Mapping{win: win, data: data}, nil
+}
+
+// Bytes returns the mapped part of the file. It's only valid until Close, and
+// must not be modified.
+func (m *Mapping) Bytes() []byte { return m.data }
+
+// Close unmaps m.
+func (m *Mapping) Close() error {
+	if m.win == nil {
+		return nil
+	}
+	err := unmapWindow(m.win)
+	m.win, m.data = nil, nil
+	return err
+}
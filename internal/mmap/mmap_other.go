@@ -0,0 +1,16 @@
+// +build !linux,!freebsd,!darwin
+
+package mmap
+
+import (
+	"errors"
+	"os"
+)
+
+const canMap = false
+
+func mapWindow(_ *os.File, _ int64, _ int) (win, data []byte, err error) {
+	return nil, nil, errors.New("mmap: not supported")
+}
+
+func unmapWindow(_ []byte) error { return nil }
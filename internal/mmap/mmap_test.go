@@ -0,0 +1,164 @@
+package mmap
+
+import (
+	"bytes"
+	"io"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"testing"
+)
+
+func TestReader(t *testing.T) {
+	f, err := ioutil.TempFile("", "mmap")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	defer f.Close()
+
+	data := make([]byte, 3<<20+123)
+	rand.New(rand.NewSource(1)).Read(data)
+	if _, err := f.Write(data); err != nil {
+		t.Fatal(err)
+	}
+
+	defer func(t int64, w int) { Threshold, WindowSize = t, w }(Threshold, WindowSize)
+	WindowSize = 1 << 20
+
+	for _, tc := range []struct {
+		threshold int64
+		start     int64
+		mapped    bool
+	}{
+		{1 << 20, 0, canMap},
+		{1 << 20, 12345, canMap}, // unaligned start
+		{1 << 30, 0, false},
+	} {
+		Threshold = tc.threshold
+		if _, err := f.Seek(tc.start, io.SeekStart); err != nil {
+			t.Fatal(err)
+		}
+		r := NewReader(f)
+		if r.Mapped() != tc.mapped {
+			t.Fatalf("%+v: Mapped() = %t", tc, r.Mapped())
+		}
+
+		// Read a little through Read, then the rest through WriteTo.
+		head := make([]byte, 1000)
+		if _, err := io.ReadFull(r, head); err != nil {
+			t.Fatal(err)
+		}
+		var buf bytes.Buffer
+		buf.Write(head)
+		if _, err := r.WriteTo(&buf); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(buf.Bytes(), data[tc.start:]) {
+			t.Fatalf("%+v: read data doesn't match", tc)
+		}
+		if err := r.Close(); err != nil {
+			t.Fatal(err)
+		}
+		if off, _ := f.Seek(0, io.SeekCurrent); off != int64(len(data)) {
+			t.Fatalf("%+v: offset after Close = %d, want %d", tc, off, len(data))
+		}
+	}
+}
+
+func TestMap(t *testing.T) {
+	if !canMap {
+		t.Skip("no mmap")
+	}
+	f, err := ioutil.TempFile("", "mmap")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	defer f.Close()
+
+	data := make([]byte, 1<<20)
+	rand.New(rand.NewSource(1)).Read(data)
+	if _, err := f.Write(data); err != nil {
+		t.Fatal(err)
+	}
+	m, err := Map(f, 12345, 100000)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(m.Bytes(), data[12345:12345+100000]) {
+		t.Error("wrong contents")
+	}
+	if err := m.Close(); err != nil {
+		t.Fatal(err)
+	}
+}
+
+// TestGuard checks that touching the pages of a Reader's window that a
+// truncation took away is an error, not a crash, and that a Reader goes on
+// to what's appended to its file.
+func TestGuard(t *testing.T) {
+	if !canMap {
+		t.Skip("no mmap")
+	}
+	f, err := ioutil.TempFile("", "mmap")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	defer f.Close()
+
+	data := make([]byte, 2<<20)
+	rand.New(rand.NewSource(1)).Read(data)
+	if _, err := f.Write(data); err != nil {
+		t.Fatal(err)
+	}
+	if _, err := f.Seek(0, io.SeekStart); err != nil {
+		t.Fatal(err)
+	}
+	defer func(t int64, w int) { Threshold, WindowSize = t, w }(Threshold, WindowSize)
+	Threshold, WindowSize = 1<<20, 1<<20
+
+	r := NewReader(f)
+	defer r.Close()
+	p, err := r.Next()
+	if err != nil {
+		t.Fatal(err)
+	}
+	if _, err := f.WriteAt(data, int64(len(data))); err != nil {
+		t.Fatal(err)
+	}
+	var got int64
+	for {
+		p, err := r.Next()
+		if err == io.EOF {
+			break
+		}
+		if err != nil {
+			t.Fatal(err)
+		}
+		got += int64(len(p))
+	}
+	if want := int64(2*len(data) - len(p)); got != want {
+		t.Errorf("read %d bytes after the first window, want %d", got, want)
+	}
+
+	m, err := Map(f, 0, len(data))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer m.Close()
+	if err := f.Truncate(0); err != nil {
+		t.Fatal(err)
+	}
+	var sum byte
+	err = Guard(f, func() error {
+		for _, c := range m.Bytes() {
+			sum += c
+		}
+		return nil
+	})
+	if pe, ok := err.(*os.PathError); !ok || pe.Err != ErrTruncated {
+		t.Errorf("got %v, want %v", err, ErrTruncated)
+	}
+}
@@ -0,0 +1,33 @@
+// +build linux freebsd darwin
+
+package mmap
+
+import (
+	"os"
+
+	"golang.org/x/sys/unix"
+)
+
+const canMap = true
+
+var pageMask = int64(os.Getpagesize() - 1)
+
+// mapWindow maps n bytes of f starting at off, which doesn't need to be
+// page-aligned. It returns the whole mapping, to unmap later, and the part
+// of it that was asked for.
+func mapWindow(f *os.File, off int64, n int) (win, data []byte, err error) {
+	start := off &^ pageMask
+	skip := int(off - start)
+	win, err = unix.Mmap(int(f.Fd()), start, skip+n, unix.PROT_READ, unix.MAP_SHARED)
+	if err != nil {
+		return nil, nil, &os.PathError{Op: "mmap", Path: f.Name(), Err: err}
+	}
+	// The advice is only a hint, so errors aren't worth failing over.
+	unix.Madvise(win, unix.MADV_SEQUENTIAL)
+	unix.Madvise(win, unix.MADV_WILLNEED)
+	return win, win[skip:], nil
+}
+
+func unmapWindow(win []byte) error {
+	return unix.Munmap(win)
+}
@@ -0,0 +1,68 @@
+package walk
+
+import (
+	"bytes"
+	"unsafe"
+
+	"golang.org/x/sys/unix"
+)
+
+// BufSize is the size of the buffer each worker should read directory
+// entries into.
+const BufSize = 64 * 1024
+
+// ReadDir reads the entries of the directory open as fd with getdents(2),
+// through buf, and calls fn with the name and d_type of each but "." and
+// "..". name is only valid until fn returns; the byte after it is its NUL,
+// so name[:len(name)+1] can be handed to the kernel as is. ReadDir stops
+// early if fn returns false, and returns the first error getdents does.
+func ReadDir(fd int, buf []byte, fn func(name []byte, typ uint8) bool) error {
+	for {
+		n, err := unix.Getdents(fd, buf)
+		if err == unix.EINTR {
+			continue
+		}
+		if err != nil {
+			return err
+		}
+		if n <= 0 {
+			return nil
+		}
+		if !entries(buf[:n], fn) {
+			return nil
+		}
+	}
+}
+
+// entries calls fn for a buffer of linux_dirent64 records:
+//
+//	u64 d_ino; s64 d_off; u16 d_reclen; u8 d_type; char d_name[];
+func entries(buf []byte, fn func(name []byte, typ uint8) bool) bool {
+	const (
+		reclenOff = 16
+		typeOff   = 18
+		nameOff   = 19
+	)
+	for len(buf) > nameOff {
+		reclen := int(*(*uint16)(unsafe.Pointer(&buf[reclenOff])))
+		if reclen <= nameOff || reclen > len(buf) {
+			return true
+		}
+		typ := buf[typeOff]
+		name := buf[nameOff:reclen]
+		buf = buf[reclen:]
+
+		i := bytes.IndexByte(name, 0)
+		if i <= 0 {
+			continue // truncated record
+		}
+		name = name[:i]
+		if name[0] == '.' && (len(name) == 1 || len(name) == 2 && name[1] == '.') {
+			continue
+		}
+		if !fn(name, typ) {
+			return false
+		}
+	}
+	return true
+}
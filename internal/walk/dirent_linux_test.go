@@ -0,0 +1,54 @@
+package walk
+
+import (
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"testing"
+)
+
+func TestReadDir(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "walk")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	var want []string
+	for i := 0; i < 5000; i++ { // more than fit in one buffer
+		name := "file" + strconv.Itoa(i)
+		if err := ioutil.WriteFile(filepath.Join(tmp, name), nil, 0644); err != nil {
+			t.Fatal(err)
+		}
+		want = append(want, name)
+	}
+	f, err := os.Open(tmp)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer f.Close()
+
+	var got []string
+	err = ReadDir(int(f.Fd()), make([]byte, BufSize), func(name []byte, typ uint8) bool {
+		if name[:len(name)+1][len(name)] != 0 {
+			t.Fatalf("%s isn't followed by a NUL", name)
+		}
+		got = append(got, string(name))
+		return true
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+	sort.Strings(got)
+	sort.Strings(want)
+	if len(got) != len(want) {
+		t.Fatalf("got %d names, want %d", len(got), len(want))
+	}
+	for i := range got {
+		if got[i] != want[i] {
+			t.Fatalf("got %q, want %q", got[i], want[i])
+		}
+	}
+}
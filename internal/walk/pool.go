@@ -0,0 +1,133 @@
+// Package walk has what rm and du share for walking directory trees in
+// parallel: a pool of workers that steal each other's work and, on Linux, a
+// reader for the entries getdents(2) returns. What's done with each
+// directory is up to the caller.
+package walk
+
+import (
+	"sync"
+	"sync/atomic"
+)
+
+// Pool runs jobs, usually directories, on a fixed set of workers. Each
+// worker works through its own queue newest first, which walks a tree depth
+// first, and steals the oldest (and so usually largest) subtrees from the
+// others when it runs out.
+type Pool struct {
+	do     func(worker int, job interface{})
+	queues []queue
+
+	// pending counts queued and running jobs. Workers exit once it reaches
+	// zero.
+	pending int64
+	idle    int32
+
+	mu   sync.Mutex // guards sleeping on cond
+	cond sync.Cond
+}
+
+type queue struct {
+	mu   sync.Mutex
+	jobs []interface{}
+}
+
+// NewPool returns a Pool of n workers, numbered from 0, each of which calls
+// do for the jobs it takes.
+func NewPool(n int, do func(worker int, job interface{})) *Pool {
+	p := &Pool{do: do, queues: make([]queue, n)}
+	p.cond.L = &p.mu
+	return p
+}
+
+// Push queues job for worker. do pushes the jobs it finds to the worker it
+// was called by.
+func (p *Pool) Push(worker int, job interface{}) {
+	atomic.AddInt64(&p.pending, 1)
+	q := &p.queues[worker]
+	q.mu.Lock()
+	q.jobs = append(q.jobs, job)
+	q.mu.Unlock()
+	if atomic.LoadInt32(&p.idle) > 0 {
+		p.mu.Lock()
+		p.cond.Signal()
+		p.mu.Unlock()
+	}
+}
+
+// Run starts the workers and returns once every job, including the ones
+// pushed while it runs, is done.
+func (p *Pool) Run() {
+	var wg sync.WaitGroup
+	wg.Add(len(p.queues))
+	for i := range p.queues {
+		go func(i int) {
+			defer wg.Done()
+			p.work(i)
+		}(i)
+	}
+	wg.Wait()
+}
+
+// next returns the newest job in worker i's queue or, if that's empty, the
+// oldest one in another's.
+func (p *Pool) next(i int) interface{} {
+	q := &p.queues[i]
+	q.mu.Lock()
+	if n := len(q.jobs); n > 0 {
+		job := q.jobs[n-1]
+		q.jobs[n-1] = nil
+		q.jobs = q.jobs[:n-1]
+		q.mu.Unlock()
+		return job
+	}
+	q.mu.Unlock()
+
+	for k := 1; k < len(p.queues); k++ {
+		v := &p.queues[(i+k)%len(p.queues)]
+		v.mu.Lock()
+		if len(v.jobs) > 0 {
+			job := v.jobs[0]
+			v.jobs[0] = nil
+			v.jobs = v.jobs[1:]
+			v.mu.Unlock()
+			return job
+		}
+		v.mu.Unlock()
+	}
+	return nil
+}
+
+func (p *Pool) work(i int) {
+	for {
+		if job := p.next(i); job != nil {
+			p.run(i, job)
+			continue
+		}
+
+		// Nothing to do right now. Sleep until someone queues more, or
+		// everything is done. idle is raised before looking again, so a
+		// push either sees it or is seen by next.
+		p.mu.Lock()
+		atomic.AddInt32(&p.idle, 1)
+		job := p.next(i)
+		for job == nil && atomic.LoadInt64(&p.pending) > 0 {
+			p.cond.Wait()
+			job = p.next(i)
+		}
+		atomic.AddInt32(&p.idle, -1)
+		p.mu.Unlock()
+		if job == nil {
+			return
+		}
+		p.run(i, job)
+	}
+}
+
+func (p *Pool) run(i int, job interface{}) {
+	p.do(i, job)
+	if atomic.AddInt64(&p.pending, -1) == 0 {
+		p.mu.Lock()
+		p.cond.Broadcast()
+		p.mu.Unlock()
+	}
+}
@@ -0,0 +1,30 @@
+package walk
+
+import (
+	"sync/atomic"
+	"testing"
+)
+
+// TestPool walks a tree in which job n has children 2n+1 and 2n+2, so every
+// job below limit is done exactly once whoever takes it.
+func TestPool(t *testing.T) {
+	const limit = 100000
+	var done [limit]int32
+	var p *Pool
+	p = NewPool(8, func(worker int, job interface{}) {
+		n := job.(int)
+		atomic.AddInt32(&done[n], 1)
+		for _, c := range []int{2*n + 1, 2*n + 2} {
+			if c < limit {
+				p.Push(worker, c)
+			}
+		}
+	})
+	p.Push(0, 0)
+	p.Run()
+	for n, k := range done {
+		if k != 1 {
+			t.Fatalf("job %d done %d times", n, k)
+		}
+	}
+}
@@ -19,48 +19,23 @@
 package checksum_common
 
 import (
-	"crypto/md5"
-	"crypto/sha1"
-	"crypto/sha256"
-	"crypto/sha512"
 	"fmt"
-	//flag "github.com/ogier/pflag"
-	"hash"
 	"io"
-	"os"
 	"path/filepath"
+	"strings"
 )
 
 /*
-   read from os.File and return the whole file's checksum
+   read from fp and return the whole file's checksum, or "" if t is unknown
+   or fp can't be read
 */
 func calc_checksum(fp io.Reader, t string) string {
-	var m hash.Hash
-	switch t {
-	case "md5":
-		m = md5.New()
-	case "sha1":
-		m = sha1.New()
-	case "sha512":
-		m = sha512.New()
-	case "sha256":
-		m = sha256.New()
-	case "sha224":
-		m = sha256.New224()
-	case "sha384":
-		m = sha512.New384()
-	default:
-		output_e("unknown type: %s\n", t)
+	m := new_hash(t)
+	if m == nil {
 		return ""
 	}
 
-	/*  issue:
-	    if fp is os.Stdin, there is no way to trigger EOF
-	*/
-	_, err := io.Copy(m, fp)
-
-	if err != nil {
-		output_e("%ssum: %s\n", t, err.Error())
+	if _, err := io.Copy(m, fp); err != nil {
 		return ""
 	}
 
@@ -68,57 +43,73 @@ func calc_checksum(fp io.Reader, t string) string {
 }
 
 /*
-   generate the checksum for all of files from cmdline
-*/
-func gen_checksum(files []string, t string) bool {
-
-	has_error := false
+   generate the checksum for all of files from cmdline.
 
-	for i := 0; i < len(files); i++ {
-		fn := files[i]
+   t is the tool's type of checksum, and is used for messages. types are
+   the checksums to print for each file; they're all computed in a single
+   read. if tagged is set, each one is printed as "TYPE (file) = sum", the
+   only format that can tell several types of checksum apart.
+*/
+func gen_checksum(o *Options, files []string, t string, types []string, tagged bool) bool {
 
-		/* stdin */
-		if fn == "-" {
-			sum := calc_checksum(os.Stdin, t)
-			if sum != "" {
-				fmt.Fprintf(os.Stdout, "%s *%s\n", sum, fn)
-			} else {
-				has_error = true
-			}
-			continue
+	for _, t1 := range types {
+		if new_hash(t1) == nil {
+			o.output_e("%s: unknown type: %s\n", prog(t), t1)
+			return false
 		}
+	}
 
-		/* file */
+	has_error := false
 
-		/* extends file lists when filename contains '*' */
-		filenames, _ := filepath.Glob(fn)
-		if filenames == nil {
-			filenames = append(filenames, fn)
-		}
+	/* the files from cmdline, with the globs expanded */
+	var names []string
+	next := func() (sum_job, bool) {
+		for len(names) == 0 {
+			if len(files) == 0 {
+				return sum_job{}, false
+			}
+			fn := files[0]
+			files = files[1:]
 
-		for _, f := range filenames {
-			file, err := os.Open(f)
-			if err != nil {
-				has_error = true
-				fmt.Fprintf(os.Stderr, "%ssum: %s\n", t, err.Error())
-				continue
+			/* stdin */
+			if fn == "-" {
+				return sum_job{name: fn, stdin: true, types: types}, true
 			}
-			sum := calc_checksum(file, t)
-			file.Close()
-			if sum != "" {
-				fmt.Fprintf(os.Stdout, "%s *%s\n", sum, f)
-			} else {
-				has_error = true
+
+			/* extends file lists when filename contains '*' */
+			names, _ = filepath.Glob(fn)
+			if names == nil {
+				names = append(names, fn)
 			}
 		}
+		fn := names[0]
+		names = names[1:]
+		return sum_job{name: fn, types: types}, true
 	}
 
+	hash_files(o.Ctx, next, func(r *sum_result) {
+		if r.err != nil {
+			has_error = true
+			fmt.Fprintf(o.Ctx.Stderr, "%s: %s\n", prog(t), r.err.Error())
+			return
+		}
+		if !tagged {
+			fmt.Fprintf(o.Ctx.Stdout, "%s *%s\n", r.sums[0], r.name)
+			return
+		}
+		for i, t1 := range r.types {
+			fmt.Fprintf(o.Ctx.Stdout, "%s (%s) = %s\n", strings.ToUpper(t1), r.name, r.sums[i])
+		}
+	})
+
 	return !has_error
 }
 
 /*
    generate the checksum for given file list.
 
+   o: where to read standard input and write the checksums
+
    files: the file name lists to generate checksum
 
    t: the type of checksum, md5 or sha1...
@@ -127,6 +118,31 @@ func gen_checksum(files []string, t string) bool {
 
    return true if there is no error.
 */
-func GenerateChecksum(files []string, t string) bool {
-	return gen_checksum(files, t)
+func GenerateChecksum(o Options, files []string, t string) bool {
+	return gen_checksum(&o, files, t, []string{t}, false)
+}
+
+/*
+   generate several types of checksum for the given file list, reading
+   each file only once, and print them in the tagged format.
+
+   files: the file name lists to generate checksum
+
+   types: the types of checksum, md5, sha1, or anything added with
+   RegisterHash
+
+   return false if there are some errors.
+*/
+func GenerateTagged(o Options, files []string, types []string) bool {
+	return gen_checksum(&o, files, "", types, true)
+}
+
+/*
+   generate the tree hash of type t for the given file list, in the tagged
+   format, see TreeHash.
+
+   return false if there are some errors.
+*/
+func GenerateTree(o Options, files []string, t string) bool {
+	return gen_checksum(&o, files, t, []string{t + "-tree"}, true)
 }
@@ -23,7 +23,6 @@ package checksum_common
 
 import (
 	"bufio"
-	//flag "github.com/ogier/pflag"
 	"io"
 	"os"
 	"path/filepath"
@@ -33,7 +32,7 @@ import (
 /*
    check the checksum for all of files
 */
-func check_checksum(files []string, t string) bool {
+func check_checksum(o *Options, files []string, t string) bool {
 
 	has_err := false
 
@@ -41,7 +40,7 @@ func check_checksum(files []string, t string) bool {
 
 		/* stdin */
 		if files[i] == "-" {
-			if b := check_checksum_f(os.Stdin, t); !b {
+			if b := check_checksum_f(o, o.Ctx.Stdin, t); !b {
 				has_err = true
 			}
 			continue
@@ -50,11 +49,11 @@ func check_checksum(files []string, t string) bool {
 		/* file */
 		file, err := os.Open(files[i])
 		if err != nil {
-			output_e("%ssum: %s\n", t, err.Error())
+			o.output_e("%s: %s\n", prog(t), err.Error())
 			has_err = true
 			continue
 		}
-		if b := check_checksum_f(file, t); !b {
+		if b := check_checksum_f(o, file, t); !b {
 			has_err = true
 		}
 		file.Close()
@@ -63,10 +62,64 @@ func check_checksum(files []string, t string) bool {
 	return !has_err
 }
 
+/*
+   split a line of a checksum list into its type of checksum, the checksum
+   and the file name. a line is either "TYPE (file) = sum", for any
+   registered type, or "sum file" or "sum *file", for the tool's own type t.
+   cksum, whose t is empty, only reads the first kind.
+*/
+func parse_line(ll, t string) (t1, sum, fn string, ok bool) {
+	if i := strings.Index(ll, " ("); i > 0 {
+		if j := strings.LastIndex(ll, ") = "); j > i {
+			t1 = strings.ToLower(ll[:i])
+			if _, ok := hash_types[t1]; ok {
+				return t1, ll[j+4:], ll[i+2 : j], true
+			}
+		}
+	}
+	if t == "" {
+		return "", "", "", false
+	}
+
+	fields := strings.Fields(ll)
+
+	if len(fields) != 2 {
+		return "", "", "", false
+	}
+
+	sum, fn = fields[0], fields[1]
+
+	/* strip the '*' from filename */
+	if fn[0] == '*' {
+		fn = fn[1:]
+	}
+
+	return t, sum, fn, true
+}
+
+func has_type(types []string, t string) bool {
+	for _, t1 := range types {
+		if t1 == t {
+			return true
+		}
+	}
+	return false
+}
+
+/*
+   "MD5 " for md5sum's messages, nothing for cksum's
+*/
+func type_name(t string) string {
+	if t == "" {
+		return ""
+	}
+	return strings.ToUpper(t) + " "
+}
+
 /*
    process single checksum list file
 */
-func check_checksum_f(fp io.Reader, t string) bool {
+func check_checksum_f(o *Options, fp io.Reader, t string) bool {
 	has_err := false
 	reader := bufio.NewReader(fp)
 
@@ -82,82 +135,125 @@ func check_checksum_f(fp io.Reader, t string) bool {
 	/* line number */
 	line_num := 0
 
-	for {
-		line_num += 1
-		l, _, err := reader.ReadLine()
-		if err != nil {
-			if err != io.EOF {
-				has_err = true
-				output_e("%ssum: %s\n", t, err.Error())
+	/* the lines are parsed as the files are hashed */
+	var read_err error
+	read_line := func() (sum_job, bool) {
+		for {
+			line_num += 1
+			l, _, err := reader.ReadLine()
+			if err != nil {
+				if err != io.EOF {
+					read_err = err
+				}
+				return sum_job{}, false
 			}
-			break
-		}
-
-		ll := strings.TrimSpace(string(l))
 
-		if ll == "" {
-			continue
-		}
+			ll := strings.TrimSpace(string(l))
 
-		/* strip the '\' at beginning */
-		if ll[0] == '\\' {
-			ll = ll[1:]
-		}
+			if ll == "" {
+				continue
+			}
 
-		fields := strings.Fields(ll)
+			/* strip the '\' at beginning */
+			if ll[0] == '\\' {
+				ll = ll[1:]
+			}
 
-		if len(fields) != 2 {
-			if show_warn {
-				output_e("%ssum: line: %d: improperly formatted %s checksum line\n",
-					t, line_num, strings.ToUpper(t))
+			t1, sum, fn, ok := parse_line(ll, t)
+			if !ok {
+				return sum_job{bad: true, line: line_num}, true
 			}
-			continue
-		}
 
-		sum, fn := fields[0], fields[1]
+			fn = filepath.Clean(fn)
 
-		/* strip the '*' from filename */
-		if fn[0] == '*' {
-			fn = fn[1:]
+			return sum_job{
+				name:  fn,
+				types: []string{t1},
+				wants: []string{sum},
+				line:  line_num,
+			}, true
 		}
+	}
 
-		fn = filepath.Clean(fn)
+	/*
+	   consecutive lines for the same file, such as the ones GenerateTagged
+	   prints, are checked with a single read of it
+	*/
+	var (
+		ahead     sum_job
+		has_ahead bool
+	)
+	next := func() (sum_job, bool) {
+		j, ok := ahead, has_ahead
+		has_ahead = false
+		if !ok {
+			if j, ok = read_line(); !ok {
+				return j, false
+			}
+		}
+		if j.bad {
+			return j, true
+		}
+		for {
+			k, ok := read_line()
+			if !ok {
+				return j, true
+			}
+			if k.bad || k.name != j.name || has_type(j.types, k.types[0]) {
+				ahead, has_ahead = k, true
+				return j, true
+			}
+			j.types = append(j.types, k.types[0])
+			j.wants = append(j.wants, k.wants[0])
+		}
+	}
 
-		file, err := os.Open(fn)
-		if err != nil {
-			output_e("%ssum: %s\n", t, err.Error())
-			has_err = true
-			errored += 1
-			continue
+	hash_files(o.Ctx, next, func(r *sum_result) {
+		if r.bad {
+			if o.Warn {
+				o.output_e("%s: line: %d: improperly formatted %schecksum line\n",
+					prog(t), r.line, type_name(t))
+			}
+			return
 		}
 
-		sum1 := calc_checksum(file, t)
-		file.Close()
+		if r.err != nil {
+			o.output_e("%s: %s\n", prog(t), r.err.Error())
+			has_err = true
+			errored += len(r.types)
+			/* files that couldn't be opened aren't counted in total */
+			if e, ok := r.err.(*os.PathError); !ok || e.Op != "open" {
+				total += len(r.types)
+			}
+			return
+		}
 
-		total += 1
+		for i, sum := range r.sums {
+			total += 1
 
-		if sum1 != "" {
-			if sum1 != sum { // failed
+			if sum != r.wants[i] { // failed
 				failed += 1
-				output_e("%s: FAILED\n", fn)
+				o.output_e("%s: FAILED\n", r.name)
 				has_err = true
 			} else { // success
-				output_n("%s: OK\n", fn)
+				o.output_n("%s: OK\n", r.name)
 			}
-		} else { // error
-			errored += 1
-			has_err = true
 		}
+	})
+
+	if read_err != nil {
+		has_err = true
+		o.output_e("%s: %s\n", prog(t), read_err.Error())
 	}
 
-	if failed > 0 && show_warn {
-		output_e("%ssum: WARNING: %d of %d computed checksums did NOT match\n",
-			t, failed, total)
+	if failed > 0 && o.Warn {
+		o.output_e("%s: WARNING: %d of %d computed checksums did NOT match\n",
+			prog(t), failed, total)
 	}
 
-	if errored > 0 && show_warn {
-		output_e("%ssum: WARNING: %d of %d listed files could not be read\n",
-			t, errored, total)
+	if errored > 0 && o.Warn {
+		o.output_e("%s: WARNING: %d of %d listed files could not be read\n",
+			prog(t), errored, total)
 	}
 
 	return !has_err
@@ -166,6 +262,9 @@ func check_checksum_f(fp io.Reader, t string) bool {
 /*
 read the file contains the checksum and check it
 
+o: where to read standard input and write the results, and how much to
+report
+
 files: file name lists which contains the checksums.
 
 t: the type of checksum, md5 or sha1...
@@ -174,8 +273,14 @@ return true if everything is ok
 
 return false if there are some errors.
 */
-func CompareChecksum(files []string, t string, output_message, output_warn bool) bool {
-	no_output = !output_message
-	show_warn = output_warn
-	return check_checksum(files, t)
+func CompareChecksum(o Options, files []string, t string) bool {
+	return check_checksum(&o, files, t)
+}
+
+/*
+   like CompareChecksum, but only for checksums in the tagged format, which
+   may be of any registered type.
+*/
+func CompareTagged(o Options, files []string) bool {
+	return CompareChecksum(o, files, "")
 }
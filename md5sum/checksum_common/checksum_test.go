@@ -2,10 +2,23 @@ package checksum_common
 
 import (
 	"bytes"
+	"crypto/md5"
+	"crypto/sha256"
+	"crypto/sha512"
+	"encoding/binary"
+	"encoding/hex"
 	"fmt"
-	"io"
+	"hash"
+	"hash/crc32"
+	"io/ioutil"
+	"math/rand"
 	"os"
+	"path/filepath"
+	"strings"
 	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
 )
 
 func TestCalc_checksum(t *testing.T) {
@@ -56,32 +69,16 @@ func TestCalc_checksum(t *testing.T) {
 
 func TestCheck_checksum(t *testing.T) {
 
-	old_stdout := os.Stdout
-
 	/* capture output */
-	r, w, _ := os.Pipe()
-	os.Stdout = w
-
-	outC := make(chan string)
-
-	defer func() {
-		w.Close()
-		os.Stdout = old_stdout
-		output := <-outC
-		t.Logf("%s\n", output)
-	}()
-
-	go func() {
-		var buf bytes.Buffer
-		io.Copy(&buf, r)
-		outC <- buf.String()
-	}()
+	var buf bytes.Buffer
+	o := Options{Ctx: coreutils.Context{Stdout: &buf, Stderr: &buf}, Warn: true}
+	defer func() { t.Logf("%s\n", buf.String()) }()
 
 	sum_methods := []string{"md5", "sha1", "sha224", "sha256", "sha384", "sha512"}
 	for _, m := range sum_methods {
 		fn := fmt.Sprintf("testdata/checksum.%s", m)
 		sum_f_lists := []string{fn}
-		if r := CompareChecksum(sum_f_lists, m, true, true); !r {
+		if r := CompareChecksum(o, sum_f_lists, m); !r {
 			t.Fail()
 		} else {
 			t.Logf("check %s for %s: success\n", fn, m)
@@ -91,34 +88,234 @@ func TestCheck_checksum(t *testing.T) {
 
 func TestGenChecksum(t *testing.T) {
 
-	old_stdout := os.Stdout
-
 	/* capture output */
-	r, w, _ := os.Pipe()
-	os.Stdout = w
-
-	outC := make(chan string)
-
-	defer func() {
-		w.Close()
-		os.Stdout = old_stdout
-		output := <-outC
-		t.Logf("\n%s\n", output)
-	}()
-
-	go func() {
-		var buf bytes.Buffer
-		io.Copy(&buf, r)
-		outC <- buf.String()
-	}()
+	var buf bytes.Buffer
+	o := Options{Ctx: coreutils.Context{Stdout: &buf, Stderr: &buf}}
+	defer func() { t.Logf("\n%s\n", buf.String()) }()
 
 	sum_methods := []string{"md5", "sha1", "sha224", "sha256", "sha384", "sha512"}
 	for _, m := range sum_methods {
 		flists := []string{"testdata/*.txt"}
-		if r := GenerateChecksum(flists, m); !r {
+		if r := GenerateChecksum(o, flists, m); !r {
 			t.Fail()
 		} else {
 			t.Logf("generate %sum: success\n", m)
 		}
 	}
 }
+
+func TestHashFiles(t *testing.T) {
+	dir, err := ioutil.TempDir("", "checksum")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	rng := rand.New(rand.NewSource(1))
+	var names []string
+	var want []string
+	for i := 0; i < 200; i++ {
+		data := make([]byte, rng.Intn(300000))
+		rng.Read(data)
+		fn := filepath.Join(dir, fmt.Sprintf("f%d", i))
+		if err := ioutil.WriteFile(fn, data, 0644); err != nil {
+			t.Fatal(err)
+		}
+		names = append(names, fn)
+		want = append(want, calc_checksum(bytes.NewReader(data), "sha256"))
+	}
+	names = append(names, filepath.Join(dir, "missing"))
+
+	defer func(n int) { Workers = n }(Workers)
+	for _, Workers = range []int{1, 3, 16} {
+		i := 0
+		next := func() (sum_job, bool) {
+			if i >= len(names) {
+				return sum_job{}, false
+			}
+			i++
+			return sum_job{name: names[i-1], types: []string{"sha256"}}, true
+		}
+		var got []string
+		hash_files(coreutils.Context{}, next, func(r *sum_result) {
+			if r.name != names[len(got)] {
+				t.Fatalf("%d workers: got %s, want %s", Workers, r.name, names[len(got)])
+			}
+			if r.err != nil {
+				got = append(got, "error")
+				return
+			}
+			got = append(got, r.sums[0])
+		})
+		if len(got) != len(names) || got[len(got)-1] != "error" {
+			t.Fatalf("%d workers: got %d results", Workers, len(got))
+		}
+		for j := range want {
+			if got[j] != want[j] {
+				t.Fatalf("%d workers: %s: got %s, want %s", Workers, names[j], got[j], want[j])
+			}
+		}
+	}
+}
+
+func TestHashFilesTypes(t *testing.T) {
+	RegisterHash("CRC32", func() hash.Hash { return crc32.NewIEEE() })
+	defer delete(hash_types, "crc32")
+
+	f, err := ioutil.TempFile("", "checksum")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	data := make([]byte, 5<<20+7)
+	rand.New(rand.NewSource(2)).Read(data)
+	f.Write(data)
+	f.Close()
+
+	var want []string
+	for _, m := range []hash.Hash{md5.New(), crc32.NewIEEE(), sha512.New()} {
+		m.Write(data)
+		want = append(want, hex.EncodeToString(m.Sum(nil)))
+	}
+
+	done := false
+	next := func() (sum_job, bool) {
+		if done {
+			return sum_job{}, false
+		}
+		done = true
+		return sum_job{name: f.Name(), types: []string{"md5", "crc32", "sha512"}}, true
+	}
+	hash_files(coreutils.Context{}, next, func(r *sum_result) {
+		if r.err != nil {
+			t.Fatal(r.err)
+		}
+		for i := range want {
+			if r.sums[i] != want[i] {
+				t.Errorf("%s: got %s, want %s", r.types[i], r.sums[i], want[i])
+			}
+		}
+	})
+}
+
+/*
+   run a tool the way the coreutils binary does, with its own streams,
+   reading standard input and then checking what it printed
+*/
+func TestTool(t *testing.T) {
+	run := Tool("sha256", "", "")
+	var out, errs bytes.Buffer
+	s := new(coreutils.Stats)
+	ctx := coreutils.Context{
+		Stdin:  strings.NewReader("hello, world"),
+		Stdout: &out,
+		Stderr: &errs,
+		Stats:  s,
+	}
+	if err := run(ctx); err != nil {
+		t.Fatalf("%v: %s", err, errs.String())
+	}
+	want := "09ca7e4eaa6e8ae9c7d261167129184883644d07dfba7cbfbc4c8a2e08360d5b *-\n"
+	if out.String() != want {
+		t.Errorf("got %q, want %q", out.String(), want)
+	}
+	if s.BytesRead != int64(len("hello, world")) {
+		t.Errorf("read %d bytes", s.BytesRead)
+	}
+
+	/* check a list of checksums given on standard input */
+	dir, err := ioutil.TempDir("", "checksum")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	fn := filepath.Join(dir, "hello")
+	if err := ioutil.WriteFile(fn, []byte("hello, world"), 0644); err != nil {
+		t.Fatal(err)
+	}
+	list := strings.TrimSuffix(want, "*-\n") + " " + fn + "\n"
+
+	out.Reset()
+	ctx.Stdin = strings.NewReader(list)
+	if err := run(ctx, "-c"); err != nil || out.String() != fn+": OK\n" {
+		t.Errorf("check: got %v, %q", err, out.String())
+	}
+
+	out.Reset()
+	ctx.Stdin = strings.NewReader(strings.Replace(list, "09", "90", 1))
+	if err := run(ctx, "-c", "--status"); coreutils.Status(err) != 1 || out.Len() > 0 {
+		t.Errorf("bad checksum: got %v, %q", err, out.String())
+	}
+}
+
+/*
+   the tree hash's definition, computed serially
+*/
+func tree_reference(data []byte) []byte {
+	root := sha256.New()
+	root.Write([]byte{1})
+	for i := 0; i == 0 || i < len(data); i += tree_chunk {
+		end := i + tree_chunk
+		if end > len(data) {
+			end = len(data)
+		}
+		leaf := sha256.New()
+		leaf.Write([]byte{0})
+		leaf.Write(data[i:end])
+		root.Write(leaf.Sum(nil))
+	}
+	var size [8]byte
+	binary.BigEndian.PutUint64(size[:], uint64(len(data)))
+	root.Write(size[:])
+	return root.Sum(nil)
+}
+
+func TestTreeHash(t *testing.T) {
+	rng := rand.New(rand.NewSource(3))
+	data := make([]byte, 5*tree_chunk+12345)
+	rng.Read(data)
+
+	m := new_hash("sha256-tree")
+	for _, n := range []int{0, 1, tree_chunk - 1, tree_chunk, 3 * tree_chunk, len(data)} {
+		want := tree_reference(data[:n])
+
+		/* write in random pieces, checking Sum along the way */
+		m.Reset()
+		for p := data[:n]; len(p) > 0; {
+			k := rng.Intn(2*tree_chunk) + 1
+			if k > len(p) {
+				k = len(p)
+			}
+			m.Write(p[:k])
+			p = p[k:]
+			if rng.Intn(4) == 0 {
+				m.Sum(nil)
+			}
+		}
+		if got := m.Sum(nil); !bytes.Equal(got, want) {
+			t.Errorf("%d bytes: got %x, want %x", n, got, want)
+		}
+		plain := sha256.Sum256(data[:n])
+		if bytes.Equal(want, plain[:]) {
+			t.Errorf("%d bytes: tree hash equals the plain hash", n)
+		}
+	}
+}
+
+/*
+   hash an in-memory file with each type of checksum, the tree hashes
+   included
+*/
+func BenchmarkCalc_checksum(b *testing.B) {
+	data := benchdata.Text(benchdata.ASCII, 8<<20)
+	for _, t := range HashTypes() {
+		b.Run(t, func(b *testing.B) {
+			b.SetBytes(int64(len(data)))
+			for i := 0; i < b.N; i++ {
+				if calc_checksum(bytes.NewReader(data), t) == "" {
+					b.Fatal("no checksum")
+				}
+			}
+		})
+	}
+}
@@ -20,26 +20,49 @@ package checksum_common
 
 import (
 	"fmt"
-	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
 )
 
-var no_output bool = false
-var show_warn bool = true
+/*
+   one run of a tool: where it reads and writes, and what it reports. each
+   run has its own, so several tools can run at once in one process.
+
+   Quiet and Warn only matter when checking. Quiet, for --quiet or
+   --status, prints nothing at all, and Warn, for --warn, reports
+   improperly formatted lines and how many checksums failed.
+*/
+type Options struct {
+	Ctx   coreutils.Context
+	Quiet bool
+	Warn  bool
+}
 
 /*
    output to stdout
 */
-func output_n(s string, s1 ...interface{}) {
-	if no_output != true {
-		fmt.Fprintf(os.Stdout, s, s1...)
+func (o *Options) output_n(s string, s1 ...interface{}) {
+	if o.Quiet != true {
+		fmt.Fprintf(o.Ctx.Stdout, s, s1...)
 	}
 }
 
 /*
    output to stderr
 */
-func output_e(s string, s1 ...interface{}) {
-	if no_output != true {
-		fmt.Fprintf(os.Stderr, s, s1...)
+func (o *Options) output_e(s string, s1 ...interface{}) {
+	if o.Quiet != true {
+		fmt.Fprintf(o.Ctx.Stderr, s, s1...)
+	}
+}
+
+/*
+   the name of the tool for the type of checksum t. t is empty for cksum,
+   which handles every type.
+*/
+func prog(t string) string {
+	if t == "" {
+		return "cksum"
 	}
+	return t + "sum"
 }
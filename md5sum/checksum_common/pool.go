@@ -0,0 +1,212 @@
+/*
+    go checksum common
+
+    Copyright (c) 2014-2015 Dingjun Fang
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License version 3 as
+	published by the Free Software Foundation.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+package checksum_common
+
+import (
+	"encoding/hex"
+	"fmt"
+	"hash"
+	"io"
+	"os"
+	"runtime"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+/*
+   number of files hashed at once by GenerateChecksum and CompareChecksum.
+   values below 1 mean one file at a time.
+*/
+var Workers = runtime.NumCPU()
+
+/*
+   size of each worker's read buffer, for files too small to be mapped
+*/
+const sum_buf_size = 128 * 1024
+
+/*
+   one entry of the input, in the order it should be reported
+*/
+type sum_job struct {
+	name  string   /* file to hash */
+	stdin bool     /* hash standard input instead of name */
+	bad   bool     /* nothing to hash, just report the job in order */
+	types []string /* the types of checksum to compute, in one pass */
+	wants []string /* check mode: the expected checksum for each type */
+	line  int      /* check mode: line number in the checksum list */
+}
+
+type sum_result struct {
+	sum_job
+	sums  []string /* one for each of types */
+	err   error
+	ready chan struct{} /* closed once sums and err are set */
+}
+
+/*
+   hash objects and buffers owned by one goroutine and reused for every
+   file it hashes
+*/
+type sum_worker struct {
+	hashes map[string]hash.Hash
+	fan    fanout
+	buf    []byte
+	out    []byte
+	stats  *coreutils.Stats /* counts what's read, if not nil */
+}
+
+func new_sum_worker(stats *coreutils.Stats) *sum_worker {
+	return &sum_worker{
+		hashes: make(map[string]hash.Hash),
+		buf:    make([]byte, sum_buf_size),
+		stats:  stats,
+	}
+}
+
+func (w *sum_worker) hash(name string, types []string) ([]string, error) {
+	file, err := os.Open(name)
+	if err != nil {
+		return nil, err
+	}
+	sums, err := w.hash_file(file, types)
+	file.Close()
+	return sums, err
+}
+
+/*
+   large regular files are hashed straight from a memory mapping, the rest
+   is read through the worker's buffer
+*/
+func (w *sum_worker) hash_file(in io.Reader, types []string) ([]string, error) {
+	w.fan = w.fan[:0]
+	for _, t := range types {
+		m, ok := w.hashes[t]
+		if !ok {
+			if m = new_hash(t); m == nil {
+				return nil, fmt.Errorf("unknown type: %s", t)
+			}
+			w.hashes[t] = m
+		}
+		m.Reset()
+		w.fan = append(w.fan, m)
+	}
+
+	var r *mmap.Reader
+	file, ok := in.(*os.File)
+	if ok {
+		r = mmap.NewReader(file)
+	}
+	if r != nil && r.Mapped() {
+		var n int64
+		err := mmap.Guard(file, func() (err error) {
+			n, err = r.WriteTo(w.fan)
+			return err
+		})
+		w.stats.Took("mmap")
+		w.stats.AddMapped(n)
+		if cerr := r.Close(); err == nil {
+			err = cerr
+		}
+		if err != nil {
+			return nil, err
+		}
+	} else {
+		for {
+			start := w.stats.Start()
+			n, err := in.Read(w.buf)
+			w.stats.AddRead(n, start)
+			w.fan.Write(w.buf[:n])
+			if err == io.EOF {
+				break
+			}
+			if err != nil {
+				return nil, err
+			}
+		}
+	}
+
+	sums := make([]string, len(w.fan))
+	for i, m := range w.fan {
+		w.out = m.Sum(w.out[:0])
+		sums[i] = hex.EncodeToString(w.out)
+	}
+	return sums, nil
+}
+
+/*
+   hash the files next returns with up to Workers goroutines and call done
+   with each result, in the order next returned them. at most a few files
+   per worker are hashed ahead of the one done is waiting for.
+
+   next is called from its own goroutine and done from the calling one.
+   stdin jobs, which read ctx.Stdin, are hashed by the calling goroutine
+   when their turn comes, so standard input is never read by two goroutines
+   at once. every read is counted in ctx.Stats.
+
+   a type of checksum that isn't registered is reported as the file's error.
+*/
+func hash_files(ctx coreutils.Context, next func() (sum_job, bool), done func(*sum_result)) {
+	n := Workers
+	if n < 1 {
+		n = 1
+	}
+	main_worker := new_sum_worker(ctx.Stats)
+
+	var (
+		jobs  = make(chan *sum_result, n)
+		queue = make(chan *sum_result, 4*n)
+	)
+
+	go func() {
+		for {
+			j, ok := next()
+			if !ok {
+				break
+			}
+			r := &sum_result{sum_job: j, ready: make(chan struct{})}
+			queue <- r
+			if j.bad || j.stdin {
+				close(r.ready)
+			} else {
+				jobs <- r
+			}
+		}
+		close(jobs)
+		close(queue)
+	}()
+
+	for i := 0; i < n; i++ {
+		go func() {
+			w := new_sum_worker(ctx.Stats)
+			for r := range jobs {
+				r.sums, r.err = w.hash(r.name, r.types)
+				close(r.ready)
+			}
+		}()
+	}
+
+	for r := range queue {
+		<-r.ready
+		if r.stdin {
+			r.sums, r.err = main_worker.hash_file(ctx.Stdin, r.types)
+		}
+		done(r)
+	}
+}
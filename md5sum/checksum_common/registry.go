@@ -0,0 +1,119 @@
+/*
+    go checksum common
+
+    Copyright (c) 2014-2015 Dingjun Fang
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License version 3 as
+	published by the Free Software Foundation.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+package checksum_common
+
+import (
+	"crypto/md5"
+	"crypto/sha1"
+	"crypto/sha256"
+	"crypto/sha512"
+	"hash"
+	"sort"
+	"strings"
+	"sync"
+)
+
+/*
+   constructors for every type of checksum, by the name the tools pass as
+   t. more can be added with RegisterHash.
+*/
+var hash_types = map[string]func() hash.Hash{
+	"md5":    md5.New,
+	"sha1":   sha1.New,
+	"sha224": sha256.New224,
+	"sha256": sha256.New,
+	"sha384": sha512.New384,
+	"sha512": sha512.New,
+}
+
+func init() {
+	for _, t := range HashTypes() {
+		hash_types[t+"-tree"] = TreeHash(hash_types[t])
+	}
+}
+
+/*
+   make a type of checksum available to every tool, under the name t. this
+   is how algorithms outside the standard library, BLAKE2 or xxHash for
+   example, are plugged in: register them from an init function and select
+   them with cksum -a. register TreeHash(fn) as t+"-tree" as well to give
+   them a tree hash mode.
+
+   it must be called before any checksum is computed, and t is folded to
+   lower case, since tagged checksum lines name the type in upper case.
+*/
+func RegisterHash(t string, fn func() hash.Hash) {
+	hash_types[strings.ToLower(t)] = fn
+}
+
+/*
+   return the names of all registered checksum types, sorted
+*/
+func HashTypes() []string {
+	var types []string
+	for t := range hash_types {
+		types = append(types, t)
+	}
+	sort.Strings(types)
+	return types
+}
+
+/*
+   return a new hash.Hash for the type of checksum t, or nil if t is unknown
+*/
+func new_hash(t string) hash.Hash {
+	fn, ok := hash_types[t]
+	if !ok {
+		return nil
+	}
+	return fn()
+}
+
+/*
+   a writer that hands every write to each of its hashes, so a file can be
+   digested several ways in one pass. large writes are hashed by all of
+   them concurrently, which makes the pass about as slow as the slowest
+   hash rather than all of them added up.
+*/
+type fanout []hash.Hash
+
+/*
+   writes smaller than this aren't worth starting goroutines for
+*/
+const fanout_min = 64 * 1024
+
+func (f fanout) Write(p []byte) (int, error) {
+	if len(f) == 1 || len(p) < fanout_min {
+		for _, m := range f {
+			m.Write(p)
+		}
+		return len(p), nil
+	}
+	var wg sync.WaitGroup
+	wg.Add(len(f) - 1)
+	for _, m := range f[1:] {
+		go func(m hash.Hash) {
+			m.Write(p)
+			wg.Done()
+		}(m)
+	}
+	f[0].Write(p)
+	wg.Wait()
+	return len(p), nil
+}
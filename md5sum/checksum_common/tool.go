@@ -0,0 +1,80 @@
+/*
+    go checksum common
+
+    Copyright (c) 2014-2015 Dingjun Fang
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License version 3 as
+	published by the Free Software Foundation.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+package checksum_common
+
+import (
+	"fmt"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+/*
+   return the tool for the type of checksum t, md5sum for "md5" and so on,
+   for md5sum and the sha*sum tools to register as themselves. help and
+   version are what it prints for --help and --version.
+*/
+func Tool(t, help, version string) coreutils.Runnable {
+	return func(ctx coreutils.Context, args ...string) error {
+		var (
+			f                                 flag.FlagSet
+			check_sum, no_output, status      bool
+			show_warn, show_version           bool
+			text_mode, binary_mode, tree_mode bool
+		)
+		f.BoolVarP(&check_sum, "check", "c", false, "")
+		f.BoolVarP(&no_output, "quiet", "q", false, "")
+		f.BoolVar(&status, "status", false, "")
+		f.BoolVarP(&show_warn, "warn", "w", true, "")
+		f.BoolVarP(&show_version, "version", "v", false, "")
+		f.BoolVarP(&text_mode, "text", "t", false, "")
+		f.BoolVarP(&binary_mode, "binary", "b", false, "")
+		f.BoolVar(&tree_mode, "tree", false, "")
+		f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", help) }
+		if err := f.Parse(args); err != nil {
+			return err
+		}
+
+		/* trust --status and --quiet as the same */
+		o := Options{Ctx: ctx, Quiet: no_output || status, Warn: show_warn}
+
+		file_lists := f.Args()
+		if len(file_lists) == 0 {
+			file_lists = append(file_lists, "-")
+		}
+
+		var ok bool
+		switch {
+		case show_version:
+			fmt.Fprintf(ctx.Stdout, "%s", version)
+			return nil
+		case check_sum:
+			ok = CompareChecksum(o, file_lists, t)
+		case tree_mode:
+			ok = GenerateTree(o, file_lists, t)
+		default:
+			ok = GenerateChecksum(o, file_lists, t)
+		}
+
+		if !ok {
+			return coreutils.ExitCode(1)
+		}
+		return nil
+	}
+}
@@ -0,0 +1,162 @@
+/*
+    go checksum common
+
+    Copyright (c) 2014-2015 Dingjun Fang
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License version 3 as
+	published by the Free Software Foundation.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+package checksum_common
+
+import (
+	"encoding/binary"
+	"hash"
+	"runtime"
+	"sync"
+)
+
+/*
+   size of a tree hash's leaves. it's part of the definition of every tree
+   checksum, so changing it changes all of them.
+*/
+const tree_chunk = 1 << 20
+
+var tree_bufs = sync.Pool{
+	New: func() interface{} {
+		b := make([]byte, tree_chunk)
+		return &b
+	},
+}
+
+/*
+   a tree hash splits its input into tree_chunk byte leaves and hashes them
+   concurrently, so a single huge file isn't bound to one core's speed. the
+   root is the hash of all the leaf hashes, in order, followed by the
+   input's length:
+
+	leaf = H(0x00 || chunk)
+	root = H(0x01 || leaf... || uint64 big endian length)
+
+   an empty input has one, empty, leaf. the leading bytes keep a leaf from
+   ever being mistaken for a root. tree checksums are registered as
+   "TYPE-tree" and printed with that tag, and they don't match the plain
+   digest of the same file.
+*/
+type tree_hash struct {
+	fn     func() hash.Hash
+	leaves []*tree_leaf
+	buf    *[]byte /* the chunk being filled, nil if none */
+	n      int     /* bytes in buf */
+	size   uint64
+	sem    chan struct{} /* limits the chunks being hashed at once */
+	wg     sync.WaitGroup
+}
+
+type tree_leaf struct {
+	sum []byte
+}
+
+/*
+   return a constructor for tree hashes built from the hash fn returns
+*/
+func TreeHash(fn func() hash.Hash) func() hash.Hash {
+	return func() hash.Hash {
+		return &tree_hash{
+			fn:  fn,
+			sem: make(chan struct{}, 2*runtime.NumCPU()),
+		}
+	}
+}
+
+func (t *tree_hash) Write(p []byte) (int, error) {
+	n := len(p)
+	for len(p) > 0 {
+		if t.buf == nil {
+			t.sem <- struct{}{}
+			t.buf = tree_bufs.Get().(*[]byte)
+			t.n = 0
+		}
+		m := copy((*t.buf)[t.n:], p)
+		t.n += m
+		p = p[m:]
+		if t.n == tree_chunk {
+			t.hash_chunk()
+		}
+	}
+	t.size += uint64(n)
+	return n, nil
+}
+
+/*
+   hash the full chunk in buf in the background
+*/
+func (t *tree_hash) hash_chunk() {
+	leaf := new(tree_leaf)
+	t.leaves = append(t.leaves, leaf)
+	t.wg.Add(1)
+	go func(buf *[]byte) {
+		leaf.sum = t.leaf(*buf, nil)
+		tree_bufs.Put(buf)
+		<-t.sem
+		t.wg.Done()
+	}(t.buf)
+	t.buf = nil
+	t.n = 0
+}
+
+func (t *tree_hash) leaf(chunk, b []byte) []byte {
+	m := t.fn()
+	m.Write([]byte{0})
+	m.Write(chunk)
+	return m.Sum(b)
+}
+
+/*
+   waits for the leaves hashed so far. like every hash.Hash, more can be
+   written afterwards.
+*/
+func (t *tree_hash) Sum(b []byte) []byte {
+	t.wg.Wait()
+	root := t.fn()
+	root.Write([]byte{1})
+	for _, l := range t.leaves {
+		root.Write(l.sum)
+	}
+	if t.n > 0 || len(t.leaves) == 0 {
+		var chunk []byte
+		if t.buf != nil {
+			chunk = (*t.buf)[:t.n]
+		}
+		root.Write(t.leaf(chunk, nil))
+	}
+	var size [8]byte
+	binary.BigEndian.PutUint64(size[:], t.size)
+	root.Write(size[:])
+	return root.Sum(b)
+}
+
+func (t *tree_hash) Reset() {
+	t.wg.Wait()
+	if t.buf != nil {
+		tree_bufs.Put(t.buf)
+		<-t.sem
+		t.buf = nil
+	}
+	t.leaves = t.leaves[:0]
+	t.n = 0
+	t.size = 0
+}
+
+func (t *tree_hash) Size() int { return t.fn().Size() }
+
+func (t *tree_hash) BlockSize() int { return t.fn().BlockSize() }
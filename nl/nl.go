@@ -12,52 +12,84 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
-
-import "os"
-import "fmt"
-import "io/ioutil"
-import "strings"
-import flag "github.com/ogier/pflag"
-
-func main() {
-	bFlag := flag.StringP("body-numbering", "b", "t", "style")
-	flag.Parse()
-	if len(flag.Args()) == 0 {
-		bytes, _ := ioutil.ReadAll(os.Stdin)
-		lines := strings.Split(string(bytes), "\n")
-		linecount := 0
-		for i := 0; i < len(lines)-1; i++ {
-			if *bFlag == "t" {
-				if len(strings.TrimSpace(lines[i])) > 0 {
-					linecount++
-					fmt.Printf("%6d  %s\n", linecount, lines[i])
-				} else {
-					fmt.Println(lines[i])
-				}
-			} else {
-				linecount++
-				fmt.Printf("%6d  %s\n", linecount, lines[i])
-			}
+package nl
+
+import (
+	"bufio"
+	"bytes"
+	"fmt"
+	"io"
+	"os"
+	"strconv"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/lines"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("nl", run)
+}
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f     flag.FlagSet
+		style string
+	)
+	f.StringVarP(&style, "body-numbering", "b", "t", "style")
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "nl: %v\n", err)
 		}
-	} else if len(flag.Args()) > 0 {
-		linecount := 0
-		for j := 0; j < len(flag.Args()); j++ {
-			bytes, _ := ioutil.ReadFile(flag.Arg(j))
-			lines := strings.Split(string(bytes), "\n")
-			for i := 0; i < len(lines)-1; i++ {
-				if *bFlag == "t" {
-					if len(strings.TrimSpace(lines[i])) > 0 {
-						linecount++
-						fmt.Printf("%6d  %s\n", linecount, lines[i])
-					} else {
-						fmt.Println(lines[i])
-					}
-				} else {
-					linecount++
-					fmt.Printf("%6d  %s\n", linecount, lines[i])
+	}()
+
+	w := bufio.NewWriterSize(ctx.Stdout, coreutils.BufferSize)
+	n := 0
+	number := func(r io.Reader) error {
+		lr := lines.NewReader(r, '\n')
+		for {
+			line, err := lr.Next()
+			if err == io.EOF {
+				return nil
+			}
+			if err != nil {
+				return err
+			}
+			if style != "t" || len(bytes.TrimSpace(line)) > 0 {
+				n++
+				var num [20]byte
+				b := strconv.AppendInt(num[:0], int64(n), 10)
+				for i := len(b); i < 6; i++ {
+					w.WriteByte(' ')
 				}
+				w.Write(b)
+				w.WriteString("  ")
 			}
+			w.Write(line)
+			w.WriteByte('\n')
 		}
 	}
+
+	if f.NArg() == 0 {
+		err = number(ctx.Stdin)
+	}
+	for _, name := range f.Args() {
+		file, err := os.Open(name)
+		if err != nil {
+			return err
+		}
+		err = number(file)
+		file.Close()
+		if err != nil {
+			return err
+		}
+	}
+	if ferr := w.Flush(); err == nil {
+		err = ferr
+	}
+	return err
 }
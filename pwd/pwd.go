@@ -17,7 +17,7 @@
 	Written by Robert Deusser <iamthemuffinman@outlook.com>
 */
 
-package main
+package pwd
 
 import (
 	"fmt"
@@ -26,9 +26,14 @@ import (
 	"sync"
 	"syscall"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("pwd", run)
+}
+
 const (
 	Help = `
 NAME
@@ -88,12 +93,6 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	logical  = flag.BoolP("logical", "L", false, "")
-	physical = flag.BoolP("physical", "P", false, "")
-	version  = flag.BoolP("version", "V", false, "")
-)
-
 // From here till main is the Getwd function from the os package rewritten to NOT follow symlinks
 
 var getwdCache struct {
@@ -208,34 +207,44 @@ func GetwdWithoutSymlinks() (dir string, err error) {
 	return dir, nil
 }
 
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f                 flag.FlagSet
+		logical, physical bool
+		version           bool
+	)
+	f.BoolVarP(&logical, "logical", "L", false, "")
+	f.BoolVarP(&physical, "physical", "P", false, "")
+	f.BoolVarP(&version, "version", "V", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
-	flag.Parse()
 
-	switch {
-	case *version:
-		fmt.Fprintf(os.Stdout, "%s", Version)
-		os.Exit(0)
-	case *logical:
-		dir, err := os.Getwd()
-		if err != nil {
-			os.Exit(1)
-		}
-		fmt.Println(dir)
-	case *physical:
-		dir, err := GetwdWithoutSymlinks()
+	defer func() {
 		if err != nil {
-			os.Exit(1)
+			fmt.Fprintf(ctx.Stderr, "pwd: %v\n", err)
 		}
-		fmt.Println(dir)
+	}()
+
+	if version {
+		fmt.Fprintf(ctx.Stdout, "%s", Version)
+		return nil
+	}
+
+	var dir string
+	switch {
+	case ctx.Dir != "":
+		// Run in-process, the directory it was given is its own.
+		dir = ctx.Dir
+	case logical && !physical:
+		dir, err = os.Getwd()
 	default:
-		dir, err := GetwdWithoutSymlinks()
-		if err != nil {
-			os.Exit(1)
-		}
-		fmt.Println(dir)
+		dir, err = GetwdWithoutSymlinks()
+	}
+	if err != nil {
+		return err
 	}
+	_, err = fmt.Fprintln(ctx.Stdout, dir)
+	return err
 }
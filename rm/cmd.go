@@ -17,10 +17,10 @@ func init() {
 // without multi-character options. (e.g., if we want -i but not --i.)
 const (
 	uniNonChar   = 0xFDD0
-	interDefault = string(uniNonChar + 1)
-	bad1         = string(uniNonChar + 2)
-	bad2         = string(uniNonChar + 3)
-	bad3         = string(uniNonChar + 4)
+	interDefault = string(rune(uniNonChar + 1))
+	bad1         = string(rune(uniNonChar + 2))
+	bad2         = string(rune(uniNonChar + 3))
+	bad3         = string(rune(uniNonChar + 4))
 )
 
 func newCommand() *cmd {
@@ -54,7 +54,11 @@ type cmd struct {
 	version              bool
 }
 
-func run(ctx coreutils.Context, args ...string) error {
+// logBufSize is how much of the verbose log is buffered before rm waits for
+// it to be written.
+const logBufSize = 64 * 1024
+
+func run(ctx coreutils.Context, args ...string) (err error) {
 	c := newCommand()
 	if err := c.f.Parse(args); err != nil {
 		return err
@@ -146,11 +150,14 @@ func run(ctx coreutils.Context, args ...string) error {
 		}
 	}
 
-	if r.Log != nil {
-		defer close(r.Log)
-		go func() {
-			for msg := range r.Log {
-				fmt.Fprintln(ctx.Stdout, msg)
+	if r.opts&Verbose != 0 {
+		r.Log = NewLogSink(ctx.Stdout, logBufSize, Block)
+		defer func() {
+			if cerr := r.Log.Close(); err == nil {
+				err = cerr
+			}
+			if n := r.Log.Dropped(); n > 0 {
+				fmt.Fprintf(ctx.Stderr, "rm: %d log records dropped\n", n)
 			}
 		}()
 	}
@@ -0,0 +1,146 @@
+package rm
+
+import (
+	"io"
+	"sync"
+)
+
+// Backpressure decides what a LogSink does with a record when its buffer is
+// full because the writer can't keep up.
+type Backpressure uint8
+
+const (
+	// Block makes the caller wait until the buffer has been handed to the
+	// writer. No record is lost.
+	Block Backpressure = iota
+	// Drop discards the record and counts it, so removal never waits on the
+	// log.
+	Drop
+)
+
+// LogSink collects the records of a verbose Remover and writes them out in
+// chunks from its own goroutine. Records are formatted straight into a
+// buffer, so logging a removal doesn't allocate and, unless the buffer is
+// full, doesn't wait for anything but a short critical section. That lets
+// removeTree's workers log without serializing on the writer.
+//
+// While one buffer is being written, records are added to a second one; the
+// two are swapped each time the writer is done.
+type LogSink struct {
+	w      io.Writer
+	size   int
+	policy Backpressure
+
+	mu      sync.Mutex
+	ready   sync.Cond // signalled when buf has records
+	space   sync.Cond // signalled when buf has been handed off
+	buf     []byte
+	spare   []byte
+	dropped int64
+	closed  bool
+	name    []byte // the name being logged, before it's quoted
+
+	err  error // only touched by the writing goroutine until done is closed
+	done chan struct{}
+}
+
+// NewLogSink returns a LogSink that writes to w, holding at most about size
+// bytes of records before applying policy.
+func NewLogSink(w io.Writer, size int, policy Backpressure) *LogSink {
+	s := &LogSink{
+		w:      w,
+		size:   size,
+		policy: policy,
+		buf:    make([]byte, 0, size),
+		spare:  make([]byte, 0, size),
+		done:   make(chan struct{}),
+	}
+	s.ready.L = &s.mu
+	s.space.L = &s.mu
+	go s.flush()
+	return s
+}
+
+// Removed logs the removal of name.
+func (s *LogSink) Removed(name string, dir bool) {
+	s.add(dir, name, nil)
+}
+
+// add logs the removal of path, or of name inside the directory path if name
+// isn't nil.
+func (s *LogSink) add(dir bool, path string, name []byte) {
+	prefix := "removed "
+	if dir {
+		prefix = "removed directory "
+	}
+	sep := name != nil && (len(path) == 0 || path[len(path)-1] != '/')
+	n := len(prefix) + len(path) + len(name) + 4
+
+	s.mu.Lock()
+	for len(s.buf) > 0 && len(s.buf)+n > s.size {
+		if s.policy == Drop {
+			s.dropped++
+			s.mu.Unlock()
+			return
+		}
+		s.space.Wait()
+	}
+	wake := len(s.buf) == 0
+	s.name = append(s.name[:0], path...)
+	if sep {
+		s.name = append(s.name, '/')
+	}
+	s.name = append(s.name, name...)
+	s.buf = append(s.buf, prefix...)
+	s.buf = appendQuote(s.buf, s.name)
+	s.buf = append(s.buf, '\n')
+	s.mu.Unlock()
+	if wake {
+		s.ready.Signal()
+	}
+}
+
+func (s *LogSink) flush() {
+	defer close(s.done)
+	s.mu.Lock()
+	for {
+		for len(s.buf) == 0 && !s.closed {
+			s.ready.Wait()
+		}
+		if len(s.buf) == 0 {
+			s.mu.Unlock()
+			return
+		}
+		p := s.buf
+		s.buf, s.spare = s.spare[:0], nil
+		s.space.Broadcast()
+		s.mu.Unlock()
+
+		// After a failed write the rest of the log is discarded, so
+		// callers never block on a broken writer.
+		if s.err == nil {
+			_, s.err = s.w.Write(p)
+		}
+
+		s.mu.Lock()
+		s.spare = p[:0]
+	}
+}
+
+// Close writes out the records left in the buffer and returns the first
+// error from the writer, if any. Nothing may be logged after Close.
+func (s *LogSink) Close() error {
+	s.mu.Lock()
+	s.closed = true
+	s.mu.Unlock()
+	s.ready.Signal()
+	<-s.done
+	return s.err
+}
+
+// Dropped returns the number of records discarded by the Drop policy.
+func (s *LogSink) Dropped() int64 {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return s.dropped
+}
@@ -0,0 +1,84 @@
+package rm
+
+import (
+	"strings"
+	"unicode"
+	"unicode/utf8"
+)
+
+// appendQuote appends s to dst quoted as GNU rm quotes names: in single
+// quotes, which are closed around each single quote in s, written as \', and
+// around anything unprintable, written as $'...' escapes. A name whose only
+// awkward character is a single quote is put in double quotes instead.
+func appendQuote(dst, s []byte) []byte {
+	single, plain := false, true
+	for _, c := range s {
+		switch {
+		case c == '\'':
+			single = true
+		case c >= 'a' && c <= 'z', c >= 'A' && c <= 'Z', c >= '0' && c <= '9':
+		case c != 0 && strings.IndexByte(" %+,-./:@]_", c) >= 0:
+		default:
+			plain = false
+		}
+	}
+	if single && plain {
+		dst = append(dst, '"')
+		dst = append(dst, s...)
+		return append(dst, '"')
+	}
+
+	dst = append(dst, '\'')
+	open := true
+	for i := 0; i < len(s); {
+		r, size := utf8.DecodeRune(s[i:])
+		switch {
+		case r == utf8.RuneError && size == 1 || r != ' ' && !unicode.IsPrint(r):
+			if open {
+				dst = append(dst, "'$'"...)
+				open = false
+			} else {
+				// Carry on with the previous $'...'.
+				dst = dst[:len(dst)-1]
+			}
+			for _, c := range s[i : i+size] {
+				dst = appendEscape(dst, c)
+			}
+			dst = append(dst, '\'')
+		case !open:
+			dst = append(dst, '\'')
+			open = true
+			continue
+		case r == '\'':
+			dst = append(dst, `'\''`...)
+		default:
+			dst = append(dst, s[i:i+size]...)
+		}
+		i += size
+	}
+	if open {
+		dst = append(dst, '\'')
+	}
+	return dst
+}
+
+// appendEscape appends c as it's written inside $'...'.
+func appendEscape(dst []byte, c byte) []byte {
+	switch c {
+	case '\a':
+		return append(dst, `\a`...)
+	case '\b':
+		return append(dst, `\b`...)
+	case '\f':
+		return append(dst, `\f`...)
+	case '\n':
+		return append(dst, `\n`...)
+	case '\r':
+		return append(dst, `\r`...)
+	case '\t':
+		return append(dst, `\t`...)
+	case '\v':
+		return append(dst, `\v`...)
+	}
+	return append(dst, '\\', '0'+c>>6, '0'+c>>3&7, '0'+c&7)
+}
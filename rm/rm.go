@@ -39,11 +39,7 @@ const (
 )
 
 func NewRemover(opts RemoveOption) *Remover {
-	r := Remover{opts: opts}
-	if opts&Verbose != 0 {
-		r.Log = make(chan string)
-	}
-	return &r
+	return &Remover{opts: opts}
 }
 
 type Remover struct {
@@ -54,7 +50,13 @@ type Remover struct {
 	// options. If it returns true, the action continues, otherwise it stops.
 	Prompt func(name string, opts PromptOption) bool
 
-	Log chan string
+	// Log, if non-nil, receives a record of each removed object when the
+	// Remover is verbose.
+	Log *LogSink
+
+	// Workers is the number of goroutines that remove a directory tree when
+	// no prompting is needed. Zero means one for each CPU.
+	Workers int
 
 	stack []node
 }
@@ -78,6 +80,13 @@ func (r *Remover) Remove(path string) (err error) {
 		return nil
 	}
 
+	if r.opts&PromptAlways == 0 && canRemoveTree {
+		if err := r.checkDir(path, r.root); err != nil {
+			return err
+		}
+		return r.removeTree(path, r.root)
+	}
+
 	// GNU rm uses a DFS that, once it reaches a leaf node (doesn't contain any
 	// further directories), clears out all files and "walks back" to the most
 	// recently seen non-leaf node. This is typicall DFS behavior, but the
@@ -190,11 +199,30 @@ func (r *Remover) rm(name string, dir bool) (err error) {
 	if err != nil && (r.opts&IgnoreMissing == 0 || !os.IsNotExist(err)) {
 		return err
 	}
-	if r.opts&Verbose != 0 {
-		if dir {
-			r.Log <- fmt.Sprintf("removed directory %s")
-		} else {
-			r.Log <- fmt.Sprintf("removed %s")
+	r.log(name, dir)
+	return nil
+}
+
+// log reports a removed object if the Remover is verbose. It's safe to call
+// from multiple goroutines.
+func (r *Remover) log(name string, dir bool) {
+	if r.opts&Verbose != 0 && r.Log != nil {
+		r.Log.Removed(name, dir)
+	}
+}
+
+// checkDir refuses to remove directories POSIX (or --preserve-root) doesn't
+// allow to be removed.
+func (r *Remover) checkDir(path string, info os.FileInfo) error {
+	switch info.Name() {
+	// POSIX doesn't let us do anything with . or ..
+	case ".", "..":
+		return rmError{msg: "cannot remove '.' or '..'"}
+	case "/":
+		return rmError{msg: "cannot remove root directory"}
+	default:
+		if r.opts&NoPreserveRoot == 0 && sys.IsRoot(info) {
+			return rmError{msg: "cannot remove root directory"}
 		}
 	}
 	return nil
@@ -202,16 +230,8 @@ func (r *Remover) rm(name string, dir bool) (err error) {
 
 func (r *Remover) remove(path string, info os.FileInfo) error {
 	if info.Mode()&os.ModeDir != 0 {
-		switch info.Name() {
-		// POSIX doesn't let us do anything with . or ..
-		case ".", "..":
-			return rmError{msg: "cannot remove '.' or '..'"}
-		case "/":
-			return rmError{msg: "cannot remove root directory"}
-		default:
-			if r.opts&NoPreserveRoot == 0 && sys.IsRoot(info) {
-				return rmError{msg: "cannot remove root directory"}
-			}
+		if err := r.checkDir(path, info); err != nil {
+			return err
 		}
 		if r.opts&Recursive == 0 && (r.opts&RemoveEmpty == 0 || isEmpty(path)) {
 			return rmError{msg: fmt.Sprintf("cannot remove directory: %q", path)}
@@ -0,0 +1,277 @@
+package rm
+
+import (
+	"bytes"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
+)
+
+// makeTree creates a tree under root and returns the number of files and
+// directories in it, root included.
+func makeTree(t *testing.T, root, outside string) (files, dirs int) {
+	mkdir := func(path string) {
+		if err := os.Mkdir(path, 0755); err != nil {
+			t.Fatal(err)
+		}
+		dirs++
+	}
+	touch := func(path string) {
+		if err := ioutil.WriteFile(path, []byte(path), 0644); err != nil {
+			t.Fatal(err)
+		}
+		files++
+	}
+
+	mkdir(root)
+	// Enough long names to take several reads of the directory.
+	wide := filepath.Join(root, "wide")
+	mkdir(wide)
+	for i := 0; i < 2000; i++ {
+		touch(filepath.Join(wide, fmt.Sprintf("%s%05d", strings.Repeat("f", 40), i)))
+	}
+	deep := root
+	for i := 0; i < 30; i++ {
+		deep = filepath.Join(deep, "d")
+		mkdir(deep)
+		touch(filepath.Join(deep, "file"))
+	}
+	for i := 0; i < 20; i++ {
+		sub := filepath.Join(root, fmt.Sprintf("sub%d", i))
+		mkdir(sub)
+		mkdir(filepath.Join(sub, "empty"))
+		for j := 0; j < 10; j++ {
+			touch(filepath.Join(sub, fmt.Sprintf("f%d", j)))
+		}
+	}
+	// Symlinks are removed, never followed.
+	if err := os.Symlink(outside, filepath.Join(root, "link")); err != nil {
+		t.Fatal(err)
+	}
+	files++
+	return files, dirs
+}
+
+func TestRemoveRecursive(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "rm")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	outside := filepath.Join(tmp, "outside")
+	if err := os.Mkdir(outside, 0755); err != nil {
+		t.Fatal(err)
+	}
+	keep := filepath.Join(outside, "keep")
+	if err := ioutil.WriteFile(keep, nil, 0644); err != nil {
+		t.Fatal(err)
+	}
+
+	for _, tc := range []struct {
+		workers int
+		opts    RemoveOption
+	}{
+		{1, 0},
+		{4, 0},
+		{8, Verbose},
+	} {
+		root := filepath.Join(tmp, "tree")
+		files, dirs := makeTree(t, root, outside)
+
+		r := NewRemover(Recursive | tc.opts)
+		r.Workers = tc.workers
+		var log bytes.Buffer
+		if tc.opts&Verbose != 0 {
+			r.Log = NewLogSink(&log, 4096, Block)
+		}
+
+		if err := r.Remove(root); err != nil {
+			t.Fatalf("%+v: %v", tc, err)
+		}
+		if r.Log != nil {
+			if err := r.Log.Close(); err != nil {
+				t.Fatal(err)
+			}
+			var nfiles, ndirs int
+			for _, msg := range strings.SplitAfter(log.String(), "\n") {
+				switch {
+				case msg == "":
+				case strings.HasPrefix(msg, "removed directory '"+tmp):
+					ndirs++
+				case strings.HasPrefix(msg, "removed '"+tmp):
+					nfiles++
+				default:
+					t.Fatalf("%+v: bad log record: %q", tc, msg)
+				}
+			}
+			if nfiles != files || ndirs != dirs {
+				t.Errorf("%+v: logged %d files and %d directories, want %d and %d",
+					tc, nfiles, ndirs, files, dirs)
+			}
+		}
+		if _, err := os.Lstat(root); !os.IsNotExist(err) {
+			t.Fatalf("%+v: tree still exists: %v", tc, err)
+		}
+		if _, err := os.Stat(keep); err != nil {
+			t.Fatalf("%+v: followed a symlink: %v", tc, err)
+		}
+	}
+}
+
+func TestRemoveRecursiveError(t *testing.T) {
+	if os.Geteuid() == 0 {
+		t.Skip("permissions aren't enforced for root")
+	}
+	tmp, err := ioutil.TempDir("", "rm")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	locked := filepath.Join(tmp, "tree", "locked")
+	if err := os.MkdirAll(locked, 0755); err != nil {
+		t.Fatal(err)
+	}
+	if err := ioutil.WriteFile(filepath.Join(locked, "f"), nil, 0644); err != nil {
+		t.Fatal(err)
+	}
+	if err := os.Chmod(locked, 0555); err != nil {
+		t.Fatal(err)
+	}
+	defer os.Chmod(locked, 0755)
+
+	err = NewRemover(Recursive).Remove(filepath.Join(tmp, "tree"))
+	if !os.IsPermission(err) {
+		t.Fatalf("got %v, want a permission error", err)
+	}
+	if _, err := os.Stat(locked); err != nil {
+		t.Fatalf("directory above the error was removed: %v", err)
+	}
+}
+
+// stallWriter blocks every Write until release is closed.
+type stallWriter struct {
+	release chan struct{}
+	bytes.Buffer
+}
+
+func (w *stallWriter) Write(p []byte) (int, error) {
+	<-w.release
+	return w.Buffer.Write(p)
+}
+
+func TestLogSink(t *testing.T) {
+	for _, policy := range []Backpressure{Block, Drop} {
+		w := &stallWriter{release: make(chan struct{})}
+		s := NewLogSink(w, 64, policy)
+		const n = 100
+		done := make(chan struct{})
+		go func() {
+			for i := 0; i < n; i++ {
+				s.Removed(fmt.Sprintf("f%03d", i), i%2 == 0)
+			}
+			close(done)
+		}()
+		if policy == Drop {
+			// Nothing can be written yet, so most records must be
+			// dropped rather than waited for.
+			<-done
+		}
+		close(w.release)
+		<-done
+		if err := s.Close(); err != nil {
+			t.Fatal(err)
+		}
+
+		lines := strings.Split(strings.TrimSuffix(w.String(), "\n"), "\n")
+		if int64(len(lines))+s.Dropped() != n {
+			t.Fatalf("policy %d: %d lines and %d dropped, want %d in all",
+				policy, len(lines), s.Dropped(), n)
+		}
+		if policy == Block && s.Dropped() != 0 {
+			t.Fatalf("Block dropped %d records", s.Dropped())
+		}
+		if policy == Drop && s.Dropped() == 0 {
+			t.Fatal("Drop didn't drop anything")
+		}
+		last := -1
+		for _, line := range lines {
+			var i int
+			if _, err := fmt.Sscanf(line[strings.LastIndexByte(line, ' ')+1:], "'f%d'", &i); err != nil || i <= last {
+				t.Fatalf("policy %d: bad or out of order record %q", policy, line)
+			}
+			want := "removed 'f"
+			if i%2 == 0 {
+				want = "removed directory 'f"
+			}
+			if !strings.HasPrefix(line, want) {
+				t.Fatalf("policy %d: record %q doesn't start with %q", policy, line, want)
+			}
+			last = i
+		}
+	}
+}
+
+// TestQuote checks names are quoted in the log as GNU rm quotes them.
+func TestQuote(t *testing.T) {
+	for _, tc := range []struct {
+		name, want string
+	}{
+		{"f", "'f'"},
+		{"/tmp/a b", "'/tmp/a b'"},
+		{"-b", "'-b'"},
+		{"it's", `"it's"`},
+		{"d'q/f", `"d'q/f"`},
+		{"a'b'c", `"a'b'c"`},
+		{"it's $x", `'it'\''s $x'`},
+		{"can't!", `'can'\''t!'`},
+		{`q"'`, `'q"'\'''`},
+		{"nl\nx", `'nl'$'\n''x'`},
+		{"a\n", `'a'$'\n'`},
+		{"\nb", `''$'\n''b'`},
+		{"x\x01\x02y", `'x'$'\001\002''y'`},
+		{"tab\tx", `'tab'$'\t''x'`},
+		{"\xff", `''$'\377'`},
+		{"é", "'é'"},
+	} {
+		if got := string(appendQuote(nil, []byte(tc.name))); got != tc.want {
+			t.Errorf("%q: got %s, want %s", tc.name, got, tc.want)
+		}
+	}
+}
+
+// BenchmarkRemove removes a tree of many small files, with one worker and
+// with the default of one per CPU. Each tree is written with the timer
+// stopped.
+func BenchmarkRemove(b *testing.B) {
+	tmp, err := ioutil.TempDir("", "rm")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	const files = 5000
+	for _, workers := range []int{1, 0} {
+		b.Run(fmt.Sprintf("workers=%d", workers), func(b *testing.B) {
+			r := NewRemover(Recursive | Force)
+			r.Workers = workers
+			for i := 0; i < b.N; i++ {
+				b.StopTimer()
+				root := filepath.Join(tmp, "tree")
+				if _, err := benchdata.WriteFiles(root, files, 64); err != nil {
+					b.Fatal(err)
+				}
+				b.StartTimer()
+				if err := r.Remove(root); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
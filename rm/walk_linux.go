@@ -0,0 +1,251 @@
+package rm
+
+import (
+	"os"
+	"runtime"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"unsafe"
+
+	"github.com/ericlagergren/go-coreutils/internal/walk"
+	"golang.org/x/sys/unix"
+)
+
+// canRemoveTree reports whether removeTree is implemented on this platform.
+const canRemoveTree = true
+
+// removeTree removes the directory tree rooted at path without prompting.
+//
+// Unlike the DFS in Remove, every directory is opened exactly once, and its
+// entries are read with getdents(2). Entries whose type the filesystem
+// reports are never stat'ed: anything that isn't a directory is unlinked
+// straight away with unlinkat(2), relative to the directory's descriptor,
+// using the name in the getdents buffer. Subdirectories are queued and
+// removed by a walk.Pool of workers, and a directory is removed once its
+// last subdirectory is.
+//
+// An open descriptor is kept for every directory whose subtree is still
+// being removed, so the number of descriptors in use grows with the depth of
+// the tree and the number of workers, not with its size.
+//
+// Like the DFS, removal stops at the first error, which is returned.
+func (r *Remover) removeTree(path string, info os.FileInfo) error {
+	n := r.Workers
+	if n < 1 {
+		n = runtime.NumCPU()
+	}
+	e := &engine{
+		r:       r,
+		workers: make([]worker, n),
+		rootDev: uint64(info.Sys().(*syscall.Stat_t).Dev),
+	}
+	e.pool = walk.NewPool(n, func(i int, job interface{}) {
+		e.scan(&e.workers[i], job.(*dir))
+	})
+	for i := range e.workers {
+		e.workers[i].id = i
+	}
+
+	root := &dir{name: path, path: path, fd: -1}
+	e.push(&e.workers[0], root)
+	e.pool.Run()
+	return e.err
+}
+
+// dir is a directory being removed.
+type dir struct {
+	parent *dir
+	name   string // relative to parent, or the path given to Remove
+	path   string // for errors and the log
+	fd     int
+
+	// left counts what must finish before the directory can be removed:
+	// reading its entries, and each subdirectory found so far.
+	left int32
+	// kept is set if anything underneath the directory wasn't removed.
+	kept int32
+}
+
+func (d *dir) dirfd() int {
+	if d.parent == nil {
+		return unix.AT_FDCWD
+	}
+	return d.parent.fd
+}
+
+func (d *dir) join(name string) string {
+	if len(d.path) > 0 && d.path[len(d.path)-1] == '/' {
+		return d.path + name
+	}
+	return d.path + "/" + name
+}
+
+type worker struct {
+	id  int
+	buf []byte
+}
+
+type engine struct {
+	r       *Remover
+	pool    *walk.Pool
+	workers []worker
+	rootDev uint64
+
+	mu   sync.Mutex // guards err
+	err  error
+	stop int32
+}
+
+func (e *engine) fail(err error) {
+	e.mu.Lock()
+	if e.err == nil {
+		e.err = err
+	}
+	e.mu.Unlock()
+	atomic.StoreInt32(&e.stop, 1)
+}
+
+func (e *engine) push(w *worker, d *dir) {
+	atomic.AddInt32(&d.left, 1) // reading its entries
+	if d.parent != nil {
+		atomic.AddInt32(&d.parent.left, 1)
+	}
+	e.pool.Push(w.id, d)
+}
+
+// scan opens d, removes everything in it that isn't a directory and queues
+// the directories.
+func (e *engine) scan(w *worker, d *dir) {
+	if atomic.LoadInt32(&e.stop) != 0 {
+		atomic.StoreInt32(&d.kept, 1)
+		e.finish(d)
+		return
+	}
+
+	fd, err := unix.Openat(d.dirfd(), d.name,
+		unix.O_RDONLY|unix.O_DIRECTORY|unix.O_NOFOLLOW|unix.O_CLOEXEC, 0)
+	if err != nil {
+		if err != unix.ENOENT || e.r.opts&IgnoreMissing == 0 {
+			e.fail(&os.PathError{Op: "open", Path: d.path, Err: err})
+			atomic.StoreInt32(&d.kept, 1)
+		}
+		d.fd = -1
+		e.finish(d)
+		return
+	}
+	d.fd = fd
+
+	if e.r.opts&OneFileSystem != 0 {
+		var stat unix.Stat_t
+		if err := unix.Fstat(fd, &stat); err != nil {
+			e.fail(&os.PathError{Op: "stat", Path: d.path, Err: err})
+			atomic.StoreInt32(&d.kept, 1)
+		} else if uint64(stat.Dev) != e.rootDev {
+			e.fail(rmError{msg: "cannot recurse into a different filesystem"})
+			atomic.StoreInt32(&d.kept, 1)
+		}
+		if atomic.LoadInt32(&d.kept) != 0 {
+			e.finish(d)
+			return
+		}
+	}
+
+	if w.buf == nil {
+		w.buf = make([]byte, walk.BufSize)
+	}
+	err = walk.ReadDir(fd, w.buf, func(name []byte, typ uint8) bool {
+		return atomic.LoadInt32(&e.stop) == 0 && e.entry(w, d, name, typ)
+	})
+	if err != nil {
+		e.fail(&os.PathError{Op: "readdirent", Path: d.path, Err: err})
+	}
+	if atomic.LoadInt32(&e.stop) != 0 {
+		atomic.StoreInt32(&d.kept, 1)
+	}
+	e.finish(d)
+}
+
+// entry removes d's entry name if it isn't a directory, and queues it if it
+// is. It returns false if removal has to stop.
+func (e *engine) entry(w *worker, d *dir, name []byte, typ uint8) bool {
+	if typ == unix.DT_UNKNOWN {
+		var stat unix.Stat_t
+		err := unix.Fstatat(d.fd, string(name), &stat, unix.AT_SYMLINK_NOFOLLOW)
+		switch {
+		case err == nil && stat.Mode&unix.S_IFMT == unix.S_IFDIR:
+			typ = unix.DT_DIR
+		case err == unix.ENOENT && e.r.opts&IgnoreMissing != 0:
+			return true
+		case err != nil:
+			e.fail(&os.PathError{Op: "stat", Path: d.join(string(name)), Err: err})
+			atomic.StoreInt32(&d.kept, 1)
+			return false
+		}
+	}
+
+	if typ != unix.DT_DIR {
+		// The name is followed by its NUL, so it can be passed to the
+		// kernel as is.
+		err := unlinkat(d.fd, name[:len(name)+1], 0)
+		if err == nil {
+			if e.r.opts&Verbose != 0 && e.r.Log != nil {
+				e.r.Log.add(false, d.path, name)
+			}
+			return true
+		}
+		if err == unix.ENOENT && e.r.opts&IgnoreMissing != 0 {
+			return true
+		}
+		if err != unix.EISDIR {
+			e.fail(&os.PathError{Op: "remove", Path: d.join(string(name)), Err: err})
+			atomic.StoreInt32(&d.kept, 1)
+			return false
+		}
+		// It was replaced by a directory after it was listed.
+	}
+
+	s := string(name)
+	e.push(w, &dir{parent: d, name: s, path: d.join(s), fd: -1})
+	return true
+}
+
+// finish marks one of the things d was waiting for as done, and removes d
+// if it was the last. Removing d may in turn finish its parent.
+func (e *engine) finish(d *dir) {
+	for d != nil && atomic.AddInt32(&d.left, -1) == 0 {
+		if d.fd >= 0 {
+			unix.Close(d.fd)
+		}
+		parent := d.parent
+		if atomic.LoadInt32(&d.kept) != 0 {
+			if parent != nil {
+				atomic.StoreInt32(&parent.kept, 1)
+			}
+		} else if d.fd >= 0 {
+			err := unix.Unlinkat(d.dirfd(), d.name, unix.AT_REMOVEDIR)
+			switch {
+			case err == nil:
+				e.r.log(d.path, true)
+			case err == unix.ENOENT && e.r.opts&IgnoreMissing != 0:
+			default:
+				e.fail(&os.PathError{Op: "remove", Path: d.path, Err: err})
+				if parent != nil {
+					atomic.StoreInt32(&parent.kept, 1)
+				}
+			}
+		}
+		d = parent
+	}
+}
+
+// unlinkat is unix.Unlinkat for a NUL-terminated name, which saves copying
+// the name for every file removed.
+func unlinkat(dirfd int, name []byte, flags int) error {
+	_, _, errno := unix.Syscall(unix.SYS_UNLINKAT, uintptr(dirfd),
+		uintptr(unsafe.Pointer(&name[0])), uintptr(flags))
+	if errno != 0 {
+		return errno
+	}
+	return nil
+}
@@ -0,0 +1,12 @@
+// +build !linux
+
+package rm
+
+import "os"
+
+// canRemoveTree reports whether removeTree is implemented on this platform.
+const canRemoveTree = false
+
+func (r *Remover) removeTree(path string, info os.FileInfo) error {
+	panic("unreachable")
+}
@@ -12,46 +12,64 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package seq
 
 import (
-	"os"
+	"bufio"
+	"errors"
+	"fmt"
 	"strconv"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
 )
-import "fmt"
 
-func main() {
+func init() {
+	coreutils.Register("seq", run)
+}
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	defer func() {
+		if err != nil {
+			fmt.Fprintln(ctx.Stderr, "seq:", err)
+		}
+	}()
+
 	// TODO: Also handle floats.
 	start, inc, end := 1, 1, 0
-	nargs := len(os.Args)
+	nargs := len(args)
 	switch nargs {
-	case 4:
-		inc = parseInt(os.Args[2])
-		fallthrough
 	case 3:
-		start = parseInt(os.Args[1])
+		if inc, err = strconv.Atoi(args[1]); err != nil {
+			return err
+		}
 		fallthrough
 	case 2:
-		end = parseInt(os.Args[nargs-1])
+		if start, err = strconv.Atoi(args[0]); err != nil {
+			return err
+		}
+		fallthrough
+	case 1:
+		if end, err = strconv.Atoi(args[nargs-1]); err != nil {
+			return err
+		}
 	default:
-		msg := "missing operand"
-		if nargs > 4 {
-			msg = fmt.Sprintf("extra operand '%s'", os.Args[4])
+		if nargs > 3 {
+			return fmt.Errorf("extra operand '%s'", args[3])
 		}
-		fmt.Println("seq:", msg)
-		os.Exit(1)
+		return errors.New("missing operand")
 	}
-
-	for i := start; i <= end; i += inc {
-		fmt.Println(i)
+	if inc == 0 {
+		return fmt.Errorf("invalid Zero increment value: '%s'", args[1])
 	}
-}
 
-func parseInt(a string) int {
-	i, err := strconv.Atoi(a)
-	if err != nil {
-		fmt.Println("seq:", err)
-		os.Exit(1)
+	w := bufio.NewWriter(ctx.Stdout)
+	var num []byte
+	for i := start; inc > 0 && i <= end || inc < 0 && i >= end; i += inc {
+		num = strconv.AppendInt(num[:0], int64(i), 10)
+		num = append(num, '\n')
+		if _, err := w.Write(num); err != nil {
+			return err
+		}
 	}
-	return i
+	return w.Flush()
 }
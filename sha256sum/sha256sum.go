@@ -29,6 +29,7 @@ With no FILE, or when FILE is -, read standard input.
   -b, --binary  read in binary mode(default)
   -c, --check   read SHA256 sums from the FILEs and check them
   -t, --text    read in text mode
+      --tree    print a tree hash, computed on every CPU at once
   Note: there is no difference between text and binary mode option.
 
 The following three options are useful only when verifying checksums:
@@ -44,13 +45,11 @@ should be a former output of this program.  The default mode is to print
 a line with checksum, a character indicating type ('*' for binary, ' ' for
 text), and name for each FILE.
 */
-package main
+package sha256sum
 
 import (
-	"fmt"
-	cc "github.com/fangdingjun/go-coreutils/md5sum/checksum_common"
-	flag "github.com/ogier/pflag"
-	"os"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	cc "github.com/ericlagergren/go-coreutils/md5sum/checksum_common"
 )
 
 const (
@@ -61,6 +60,7 @@ With no FILE, or when FILE is -, read standard input.
   -b, --binary  read in binary mode(default)
   -c, --check   read SHA256 sums from the FILEs and check them
   -t, --text    read in text mode
+      --tree    print a tree hash, computed on every CPU at once
   Note: there is no difference between text and binary mode option.
 
 The following three options are useful only when verifying checksums:
@@ -84,54 +84,6 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	check_sum    = flag.BoolP("check", "c", false, "")
-	no_output    = flag.BoolP("quiet", "q", false, "")
-	no_output_s  = flag.BoolP("status", "", false, "")
-	show_warn    = flag.BoolP("warn", "w", true, "")
-	show_version = flag.BoolP("version", "v", false, "")
-	text_mode    = flag.BoolP("text", "t", false, "")
-	binary_mode  = flag.BoolP("binary", "b", false, "")
-)
-
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
-	}
-
-	flag.Parse()
-
-	/* trust --status and --quiet as the same */
-	if *no_output_s == true {
-		*no_output = true
-	}
-
-	has_error := false
-
-	file_lists := flag.Args()
-	if len(file_lists) == 0 {
-		file_lists = append(file_lists, "-")
-	}
-
-	switch {
-	case *show_version:
-		fmt.Fprintf(os.Stdout, "%s", Version)
-		os.Exit(0)
-	case *check_sum:
-		if r := cc.CompareChecksum(file_lists, "sha256",
-			!(*no_output), *show_warn); !r {
-			has_error = true
-		}
-	default:
-		if r := cc.GenerateChecksum(file_lists, "sha256"); !r {
-			has_error = true
-		}
-	}
-
-	if has_error {
-		os.Exit(1)
-	}
-
-	os.Exit(0)
+func init() {
+	coreutils.Register("sha256sum", cc.Tool("sha256", Help, Version))
 }
@@ -0,0 +1,230 @@
+package shuf
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"strconv"
+	"strings"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("shuf", run)
+}
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.echo, "echo", "e", false, "treat each ARG as an input line")
+	c.f.StringVarP(&c.inputRange, "input-range", "i", "", "treat each number LO through HI as an input line")
+	c.f.StringVarP(&c.headCount, "head-count", "n", "", "output at most COUNT lines")
+	c.f.StringVarP(&c.output, "output", "o", "", "write result to FILE instead of standard output")
+	c.f.StringVar(&c.randomSource, "random-source", "", "get random bytes from FILE")
+	c.f.BoolVarP(&c.repeat, "repeat", "r", false, "output lines can be repeated")
+	c.f.BoolVarP(&c.zero, "zero-terminated", "z", false, "line delimiter is NUL, not newline")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f            flag.FlagSet
+	echo         bool
+	inputRange   string
+	headCount    string
+	output       string
+	randomSource string
+	repeat       bool
+	zero         bool
+	version      bool
+}
+
+var errNoLines = errors.New("no lines to repeat")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "shuf (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "shuf: %v\n", err)
+		}
+	}()
+
+	ranged := c.f.Changed("input-range")
+	var lo, hi uint64
+	if ranged {
+		if c.echo {
+			return errors.New("cannot combine -e and -i options")
+		}
+		if lo, hi, err = parseRange(c.inputRange); err != nil {
+			return err
+		}
+	}
+	names := c.f.Args()
+	switch {
+	case ranged && len(names) > 0:
+		return fmt.Errorf("extra operand '%s'", names[0])
+	case !ranged && !c.echo && len(names) > 1:
+		return fmt.Errorf("extra operand '%s'", names[1])
+	}
+
+	rnd := NewRand()
+	if c.randomSource != "" {
+		f, err := os.Open(c.randomSource)
+		if err != nil {
+			return fmt.Errorf("%s: %v", c.randomSource, unwrap(err))
+		}
+		defer f.Close()
+		rnd = NewRandReader(f)
+	}
+
+	s := NewShuffler(rnd)
+	s.Repeat = c.repeat
+	if c.zero {
+		s.Delim = 0
+	}
+	if c.f.Changed("head-count") {
+		n, err := strconv.ParseUint(c.headCount, 10, 64)
+		if err != nil {
+			if e, ok := err.(*strconv.NumError); !ok || e.Err != strconv.ErrRange {
+				return fmt.Errorf("invalid line count: '%s'", c.headCount)
+			}
+			n = math.MaxInt64
+		}
+		if n > math.MaxInt64 {
+			n = math.MaxInt64
+		}
+		s.Count = int64(n)
+	}
+
+	out := ctx.Stdout
+	if c.output != "" {
+		f := &lazyFile{name: c.output}
+		defer func() {
+			if cerr := f.Close(); err == nil && cerr != nil {
+				err = fmt.Errorf("%s: %v", c.output, unwrap(cerr))
+			}
+		}()
+		out = f
+	}
+
+	switch {
+	case ranged:
+		err = s.ShuffleRange(out, lo, hi)
+	case c.echo:
+		lines := make([][]byte, len(names))
+		for i, name := range names {
+			lines[i] = []byte(name)
+		}
+		err = s.ShuffleLines(out, lines)
+	default:
+		var in io.Reader = ctx.Stdin
+		if len(names) > 0 && names[0] != "-" && s.Count != 0 {
+			f, err := os.Open(names[0])
+			if err != nil {
+				return fmt.Errorf("%s: %v", names[0], unwrap(err))
+			}
+			defer f.Close()
+			s.NoMap = c.output != "" && sameFile(f, c.output)
+			in = f
+		}
+		err = s.Shuffle(out, in)
+	}
+	if rerr := rnd.Err(); rerr != nil {
+		if rerr == io.EOF {
+			return fmt.Errorf("'%s': end of file", c.randomSource)
+		}
+		return fmt.Errorf("'%s': %v", c.randomSource, unwrap(rerr))
+	}
+	if pe, ok := err.(*os.PathError); ok {
+		if pe.Op == "write" {
+			return fmt.Errorf("write error: %v", pe.Err)
+		}
+		return fmt.Errorf("%s: %v", pe.Path, pe.Err)
+	}
+	return err
+}
+
+// parseRange parses LO-HI, which can be empty, but has to have fewer
+// numbers in it than the largest uint64.
+func parseRange(s string) (lo, hi uint64, err error) {
+	i := strings.IndexByte(s, '-')
+	if i < 0 {
+		return 0, 0, fmt.Errorf("invalid input range: '%s'", s)
+	}
+	for _, p := range []struct {
+		s string
+		v *uint64
+	}{{s[:i], &lo}, {s[i+1:], &hi}} {
+		if p.s == "" || p.s[0] == '+' || p.s[0] == '-' {
+			return 0, 0, fmt.Errorf("invalid input range: '%s'", s)
+		}
+		if *p.v, err = strconv.ParseUint(p.s, 10, 64); err != nil {
+			if e, ok := err.(*strconv.NumError); ok && e.Err == strconv.ErrRange {
+				return 0, 0, fmt.Errorf("invalid input range: '%s': value too large for defined data type", p.s)
+			}
+			return 0, 0, fmt.Errorf("invalid input range: '%s'", s)
+		}
+	}
+	if hi < lo && lo-hi > 1 || hi >= lo && hi-lo == math.MaxUint64 {
+		return 0, 0, fmt.Errorf("invalid input range: '%s'", s)
+	}
+	return lo, hi, nil
+}
+
+// lazyFile is the output file, which isn't created until it's first written
+// to, after the input has been read, so that the two can be the same file.
+type lazyFile struct {
+	name string
+	f    *os.File
+}
+
+func (l *lazyFile) Write(p []byte) (int, error) {
+	if l.f == nil {
+		f, err := os.Create(l.name)
+		if err != nil {
+			return 0, err
+		}
+		l.f = f
+	}
+	return l.f.Write(p)
+}
+
+func (l *lazyFile) Close() error {
+	if l.f == nil {
+		// Nothing was written, but the file is still truncated.
+		f, err := os.Create(l.name)
+		if err != nil {
+			return err
+		}
+		l.f = f
+	}
+	return l.f.Close()
+}
+
+func sameFile(f *os.File, name string) bool {
+	a, err := f.Stat()
+	if err != nil {
+		return false
+	}
+	b, err := os.Stat(name)
+	return err == nil && os.SameFile(a, b)
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
@@ -0,0 +1,84 @@
+package shuf
+
+import (
+	"bufio"
+	crand "crypto/rand"
+	"encoding/binary"
+	"io"
+	"math"
+	"math/rand"
+)
+
+// Rand is where a Shuffler's random numbers come from.
+type Rand struct {
+	src rand.Source64
+	r   *bufio.Reader
+	buf [8]byte
+	err error
+}
+
+// NewRand returns a Rand seeded from crypto/rand.
+func NewRand() *Rand {
+	var seed [8]byte
+	crand.Read(seed[:])
+	return NewRandSeed(int64(binary.LittleEndian.Uint64(seed[:])))
+}
+
+// NewRandSeed returns a Rand that always gives the same numbers for the
+// same seed.
+func NewRandSeed(seed int64) *Rand {
+	return &Rand{src: rand.NewSource(seed).(rand.Source64)}
+}
+
+// NewRandReader returns a Rand that takes its numbers from the bytes of r,
+// like GNU shuf's --random-source. If r runs out, the numbers are all zero
+// from then on, and Err returns why.
+func NewRandReader(r io.Reader) *Rand {
+	return &Rand{r: bufio.NewReader(r)}
+}
+
+// Err returns the error reading the Rand's source, if any. io.EOF means it
+// ran out.
+func (r *Rand) Err() error { return r.err }
+
+func (r *Rand) uint64() uint64 {
+	if r.src != nil {
+		return r.src.Uint64()
+	}
+	if r.err != nil {
+		return 0
+	}
+	if _, err := io.ReadFull(r.r, r.buf[:]); err != nil {
+		if err == io.ErrUnexpectedEOF {
+			err = io.EOF
+		}
+		r.err = err
+		return 0
+	}
+	return binary.LittleEndian.Uint64(r.buf[:])
+}
+
+// uint64n returns a number in [0, n), each as likely as any other: numbers
+// from the top of the range that would make smaller ones likelier are
+// thrown away. Zero is never thrown away, so a source of nothing but zeros
+// gives nothing but zeros.
+func (r *Rand) uint64n(n uint64) uint64 {
+	if n&(n-1) == 0 {
+		return r.uint64() & (n - 1)
+	}
+	max := math.MaxUint64 - (math.MaxUint64%n+1)%n
+	v := r.uint64()
+	for v > max {
+		v = r.uint64()
+	}
+	return v % n
+}
+
+func (r *Rand) intn(n int) int {
+	return int(r.uint64n(uint64(n)))
+}
+
+// float returns a number in (0, 1].
+func (r *Rand) float() float64 {
+	return 1 - float64(r.uint64()>>11)/(1<<53)
+}
@@ -1,3 +1,426 @@
-package main
+// Package shuf writes random permutations of its input.
+package shuf
 
-func main() {}
+import (
+	"bufio"
+	"bytes"
+	"io"
+	"math"
+	"os"
+	"strconv"
+
+	"github.com/ericlagergren/go-coreutils/internal/lines"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+// Shuffler writes its input lines in a random order.
+type Shuffler struct {
+	// Count is how many lines are written, at most. Negative means all of
+	// them, or for Repeat, without end.
+	Count int64
+	// Repeat picks each line from all of them, so lines can come out more
+	// than once, instead of writing a permutation.
+	Repeat bool
+	// Delim ends each line.
+	Delim byte
+	// NoMap reads a regular file into memory rather than mapping it, for
+	// when it may change while it's being shuffled, such as by being the
+	// output too.
+	NoMap bool
+
+	rand *Rand
+}
+
+// NewShuffler returns a Shuffler that writes every line once, in an order
+// picked by r.
+func NewShuffler(r *Rand) *Shuffler {
+	return &Shuffler{Count: -1, Delim: '\n', rand: r}
+}
+
+// outBufSize is the size of the buffer output is gathered in.
+const outBufSize = 64 * 1024
+
+// Shuffle writes the lines read from r, which has to be read to the end
+// first.
+//
+// With a Count and without Repeat, only that many lines are kept, chosen
+// with Li's Algorithm L: after the first Count lines, the number of lines
+// to pass over before the next one replaces one of those kept is drawn
+// directly, so random numbers are only needed for lines that are kept,
+// and the lines in between are only counted.
+//
+// Otherwise every line is needed at once. A regular file is mapped, and
+// only the offsets of its lines are shuffled; anything else is read into
+// memory first.
+func (s *Shuffler) Shuffle(w io.Writer, r io.Reader) error {
+	if s.Count == 0 {
+		return nil
+	}
+	if f, ok := r.(*os.File); ok && !s.NoMap {
+		if m := mapFile(f); m != nil {
+			defer m.Close()
+			data := m.Bytes()
+			return mmap.Guard(f, func() error {
+				if s.Count > 0 && !s.Repeat {
+					return s.write(w, s.sampleMapped(data))
+				}
+				return s.write(w, s.index(data))
+			})
+		}
+	}
+	if s.Count > 0 && !s.Repeat {
+		set, err := s.sample(r)
+		if err != nil {
+			return err
+		}
+		return s.write(w, set)
+	}
+	var buf bytes.Buffer
+	if _, err := buf.ReadFrom(r); err != nil {
+		return err
+	}
+	return s.write(w, s.index(buf.Bytes()))
+}
+
+// ShuffleLines writes lines, which can contain Delim.
+func (s *Shuffler) ShuffleLines(w io.Writer, lines [][]byte) error {
+	if s.Count == 0 {
+		return nil
+	}
+	return s.write(w, lineList(lines))
+}
+
+// mapFile maps all of f, if it's a regular file large enough to be worth
+// it and that can be. Otherwise it returns nil.
+func mapFile(f *os.File) *mmap.Mapping {
+	info, err := f.Stat()
+	if err != nil || !info.Mode().IsRegular() {
+		return nil
+	}
+	off, err := f.Seek(0, io.SeekCurrent)
+	if err != nil {
+		return nil
+	}
+	n := info.Size() - off
+	if n < mmap.Threshold || int64(int(n)) != n {
+		return nil
+	}
+	m, err := mmap.Map(f, off, int(n))
+	if err != nil {
+		return nil
+	}
+	return m
+}
+
+// lineSet is a set of lines to be shuffled.
+type lineSet interface {
+	Len() int
+	Line(i int) []byte
+	Swap(i, j int)
+}
+
+type lineList [][]byte
+
+func (l lineList) Len() int          { return len(l) }
+func (l lineList) Line(i int) []byte { return l[i] }
+func (l lineList) Swap(i, j int)     { l[i], l[j] = l[j], l[i] }
+
+// offsets is a set of lines in data, by where each starts.
+type offsets struct {
+	data   []byte
+	starts []int64
+	delim  byte
+}
+
+func (o *offsets) Len() int      { return len(o.starts) }
+func (o *offsets) Swap(i, j int) { o.starts[i], o.starts[j] = o.starts[j], o.starts[i] }
+
+func (o *offsets) Line(i int) []byte {
+	line := o.data[o.starts[i]:]
+	if j := bytes.IndexByte(line, o.delim); j >= 0 {
+		line = line[:j]
+	}
+	return line
+}
+
+// next returns the start of the line after the one at i, or len(data).
+func (o *offsets) next(i int64) int64 {
+	j := bytes.IndexByte(o.data[i:], o.delim)
+	if j < 0 {
+		return int64(len(o.data))
+	}
+	return i + int64(j) + 1
+}
+
+// skipChunk is how much of the input skip counts lines in at once.
+const skipChunk = 4096
+
+// skip returns the start of the nth line after the one at i, or len(data).
+// Lines are counted a chunk at a time until the one it's in is found.
+func (o *offsets) skip(i, n int64) int64 {
+	end := int64(len(o.data))
+	for n > 0 && i < end {
+		c := end - i
+		if c > skipChunk {
+			c = skipChunk
+		}
+		chunk := o.data[i : i+c]
+		if k := int64(bytes.Count(chunk, []byte{o.delim})); k < n {
+			n -= k
+			i += c
+			continue
+		}
+		for ; n > 0; n-- {
+			i = o.next(i)
+		}
+	}
+	return i
+}
+
+// index returns every line in data.
+func (s *Shuffler) index(data []byte) *offsets {
+	o := &offsets{data: data, delim: s.Delim}
+	// Guess at the number of lines from the first few.
+	head := data
+	if len(head) > skipChunk {
+		head = head[:skipChunk]
+	}
+	if n := bytes.Count(head, []byte{s.Delim}); n > 0 {
+		o.starts = make([]int64, 0, int64(len(data))/int64(len(head))*int64(n)+1)
+	}
+	for i := int64(0); i < int64(len(data)); i = o.next(i) {
+		o.starts = append(o.starts, i)
+	}
+	return o
+}
+
+// reservoir implements Li's Algorithm L, which picks k of a stream of
+// items, each as likely as any other, without knowing how many there are.
+type reservoir struct {
+	k    int
+	w    float64
+	rand *Rand
+}
+
+// maxSkip bounds the number of items skipped at once.
+const maxSkip = 1 << 62
+
+func newReservoir(k int, r *Rand) *reservoir {
+	return &reservoir{k: k, w: math.Exp(math.Log(r.float()) / float64(k)), rand: r}
+}
+
+// skip returns how many items to pass over before the next one to keep,
+// once the first k have been.
+func (a *reservoir) skip() int64 {
+	n := math.Floor(math.Log(a.rand.float()) / math.Log1p(-a.w))
+	a.w *= math.Exp(math.Log(a.rand.float()) / float64(a.k))
+	switch {
+	case !(n < maxSkip): // NaN too
+		return maxSkip
+	case n < 0:
+		return 0
+	}
+	return int64(n)
+}
+
+// slot returns which of the items kept the next one replaces.
+func (a *reservoir) slot() int {
+	return a.rand.intn(a.k)
+}
+
+// capacity is how many lines a sample of up to k keeps room for to begin
+// with: k itself, unless it's large, when it's more than likely the input
+// has fewer lines.
+func capacity(k int64) int {
+	const max = 1 << 16
+	if k > max {
+		return max
+	}
+	return int(k)
+}
+
+// k is Count as an int, which is how many lines there can be at most.
+func (s *Shuffler) k() int {
+	if int64(int(s.Count)) != s.Count {
+		return math.MaxInt
+	}
+	return int(s.Count)
+}
+
+// sampleMapped picks Count lines of data, keeping their offsets.
+func (s *Shuffler) sampleMapped(data []byte) *offsets {
+	o := &offsets{data: data, delim: s.Delim, starts: make([]int64, 0, capacity(s.Count))}
+	k := s.k()
+	end := int64(len(data))
+	i := int64(0)
+	for ; i < end && len(o.starts) < k; i = o.next(i) {
+		o.starts = append(o.starts, i)
+	}
+	if i >= end {
+		return o
+	}
+	a := newReservoir(k, s.rand)
+	for {
+		if i = o.skip(i, a.skip()); i >= end {
+			return o
+		}
+		o.starts[a.slot()] = i
+		i = o.next(i)
+	}
+}
+
+// sample picks Count lines of r, copying each line kept into the one it
+// replaces, which mostly has room for it.
+func (s *Shuffler) sample(r io.Reader) (lineList, error) {
+	lr := lines.NewReader(r, s.Delim)
+	res := make(lineList, 0, capacity(s.Count))
+	k := s.k()
+	for len(res) < k {
+		line, err := lr.Next()
+		if err == io.EOF {
+			return res, nil
+		}
+		if err != nil {
+			return nil, err
+		}
+		res = append(res, append([]byte(nil), line...))
+	}
+	a := newReservoir(k, s.rand)
+	for {
+		for n := a.skip(); n >= 0; n-- {
+			line, err := lr.Next()
+			if err == io.EOF {
+				return res, nil
+			}
+			if err != nil {
+				return nil, err
+			}
+			if n == 0 {
+				j := a.slot()
+				res[j] = append(res[j][:0], line...)
+			}
+		}
+	}
+}
+
+// write writes the lines in set: Count of them, picked at random, for
+// Repeat, or else a random permutation of them.
+func (s *Shuffler) write(w io.Writer, set lineSet) error {
+	bw := bufio.NewWriterSize(w, outBufSize)
+	n := set.Len()
+	if s.Repeat {
+		if n == 0 {
+			return errNoLines
+		}
+		for i := int64(0); (s.Count < 0 || i < s.Count) && s.rand.err == nil; i++ {
+			bw.Write(set.Line(s.rand.intn(n)))
+			if err := bw.WriteByte(s.Delim); err != nil {
+				return err
+			}
+		}
+		if s.rand.err != nil {
+			return s.rand.err
+		}
+		return bw.Flush()
+	}
+
+	k := n
+	if s.Count >= 0 && s.Count < int64(n) {
+		k = int(s.Count)
+	}
+	// Fisher and Yates's shuffle, front to back, stopping at k.
+	for i := 0; i < k && i < n-1; i++ {
+		set.Swap(i, i+s.rand.intn(n-i))
+	}
+	if s.rand.err != nil {
+		return s.rand.err
+	}
+	for i := 0; i < k; i++ {
+		bw.Write(set.Line(i))
+		if err := bw.WriteByte(s.Delim); err != nil {
+			return err
+		}
+	}
+	return bw.Flush()
+}
+
+// denseFactor says when ShuffleRange keeps the whole range: when at least
+// one in this many numbers of it are written.
+const denseFactor = 8
+
+// ShuffleRange writes the numbers lo through hi, which is at least lo-1,
+// as lines.
+//
+// A permutation of the whole range is only made when much of it is
+// written. Otherwise, the same shuffle is done in a map holding just the
+// numbers that have been moved, so memory grows with Count, not with the
+// size of the range.
+func (s *Shuffler) ShuffleRange(w io.Writer, lo, hi uint64) error {
+	n := hi - lo + 1 // can't overflow: hi-lo is less than the largest uint64
+	if s.Count == 0 {
+		return nil
+	}
+	bw := bufio.NewWriterSize(w, outBufSize)
+	var num []byte
+	put := func(v uint64) error {
+		num = strconv.AppendUint(num[:0], lo+v, 10)
+		num = append(num, s.Delim)
+		_, err := bw.Write(num)
+		return err
+	}
+
+	if s.Repeat {
+		if n == 0 {
+			return errNoLines
+		}
+		for i := int64(0); (s.Count < 0 || i < s.Count) && s.rand.err == nil; i++ {
+			if err := put(s.rand.uint64n(n)); err != nil {
+				return err
+			}
+		}
+		if s.rand.err != nil {
+			return s.rand.err
+		}
+		return bw.Flush()
+	}
+
+	k := n
+	if s.Count >= 0 && uint64(s.Count) < n {
+		k = uint64(s.Count)
+	}
+	if k > n/denseFactor {
+		perm := make([]uint64, n)
+		for i := range perm {
+			perm[i] = uint64(i)
+		}
+		for i := uint64(0); i < k; i++ {
+			j := i + s.rand.uint64n(n-i)
+			perm[i], perm[j] = perm[j], perm[i]
+			if err := put(perm[i]); err != nil {
+				return err
+			}
+		}
+	} else {
+		// moved[i] is what's at i, if it isn't i.
+		moved := make(map[uint64]uint64, k)
+		at := func(i uint64) uint64 {
+			if v, ok := moved[i]; ok {
+				return v
+			}
+			return i
+		}
+		for i := uint64(0); i < k; i++ {
+			j := i + s.rand.uint64n(n-i)
+			vi, vj := at(i), at(j)
+			moved[j] = vi
+			delete(moved, i)
+			if err := put(vj); err != nil {
+				return err
+			}
+		}
+	}
+	if s.rand.err != nil {
+		return s.rand.err
+	}
+	return bw.Flush()
+}
@@ -0,0 +1,209 @@
+package shuf
+
+import (
+	"bytes"
+	"fmt"
+	"io/ioutil"
+	"math"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+func numbered(n int) string {
+	var b strings.Builder
+	for i := 0; i < n; i++ {
+		fmt.Fprintf(&b, "%d\n", i)
+	}
+	return b.String()
+}
+
+func sorted(s string) string {
+	lines := strings.SplitAfter(s, "\n")
+	sort.Strings(lines)
+	return strings.Join(lines, "")
+}
+
+func TestShuffle(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "shuf")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	in := numbered(200000) // more than mmap.Threshold
+	if int64(len(in)) < mmap.Threshold {
+		t.Fatal("input too small to be mapped")
+	}
+	name := filepath.Join(tmp, "in")
+	if err := ioutil.WriteFile(name, []byte(in), 0644); err != nil {
+		t.Fatal(err)
+	}
+
+	for _, mapped := range []bool{false, true} {
+		for _, count := range []int64{-1, 0, 1, 1000, 199999, 200000, 1 << 40} {
+			s := NewShuffler(NewRandSeed(count))
+			s.Count = count
+			var out bytes.Buffer
+			if mapped {
+				f, err := os.Open(name)
+				if err != nil {
+					t.Fatal(err)
+				}
+				err = s.Shuffle(&out, f)
+				f.Close()
+			} else {
+				err = s.Shuffle(&out, strings.NewReader(in))
+			}
+			if err != nil {
+				t.Fatalf("mapped %t, count %d: %v", mapped, count, err)
+			}
+
+			want := count
+			if count < 0 || count > 200000 {
+				want = 200000
+			}
+			lines := strings.SplitAfter(out.String(), "\n")
+			lines = lines[:len(lines)-1]
+			seen := make(map[string]bool)
+			for _, l := range lines {
+				if seen[l] || !strings.HasSuffix(l, "\n") {
+					t.Fatalf("mapped %t, count %d: bad or repeated line %q", mapped, count, l)
+				}
+				seen[l] = true
+			}
+			if int64(len(lines)) != want {
+				t.Fatalf("mapped %t, count %d: got %d lines", mapped, count, len(lines))
+			}
+			if want == 200000 && sorted(out.String()) != sorted(in) {
+				t.Fatalf("mapped %t, count %d: not a permutation", mapped, count)
+			}
+			if count == -1 && out.String() == in {
+				t.Fatalf("mapped %t: not shuffled", mapped)
+			}
+		}
+	}
+
+	// The last line gets a delimiter.
+	var out bytes.Buffer
+	s := NewShuffler(NewRandSeed(1))
+	s.Delim = 0
+	if err := s.Shuffle(&out, strings.NewReader("a\x00b")); err != nil || sorted(out.String()) != sorted("a\x00b\x00") {
+		t.Fatalf("got %q, %v", out.String(), err)
+	}
+}
+
+// TestSample checks that each line is as likely as any other to be picked
+// by the reservoir.
+func TestSample(t *testing.T) {
+	const (
+		n      = 50
+		k      = 5
+		trials = 20000
+	)
+	in := numbered(n)
+	counts := make([]int, n)
+	s := NewShuffler(NewRandSeed(1))
+	s.Count = k
+	for i := 0; i < trials; i++ {
+		set, err := s.sample(strings.NewReader(in))
+		if err != nil {
+			t.Fatal(err)
+		}
+		for _, line := range set {
+			var v int
+			fmt.Sscan(string(line), &v)
+			counts[v]++
+		}
+	}
+	// Each is picked trials*k/n = 2000 times, give or take sqrt(2000).
+	want := float64(trials * k / n)
+	for i, c := range counts {
+		if math.Abs(float64(c)-want) > 5*math.Sqrt(want) {
+			t.Errorf("line %d picked %d times, want about %g", i, c, want)
+		}
+	}
+}
+
+func TestShuffleRange(t *testing.T) {
+	for _, tc := range []struct {
+		lo, hi uint64
+		count  int64
+		repeat bool
+		want   int
+	}{
+		{1, 10, -1, false, 10},
+		{1, 0, -1, false, 0},
+		{5, 1000, 3, false, 3}, // sparse
+		{5, 1000, 500, false, 500},
+		{0, math.MaxUint64 - 1, 4, false, 4},
+		{1, 3, 10, true, 10},
+	} {
+		s := NewShuffler(NewRandSeed(1))
+		s.Count = tc.count
+		s.Repeat = tc.repeat
+		var out bytes.Buffer
+		if err := s.ShuffleRange(&out, tc.lo, tc.hi); err != nil {
+			t.Fatal(err)
+		}
+		lines := strings.Fields(out.String())
+		seen := make(map[uint64]bool)
+		for _, l := range lines {
+			var v uint64
+			fmt.Sscan(l, &v)
+			if v < tc.lo || v > tc.hi || seen[v] && !tc.repeat {
+				t.Fatalf("%+v: bad or repeated number %d", tc, v)
+			}
+			seen[v] = true
+		}
+		if len(lines) != tc.want {
+			t.Fatalf("%+v: got %d numbers, want %d", tc, len(lines), tc.want)
+		}
+	}
+}
+
+func TestRun(t *testing.T) {
+	// All zeros never move anything.
+	for _, tc := range []struct {
+		stdin string
+		args  []string
+		want  string
+	}{
+		{"", []string{"-i", "3-6"}, "3\n4\n5\n6\n"},
+		{"", []string{"-e", "a", "b", "c"}, "a\nb\nc\n"},
+		{"", []string{"-ze", "a", "b"}, "a\x00b\x00"},
+		{"", []string{"-rn3", "-e", "a", "b"}, "a\na\na\n"},
+		{"x\ny\nz", nil, "x\ny\nz\n"},
+		{"x\ny\nz\n", []string{"-n", "99999999999999999999"}, "x\ny\nz\n"},
+		{"x\ny\n", []string{"-n0", "nonexistent"}, ""},
+	} {
+		got, _, err := cmdtest.Run(run, tc.stdin, append(tc.args, "--random-source=/dev/zero")...)
+		if err != nil || got != tc.want {
+			t.Errorf("%q: got %q, %v, want %q", tc.args, got, err, tc.want)
+		}
+	}
+
+	for _, args := range [][]string{
+		{"-n", "x"}, {"-i", "5-3"}, {"-i", "0-18446744073709551615"}, {"-i", "1-2", "a"},
+		{"-e", "-i", "1-2"}, {"a", "b"}, {"-r"}, {"--random-source=/dev/null", "-i", "1-5"},
+	} {
+		if _, _, err := cmdtest.Run(run, "", args...); err == nil {
+			t.Errorf("%q: no error", args)
+		}
+	}
+}
+
+func BenchmarkSample(b *testing.B) {
+	in := []byte(numbered(1 << 20))
+	b.SetBytes(int64(len(in)))
+	for i := 0; i < b.N; i++ {
+		s := NewShuffler(NewRandSeed(1))
+		s.Count = 1000
+		s.write(ioutil.Discard, s.sampleMapped(in))
+	}
+}
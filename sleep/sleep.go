@@ -12,18 +12,37 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package sleep
 
-import "time"
-import "os"
-import "strconv"
+import (
+	"strconv"
+	"time"
 
-func main() {
-	if len(os.Args) >= 2 {
-		duration, err := strconv.ParseInt(os.Args[1], 0, 64)
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+func init() {
+	coreutils.Register("sleep", run)
+}
+
+func run(ctx coreutils.Context, args ...string) error {
+	if len(args) >= 1 {
+		duration, err := strconv.ParseInt(args[0], 0, 64)
 		if err != nil || duration < 0 {
-			os.Exit(1)
+			return coreutils.ExitCode(1)
+		}
+		t := time.NewTimer(time.Duration(duration) * time.Second)
+		defer t.Stop()
+		// Run in-process, sleep can be cut short by its Context.
+		var done <-chan struct{}
+		if ctx.Context != nil {
+			done = ctx.Done()
+		}
+		select {
+		case <-t.C:
+		case <-done:
+			return ctx.Err()
 		}
-		time.Sleep(time.Duration(duration) * time.Second)
 	}
+	return nil
 }
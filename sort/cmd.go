@@ -0,0 +1,293 @@
+package sort
+
+import (
+	"errors"
+	"fmt"
+	"math"
+	"os"
+	"strconv"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("sort", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -C but not --C.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.ignoreBlanks, "ignore-leading-blanks", "b", false, "ignore leading blanks")
+	c.f.BoolVarP(&c.ignoreCase, "ignore-case", "f", false, "fold lower case to upper case characters")
+	c.f.BoolVarP(&c.human, "human-numeric-sort", "h", false, "compare human readable numbers (e.g., 2K 1G)")
+	c.f.BoolVarP(&c.numeric, "numeric-sort", "n", false, "compare according to string numerical value")
+	c.f.IntVar(&c.batchSize, "batch-size", DefaultBatchSize, "merge at most NMERGE inputs at once; for more use temp files")
+	c.f.BoolVarP(&c.check, "check", "c", false, "check for sorted input; do not sort")
+	c.f.BoolVarP(&c.quiet, bad1, "C", false, "like -c, but do not report first bad line")
+	c.f.StringArrayVarP(&c.keys, "key", "k", nil, `sort via a key; KEYDEF gives location and type
+                             (F[.C][OPTS][,F[.C][OPTS]])`)
+	c.f.BoolVarP(&c.merge, "merge", "m", false, "merge already sorted files; do not sort")
+	c.f.StringVarP(&c.output, "output", "o", "", "write result to FILE instead of standard output")
+	c.f.IntVar(&c.parallel, "parallel", 0, "change the number of sorts run concurrently to N")
+	c.f.BoolVarP(&c.reverse, "reverse", "r", false, "reverse the result of comparisons")
+	c.f.StringVarP(&c.bufferSize, "buffer-size", "S", "", "use SIZE for main memory buffer")
+	c.f.BoolVarP(&c.stable, "stable", "s", false, "stabilize sort by disabling last-resort comparison")
+	c.f.StringVarP(&c.separator, "field-separator", "t", "", "use SEP instead of non-blank to blank transition")
+	c.f.StringArrayVarP(&c.tempDirs, "temporary-directory", "T", nil, `use DIR for temporaries, not $TMPDIR or /tmp;
+                             multiple options specify multiple directories`)
+	c.f.BoolVarP(&c.unique, "unique", "u", false, "output only the first of an equal run")
+	c.f.BoolVarP(&c.zero, "zero-terminated", "z", false, "line delimiter is NUL, not newline")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f            flag.FlagSet
+	ignoreBlanks bool
+	ignoreCase   bool
+	human        bool
+	numeric      bool
+	batchSize    int
+	check        bool
+	quiet        bool
+	keys         []string
+	merge        bool
+	output       string
+	parallel     int
+	reverse      bool
+	bufferSize   string
+	stable       bool
+	separator    string
+	tempDirs     []string
+	unique       bool
+	zero         bool
+	version      bool
+}
+
+// errDisorder is returned by -C for unsorted input.
+var errDisorder = errors.New("input is not sorted")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "sort (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errDisorder {
+			fmt.Fprintf(ctx.Stderr, "sort: %v\n", err)
+		}
+	}()
+
+	s := NewSorter()
+	s.Reverse = c.reverse
+	s.Unique = c.unique
+	s.Stable = c.stable
+	s.IgnoreBlanks = c.ignoreBlanks
+	s.IgnoreCase = c.ignoreCase
+	s.Numeric = c.numeric
+	s.HumanNumeric = c.human
+	for _, spec := range c.keys {
+		k, err := ParseKey(spec)
+		if err != nil {
+			return err
+		}
+		s.Keys = append(s.Keys, k)
+	}
+	if c.f.Changed("field-separator") {
+		switch {
+		case c.separator == "":
+			return errors.New("empty tab")
+		case c.separator == `\0`:
+			s.FieldSeparator = 0
+		case len(c.separator) > 1:
+			return fmt.Errorf("multi-character tab '%s'", c.separator)
+		default:
+			s.FieldSeparator = int(c.separator[0])
+		}
+	}
+	s.ZeroTerminated = c.zero
+	s.BatchSize = c.batchSize
+	if ctx.Stdin != nil {
+		s.Stdin = ctx.Stdin
+	}
+	if c.bufferSize != "" {
+		if s.BufferSize, err = parseSize(c.bufferSize); err != nil {
+			return err
+		}
+	}
+	if c.parallel < 0 {
+		return fmt.Errorf("invalid number after '--parallel': '%d'", c.parallel)
+	}
+	if c.parallel > 0 {
+		s.Parallel = c.parallel
+	}
+	if c.batchSize < 2 {
+		return fmt.Errorf("invalid --batch-size argument '%d'", c.batchSize)
+	}
+	if len(c.tempDirs) > 0 {
+		s.TempDirs = c.tempDirs
+	} else if dir := getEnv(ctx, "TMPDIR"); dir != "" {
+		s.TempDirs = []string{dir}
+	} else {
+		s.TempDirs = []string{"/tmp"}
+	}
+
+	names := c.f.Args()
+	if len(names) == 0 {
+		names = []string{"-"}
+	}
+
+	if c.check || c.quiet {
+		if len(names) > 1 {
+			return fmt.Errorf("extra operand '%s' not allowed with -c", names[1])
+		}
+		err := s.Check(names[0])
+		if _, ok := err.(*DisorderError); ok {
+			if !c.quiet {
+				fmt.Fprintf(ctx.Stderr, "sort: %v\n", err)
+			}
+			return errDisorder
+		}
+		return err
+	}
+
+	out := ctx.Stdout
+	if c.output != "" {
+		f := &lazyFile{name: c.output}
+		defer func() {
+			if err == nil {
+				err = f.Close()
+			} else if f.f != nil {
+				f.f.Close()
+			}
+		}()
+		out = f
+	}
+
+	if c.merge {
+		if c.output != "" {
+			// Merging writes as it reads, so an input that's also
+			// the output has to be read from a copy.
+			for i, name := range names {
+				if sameFile(name, c.output) {
+					if names[i], err = s.copyToTemp(name); err != nil {
+						return err
+					}
+				}
+			}
+		}
+		return s.Merge(out, names...)
+	}
+	return s.Sort(out, names...)
+}
+
+func getEnv(ctx coreutils.Context, key string) string {
+	if ctx.GetEnv != nil {
+		return ctx.GetEnv(key)
+	}
+	return os.Getenv(key)
+}
+
+func sameFile(a, b string) bool {
+	if a == "-" || b == "-" {
+		return false
+	}
+	ai, err := os.Stat(a)
+	if err != nil {
+		return false
+	}
+	bi, err := os.Stat(b)
+	return err == nil && os.SameFile(ai, bi)
+}
+
+// lazyFile is the -o file. It's only created when it's first written to, or
+// closed, which is after all the input has been read, so it may be one of
+// the inputs.
+type lazyFile struct {
+	name string
+	f    *os.File
+	err  error
+}
+
+func (l *lazyFile) open() error {
+	if l.f == nil && l.err == nil {
+		if l.f, l.err = os.Create(l.name); l.err != nil {
+			l.err = fmt.Errorf("open failed: %s: %v", l.name, unwrap(l.err))
+		}
+	}
+	return l.err
+}
+
+func (l *lazyFile) Write(p []byte) (int, error) {
+	if err := l.open(); err != nil {
+		return 0, err
+	}
+	return l.f.Write(p)
+}
+
+func (l *lazyFile) Close() error {
+	if err := l.open(); err != nil {
+		return err
+	}
+	return l.f.Close()
+}
+
+// parseSize parses the argument to -S: a number followed by an optional
+// unit, which is one of b (bytes), K, M, G, T, P or E (powers of 1024), or %
+// (of physical memory). Without a unit, the number is in kilobytes.
+func parseSize(arg string) (int64, error) {
+	i := 0
+	for i < len(arg) && '0' <= arg[i] && arg[i] <= '9' {
+		i++
+	}
+	n, err := strconv.ParseInt(arg[:i], 10, 64)
+	if i == 0 || err != nil && err.(*strconv.NumError).Err != strconv.ErrRange {
+		return 0, fmt.Errorf("invalid -S argument '%s'", arg)
+	}
+	if err != nil {
+		return math.MaxInt64, nil
+	}
+
+	var mult int64
+	switch arg[i:] {
+	case "b":
+		mult = 1
+	case "", "k", "K":
+		mult = 1 << 10
+	case "m", "M":
+		mult = 1 << 20
+	case "g", "G":
+		mult = 1 << 30
+	case "t", "T":
+		mult = 1 << 40
+	case "p", "P":
+		mult = 1 << 50
+	case "e", "E":
+		mult = 1 << 60
+	case "%":
+		mem := physMem()
+		if mem == 0 || n > 100 {
+			return 0, fmt.Errorf("invalid -S argument '%s'", arg)
+		}
+		return mem / 100 * n, nil
+	default:
+		return 0, fmt.Errorf("invalid -S argument '%s'", arg)
+	}
+	if n > math.MaxInt64/mult {
+		return math.MaxInt64, nil
+	}
+	return n * mult, nil
+}
@@ -0,0 +1,472 @@
+package sort
+
+import (
+	"bytes"
+	"encoding/binary"
+	"fmt"
+	"strconv"
+)
+
+// Key is a sort key: a part of each line, and how to compare it. The zero
+// Key is the whole line, compared byte by byte.
+type Key struct {
+	sword, schar int // field and character the key starts at, from 0
+	eword, echar int // field and character it ends at; eword < 0 is the end of the line
+
+	skipsblanks bool // skip blanks before schar
+	skipeblanks bool // skip blanks before echar
+	fold        bool // compare as upper case
+	numeric     bool
+	human       bool
+	reverse     bool
+}
+
+// ParseKey parses a -k argument, POS1[,POS2], where each POS is F[.C][OPTS].
+// OPTS are the option letters b, f, h, n and r, with the same meaning as the
+// global flags; b on POS2 skips blanks before its character.
+func ParseKey(spec string) (Key, error) {
+	k := Key{eword: -1}
+	bad := func(msg string) (Key, error) {
+		return Key{}, fmt.Errorf("%s: invalid field specification '%s'", msg, spec)
+	}
+
+	s := spec
+	var err error
+	if k.sword, s, err = fieldCount(s, spec); err != nil {
+		return Key{}, err
+	}
+	if k.sword == 0 {
+		return bad("field number is zero")
+	}
+	k.sword--
+	if len(s) > 0 && s[0] == '.' {
+		if k.schar, s, err = fieldCount(s[1:], spec); err != nil {
+			return Key{}, err
+		}
+		if k.schar == 0 {
+			return bad("character offset is zero")
+		}
+		k.schar--
+	}
+	if s, err = k.options(s, true); err != nil {
+		return Key{}, err
+	}
+
+	if len(s) > 0 && s[0] == ',' {
+		if k.eword, s, err = fieldCount(s[1:], spec); err != nil {
+			return Key{}, err
+		}
+		if k.eword == 0 {
+			return bad("field number is zero")
+		}
+		k.eword--
+		if len(s) > 0 && s[0] == '.' {
+			if k.echar, s, err = fieldCount(s[1:], spec); err != nil {
+				return Key{}, err
+			}
+		}
+		if s, err = k.options(s, false); err != nil {
+			return Key{}, err
+		}
+	}
+	if s != "" {
+		return bad("stray character in field spec")
+	}
+	if k.numeric && k.human {
+		return Key{}, fmt.Errorf("options '-hn' are incompatible")
+	}
+	return k, nil
+}
+
+// fieldCount parses the number at the start of s.
+func fieldCount(s, spec string) (int, string, error) {
+	i := 0
+	for i < len(s) && '0' <= s[i] && s[i] <= '9' {
+		i++
+	}
+	if i == 0 {
+		return 0, s, fmt.Errorf("invalid number at field start: invalid count at start of '%s'", s)
+	}
+	n, err := strconv.Atoi(s[:i])
+	if err != nil {
+		n = int(^uint(0) >> 1)
+	}
+	return n, s[i:], nil
+}
+
+// options parses the option letters at the start of s.
+func (k *Key) options(s string, start bool) (string, error) {
+	for ; len(s) > 0; s = s[1:] {
+		switch c := s[0]; c {
+		case 'b':
+			if start {
+				k.skipsblanks = true
+			} else {
+				k.skipeblanks = true
+			}
+		case 'f':
+			k.fold = true
+		case 'h':
+			k.human = true
+		case 'n':
+			k.numeric = true
+		case 'r':
+			k.reverse = true
+		case 'd', 'g', 'i', 'M', 'R', 'V':
+			return s, fmt.Errorf("key option '%c' is not supported", c)
+		default:
+			return s, nil
+		}
+	}
+	return s, nil
+}
+
+// ordered reports whether k has any options of its own. Keys that don't
+// take the global ones.
+func (k *Key) ordered() bool {
+	return k.skipsblanks || k.skipeblanks || k.fold || k.numeric || k.human || k.reverse
+}
+
+// whole reports whether k is all of every line.
+func (k *Key) whole() bool {
+	return k.sword == 0 && k.schar == 0 && !k.skipsblanks && k.eword < 0
+}
+
+func isBlank(c byte) bool {
+	return c == ' ' || c == '\t' || c == '\n'
+}
+
+// begin returns where k starts in line. With tab < 0, fields are separated
+// by the empty string between a non-blank and a blank, so each field but the
+// first starts with blanks.
+func (k *Key) begin(line []byte, tab int) int {
+	ptr, lim := 0, len(line)
+	if tab >= 0 {
+		for sword := k.sword; ptr < lim && sword > 0; sword-- {
+			for ptr < lim && line[ptr] != byte(tab) {
+				ptr++
+			}
+			if ptr < lim {
+				ptr++
+			}
+		}
+	} else {
+		for sword := k.sword; ptr < lim && sword > 0; sword-- {
+			for ptr < lim && isBlank(line[ptr]) {
+				ptr++
+			}
+			for ptr < lim && !isBlank(line[ptr]) {
+				ptr++
+			}
+		}
+	}
+	if k.skipsblanks {
+		for ptr < lim && isBlank(line[ptr]) {
+			ptr++
+		}
+	}
+	if ptr+k.schar < lim {
+		return ptr + k.schar
+	}
+	return lim
+}
+
+// end returns where k ends in line.
+func (k *Key) end(line []byte, tab int) int {
+	ptr, lim := 0, len(line)
+	if k.eword < 0 {
+		return lim
+	}
+	eword, echar := k.eword, k.echar
+	if echar == 0 {
+		eword++ // all of the last field
+	}
+	if tab >= 0 {
+		for ; ptr < lim && eword > 0; eword-- {
+			for ptr < lim && line[ptr] != byte(tab) {
+				ptr++
+			}
+			if ptr < lim && (eword > 1 || echar != 0) {
+				ptr++
+			}
+		}
+	} else {
+		for ; ptr < lim && eword > 0; eword-- {
+			for ptr < lim && isBlank(line[ptr]) {
+				ptr++
+			}
+			for ptr < lim && !isBlank(line[ptr]) {
+				ptr++
+			}
+		}
+	}
+	if echar != 0 {
+		if k.skipeblanks {
+			for ptr < lim && isBlank(line[ptr]) {
+				ptr++
+			}
+		}
+		if ptr+echar < lim {
+			return ptr + echar
+		}
+		return lim
+	}
+	return ptr
+}
+
+// extractor returns a function that returns k's part of a line.
+func (k *Key) extractor(tab int) func([]byte) []byte {
+	if k.whole() {
+		return func(line []byte) []byte { return line }
+	}
+	key := *k
+	if key.eword < 0 {
+		return func(line []byte) []byte { return line[key.begin(line, tab):] }
+	}
+	return func(line []byte) []byte {
+		b, e := key.begin(line, tab), key.end(line, tab)
+		if e <= b {
+			return line[b:b]
+		}
+		return line[b:e]
+	}
+}
+
+// keyFuncs returns the comparison and prefix functions for the text of k.
+// Each combination of options gets its own pair, so neither checks the
+// options as it runs.
+func (k *Key) keyFuncs() (cmp func(a, b []byte) int, prefix func([]byte) uint64) {
+	switch {
+	case k.numeric:
+		return compareNumeric, numericPrefix
+	case k.human:
+		return compareHuman, humanPrefix
+	case k.fold:
+		return compareFold, foldPrefix
+	default:
+		return bytes.Compare, bytesPrefix
+	}
+}
+
+// comparator returns a function that compares lines by k, and one that
+// returns the prefix of a line's key.
+func (k *Key) comparator(tab int) (cmp func(a, b []byte) int, prefix func([]byte) uint64) {
+	kcmp, kprefix := k.keyFuncs()
+	extract := k.extractor(tab)
+
+	if k.whole() {
+		cmp, prefix = kcmp, kprefix
+	} else {
+		cmp = func(a, b []byte) int { return kcmp(extract(a), extract(b)) }
+		prefix = func(line []byte) uint64 { return kprefix(extract(line)) }
+	}
+	if k.reverse {
+		fwd, fwdPrefix := cmp, prefix
+		cmp = func(a, b []byte) int { return fwd(b, a) }
+		prefix = func(line []byte) uint64 { return ^fwdPrefix(line) }
+	}
+	return cmp, prefix
+}
+
+// A prefix is a uint64 made from the start of a key, such that if two keys'
+// prefixes differ, they compare the same way the keys do. Only keys with
+// equal prefixes have to be compared in full.
+
+// bytesPrefix is the first 8 bytes of b, padded with zeros.
+func bytesPrefix(b []byte) uint64 {
+	if len(b) >= 8 {
+		return binary.BigEndian.Uint64(b)
+	}
+	var p [8]byte
+	copy(p[:], b)
+	return binary.BigEndian.Uint64(p[:])
+}
+
+var upper = func() (t [256]byte) {
+	for i := range t {
+		t[i] = byte(i)
+	}
+	for c := 'a'; c <= 'z'; c++ {
+		t[c] = byte(c - 'a' + 'A')
+	}
+	return t
+}()
+
+func foldPrefix(b []byte) uint64 {
+	var p uint64
+	for i := 0; i < 8; i++ {
+		p <<= 8
+		if i < len(b) {
+			p |= uint64(upper[b[i]])
+		}
+	}
+	return p
+}
+
+func compareFold(a, b []byte) int {
+	n := len(a)
+	if len(b) < n {
+		n = len(b)
+	}
+	for i := 0; i < n; i++ {
+		if x, y := upper[a[i]], upper[b[i]]; x != y {
+			if x < y {
+				return -1
+			}
+			return 1
+		}
+	}
+	switch {
+	case len(a) < len(b):
+		return -1
+	case len(a) > len(b):
+		return 1
+	}
+	return 0
+}
+
+// number is a decimal number at the start of a key, after any blanks: an
+// optional minus sign, digits and an optional fraction. Anything else is
+// zero. int has no leading zeros and frac no trailing ones, so numbers can be
+// compared as text.
+type number struct {
+	neg       bool
+	int, frac []byte
+	rest      []byte // what follows it
+}
+
+func parseNumber(b []byte) number {
+	i := 0
+	for i < len(b) && isBlank(b[i]) {
+		i++
+	}
+	var n number
+	if i < len(b) && b[i] == '-' {
+		n.neg = true
+		i++
+	}
+	for i < len(b) && b[i] == '0' {
+		i++
+	}
+	start := i
+	for i < len(b) && '0' <= b[i] && b[i] <= '9' {
+		i++
+	}
+	n.int = b[start:i]
+	if i < len(b) && b[i] == '.' {
+		i++
+		start = i
+		for i < len(b) && '0' <= b[i] && b[i] <= '9' {
+			i++
+		}
+		n.frac = bytes.TrimRight(b[start:i], "0")
+	}
+	n.rest = b[i:]
+	if len(n.int) == 0 && len(n.frac) == 0 {
+		n.neg = false // -0 is 0
+	}
+	return n
+}
+
+func (n *number) zero() bool { return len(n.int) == 0 && len(n.frac) == 0 }
+
+func compareNumbers(a, b *number) int {
+	if a.neg != b.neg {
+		if a.neg {
+			return -1
+		}
+		return 1
+	}
+	c := len(a.int) - len(b.int)
+	if c == 0 {
+		c = bytes.Compare(a.int, b.int)
+	}
+	if c == 0 {
+		c = bytes.Compare(a.frac, b.frac)
+	}
+	if a.neg {
+		return -c
+	}
+	return c
+}
+
+func compareNumeric(a, b []byte) int {
+	x, y := parseNumber(a), parseNumber(b)
+	return sign(compareNumbers(&x, &y))
+}
+
+// numberPrefix packs n into 64 bits: a sign bit, then the number of integer
+// digits in 7 bits, then as many digits as fit, 4 bits each. Negative numbers
+// have the bits after the sign inverted. Numbers with 127 or more integer
+// digits only get the length, since it can't tell them apart.
+func numberPrefix(n *number) uint64 {
+	p := uint64(127) << 56
+	if len(n.int) < 127 {
+		p = uint64(len(n.int)) << 56
+		shift := 56
+	digits:
+		for _, d := range [2][]byte{n.int, n.frac} {
+			for _, c := range d {
+				if shift == 0 {
+					break digits
+				}
+				shift -= 4
+				p |= uint64(c-'0') << uint(shift)
+			}
+		}
+	}
+	if n.neg {
+		return ^p &^ (1 << 63)
+	}
+	return p | 1<<63
+}
+
+func numericPrefix(b []byte) uint64 {
+	n := parseNumber(b)
+	return numberPrefix(&n)
+}
+
+// unitOrder ranks the suffixes of -h numbers.
+var unitOrder = [256]int8{
+	'K': 1, 'k': 1, 'M': 2, 'G': 3, 'T': 4, 'P': 5, 'E': 6, 'Z': 7, 'Y': 8,
+}
+
+// humanOrder returns the order of n's unit, negated for negative numbers.
+// Zero has no unit.
+func humanOrder(n *number) int {
+	if n.zero() || len(n.rest) == 0 {
+		return 0
+	}
+	o := int(unitOrder[n.rest[0]])
+	if n.neg {
+		return -o
+	}
+	return o
+}
+
+// compareHuman compares numbers with SI suffixes, like 2K and 1G: first by
+// suffix, then by number.
+func compareHuman(a, b []byte) int {
+	x, y := parseNumber(a), parseNumber(b)
+	if c := humanOrder(&x) - humanOrder(&y); c != 0 {
+		return sign(c)
+	}
+	return sign(compareNumbers(&x, &y))
+}
+
+// humanPrefix is the unit's order in the top byte, then the number's
+// prefix.
+func humanPrefix(b []byte) uint64 {
+	n := parseNumber(b)
+	return uint64(humanOrder(&n)+128)<<56 | numberPrefix(&n)>>8
+}
+
+func sign(c int) int {
+	switch {
+	case c < 0:
+		return -1
+	case c > 0:
+		return 1
+	}
+	return 0
+}
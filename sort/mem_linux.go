@@ -0,0 +1,12 @@
+package sort
+
+import "golang.org/x/sys/unix"
+
+// physMem returns the amount of physical memory, or 0 if it's unknown.
+func physMem() int64 {
+	var info unix.Sysinfo_t
+	if err := unix.Sysinfo(&info); err != nil {
+		return 0
+	}
+	return int64(info.Totalram) * int64(info.Unit)
+}
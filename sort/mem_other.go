@@ -0,0 +1,6 @@
+// +build !linux
+
+package sort
+
+// physMem returns the amount of physical memory, or 0 if it's unknown.
+func physMem() int64 { return 0 }
@@ -0,0 +1,203 @@
+package sort
+
+import (
+	"bufio"
+	"io"
+)
+
+// mergeBufSize is the size of the buffer for each file being merged.
+const mergeBufSize = 256 * 1024
+
+// source is a sorted stream of lines. next returns the next line, without its
+// delimiter, which is only valid until the following call, and the prefix of
+// its first key. At the end it returns io.EOF.
+type source interface {
+	next() ([]byte, uint64, error)
+}
+
+// merger merges sources with a loser tree: after the first line, each one
+// costs a single comparison per level of the tree, log2(len(srcs)) in all.
+//
+// The tree is stored like a heap. tree[0] is the source with the smallest
+// current line, and every other node holds the source that lost the match
+// played there. Ties go to the earlier source, so a merge is stable.
+type merger struct {
+	srcs []source
+	cur  [][]byte
+	keys []uint64 // prefixes of cur
+	done []bool
+	tree []int
+	cmp  func(a, b []byte) int
+}
+
+func newMerger(srcs []source, cmp func(a, b []byte) int) (*merger, error) {
+	k := len(srcs)
+	m := &merger{
+		srcs: srcs,
+		cur:  make([][]byte, k),
+		keys: make([]uint64, k),
+		done: make([]bool, k),
+		tree: make([]int, k),
+		cmp:  cmp,
+	}
+	for i := range srcs {
+		if err := m.advance(i); err != nil {
+			return nil, err
+		}
+	}
+	if k == 0 {
+		return m, nil
+	}
+
+	// Play the first round bottom up, with the leaves at k+i.
+	win := make([]int, 2*k)
+	for i := 0; i < k; i++ {
+		win[k+i] = i
+	}
+	for n := k - 1; n >= 1; n-- {
+		a, b := win[2*n], win[2*n+1]
+		if m.less(b, a) {
+			a, b = b, a
+		}
+		win[n], m.tree[n] = a, b
+	}
+	m.tree[0] = win[1]
+	return m, nil
+}
+
+func (m *merger) advance(i int) error {
+	b, key, err := m.srcs[i].next()
+	if err == io.EOF {
+		m.cur[i], m.done[i] = nil, true
+		return nil
+	}
+	if err != nil {
+		return err
+	}
+	m.cur[i], m.keys[i] = b, key
+	return nil
+}
+
+// less reports whether source i's line goes before source j's. Finished
+// sources go after everything.
+func (m *merger) less(i, j int) bool {
+	if m.done[i] || m.done[j] {
+		return !m.done[i]
+	}
+	if m.keys[i] != m.keys[j] {
+		return m.keys[i] < m.keys[j]
+	}
+	if c := m.cmp(m.cur[i], m.cur[j]); c != 0 {
+		return c < 0
+	}
+	return i < j
+}
+
+// writeTo writes the merged lines to w.
+func (m *merger) writeTo(w *lineWriter) error {
+	k := len(m.srcs)
+	if k == 0 {
+		return nil
+	}
+	for {
+		i := m.tree[0]
+		if m.done[i] {
+			return nil
+		}
+		w.put(m.cur[i])
+		if err := m.advance(i); err != nil {
+			return err
+		}
+		for n := (i + k) / 2; n >= 1; n /= 2 {
+			if m.less(m.tree[n], i) {
+				m.tree[n], i = i, m.tree[n]
+			}
+		}
+		m.tree[0] = i
+	}
+}
+
+// lineWriter writes lines, each followed by the delimiter. With unique set,
+// it drops lines equal to the one before.
+type lineWriter struct {
+	w      *bufio.Writer
+	delim  byte
+	unique bool
+	cmp    func(a, b []byte) int
+	prev   []byte
+	any    bool
+}
+
+func (s *Sorter) newLineWriter(w io.Writer) *lineWriter {
+	return &lineWriter{
+		w:      bufio.NewWriterSize(w, mergeBufSize),
+		delim:  s.delim(),
+		unique: s.Unique,
+		cmp:    s.cmp,
+	}
+}
+
+func (w *lineWriter) put(b []byte) {
+	if w.unique {
+		if w.any && w.cmp(w.prev, b) == 0 {
+			return
+		}
+		w.prev = append(w.prev[:0], b...)
+		w.any = true
+	}
+	// Errors stick in w.w, and are reported by flush.
+	w.w.Write(b)
+	w.w.WriteByte(w.delim)
+}
+
+func (w *lineWriter) flush() error {
+	return w.w.Flush()
+}
+
+// readerSource reads lines from a stream.
+type readerSource struct {
+	r      *bufio.Reader
+	delim  byte
+	prefix func([]byte) uint64
+	long   []byte // holds lines longer than r's buffer
+	name   string
+}
+
+func (s *Sorter) newReaderSource(r io.Reader, name string) *readerSource {
+	return &readerSource{
+		r:      bufio.NewReaderSize(r, mergeBufSize),
+		delim:  s.delim(),
+		prefix: s.prefix,
+		name:   name,
+	}
+}
+
+func (s *readerSource) next() ([]byte, uint64, error) {
+	b, err := s.line()
+	if err != nil {
+		return nil, 0, err
+	}
+	return b, s.prefix(b), nil
+}
+
+func (s *readerSource) line() ([]byte, error) {
+	b, err := s.r.ReadSlice(s.delim)
+	if err == bufio.ErrBufferFull {
+		s.long = append(s.long[:0], b...)
+		for err == bufio.ErrBufferFull {
+			b, err = s.r.ReadSlice(s.delim)
+			s.long = append(s.long, b...)
+		}
+		b = s.long
+	}
+	switch {
+	case err == io.EOF:
+		if len(b) == 0 {
+			return nil, io.EOF
+		}
+		return b, nil // the last line, without a delimiter
+	case err != nil:
+		return nil, &readError{name: s.name, err: err}
+	}
+	return b[:len(b)-1], nil
+}
@@ -0,0 +1,222 @@
+package sort
+
+import (
+	"bytes"
+	"io"
+	"math"
+	"sort"
+	"sync"
+)
+
+// minPart is the smallest number of lines sortRun gives a goroutine of its
+// own.
+const minPart = 4096
+
+// minRead is the least free space fill reads into.
+const minRead = 64 * 1024
+
+// lineOverhead is what each line costs on top of its bytes: its entry in
+// lines, twice over since appending may have doubled it.
+const lineOverhead = 32
+
+// maxRun bounds one run's data, so offsets into it fit in a line.
+const maxRun = math.MaxUint32
+
+// line is a line held in a run: data[off:off+n], without its delimiter, and
+// the prefix of its first key.
+type line struct {
+	off, n uint32
+	key    uint64
+}
+
+// memRun is a batch of lines small enough to sort in memory. Every line is kept
+// in one arena, data, which is read into directly, and is referred to by
+// offset, so holding a line costs no allocation and no pointer for the GC to
+// scan.
+type memRun struct {
+	data  []byte
+	lines []line
+	// tail is where the incomplete line at the end of data starts. It's
+	// moved to the front of data by reset, for the next run.
+	tail int
+}
+
+func (r *memRun) bytes(l line) []byte {
+	return r.data[l.off : l.off+l.n : l.off+l.n]
+}
+
+// reset empties r, keeping the incomplete line read last.
+func (r *memRun) reset() {
+	n := copy(r.data, r.data[r.tail:])
+	r.data = r.data[:n]
+	r.lines = r.lines[:0]
+	r.tail = 0
+}
+
+// inputs reads the input files one after the other, as lines.
+type inputs struct {
+	s     *Sorter
+	names []string
+	cur   io.ReadCloser
+	name  string
+}
+
+// fill reads lines into r until it uses about limit bytes or the input runs
+// out, and reports whether there's more input to read. A line that doesn't
+// end with the delimiter is ended by the end of its file.
+func (in *inputs) fill(r *memRun, limit int64) (more bool, err error) {
+	if limit > maxRun {
+		limit = maxRun
+	}
+	delim := in.s.delim()
+	scanned := len(r.data)
+	for {
+		if in.cur == nil {
+			if len(in.names) == 0 {
+				return false, nil
+			}
+			in.name = in.names[0]
+			in.names = in.names[1:]
+			if in.cur, err = in.s.open(in.name); err != nil {
+				return false, err
+			}
+		}
+
+		if cap(r.data)-len(r.data) < minRead {
+			used := int64(len(r.data)) + lineOverhead*int64(len(r.lines))
+			if used+minRead > limit && len(r.lines) > 0 {
+				return true, nil
+			}
+			// Grow the arena. A line longer than limit is allowed
+			// to go over it, since it has to fit somewhere.
+			size := 2 * int64(cap(r.data))
+			if max := limit - lineOverhead*int64(len(r.lines)); size > max {
+				size = max
+			}
+			if min := int64(len(r.data)) + minRead; size < min {
+				size = min
+			}
+			data := make([]byte, len(r.data), size)
+			copy(data, r.data)
+			r.data = data
+		}
+
+		n, rerr := in.cur.Read(r.data[len(r.data):cap(r.data)])
+		r.data = r.data[:len(r.data)+n]
+		for i := scanned; i < len(r.data); i++ {
+			j := bytes.IndexByte(r.data[i:], delim)
+			if j < 0 {
+				break
+			}
+			i += j
+			r.lines = append(r.lines, line{off: uint32(r.tail), n: uint32(i - r.tail)})
+			r.tail = i + 1
+		}
+		scanned = len(r.data)
+
+		if rerr == io.EOF {
+			if r.tail < len(r.data) {
+				r.lines = append(r.lines, line{off: uint32(r.tail), n: uint32(len(r.data) - r.tail)})
+				r.tail = len(r.data)
+			}
+			in.cur.Close()
+			in.cur = nil
+			continue
+		}
+		if rerr != nil {
+			return false, &readError{name: in.name, err: rerr}
+		}
+	}
+}
+
+func (in *inputs) close() {
+	if in.cur != nil {
+		in.cur.Close()
+		in.cur = nil
+	}
+}
+
+// lineSorter sorts one part of a run.
+type lineSorter struct {
+	r     *memRun
+	lines []line
+	cmp   func(a, b []byte) int
+}
+
+func (s *lineSorter) Len() int      { return len(s.lines) }
+func (s *lineSorter) Swap(i, j int) { s.lines[i], s.lines[j] = s.lines[j], s.lines[i] }
+
+// Less compares prefixes, then whole keys, then where the lines are in the
+// run, so equal lines stay in input order without a stable sort.
+func (s *lineSorter) Less(i, j int) bool {
+	a, b := &s.lines[i], &s.lines[j]
+	if a.key != b.key {
+		return a.key < b.key
+	}
+	if c := s.cmp(s.r.bytes(*a), s.r.bytes(*b)); c != 0 {
+		return c < 0
+	}
+	return a.off < b.off
+}
+
+// sortRun cuts r's lines into up to s.Parallel parts, finds the prefixes of
+// their keys and sorts them, all at the same time, and returns them. The sorted run is the merge of the parts, which
+// spill and Sort do as they write it out, so the parts are never merged in
+// memory.
+func (s *Sorter) sortRun(r *memRun) [][]line {
+	n := s.Parallel
+	if max := len(r.lines) / minPart; n > max {
+		n = max
+	}
+	if n < 1 {
+		n = 1
+	}
+	parts := make([][]line, n)
+	size := (len(r.lines) + n - 1) / n
+	for i := range parts {
+		lo, hi := i*size, (i+1)*size
+		if hi > len(r.lines) {
+			hi = len(r.lines)
+		}
+		parts[i] = r.lines[lo:hi]
+	}
+
+	var wg sync.WaitGroup
+	wg.Add(n)
+	for i := range parts {
+		go func(part []line) {
+			defer wg.Done()
+			for i := range part {
+				part[i].key = s.prefix(r.bytes(part[i]))
+			}
+			ls := &lineSorter{r: r, lines: part, cmp: s.cmp}
+			sort.Sort(ls)
+		}(parts[i])
+	}
+	wg.Wait()
+	return parts
+}
+
+// memSource reads the lines of a sorted part of a run.
+type memSource struct {
+	r     *memRun
+	lines []line
+}
+
+func (m *memSource) next() ([]byte, uint64, error) {
+	if len(m.lines) == 0 {
+		return nil, 0, io.EOF
+	}
+	l := m.lines[0]
+	m.lines = m.lines[1:]
+	return m.r.bytes(l), l.key, nil
+}
+
+// sources returns a source for each part of r.
+func (r *memRun) sources(parts [][]line) []source {
+	srcs := make([]source, len(parts))
+	for i, p := range parts {
+		srcs[i] = &memSource{r: r, lines: p}
+	}
+	return srcs
+}
@@ -1,3 +1,436 @@
-package main
+// Package sort sorts, merges and checks text files, line by line.
+//
+// The input is read in runs: as many lines as fit in BufferSize bytes are
+// read into one arena, sorted by Parallel goroutines at once and, if there's
+// more input than fits, written to a temporary file. The runs are then merged
+// with a loser tree, BatchSize at a time, until one merge writes the output.
+// Since only one run is held at a time, inputs much larger than memory can be
+// sorted.
+//
+// Lines are compared byte by byte, as in the C locale, or by keys. The first
+// key of each line is encoded once, when it's read, as a 64-bit prefix that
+// orders lines the same way, so most comparisons are of two integers.
+package sort
 
-func main() {}
+import (
+	"bytes"
+	"errors"
+	"fmt"
+	"io"
+	"io/ioutil"
+	"os"
+	"runtime"
+)
+
+// DefaultBatchSize is how many files are merged at once, by default.
+const DefaultBatchSize = 16
+
+// Sorter sorts lines. Its fields may be changed until it's first used.
+type Sorter struct {
+	Reverse        bool
+	Unique         bool // output only the first of equal lines
+	Stable         bool // don't compare whole lines when their keys are equal
+	ZeroTerminated bool // lines end with NUL, not newline
+
+	// Keys are compared in order. Keys without options of their own take
+	// the global ones below, and Reverse. With no keys, the whole line is
+	// the key.
+	Keys           []Key
+	FieldSeparator int // or -1 to split fields at blanks
+	IgnoreBlanks   bool
+	IgnoreCase     bool
+	Numeric        bool
+	HumanNumeric   bool
+
+	BufferSize int64    // memory for a run, in bytes
+	Parallel   int      // goroutines sorting a run
+	BatchSize  int      // files merged at once
+	TempDirs   []string // temporary files are spread across these
+
+	// Stdin is read for the input "-".
+	Stdin io.Reader
+
+	cmp    func(a, b []byte) int
+	prefix func([]byte) uint64 // of the first key
+	temps  map[string]bool
+	ntemp  int
+}
+
+// NewSorter returns a Sorter with the default settings.
+func NewSorter() *Sorter {
+	return &Sorter{
+		FieldSeparator: -1,
+		BufferSize:     defaultBufferSize(),
+		Parallel:       runtime.NumCPU(),
+		BatchSize:      DefaultBatchSize,
+		TempDirs:       []string{os.TempDir()},
+		Stdin:          os.Stdin,
+	}
+}
+
+func (s *Sorter) init() error {
+	if s.cmp != nil {
+		return nil
+	}
+	if err := s.compile(); err != nil {
+		return err
+	}
+	if s.Parallel < 1 {
+		s.Parallel = 1
+	}
+	if s.BatchSize < 2 {
+		s.BatchSize = 2
+	}
+	if s.BufferSize < minRead {
+		s.BufferSize = minRead
+	}
+	s.temps = make(map[string]bool)
+	return nil
+}
+
+// compile builds s.cmp and s.prefix for the keys and options. Comparing
+// lines is what sorting spends its time on, so the functions are put
+// together here to do only what the options ask for.
+func (s *Sorter) compile() error {
+	if s.Numeric && s.HumanNumeric {
+		return errors.New("options '-hn' are incompatible")
+	}
+	global := Key{
+		eword:       -1,
+		skipsblanks: s.IgnoreBlanks,
+		skipeblanks: s.IgnoreBlanks,
+		fold:        s.IgnoreCase,
+		numeric:     s.Numeric,
+		human:       s.HumanNumeric,
+		reverse:     s.Reverse,
+	}
+	keys := append([]Key(nil), s.Keys...)
+	for i := range keys {
+		if !keys[i].ordered() {
+			global.sword, global.schar = keys[i].sword, keys[i].schar
+			global.eword, global.echar = keys[i].eword, keys[i].echar
+			keys[i] = global
+		}
+	}
+	if len(keys) == 0 && (s.IgnoreBlanks || s.IgnoreCase || s.Numeric || s.HumanNumeric) {
+		keys = []Key{global}
+	}
+
+	if len(keys) == 0 {
+		s.cmp, s.prefix = bytes.Compare, bytesPrefix
+		if s.Reverse {
+			s.cmp = func(a, b []byte) int { return bytes.Compare(b, a) }
+			s.prefix = func(b []byte) uint64 { return ^bytesPrefix(b) }
+		}
+		return nil
+	}
+
+	cmps := make([]func(a, b []byte) int, len(keys))
+	for i := range keys {
+		var prefix func([]byte) uint64
+		cmps[i], prefix = keys[i].comparator(s.FieldSeparator)
+		if i == 0 {
+			s.prefix = prefix
+		}
+	}
+	// Lines with equal keys are compared as a whole, unless that's
+	// been turned off.
+	if !s.Stable && !s.Unique {
+		last := bytes.Compare
+		if s.Reverse {
+			last = func(a, b []byte) int { return bytes.Compare(b, a) }
+		}
+		cmps = append(cmps, last)
+	}
+
+	switch len(cmps) {
+	case 1:
+		s.cmp = cmps[0]
+	case 2:
+		first, second := cmps[0], cmps[1]
+		s.cmp = func(a, b []byte) int {
+			if c := first(a, b); c != 0 {
+				return c
+			}
+			return second(a, b)
+		}
+	default:
+		s.cmp = func(a, b []byte) int {
+			for _, cmp := range cmps {
+				if c := cmp(a, b); c != 0 {
+					return c
+				}
+			}
+			return 0
+		}
+	}
+	return nil
+}
+
+func (s *Sorter) delim() byte {
+	if s.ZeroTerminated {
+		return 0
+	}
+	return '\n'
+}
+
+// Sort writes the lines of the named files, sorted, to w. Nothing is written
+// until all of the input has been read, so w may truncate one of the inputs.
+func (s *Sorter) Sort(w io.Writer, names ...string) error {
+	if err := s.init(); err != nil {
+		return err
+	}
+	defer s.cleanup()
+
+	in := &inputs{s: s, names: names}
+	defer in.close()
+
+	var (
+		r    memRun
+		runs []string
+	)
+	for {
+		more, err := in.fill(&r, s.BufferSize)
+		if err != nil {
+			return err
+		}
+		parts := s.sortRun(&r)
+		if !more && runs == nil {
+			return s.write(w, r.sources(parts))
+		}
+		name, err := s.spill(r.sources(parts))
+		if err != nil {
+			return err
+		}
+		runs = append(runs, name)
+		if !more {
+			break
+		}
+		r.reset()
+	}
+	r = memRun{} // the merge doesn't need it
+	return s.merge(w, runs)
+}
+
+// Merge writes the lines of the named files, which must already be sorted,
+// to w.
+func (s *Sorter) Merge(w io.Writer, names ...string) error {
+	if err := s.init(); err != nil {
+		return err
+	}
+	defer s.cleanup()
+	return s.merge(w, names)
+}
+
+// Check reads the named file and returns a *DisorderError describing the
+// first line that's out of order, or nil if there's none.
+func (s *Sorter) Check(name string) error {
+	if err := s.init(); err != nil {
+		return err
+	}
+	f, err := s.open(name)
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+
+	src := s.newReaderSource(f, name)
+	var prev []byte
+	for n := int64(1); ; n++ {
+		b, _, err := src.next()
+		if err == io.EOF {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+		if n > 1 {
+			c := s.cmp(prev, b)
+			if c > 0 || c == 0 && s.Unique {
+				return &DisorderError{Name: name, Line: n, Text: string(b)}
+			}
+		}
+		prev = append(prev[:0], b...)
+	}
+}
+
+// write merges srcs to w.
+func (s *Sorter) write(w io.Writer, srcs []source) error {
+	m, err := newMerger(srcs, s.cmp)
+	if err != nil {
+		return err
+	}
+	lw := s.newLineWriter(w)
+	if err := m.writeTo(lw); err != nil {
+		return err
+	}
+	return lw.flush()
+}
+
+// spill merges srcs to a new temporary file and returns its name.
+func (s *Sorter) spill(srcs []source) (string, error) {
+	f, err := s.tempFile()
+	if err != nil {
+		return "", err
+	}
+	err = s.write(f, srcs)
+	if cerr := f.Close(); err == nil {
+		err = cerr
+	}
+	return f.Name(), err
+}
+
+// merge merges the named sorted files to w. Files are merged BatchSize at a
+// time, into temporary files, until the last merge can go straight to w.
+// Neighbouring files are merged together so that, as ties go to the earlier
+// file, order is kept from one pass to the next.
+func (s *Sorter) merge(w io.Writer, names []string) error {
+	for len(names) > s.BatchSize {
+		var next []string
+		for i := 0; i < len(names); i += s.BatchSize {
+			group := names[i:]
+			if len(group) > s.BatchSize {
+				group = group[:s.BatchSize]
+			}
+			if len(group) == 1 {
+				next = append(next, group[0])
+				continue
+			}
+			f, err := s.tempFile()
+			if err != nil {
+				return err
+			}
+			err = s.mergeFiles(f, group)
+			if cerr := f.Close(); err == nil {
+				err = cerr
+			}
+			if err != nil {
+				return err
+			}
+			next = append(next, f.Name())
+		}
+		names = next
+	}
+	return s.mergeFiles(w, names)
+}
+
+// mergeFiles merges the named files to w, then removes any that were
+// temporary.
+func (s *Sorter) mergeFiles(w io.Writer, names []string) error {
+	srcs := make([]source, len(names))
+	for i, name := range names {
+		f, err := s.open(name)
+		if err != nil {
+			return err
+		}
+		defer f.Close()
+		srcs[i] = s.newReaderSource(f, name)
+	}
+	if err := s.write(w, srcs); err != nil {
+		return err
+	}
+	for _, name := range names {
+		if s.temps[name] {
+			os.Remove(name)
+			delete(s.temps, name)
+		}
+	}
+	return nil
+}
+
+func (s *Sorter) open(name string) (io.ReadCloser, error) {
+	if name == "-" {
+		return ioutil.NopCloser(s.Stdin), nil
+	}
+	f, err := os.Open(name)
+	if err != nil {
+		return nil, &readError{name: name, err: err}
+	}
+	return f, nil
+}
+
+// tempFile creates a temporary file, taking each of TempDirs in turn.
+func (s *Sorter) tempFile() (*os.File, error) {
+	dir := os.TempDir()
+	if len(s.TempDirs) > 0 {
+		dir = s.TempDirs[s.ntemp%len(s.TempDirs)]
+		s.ntemp++
+	}
+	f, err := ioutil.TempFile(dir, "sort")
+	if err != nil {
+		return nil, fmt.Errorf("cannot create temporary file in '%s': %v", dir, unwrap(err))
+	}
+	s.temps[f.Name()] = true
+	return f, nil
+}
+
+// copyToTemp copies the named file to a temporary file, and returns its name.
+func (s *Sorter) copyToTemp(name string) (string, error) {
+	if err := s.init(); err != nil {
+		return "", err
+	}
+	r, err := s.open(name)
+	if err != nil {
+		return "", err
+	}
+	defer r.Close()
+	f, err := s.tempFile()
+	if err != nil {
+		return "", err
+	}
+	_, err = io.Copy(f, r)
+	if cerr := f.Close(); err == nil {
+		err = cerr
+	}
+	return f.Name(), err
+}
+
+// cleanup removes the temporary files left.
+func (s *Sorter) cleanup() {
+	for name := range s.temps {
+		os.Remove(name)
+	}
+	s.temps = make(map[string]bool)
+}
+
+// DisorderError is returned by Check for a line that's out of order.
+type DisorderError struct {
+	Name string
+	Line int64
+	Text string
+}
+
+func (e *DisorderError) Error() string {
+	return fmt.Sprintf("%s:%d: disorder: %s", e.Name, e.Line, e.Text)
+}
+
+type readError struct {
+	name string
+	err  error
+}
+
+func (e *readError) Error() string {
+	return fmt.Sprintf("cannot read: %s: %v", e.name, unwrap(e.err))
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
+
+// defaultBufferSize is an eighth of physical memory, but at least 64MB. If
+// the amount of memory is unknown it's 256MB.
+func defaultBufferSize() int64 {
+	const min = 64 << 20
+	mem := physMem()
+	switch {
+	case mem == 0:
+		return 256 << 20
+	case mem/8 < min:
+		return min
+	default:
+		return mem / 8
+	}
+}
@@ -0,0 +1,277 @@
+package sort
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+func randomLines(n int, seed int64) []string {
+	rng := rand.New(rand.NewSource(seed))
+	lines := make([]string, n)
+	for i := range lines {
+		b := make([]byte, rng.Intn(20))
+		for j := range b {
+			const chars = "abcXYZ019 \t\xff"
+			b[j] = chars[rng.Intn(len(chars))]
+		}
+		lines[i] = string(b)
+	}
+	return lines
+}
+
+func runSort(t *testing.T, stdin string, args ...string) (string, error) {
+	stdout, stderr, err := cmdtest.Run(run, stdin, args...)
+	if err != nil && stderr == "" && err != errDisorder {
+		t.Errorf("%q: error %v wasn't reported", args, err)
+	}
+	return stdout, err
+}
+
+func TestSort(t *testing.T) {
+	lines := randomLines(50000, 1)
+	in := strings.Join(lines, "\n")
+
+	sorted := append([]string(nil), lines...)
+	sort.Strings(sorted)
+	var uniq []string
+	for i, s := range sorted {
+		if i == 0 || s != sorted[i-1] {
+			uniq = append(uniq, s)
+		}
+	}
+	reverse := func(s []string) []string {
+		r := make([]string, len(s))
+		for i := range s {
+			r[len(s)-1-i] = s[i]
+		}
+		return r
+	}
+	join := func(s []string) string { return strings.Join(s, "\n") + "\n" }
+
+	for _, tc := range []struct {
+		args []string
+		want []string
+	}{
+		{nil, sorted},
+		{[]string{"-r"}, reverse(sorted)},
+		{[]string{"-u"}, uniq},
+		{[]string{"-ru"}, reverse(uniq)},
+		{[]string{"--parallel=1"}, sorted},
+		// Small enough to spill runs, and to take several passes to
+		// merge them.
+		{[]string{"-S", "100K"}, sorted},
+		{[]string{"-S", "100K", "--batch-size=2", "-u"}, uniq},
+		{[]string{"-S", "100K", "--parallel=3", "-r"}, reverse(sorted)},
+	} {
+		tmp, err := ioutil.TempDir("", "sort")
+		if err != nil {
+			t.Fatal(err)
+		}
+		args := append([]string{"-T", tmp}, tc.args...)
+		got, err := runSort(t, in, args...)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.args, err)
+		}
+		if want := join(tc.want); got != want {
+			t.Errorf("%q: wrong output (%d bytes, want %d)", tc.args, len(got), len(want))
+		}
+		if left, _ := ioutil.ReadDir(tmp); len(left) > 0 {
+			t.Errorf("%q: %d temporary files left", tc.args, len(left))
+		}
+		os.RemoveAll(tmp)
+	}
+
+	got, err := runSort(t, strings.Replace(in, "\n", "\x00", -1), "-z")
+	if want := strings.Replace(join(sorted), "\n", "\x00", -1); err != nil || got != want {
+		t.Errorf("-z: wrong output (%v)", err)
+	}
+}
+
+func TestMergeAndCheck(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "sort")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+
+	var all, names []string
+	for i := 0; i < 5; i++ {
+		lines := randomLines(1000, int64(i))
+		sort.Strings(lines)
+		all = append(all, lines...)
+		name := filepath.Join(tmp, fmt.Sprint(i))
+		if err := ioutil.WriteFile(name, []byte(strings.Join(lines, "\n")+"\n"), 0644); err != nil {
+			t.Fatal(err)
+		}
+		names = append(names, name)
+	}
+	sort.Strings(all)
+	want := strings.Join(all, "\n") + "\n"
+
+	args := append([]string{"-m", "--batch-size=2", "-T", tmp}, names...)
+	if got, err := runSort(t, "", args...); err != nil || got != want {
+		t.Errorf("-m: wrong output (%v)", err)
+	}
+
+	// The output may be one of the inputs.
+	args = append([]string{"-m", "-o", names[0]}, names...)
+	if _, err := runSort(t, "", args...); err != nil {
+		t.Fatal(err)
+	}
+	if got, _ := ioutil.ReadFile(names[0]); string(got) != want {
+		t.Error("-m -o: wrong output")
+	}
+
+	if _, err := runSort(t, "", "-c", names[0]); err != nil {
+		t.Errorf("-c: %v", err)
+	}
+	var stderr bytes.Buffer
+	err = run(coreutils.Context{
+		Context: context.Background(),
+		Stdin:   strings.NewReader("a\nc\nb\n"),
+		Stdout:  ioutil.Discard,
+		Stderr:  &stderr,
+	}, "-c")
+	if err != errDisorder || stderr.String() != "sort: -:3: disorder: b\n" {
+		t.Errorf("-c: got %v, %q", err, stderr.String())
+	}
+	if _, err := runSort(t, "a\na\n", "-cu"); err != errDisorder {
+		t.Errorf("-cu: got %v, want a disorder", err)
+	}
+}
+
+func TestKeys(t *testing.T) {
+	const in = "b 10 x\na 9 y\nc -1.5 z\nA 1K w\nd 2M v\nB  010 u\n"
+	for _, tc := range []struct {
+		args []string
+		want string
+	}{
+		{[]string{"-k2,2n"}, "c -1.5 z|A 1K w|d 2M v|a 9 y|B  010 u|b 10 x|"},
+		{[]string{"-k2,2h"}, "c -1.5 z|a 9 y|B  010 u|b 10 x|A 1K w|d 2M v|"},
+		{[]string{"-k1,1f"}, "A 1K w|a 9 y|B  010 u|b 10 x|c -1.5 z|d 2M v|"},
+		{[]string{"-k1,1f", "-s"}, "a 9 y|A 1K w|b 10 x|B  010 u|c -1.5 z|d 2M v|"},
+		{[]string{"-k2b,2", "-k1,1r"}, "c -1.5 z|B  010 u|b 10 x|A 1K w|d 2M v|a 9 y|"},
+		{[]string{"-t,", "-k2"}, "A 1K w|B  010 u|a 9 y|b 10 x|c -1.5 z|d 2M v|"},
+		{[]string{"-uf", "-k1,1"}, "a 9 y|b 10 x|c -1.5 z|d 2M v|"},
+		{[]string{"-k1.1,1.1", "-k3,3r"}, "A 1K w|B  010 u|a 9 y|b 10 x|c -1.5 z|d 2M v|"},
+	} {
+		got, err := runSort(t, in, tc.args...)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.args, err)
+		}
+		if got = strings.Replace(got, "\n", "|", -1); got != tc.want {
+			t.Errorf("%q: got %q, want %q", tc.args, got, tc.want)
+		}
+	}
+
+	for _, spec := range []string{"0", "1.0", "x", "1,", "1x", "1d", "2,1nh"} {
+		if _, err := ParseKey(spec); err == nil {
+			t.Errorf("%q: no error", spec)
+		}
+	}
+}
+
+// TestPrefix checks that prefixes never order two keys differently than
+// comparing them in full does.
+func TestPrefix(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	const chars = "-.0123456789 KMk"
+	keys := make([][]byte, 2000)
+	for i := range keys {
+		b := make([]byte, rng.Intn(24))
+		for j := range b {
+			b[j] = chars[rng.Intn(len(chars))]
+		}
+		keys[i] = b
+	}
+	keys = append(keys, []byte("-0"), []byte("0"), []byte("00.000"), []byte("-"),
+		[]byte(strings.Repeat("9", 130)), []byte(strings.Repeat("1", 140)))
+
+	for _, k := range []Key{
+		{eword: -1},
+		{eword: -1, fold: true},
+		{eword: -1, numeric: true},
+		{eword: -1, human: true},
+		{eword: -1, numeric: true, reverse: true},
+	} {
+		cmp, prefix := k.comparator(-1)
+		for i := 0; i < 20000; i++ {
+			a, b := keys[rng.Intn(len(keys))], keys[rng.Intn(len(keys))]
+			pa, pb := prefix(a), prefix(b)
+			c := cmp(a, b)
+			if pa < pb && c >= 0 || pa > pb && c <= 0 {
+				t.Fatalf("%+v: %q and %q: prefixes %x and %x, compare %d", k, a, b, pa, pb, c)
+			}
+		}
+	}
+}
+
+func TestParseSize(t *testing.T) {
+	for arg, want := range map[string]int64{
+		"10":   10 << 10,
+		"10b":  10,
+		"10K":  10 << 10,
+		"3M":   3 << 20,
+		"2G":   2 << 30,
+		"1T":   1 << 40,
+		"9E":   1<<63 - 1,
+		"99e9": -1,
+		"":     -1,
+		"M":    -1,
+		"1X":   -1,
+	} {
+		got, err := parseSize(arg)
+		if want < 0 {
+			if err == nil {
+				t.Errorf("%q: got %d, want an error", arg, got)
+			}
+			continue
+		}
+		if err != nil || got != want {
+			t.Errorf("%q: got %d, %v, want %d", arg, got, err, want)
+		}
+	}
+}
+
+func benchmarkSort(b *testing.B, in string, setup func(*Sorter)) {
+	b.SetBytes(int64(len(in)))
+	for i := 0; i < b.N; i++ {
+		s := NewSorter()
+		s.Stdin = strings.NewReader(in)
+		setup(s)
+		if err := s.Sort(ioutil.Discard, "-"); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkSort(b *testing.B) {
+	benchmarkSort(b, strings.Join(randomLines(200000, 1), "\n"), func(*Sorter) {})
+}
+
+func BenchmarkSortNumericKey(b *testing.B) {
+	rng := rand.New(rand.NewSource(1))
+	var in bytes.Buffer
+	for i := 0; i < 200000; i++ {
+		fmt.Fprintf(&in, "%x,%d,%d\n", rng.Int63(), rng.Intn(1e6)-5e5, rng.Intn(100))
+	}
+	k, err := ParseKey("2,2n")
+	if err != nil {
+		b.Fatal(err)
+	}
+	benchmarkSort(b, in.String(), func(s *Sorter) {
+		s.Keys = []Key{k}
+		s.FieldSeparator = ','
+	})
+}
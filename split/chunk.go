@@ -0,0 +1,234 @@
+package split
+
+import (
+	"bytes"
+	"io"
+	"os"
+	"runtime"
+	"sync"
+)
+
+// fileSize returns f's offset and how much of it there is after that, if
+// it's a regular file.
+func fileSize(f *os.File) (off, size int64, err error) {
+	info, err := f.Stat()
+	if err != nil {
+		return 0, 0, err
+	}
+	if !info.Mode().IsRegular() {
+		return 0, 0, ErrSize
+	}
+	if off, err = f.Seek(0, io.SeekCurrent); err != nil {
+		return 0, 0, ErrSize
+	}
+	if size = info.Size() - off; size < 0 {
+		size = 0
+	}
+	return off, size, nil
+}
+
+// chunker finds where each of n pieces of a file ends.
+type chunker struct {
+	f         *os.File
+	off, size int64
+	n, per    int64
+	lines     bool
+	delim     byte
+	buf       []byte
+}
+
+func (s *Splitter) chunker(f *os.File, off, size, n int64, lines bool) *chunker {
+	per := size / n
+	if per == 0 {
+		per = 1
+	}
+	return &chunker{f: f, off: off, size: size, n: n, per: per, lines: lines, delim: s.Delim}
+}
+
+// end returns where the kth piece ends, counting from 1, and from where the
+// pieces start.
+//
+// Each piece is given an equal share of the bytes, and the last one what's
+// left over. Split by lines, a piece ends instead with the line that's being
+// written when its share runs out, so a line longer than that can leave the
+// pieces after it empty. That only depends on where the share ends, so any
+// piece can be found without finding the others.
+func (c *chunker) end(k int64) (int64, error) {
+	if k == 0 {
+		return 0, nil
+	}
+	if k >= c.n {
+		return c.size, nil
+	}
+	e := k * c.per
+	if e >= c.size || !c.lines {
+		if e > c.size {
+			e = c.size
+		}
+		return e, nil
+	}
+	if c.buf == nil {
+		c.buf = make([]byte, 64*1024)
+	}
+	for at := e - 1; at < c.size; {
+		p := c.buf
+		if int64(len(p)) > c.size-at {
+			p = p[:c.size-at]
+		}
+		m, err := c.f.ReadAt(p, c.off+at)
+		if i := bytes.IndexByte(p[:m], c.delim); i >= 0 {
+			return at + int64(i) + 1, nil
+		}
+		if err == io.EOF {
+			break
+		}
+		if err != nil {
+			return 0, err
+		}
+		at += int64(m)
+	}
+	return c.size, nil
+}
+
+// Chunks splits f, which has to be a regular file, into n pieces of about
+// the same size, or, with lines, of about the same size without splitting
+// any lines. The pieces are copied at once, as many as Workers at a time.
+func (s *Splitter) Chunks(f *os.File, n int64, lines bool) error {
+	off, size, err := fileSize(f)
+	if err != nil {
+		return err
+	}
+	s.input(f)
+	names, err := s.names(n)
+	if err != nil {
+		return err
+	}
+	c := s.chunker(f, off, size, n, lines)
+	var k, at int64
+	return s.copyPieces(f, off, names, func() (int64, error) {
+		if k == n {
+			return -1, nil
+		}
+		k++
+		end, err := c.end(k)
+		m := end - at
+		at = end
+		return m, err
+	})
+}
+
+// Chunk writes the kth of the n pieces Chunks would split f into, counting
+// from 1, to w.
+func (s *Splitter) Chunk(w io.Writer, f *os.File, k, n int64, lines bool) error {
+	off, size, err := fileSize(f)
+	if err != nil {
+		return err
+	}
+	c := s.chunker(f, off, size, n, lines)
+	start, err := c.end(k - 1)
+	if err != nil {
+		return err
+	}
+	end, err := c.end(k)
+	if err != nil {
+		return err
+	}
+	return copyRange(w, f, off+start, end-start)
+}
+
+// piece is part of the input, to be copied to a file of its own.
+type piece struct {
+	f      *os.File
+	off, n int64
+}
+
+// copyPieces copies the pieces of in that start at off, each to a new file.
+// next returns how long each is, in order, and then a negative length. The
+// files are made in order, as the pieces are found, but the copying is left
+// to Workers goroutines.
+func (s *Splitter) copyPieces(in *os.File, off int64, names *namer, next func() (int64, error)) error {
+	workers := s.Workers
+	if workers <= 0 {
+		workers = runtime.NumCPU()
+	}
+
+	var (
+		pieces = make(chan piece, workers)
+		stop   = make(chan struct{})
+		once   sync.Once
+		mu     sync.Mutex
+		first  error
+		wg     sync.WaitGroup
+	)
+	fail := func(err error) {
+		mu.Lock()
+		if first == nil {
+			first = err
+		}
+		mu.Unlock()
+		once.Do(func() { close(stop) })
+	}
+	for i := 0; i < workers; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for p := range pieces {
+				select {
+				case <-stop:
+					p.f.Close()
+					continue
+				default:
+				}
+				err := copyRange(p.f, in, p.off, p.n)
+				if cerr := p.f.Close(); err == nil {
+					err = cerr
+				}
+				if err != nil {
+					fail(err)
+				}
+			}
+		}()
+	}
+
+	err := func() error {
+		for {
+			select {
+			case <-stop:
+				return nil
+			default:
+			}
+			n, err := next()
+			if err != nil || n < 0 {
+				return err
+			}
+			p := piece{off: off, n: n}
+			off += n
+			if n == 0 && s.Elide {
+				continue
+			}
+			name, err := names.next()
+			if err != nil {
+				return err
+			}
+			if p.f, err = s.create(name); err != nil {
+				return err
+			}
+			pieces <- p
+		}
+	}()
+	close(pieces)
+	wg.Wait()
+	if err != nil {
+		return err
+	}
+	return first
+}
+
+// copyBuffer copies n bytes at off in src to w through a buffer.
+func copyBuffer(w io.Writer, src *os.File, off, n int64) error {
+	if n <= 0 {
+		return nil
+	}
+	_, err := io.Copy(w, io.NewSectionReader(src, off, n))
+	return err
+}
@@ -0,0 +1,392 @@
+package split
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"strconv"
+	"strings"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("split", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -d but not --d.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+	bad2       = string(rune(uniNonChar + 2))
+)
+
+// noFrom is what --numeric-suffixes and --hex-suffixes are set to without
+// a FROM, which can't be one.
+const noFrom = "\x00"
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.StringVarP(&c.suffixLength, "suffix-length", "a", "", "generate suffixes of length N (default 2)")
+	c.f.StringVar(&c.additionalSuffix, "additional-suffix", "", "append an additional SUFFIX to file names")
+	c.f.StringVarP(&c.bytes, "bytes", "b", "", "put SIZE bytes per output file")
+	c.f.StringVarP(&c.lineBytes, "line-bytes", "C", "", "put at most SIZE bytes of records per output file")
+	c.f.BoolVarP(&c.numeric, bad1, "d", false, "use numeric suffixes starting at 0, not alphabetic")
+	c.f.StringVar(&c.numericFrom, "numeric-suffixes", "", "same as -d, but allow setting the start value")
+	c.f.Lookup("numeric-suffixes").NoOptDefVal = noFrom
+	c.f.BoolVarP(&c.hex, bad2, "x", false, "use hex suffixes starting at 0, not alphabetic")
+	c.f.StringVar(&c.hexFrom, "hex-suffixes", "", "same as -x, but allow setting the start value")
+	c.f.Lookup("hex-suffixes").NoOptDefVal = noFrom
+	c.f.BoolVarP(&c.elide, "elide-empty-files", "e", false, "do not generate empty output files with '-n'")
+	c.f.StringVarP(&c.lines, "lines", "l", "", "put NUMBER lines/records per output file")
+	c.f.StringVarP(&c.number, "number", "n", "", "generate CHUNKS output files")
+	c.f.StringVarP(&c.separator, "separator", "t", "", `use SEP instead of newline as the record separator;
+                            '\0' (zero) specifies the NUL character`)
+	c.f.BoolVarP(&c.unbuffered, "unbuffered", "u", false, "immediately copy input to output with '-n r/...'")
+	c.f.BoolVar(&c.verbose, "verbose", false, "print a diagnostic just before each output file is opened")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f                flag.FlagSet
+	suffixLength     string
+	additionalSuffix string
+	bytes            string
+	lineBytes        string
+	numeric          bool
+	numericFrom      string
+	hex              bool
+	hexFrom          string
+	elide            bool
+	lines            string
+	number           string
+	separator        string
+	unbuffered       bool
+	verbose          bool
+	version          bool
+}
+
+// mode is the way the input is split.
+type mode int
+
+const (
+	byLines mode = iota
+	byBytes
+	byLineBytes
+	byChunks
+	byLineChunks
+	roundRobin
+)
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(obsolete(args)); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "split (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "split: %v\n", err)
+		}
+	}()
+
+	s := NewSplitter()
+	m, n, k := byLines, int64(1000), int64(0)
+	ways := 0
+	for _, name := range []string{"bytes", "line-bytes", "lines", "number"} {
+		if c.f.Changed(name) {
+			ways++
+		}
+	}
+	if ways > 1 {
+		return errors.New("cannot split in more than one way")
+	}
+	switch {
+	case c.f.Changed("bytes"):
+		m = byBytes
+		if n, err = parseSize(c.bytes, "invalid number of bytes"); err != nil {
+			return err
+		}
+	case c.f.Changed("line-bytes"):
+		m = byLineBytes
+		if n, err = parseSize(c.lineBytes, "invalid number of bytes"); err != nil {
+			return err
+		}
+	case c.f.Changed("lines"):
+		if n, err = parseNumber(c.lines, "invalid number of lines", false); err != nil {
+			return err
+		}
+	case c.f.Changed("number"):
+		if m, k, n, err = parseChunks(c.number); err != nil {
+			return err
+		}
+	}
+
+	if c.f.Changed("suffix-length") {
+		v, err := parseNumber(c.suffixLength, "invalid suffix length", true)
+		if err != nil {
+			return err
+		}
+		if v > math.MaxInt32 {
+			return fmt.Errorf("invalid suffix length: '%s': value too large for defined data type", c.suffixLength)
+		}
+		s.SuffixLength = int(v)
+	}
+	if strings.ContainsRune(c.additionalSuffix, '/') {
+		return fmt.Errorf("invalid suffix '%s', contains directory separator", c.additionalSuffix)
+	}
+	s.AdditionalSuffix = c.additionalSuffix
+
+	// GNU split uses the alphabet given last and the last FROM given with
+	// either. The flags don't keep their order, so hex wins, but a FROM
+	// isn't lost.
+	from := c.numericFrom
+	if c.hexFrom != "" && c.hexFrom != noFrom {
+		from = c.hexFrom
+	}
+	if c.hex || c.f.Changed("hex-suffixes") {
+		s.Alphabet = Hex
+		if s.Start, err = parseFrom(from, Hex, "hexadecimal"); err != nil {
+			return err
+		}
+	} else if c.numeric || c.f.Changed("numeric-suffixes") {
+		s.Alphabet = Numeric
+		if s.Start, err = parseFrom(from, Numeric, "numerical"); err != nil {
+			return err
+		}
+	}
+
+	if c.f.Changed("separator") {
+		switch sep := c.separator; {
+		case sep == "":
+			return errors.New("empty record separator")
+		case sep == `\0`:
+			s.Delim = 0
+		case len(sep) > 1:
+			return fmt.Errorf("multi-character separator '%s'", strings.Replace(sep, `\`, `\\`, -1))
+		default:
+			s.Delim = sep[0]
+		}
+	}
+	s.Elide = c.elide
+	s.Unbuffered = c.unbuffered
+	if c.verbose {
+		s.Verbose = func(name string) {
+			fmt.Fprintf(ctx.Stdout, "creating file '%s'\n", name)
+		}
+	}
+
+	ops := c.f.Args()
+	if len(ops) > 2 {
+		return fmt.Errorf("extra operand '%s'", ops[2])
+	}
+	name := "-"
+	if len(ops) > 0 {
+		name = ops[0]
+	}
+	if len(ops) > 1 {
+		s.Prefix = ops[1]
+	}
+
+	var in io.Reader = ctx.Stdin
+	if name != "-" {
+		f, err := os.Open(name)
+		if err != nil {
+			return fmt.Errorf("cannot open '%s' for reading: %v", name, unwrap(err))
+		}
+		defer f.Close()
+		in = f
+	}
+
+	toStdout := k > 0
+	switch m {
+	case byLines:
+		err = s.Lines(in, n)
+	case byBytes:
+		err = s.Bytes(in, n)
+	case byLineBytes:
+		err = s.LineBytes(in, n)
+	case roundRobin:
+		if toStdout {
+			err = s.RoundRobinChunk(ctx.Stdout, in, k, n)
+		} else {
+			err = s.RoundRobin(in, n)
+		}
+	default:
+		f, ok := in.(*os.File)
+		if !ok {
+			err = ErrSize
+			break
+		}
+		if toStdout {
+			err = s.Chunk(ctx.Stdout, f, k, n, m == byLineChunks)
+		} else {
+			err = s.Chunks(f, n, m == byLineChunks)
+		}
+	}
+	if err == ErrSize {
+		return fmt.Errorf("%s: %v", name, err)
+	}
+	if pe, ok := err.(*os.PathError); ok {
+		switch {
+		case pe.Op == "read":
+			return fmt.Errorf("read error: %v", pe.Err)
+		case pe.Op == "write" && toStdout:
+			return fmt.Errorf("write error: %v", pe.Err)
+		}
+		return fmt.Errorf("%s: %v", pe.Path, pe.Err)
+	}
+	return err
+}
+
+// obsolete rewrites the obsolete "split -NUM" as "split -l NUM".
+func obsolete(args []string) []string {
+	if len(args) == 0 || len(args[0]) < 2 || args[0][0] != '-' {
+		return args
+	}
+	for _, c := range args[0][1:] {
+		if c < '0' || c > '9' {
+			return args
+		}
+	}
+	return append([]string{"-l", args[0][1:]}, args[1:]...)
+}
+
+var multipliers = map[string]int64{
+	"":    1,
+	"b":   512,
+	"k":   1 << 10,
+	"K":   1 << 10,
+	"KiB": 1 << 10,
+	"kB":  1000,
+	"KB":  1000,
+	"m":   1 << 20,
+	"M":   1 << 20,
+	"MiB": 1 << 20,
+	"MB":  1000 * 1000,
+	"G":   1 << 30,
+	"GiB": 1 << 30,
+	"GB":  1000 * 1000 * 1000,
+	"T":   1 << 40,
+	"TiB": 1 << 40,
+	"TB":  1000 * 1000 * 1000 * 1000,
+	"P":   1 << 50,
+	"PiB": 1 << 50,
+	"PB":  1000 * 1000 * 1000 * 1000 * 1000,
+	"E":   1 << 60,
+	"EiB": 1 << 60,
+	"EB":  1000 * 1000 * 1000 * 1000 * 1000 * 1000,
+	// Too large for anything.
+	"Z": -1, "ZiB": -1, "ZB": -1,
+	"Y": -1, "YiB": -1, "YB": -1,
+	"R": -1, "RiB": -1, "RB": -1,
+	"Q": -1, "QiB": -1, "QB": -1,
+}
+
+// parseNumber parses a decimal number, which can follow spaces and a plus
+// sign, and with units, have a multiplier suffix. msg starts the error.
+func parseNumber(arg, msg string, units bool) (int64, error) {
+	s := strings.TrimLeft(arg, " \t\n\v\f\r")
+	if s != "" && s[0] == '+' {
+		s = s[1:]
+	}
+	i := 0
+	for i < len(s) && '0' <= s[i] && s[i] <= '9' {
+		i++
+	}
+	mult, ok := multipliers[s[i:]]
+	if i == 0 || !ok || !units && i < len(s) {
+		return 0, fmt.Errorf("%s: '%s'", msg, arg)
+	}
+	v, err := strconv.ParseInt(s[:i], 10, 64)
+	if err != nil || mult < 0 || v > math.MaxInt64/mult {
+		return 0, fmt.Errorf("%s: '%s': value too large for defined data type", msg, arg)
+	}
+	if !units && v == 0 {
+		return 0, fmt.Errorf("%s: '%s': numerical result out of range", msg, arg)
+	}
+	return v * mult, nil
+}
+
+// parseSize parses the SIZE of -b and -C.
+func parseSize(arg, msg string) (int64, error) {
+	v, err := parseNumber(arg, msg, true)
+	if err == nil && v == 0 {
+		err = fmt.Errorf("%s: '%s': numerical result out of range", msg, arg)
+	}
+	return v, err
+}
+
+// parseChunks parses the CHUNKS of -n: N, K/N, l/N, l/K/N, r/N or r/K/N.
+// k is 0 without a K.
+func parseChunks(arg string) (m mode, k, n int64, err error) {
+	m = byChunks
+	s := arg
+	switch {
+	case strings.HasPrefix(s, "l/"):
+		m, s = byLineChunks, s[2:]
+	case strings.HasPrefix(s, "r/"):
+		m, s = roundRobin, s[2:]
+	}
+	kstr, nstr := "", s
+	if i := strings.IndexByte(s, '/'); i >= 0 {
+		kstr, nstr = s[:i], s[i+1:]
+	}
+	if kstr != "" {
+		if !isNumber(kstr) {
+			return 0, 0, 0, fmt.Errorf("invalid chunk number: '%s'", kstr)
+		}
+		// K can be 0 as far as its syntax goes.
+		if k, err = parseNumber(kstr, "invalid chunk number", true); err != nil {
+			return 0, 0, 0, err
+		}
+	}
+	if n, err = parseNumber(nstr, "invalid number of chunks", false); err != nil {
+		return 0, 0, 0, err
+	}
+	if kstr != "" && (k == 0 || k > n) {
+		return 0, 0, 0, fmt.Errorf("invalid chunk number: '%s': numerical result out of range", kstr)
+	}
+	return m, k, n, nil
+}
+
+// isNumber reports whether s is digits after any spaces and a plus sign.
+func isNumber(s string) bool {
+	s = strings.TrimLeft(s, " \t\n\v\f\r")
+	if s != "" && s[0] == '+' {
+		s = s[1:]
+	}
+	return s != "" && strings.Trim(s, "0123456789") == ""
+}
+
+// parseFrom parses the FROM of --numeric-suffixes or --hex-suffixes,
+// dropping leading zeros.
+func parseFrom(from, alphabet, what string) (string, error) {
+	if from == "" || from == noFrom {
+		return "", nil
+	}
+	if strings.Trim(from, alphabet) != "" {
+		return "", fmt.Errorf("'%s': invalid start value for %s suffix", from, what)
+	}
+	for len(from) > 1 && from[0] == '0' {
+		from = from[1:]
+	}
+	return from, nil
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
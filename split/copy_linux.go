@@ -0,0 +1,47 @@
+// +build linux
+
+package split
+
+import (
+	"io"
+	"os"
+
+	"golang.org/x/sys/unix"
+)
+
+// maxChunk bounds each copy_file_range or sendfile call.
+const maxChunk = 1 << 30
+
+// copyRange copies n bytes at off in src to w. When w is a file, the kernel
+// copies what it can: copy_file_range between regular files, which lets the
+// filesystem share extents or copy server-side instead of moving the data,
+// and sendfile to anything else. Files can't be copied between that way
+// before Linux 5.3 if they're on different filesystems, nor on some
+// filesystems at all, so what's left is copied through a buffer. Each piece
+// of src is read at its own offset, so pieces can be copied concurrently.
+func copyRange(w io.Writer, src *os.File, off, n int64) error {
+	if dst, ok := w.(*os.File); ok && n > 0 {
+		rfd, wfd := int(src.Fd()), int(dst.Fd())
+		for _, fn := range []func(int) (int, error){
+			func(m int) (int, error) { return unix.CopyFileRange(rfd, &off, wfd, nil, m, 0) },
+			func(m int) (int, error) { return unix.Sendfile(wfd, rfd, &off, m) },
+		} {
+			for n > 0 {
+				m := int64(maxChunk)
+				if n < m {
+					m = n
+				}
+				k, err := fn(int(m))
+				if err == unix.EINTR {
+					continue
+				}
+				if err != nil || k == 0 {
+					// Any real I/O error shows up again below.
+					break
+				}
+				n -= int64(k)
+			}
+		}
+	}
+	return copyBuffer(w, src, off, n)
+}
@@ -1,3 +1,578 @@
-package main
+// Package split writes pieces of its input to files.
+//
+// Splitting a regular file into a given number of pieces (-n) or pieces of
+// a given size (-b) doesn't need the data to be read first: where each piece
+// starts and ends follows from the file's size, with a short scan forward
+// to the end of a line for -n l/N. Splitter works those out up front and
+// copies the pieces to their files several at once, with copy_file_range
+// on Linux, so the data never passes through user space. Everything else -
+// pipes, and splitting by lines or by lines up to a size - is read once,
+// front to back, through a mapping when it's a file, and written to one
+// file after another.
+package split
 
-func main() {}
+import (
+	"bufio"
+	"bytes"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+// Suffix alphabets.
+const (
+	Alphabetic = "abcdefghijklmnopqrstuvwxyz"
+	Numeric    = "0123456789"
+	Hex        = "0123456789abcdef"
+)
+
+// ErrSize is returned when a number of pieces is asked for but the size of
+// the input can't be found, as for a pipe.
+var ErrSize = errors.New("cannot determine file size")
+
+var errExhausted = errors.New("output file suffixes exhausted")
+
+// Splitter writes pieces of its input to files named Prefix, a suffix, and
+// AdditionalSuffix.
+type Splitter struct {
+	// Prefix starts each file name.
+	Prefix string
+	// AdditionalSuffix ends each file name.
+	AdditionalSuffix string
+	// Alphabet holds the characters of the suffixes, which count up from
+	// its first one, like digits.
+	Alphabet string
+	// SuffixLength is the length of the suffixes. Zero means two, or however
+	// many it takes when the number of files is known. Otherwise, with
+	// neither SuffixLength nor Start, suffixes get longer as they run out,
+	// as in GNU split: xyz is followed by xzaaa, so the names still sort in
+	// order.
+	SuffixLength int
+	// Start, if not empty, is the first suffix, in Alphabet's digits,
+	// without leading zeros.
+	Start string
+	// Elide skips the empty files that splitting into a number of pieces
+	// can leave.
+	Elide bool
+	// Delim ends each line.
+	Delim byte
+	// Unbuffered writes each line, when splitting round-robin, as soon as
+	// it's read.
+	Unbuffered bool
+	// Workers is how many pieces are copied at once, when they can be
+	// copied without reading the input first. Zero means one for each CPU.
+	Workers int
+	// Verbose, if not nil, is called with the name of each file just
+	// before it's created.
+	Verbose func(name string)
+
+	in os.FileInfo // the input, which mustn't be overwritten
+}
+
+// NewSplitter returns a Splitter that writes files named xaa, xab, and so
+// on.
+func NewSplitter() *Splitter {
+	return &Splitter{Prefix: "x", Alphabet: Alphabetic, Delim: '\n'}
+}
+
+// namer makes the file names, in order.
+type namer struct {
+	prefix, suffix, alphabet string
+	idx                      []int
+	auto                     bool
+	started                  bool
+}
+
+// names returns a namer for making files files, or, if files is negative,
+// however many it takes.
+func (s *Splitter) names(files int64) (*namer, error) {
+	n := &namer{prefix: s.Prefix, suffix: s.AdditionalSuffix, alphabet: s.Alphabet}
+	length := s.SuffixLength
+	if files >= 0 {
+		// Leave room for every file, counting from Start if it's the
+		// smaller, so the suffixes don't have to grow.
+		last := files - 1
+		if start, ok := s.start(); ok && start < files {
+			last += start
+		}
+		need := 0
+		for base := int64(len(n.alphabet)); ; last /= base {
+			need++
+			if last < base {
+				break
+			}
+		}
+		if length != 0 && length < need {
+			return nil, fmt.Errorf("the suffix length needs to be at least %d", need)
+		}
+		if length == 0 {
+			length = need
+		}
+	} else {
+		n.auto = length == 0 && s.Start == ""
+	}
+	if length < 2 && s.SuffixLength == 0 {
+		length = 2
+	}
+	if len(s.Start) > length {
+		return nil, errors.New("numerical suffix start value is too large for the suffix length")
+	}
+	n.idx = make([]int, length)
+	for i := range s.Start {
+		n.idx[length-len(s.Start)+i] = indexByte(n.alphabet, s.Start[i])
+	}
+	return n, nil
+}
+
+// start returns Start as a number, if it's one that fits in an int64.
+func (s *Splitter) start() (int64, bool) {
+	if s.Start == "" {
+		return 0, false
+	}
+	var v int64
+	base := int64(len(s.Alphabet))
+	for i := range s.Start {
+		d := int64(indexByte(s.Alphabet, s.Start[i]))
+		if v > (1<<63-1-d)/base {
+			return 0, false
+		}
+		v = v*base + d
+	}
+	return v, true
+}
+
+func indexByte(s string, c byte) int {
+	for i := range s {
+		if s[i] == c {
+			return i
+		}
+	}
+	return 0
+}
+
+// next returns the next file name.
+func (n *namer) next() (string, error) {
+	if n.started {
+		i := len(n.idx)
+		for {
+			if i == 0 {
+				return "", errExhausted
+			}
+			i--
+			n.idx[i]++
+			if n.auto && i == 0 && n.idx[0] == len(n.alphabet)-1 {
+				// The first digit is the last there is: make it part of
+				// the prefix, and start over with a longer suffix.
+				n.prefix += n.alphabet[len(n.alphabet)-1:]
+				n.idx = make([]int, len(n.idx)+1)
+				break
+			}
+			if n.idx[i] < len(n.alphabet) {
+				break
+			}
+			n.idx[i] = 0
+		}
+	}
+	n.started = true
+	b := make([]byte, 0, len(n.prefix)+len(n.idx)+len(n.suffix))
+	b = append(b, n.prefix...)
+	for _, i := range n.idx {
+		b = append(b, n.alphabet[i])
+	}
+	return string(append(b, n.suffix...)), nil
+}
+
+// create creates the file name, or truncates it if it's there, as long as
+// it isn't the input.
+func (s *Splitter) create(name string) (*os.File, error) {
+	if s.Verbose != nil {
+		s.Verbose(name)
+	}
+	f, err := os.OpenFile(name, os.O_WRONLY|os.O_CREATE, 0666)
+	if err != nil {
+		return nil, err
+	}
+	info, err := f.Stat()
+	if err != nil {
+		f.Close()
+		return nil, err
+	}
+	if s.in != nil && os.SameFile(info, s.in) {
+		f.Close()
+		return nil, fmt.Errorf("'%s' would overwrite input; aborting", name)
+	}
+	// It's too late to write anything anywhere else, so only a regular
+	// file failing to be truncated is an error.
+	if err := f.Truncate(0); err != nil && info.Mode().IsRegular() {
+		f.Close()
+		return nil, err
+	}
+	return f, nil
+}
+
+// input remembers r, if it's a file, so it isn't overwritten.
+func (s *Splitter) input(r io.Reader) {
+	s.in = nil
+	if f, ok := r.(*os.File); ok {
+		s.in, _ = f.Stat()
+	}
+}
+
+// bufSize is the size of the buffer input is read into when it isn't
+// mapped.
+const bufSize = 128 * 1024
+
+// each calls fn with successive pieces of r, which are only valid until fn
+// returns.
+func each(r io.Reader, fn func(p []byte) error) error {
+	if f, ok := r.(*os.File); ok {
+		m := mmap.NewReader(f)
+		defer m.Close()
+		return mmap.Guard(f, func() error {
+			for {
+				p, err := m.Next()
+				if err == io.EOF {
+					return nil
+				}
+				if err != nil {
+					return err
+				}
+				if err := fn(p); err != nil {
+					return err
+				}
+			}
+		})
+	}
+	buf := make([]byte, bufSize)
+	for {
+		n, err := r.Read(buf)
+		if n > 0 {
+			if err := fn(buf[:n]); err != nil {
+				return err
+			}
+		}
+		if err == io.EOF {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+	}
+}
+
+// stream writes to one file after another, creating each only once there's
+// something to write to it.
+type stream struct {
+	s     *Splitter
+	names *namer
+	f     *os.File
+}
+
+func (o *stream) write(p []byte) error {
+	if len(p) == 0 {
+		return nil
+	}
+	if o.f == nil {
+		name, err := o.names.next()
+		if err != nil {
+			return err
+		}
+		if o.f, err = o.s.create(name); err != nil {
+			return err
+		}
+	}
+	_, err := o.f.Write(p)
+	return err
+}
+
+// end ends the current file, so the next write goes to a new one.
+func (o *stream) end() error {
+	if o.f == nil {
+		return nil
+	}
+	err := o.f.Close()
+	o.f = nil
+	return err
+}
+
+func (s *Splitter) stream(r io.Reader) (*stream, error) {
+	s.input(r)
+	names, err := s.names(-1)
+	if err != nil {
+		return nil, err
+	}
+	return &stream{s: s, names: names}, nil
+}
+
+// Lines writes n lines of r to each file.
+func (s *Splitter) Lines(r io.Reader, n int64) (err error) {
+	o, err := s.stream(r)
+	if err != nil {
+		return err
+	}
+	defer func() {
+		if cerr := o.end(); err == nil {
+			err = cerr
+		}
+	}()
+	left := n
+	return each(r, func(p []byte) error {
+		for len(p) > 0 {
+			i := 0
+			for left > 0 {
+				j := bytes.IndexByte(p[i:], s.Delim)
+				if j < 0 {
+					i = len(p)
+					break
+				}
+				i += j + 1
+				left--
+			}
+			if err := o.write(p[:i]); err != nil {
+				return err
+			}
+			p = p[i:]
+			if left == 0 {
+				if err := o.end(); err != nil {
+					return err
+				}
+				left = n
+			}
+		}
+		return nil
+	})
+}
+
+// Bytes writes n bytes of r to each file. The pieces of a regular file are
+// copied at once, as with Chunks.
+func (s *Splitter) Bytes(r io.Reader, n int64) (err error) {
+	if f, ok := r.(*os.File); ok {
+		if off, size, err := fileSize(f); err == nil && size > 0 {
+			s.input(f)
+			names, err := s.names(-1)
+			if err != nil {
+				return err
+			}
+			left := size
+			return s.copyPieces(f, off, names, func() (int64, error) {
+				if left == 0 {
+					return -1, nil
+				}
+				m := n
+				if left < m {
+					m = left
+				}
+				left -= m
+				return m, nil
+			})
+		}
+	}
+	o, err := s.stream(r)
+	if err != nil {
+		return err
+	}
+	defer func() {
+		if cerr := o.end(); err == nil {
+			err = cerr
+		}
+	}()
+	left := n
+	return each(r, func(p []byte) error {
+		for len(p) > 0 {
+			m := int64(len(p))
+			if m > left {
+				m = left
+			}
+			if err := o.write(p[:m]); err != nil {
+				return err
+			}
+			p = p[m:]
+			if left -= m; left == 0 {
+				if err := o.end(); err != nil {
+					return err
+				}
+				left = n
+			}
+		}
+		return nil
+	})
+}
+
+// LineBytes writes as many lines of r to each file as fit in n bytes, or,
+// where a line doesn't fit in a file by itself, as much of it as does.
+//
+// Once a file has a whole line in it, what comes after that line waits in
+// memory until it's known whether it fits, but before then it's written
+// straight away: it ends up in the file either way.
+func (s *Splitter) LineBytes(r io.Reader, n int64) (err error) {
+	o, err := s.stream(r)
+	if err != nil {
+		return err
+	}
+	var (
+		held  []byte
+		used  int64 // written and held
+		lines bool  // whether a line has ended in the file
+	)
+	defer func() {
+		if err == nil {
+			err = o.write(held)
+		}
+		if cerr := o.end(); err == nil {
+			err = cerr
+		}
+	}()
+	return each(r, func(p []byte) error {
+		for len(p) > 0 {
+			if used == n {
+				if err := o.end(); err != nil {
+					return err
+				}
+				// What's held starts the next file.
+				if err := o.write(held); err != nil {
+					return err
+				}
+				used = int64(len(held))
+				held = held[:0]
+				lines = false
+				continue
+			}
+			q := p
+			if int64(len(q)) > n-used {
+				q = q[:n-used]
+			}
+			switch i := bytes.LastIndexByte(q, s.Delim); {
+			case i >= 0:
+				if err := o.write(held); err != nil {
+					return err
+				}
+				if err := o.write(q[:i+1]); err != nil {
+					return err
+				}
+				held = append(held[:0], q[i+1:]...)
+				lines = true
+			case lines:
+				held = append(held, q...)
+			default:
+				if err := o.write(q); err != nil {
+					return err
+				}
+			}
+			used += int64(len(q))
+			p = p[len(q):]
+		}
+		return nil
+	})
+}
+
+// RoundRobin writes the lines of r to n files in turn.
+func (s *Splitter) RoundRobin(r io.Reader, n int64) (err error) {
+	s.input(r)
+	names, err := s.names(n)
+	if err != nil {
+		return err
+	}
+	files := make([]*os.File, n)
+	outs := make([]io.Writer, n)
+	open := func(i int64) error {
+		name, err := names.next()
+		if err != nil {
+			return err
+		}
+		f, err := s.create(name)
+		if err != nil {
+			return err
+		}
+		files[i], outs[i] = f, f
+		if !s.Unbuffered {
+			outs[i] = bufio.NewWriter(f)
+		}
+		return nil
+	}
+	defer func() {
+		for i, f := range files {
+			if f == nil {
+				continue
+			}
+			if b, ok := outs[i].(*bufio.Writer); ok {
+				if ferr := b.Flush(); err == nil {
+					err = ferr
+				}
+			}
+			if cerr := f.Close(); err == nil {
+				err = cerr
+			}
+		}
+	}()
+	// Without Elide, every file is made, even if there aren't enough lines
+	// to go round. With it, the files with lines are still named in order,
+	// since they get their first lines in order.
+	if !s.Elide {
+		for i := range files {
+			if err := open(int64(i)); err != nil {
+				return err
+			}
+		}
+	}
+	var i int64
+	return each(r, func(p []byte) error {
+		for len(p) > 0 {
+			j := bytes.IndexByte(p, s.Delim) + 1
+			if j == 0 {
+				j = len(p)
+			}
+			if outs[i] == nil {
+				if err := open(i); err != nil {
+					return err
+				}
+			}
+			if _, err := outs[i].Write(p[:j]); err != nil {
+				return err
+			}
+			if p[j-1] == s.Delim {
+				if i++; i == n {
+					i = 0
+				}
+			}
+			p = p[j:]
+		}
+		return nil
+	})
+}
+
+// RoundRobinChunk writes the lines of r that RoundRobin would write to the
+// kth of n files, counting from 1, to w.
+func (s *Splitter) RoundRobinChunk(w io.Writer, r io.Reader, k, n int64) error {
+	out := w
+	if !s.Unbuffered {
+		out = bufio.NewWriterSize(w, bufSize)
+	}
+	i := int64(1)
+	err := each(r, func(p []byte) error {
+		for len(p) > 0 {
+			j := bytes.IndexByte(p, s.Delim) + 1
+			if j == 0 {
+				j = len(p)
+			}
+			if i == k {
+				if _, err := out.Write(p[:j]); err != nil {
+					return err
+				}
+			}
+			if p[j-1] == s.Delim {
+				if i++; i > n {
+					i = 1
+				}
+			}
+			p = p[j:]
+		}
+		return nil
+	})
+	if b, ok := out.(*bufio.Writer); ok && err == nil {
+		err = b.Flush()
+	}
+	return err
+}
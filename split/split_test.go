@@ -0,0 +1,377 @@
+package split
+
+import (
+	"bytes"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+// pieces returns the files written with prefix x in dir, in order.
+func pieces(t testing.TB, dir string) [][]byte {
+	names, err := filepath.Glob(filepath.Join(dir, "x*"))
+	if err != nil {
+		t.Fatal(err)
+	}
+	sort.Strings(names)
+	var out [][]byte
+	for _, name := range names {
+		data, err := ioutil.ReadFile(name)
+		if err != nil {
+			t.Fatal(err)
+		}
+		out = append(out, data)
+		os.Remove(name)
+	}
+	return out
+}
+
+// chunks returns data split into n pieces the slow way, the way GNU split
+// does it: each piece k ends at k*(size/n), or with lines just past the first
+// separator at or after the byte before that.
+func chunks(data []byte, n int, lines bool) [][]byte {
+	per := len(data) / n
+	if per == 0 {
+		per = 1
+	}
+	var out [][]byte
+	start := 0
+	for k := 1; k <= n; k++ {
+		end := len(data)
+		if e := k * per; k < n && e < len(data) {
+			end = e
+			if lines {
+				end = len(data)
+				if i := bytes.IndexByte(data[e-1:], '\n'); i >= 0 {
+					end = e + i
+				}
+			}
+		}
+		if end < start {
+			end = start
+		}
+		out = append(out, data[start:end])
+		start = end
+	}
+	return out
+}
+
+func input(rng *rand.Rand, n int) []byte {
+	var b bytes.Buffer
+	for b.Len() < n {
+		b.WriteString(strings.Repeat("y", rng.Intn(300)))
+		b.WriteByte('\n')
+	}
+	return b.Bytes()[:n]
+}
+
+func TestChunks(t *testing.T) {
+	dir, err := ioutil.TempDir("", "split")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	name := filepath.Join(dir, "in")
+
+	rng := rand.New(rand.NewSource(1))
+	for _, size := range []int{1, 10, 999, 70000, 300000} {
+		data := input(rng, size)
+		if err := ioutil.WriteFile(name, data, 0644); err != nil {
+			t.Fatal(err)
+		}
+		for _, n := range []int{1, 2, 3, 7, 40} {
+			for _, lines := range []bool{false, true} {
+				want := chunks(data, n, lines)
+
+				f, err := os.Open(name)
+				if err != nil {
+					t.Fatal(err)
+				}
+				s := NewSplitter()
+				s.Prefix = filepath.Join(dir, "x")
+				s.Workers = 3
+				err = s.Chunks(f, int64(n), lines)
+				if err != nil {
+					t.Fatal(err)
+				}
+				got := pieces(t, dir)
+				if len(got) != len(want) {
+					t.Fatalf("%d bytes, n=%d lines=%t: got %d files, want %d", size, n, lines, len(got), len(want))
+				}
+				for k := range want {
+					if !bytes.Equal(got[k], want[k]) {
+						t.Fatalf("%d bytes, n=%d lines=%t: piece %d is %d bytes, want %d",
+							size, n, lines, k+1, len(got[k]), len(want[k]))
+					}
+					var one bytes.Buffer
+					if err := s.Chunk(&one, f, int64(k+1), int64(n), lines); err != nil {
+						t.Fatal(err)
+					}
+					if !bytes.Equal(one.Bytes(), want[k]) {
+						t.Fatalf("%d bytes, n=%d lines=%t: -n %d/%d is %d bytes, want %d",
+							size, n, lines, k+1, n, one.Len(), len(want[k]))
+					}
+				}
+				f.Close()
+			}
+		}
+	}
+}
+
+// TestStreams checks each way of splitting puts all of the input in files
+// that are each within their limit, from a file and from a pipe.
+func TestStreams(t *testing.T) {
+	dir, err := ioutil.TempDir("", "split")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	name := filepath.Join(dir, "in")
+
+	rng := rand.New(rand.NewSource(2))
+	data := input(rng, 200000)
+	data = append(data, "no newline"...)
+	if err := ioutil.WriteFile(name, data, 0644); err != nil {
+		t.Fatal(err)
+	}
+
+	tests := []struct {
+		name  string
+		split func(s *Splitter, f *os.File) error
+		check func(p []byte, last bool) bool
+	}{
+		{"lines", func(s *Splitter, f *os.File) error { return s.Lines(f, 100) }, func(p []byte, last bool) bool {
+			n := bytes.Count(p, []byte{'\n'})
+			return n == 100 || last && n < 100
+		}},
+		{"bytes", func(s *Splitter, f *os.File) error { return s.Bytes(f, 4096) }, func(p []byte, last bool) bool {
+			return len(p) == 4096 || last && len(p) < 4096
+		}},
+		{"line bytes", func(s *Splitter, f *os.File) error { return s.LineBytes(f, 1000) }, func(p []byte, last bool) bool {
+			return len(p) <= 1000 && len(p) > 0
+		}},
+	}
+	for _, tt := range tests {
+		for _, pipe := range []bool{false, true} {
+			f, err := os.Open(name)
+			if err != nil {
+				t.Fatal(err)
+			}
+			in := f
+			if pipe {
+				r, w, err := os.Pipe()
+				if err != nil {
+					t.Fatal(err)
+				}
+				go func() {
+					w.Write(data)
+					w.Close()
+				}()
+				in = r
+			}
+			s := NewSplitter()
+			s.Prefix = filepath.Join(dir, "x")
+			s.SuffixLength = 4
+			if err := tt.split(s, in); err != nil {
+				t.Fatalf("%s, pipe=%t: %v", tt.name, pipe, err)
+			}
+			in.Close()
+			f.Close()
+
+			got := pieces(t, dir)
+			if all := bytes.Join(got, nil); !bytes.Equal(all, data) {
+				t.Fatalf("%s, pipe=%t: got %d bytes back, want %d", tt.name, pipe, len(all), len(data))
+			}
+			for i, p := range got {
+				if !tt.check(p, i == len(got)-1) {
+					t.Fatalf("%s, pipe=%t: file %d has %d bytes", tt.name, pipe, i, len(p))
+				}
+			}
+		}
+	}
+}
+
+func TestRoundRobin(t *testing.T) {
+	dir, err := ioutil.TempDir("", "split")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	var in bytes.Buffer
+	for i := 0; i < 100; i++ {
+		in.WriteString(strings.Repeat("r", i))
+		in.WriteByte('\n')
+	}
+	lines := strings.SplitAfter(in.String(), "\n")
+	lines = lines[:len(lines)-1]
+
+	s := NewSplitter()
+	s.Prefix = filepath.Join(dir, "x")
+	if err := s.RoundRobin(bytes.NewReader(in.Bytes()), 7); err != nil {
+		t.Fatal(err)
+	}
+	got := pieces(t, dir)
+	if len(got) != 7 {
+		t.Fatalf("got %d files, want 7", len(got))
+	}
+	for k := range got {
+		var want, one bytes.Buffer
+		for i := k; i < len(lines); i += 7 {
+			want.WriteString(lines[i])
+		}
+		if !bytes.Equal(got[k], want.Bytes()) {
+			t.Fatalf("file %d: got %q, want %q", k, got[k], want.Bytes())
+		}
+		if err := s.RoundRobinChunk(&one, bytes.NewReader(in.Bytes()), int64(k+1), 7); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(one.Bytes(), want.Bytes()) {
+			t.Fatalf("-n r/%d/7: got %q, want %q", k+1, one.Bytes(), want.Bytes())
+		}
+	}
+}
+
+func TestSuffixes(t *testing.T) {
+	tests := []struct {
+		alphabet string
+		length   int
+		start    string
+		files    int64
+		want     []string
+		err      bool
+	}{
+		{Alphabetic, 0, "", -1, []string{"xaa", "xab"}, false},
+		{Numeric, 0, "", -1, []string{"x00", "x01"}, false},
+		{Hex, 0, "", -1, []string{"x00", "x01"}, false},
+		{Numeric, 0, "98", -1, []string{"x98", "x99"}, false},
+		{Alphabetic, 1, "", 30, nil, true},
+		{Numeric, 0, "", 101, []string{"x000"}, false},
+		{Numeric, 2, "100", 3, nil, true},
+	}
+	for _, tt := range tests {
+		s := NewSplitter()
+		s.Alphabet = tt.alphabet
+		s.SuffixLength = tt.length
+		s.Start = tt.start
+		n, err := s.names(tt.files)
+		if tt.err {
+			if err == nil {
+				t.Errorf("%+v: expected an error", tt)
+			}
+			continue
+		}
+		if err != nil {
+			t.Fatalf("%+v: %v", tt, err)
+		}
+		var got []string
+		for range tt.want {
+			name, err := n.next()
+			if err != nil {
+				t.Fatalf("%+v: %v", tt, err)
+			}
+			got = append(got, name)
+		}
+		if strings.Join(got, " ") != strings.Join(tt.want, " ") {
+			t.Errorf("%+v: got %q", tt, got)
+		}
+	}
+
+	// Without a length to keep to, xyz is followed by xzaaa, and x89 by
+	// x9000, so there's room for more files.
+	for _, tt := range []struct{ alphabet, want string }{{Alphabetic, "xzaaa"}, {Numeric, "x9000"}} {
+		s := NewSplitter()
+		s.Alphabet = tt.alphabet
+		n, err := s.names(-1)
+		if err != nil {
+			t.Fatal(err)
+		}
+		m := len(tt.alphabet)
+		var last string
+		for i := 0; i < (m-1)*m+1; i++ {
+			if last, err = n.next(); err != nil {
+				t.Fatal(err)
+			}
+		}
+		if last != tt.want {
+			t.Errorf("%s: got %q, want %q", tt.alphabet, last, tt.want)
+		}
+	}
+}
+
+func TestErrors(t *testing.T) {
+	tests := []struct {
+		args []string
+		want string
+	}{
+		{[]string{"-l", "5", "-b", "5"}, "split: cannot split in more than one way"},
+		{[]string{"-l", "0"}, "split: invalid number of lines: '0'"},
+		{[]string{"-b", "x"}, "split: invalid number of bytes: 'x'"},
+		{[]string{"-t", "ab"}, "split: multi-character separator 'ab'"},
+		{[]string{"-t", ""}, "split: empty record separator"},
+		{[]string{"-n", "3"}, "split: -: cannot determine file size"},
+		{[]string{"--additional-suffix=a/b"}, "split: invalid suffix 'a/b', contains directory separator"},
+		{[]string{"a", "b", "c"}, "split: extra operand 'c'"},
+	}
+	for _, tt := range tests {
+		_, got, err := cmdtest.Run(run, "", tt.args...)
+		if err == nil {
+			t.Errorf("%q: expected an error", tt.args)
+			continue
+		}
+		if !strings.HasPrefix(got, tt.want) {
+			t.Errorf("%q: got %q, want %q", tt.args, got, tt.want)
+		}
+	}
+}
+
+func BenchmarkChunks(b *testing.B) {
+	dir, err := ioutil.TempDir("", "split")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	name := filepath.Join(dir, "in")
+	data := bytes.Repeat([]byte("a line of the journal\n"), 1<<20)
+	if err := ioutil.WriteFile(name, data, 0644); err != nil {
+		b.Fatal(err)
+	}
+	f, err := os.Open(name)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer f.Close()
+	b.SetBytes(int64(len(data)))
+
+	s := NewSplitter()
+	s.Prefix = filepath.Join(dir, "x")
+	for i := 0; i < b.N; i++ {
+		if err := s.Chunks(f, 8, true); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkLines(b *testing.B) {
+	dir, err := ioutil.TempDir("", "split")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+	data := bytes.Repeat([]byte("a line of the journal\n"), 1<<20)
+	b.SetBytes(int64(len(data)))
+
+	s := NewSplitter()
+	s.Prefix = filepath.Join(dir, "x")
+	for i := 0; i < b.N; i++ {
+		if err := s.Lines(bytes.NewReader(data), 100000); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
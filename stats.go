@@ -0,0 +1,209 @@
+package coreutils
+
+import (
+	"encoding/json"
+	"fmt"
+	"io"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// StatsEnv is the environment variable that has the coreutils binary count
+// a utility's I/O when it's run through a link, which leaves no way to give
+// it --stats. It's set to the format of the report: text or json.
+const StatsEnv = "COREUTILS_STATS"
+
+// Stats counts what a utility did with its input and output, to tell
+// whether a slow one is waiting on its input, on its output, or on neither,
+// in which case it's busy computing.
+//
+// A nil *Stats counts nothing, and each of its methods returns at once, so
+// a utility calls them the same way whether it's being counted or not, and
+// it costs a comparison when it isn't. Only the utilities that count their
+// own I/O fill it in: cat, wc and the checksum tools do. The counters are
+// updated atomically, so one Stats can be shared by goroutines.
+type Stats struct {
+	BytesRead    int64
+	BytesWritten int64
+	// Reads and Writes are the number of read and write calls, which are
+	// syscalls unless the reader or writer buffers. Data copied inside the
+	// kernel, as cat does with splice, counts as written only, and data
+	// read from a mapping as read without any calls.
+	Reads  int64
+	Writes int64
+	// ReadWait and WriteWait are the time spent in those calls, waiting on
+	// the input or the output.
+	ReadWait  time.Duration
+	WriteWait time.Duration
+	// Elapsed is how long the utility ran, if the one who ran it sets it.
+	Elapsed time.Duration
+
+	mu    sync.Mutex
+	paths map[string]int64
+}
+
+// Start returns the time to pass to AddRead or AddWrite once the call being
+// timed returns. It doesn't read the clock if s is nil.
+func (s *Stats) Start() time.Time {
+	if s == nil {
+		return time.Time{}
+	}
+	return time.Now()
+}
+
+// AddRead counts a read call, begun at start, that read n bytes.
+func (s *Stats) AddRead(n int, start time.Time) {
+	if s == nil {
+		return
+	}
+	atomic.AddInt64(&s.BytesRead, int64(n))
+	atomic.AddInt64(&s.Reads, 1)
+	atomic.AddInt64((*int64)(&s.ReadWait), int64(time.Since(start)))
+}
+
+// AddMapped counts n bytes read from a mapping, which takes no calls.
+func (s *Stats) AddMapped(n int64) {
+	if s == nil {
+		return
+	}
+	atomic.AddInt64(&s.BytesRead, n)
+}
+
+// AddWrite counts a write call, begun at start, that wrote n bytes.
+func (s *Stats) AddWrite(n int, start time.Time) {
+	if s == nil {
+		return
+	}
+	atomic.AddInt64(&s.BytesWritten, int64(n))
+	atomic.AddInt64(&s.Writes, 1)
+	atomic.AddInt64((*int64)(&s.WriteWait), int64(time.Since(start)))
+}
+
+// Took counts a fast path, such as mmap or splice, being taken.
+func (s *Stats) Took(path string) {
+	if s == nil {
+		return
+	}
+	s.mu.Lock()
+	if s.paths == nil {
+		s.paths = make(map[string]int64)
+	}
+	s.paths[path]++
+	s.mu.Unlock()
+}
+
+// FastPaths returns the number of times each fast path was taken.
+func (s *Stats) FastPaths() map[string]int64 {
+	m := make(map[string]int64)
+	if s == nil {
+		return m
+	}
+	s.mu.Lock()
+	for path, n := range s.paths {
+		m[path] = n
+	}
+	s.mu.Unlock()
+	return m
+}
+
+// Reader returns r, with its reads counted in s. If s is nil, it returns r
+// itself. The Reader that's returned hides what r is, so a utility wraps r
+// after it's picked how to read it, not before.
+func (s *Stats) Reader(r io.Reader) io.Reader {
+	if s == nil {
+		return r
+	}
+	return &statsReader{r: r, s: s}
+}
+
+// Writer is Reader for writes.
+func (s *Stats) Writer(w io.Writer) io.Writer {
+	if s == nil {
+		return w
+	}
+	return &statsWriter{w: w, s: s}
+}
+
+type statsReader struct {
+	r io.Reader
+	s *Stats
+}
+
+func (r *statsReader) Read(p []byte) (int, error) {
+	start := time.Now()
+	n, err := r.r.Read(p)
+	r.s.AddRead(n, start)
+	return n, err
+}
+
+type statsWriter struct {
+	w io.Writer
+	s *Stats
+}
+
+func (w *statsWriter) Write(p []byte) (int, error) {
+	start := time.Now()
+	n, err := w.w.Write(p)
+	w.s.AddWrite(n, start)
+	return n, err
+}
+
+// Report writes a report of s for the utility name to w, in format, which is
+// text, a few lines prefixed with name, or json, a single line.
+func (s *Stats) Report(w io.Writer, name, format string) error {
+	var (
+		bytesRead    = atomic.LoadInt64(&s.BytesRead)
+		bytesWritten = atomic.LoadInt64(&s.BytesWritten)
+		reads        = atomic.LoadInt64(&s.Reads)
+		writes       = atomic.LoadInt64(&s.Writes)
+		readWait     = time.Duration(atomic.LoadInt64((*int64)(&s.ReadWait)))
+		writeWait    = time.Duration(atomic.LoadInt64((*int64)(&s.WriteWait)))
+		paths        = s.FastPaths()
+	)
+	switch format {
+	case "json":
+		b, err := json.Marshal(struct {
+			Utility      string           `json:"utility"`
+			ElapsedNs    int64            `json:"elapsed_ns"`
+			BytesRead    int64            `json:"bytes_read"`
+			Reads        int64            `json:"reads"`
+			ReadWaitNs   int64            `json:"read_wait_ns"`
+			BytesWritten int64            `json:"bytes_written"`
+			Writes       int64            `json:"writes"`
+			WriteWaitNs  int64            `json:"write_wait_ns"`
+			FastPaths    map[string]int64 `json:"fast_paths"`
+		}{
+			name, int64(s.Elapsed),
+			bytesRead, reads, int64(readWait),
+			bytesWritten, writes, int64(writeWait),
+			paths,
+		})
+		if err != nil {
+			return err
+		}
+		_, err = fmt.Fprintf(w, "%s\n", b)
+		return err
+	case "text":
+		var names []string
+		for path, n := range paths {
+			names = append(names, fmt.Sprintf("%s %d", path, n))
+		}
+		sort.Strings(names)
+		if len(names) == 0 {
+			names = []string{"none"}
+		}
+		_, err := fmt.Fprintf(w, "%[1]s: elapsed %[2]v\n"+
+			"%[1]s: read %[3]d bytes in %[4]d calls, blocked %[5]v\n"+
+			"%[1]s: wrote %[6]d bytes in %[7]d calls, blocked %[8]v\n"+
+			"%[1]s: fast paths: %[9]s\n",
+			name, s.Elapsed,
+			bytesRead, reads, readWait,
+			bytesWritten, writes, writeWait,
+			strings.Join(names, ", "))
+		return err
+	}
+	return fmt.Errorf("unknown stats format %q", format)
+}
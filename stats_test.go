@@ -0,0 +1,99 @@
+package coreutils
+
+import (
+	"bytes"
+	"encoding/json"
+	"io"
+	"io/ioutil"
+	"strings"
+	"sync"
+	"testing"
+)
+
+func TestStatsNil(t *testing.T) {
+	var s *Stats
+	r := strings.NewReader("x")
+	if s.Reader(r) != io.Reader(r) || s.Writer(ioutil.Discard) != ioutil.Discard {
+		t.Fatal("a nil Stats wrapped a reader or writer")
+	}
+	if !s.Start().IsZero() {
+		t.Fatal("a nil Stats read the clock")
+	}
+	s.AddRead(1, s.Start())
+	s.AddWrite(1, s.Start())
+	s.AddMapped(1)
+	s.Took("mmap")
+	if len(s.FastPaths()) != 0 {
+		t.Fatal("a nil Stats took a fast path")
+	}
+}
+
+func TestStats(t *testing.T) {
+	s, all := new(Stats), new(Stats)
+	err := Pipeline(Context{
+		Stdin:  strings.NewReader(""),
+		Stdout: ioutil.Discard,
+		Stderr: ioutil.Discard,
+		Stats:  all,
+	}, Command{Name: "test-stats"}, Command{Name: "test-stats", Stats: s}, Command{Name: "test-stats"})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if s.FastPaths()["ran"] != 1 || all.FastPaths()["ran"] != 2 {
+		t.Fatalf("Pipeline: got %v and %v", s.FastPaths(), all.FastPaths())
+	}
+
+	var wg sync.WaitGroup
+	var out bytes.Buffer
+	for i := 0; i < 4; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			buf := make([]byte, 3)
+			r := s.Reader(strings.NewReader("abcdef"))
+			for {
+				if _, err := r.Read(buf); err != nil {
+					return
+				}
+				s.Took("three")
+			}
+		}()
+	}
+	wg.Wait()
+	io.WriteString(s.Writer(&out), "written")
+	s.AddMapped(100)
+
+	if s.BytesRead != 4*6+100 || s.Reads != 4*3 || s.BytesWritten != 7 || s.Writes != 1 {
+		t.Fatalf("got %+v", s)
+	}
+	if got := s.FastPaths()["three"]; got != 4*2 {
+		t.Fatalf("three taken %d times, want 8", got)
+	}
+
+	var b bytes.Buffer
+	if err := s.Report(&b, "cat", "json"); err != nil {
+		t.Fatal(err)
+	}
+	var report struct {
+		Utility   string           `json:"utility"`
+		BytesRead int64            `json:"bytes_read"`
+		FastPaths map[string]int64 `json:"fast_paths"`
+	}
+	if err := json.Unmarshal(b.Bytes(), &report); err != nil {
+		t.Fatalf("%v: %s", err, b.Bytes())
+	}
+	if report.Utility != "cat" || report.BytesRead != s.BytesRead || report.FastPaths["three"] != 8 {
+		t.Fatalf("got %s", b.Bytes())
+	}
+
+	b.Reset()
+	if err := s.Report(&b, "cat", "text"); err != nil {
+		t.Fatal(err)
+	}
+	if got := b.String(); !strings.Contains(got, "cat: read 124 bytes in 12 calls") || !strings.Contains(got, "cat: fast paths: ran 1, three 8\n") {
+		t.Fatalf("got %q", got)
+	}
+	if err := s.Report(&b, "cat", "xml"); err == nil {
+		t.Fatal("xml: expected an error")
+	}
+}
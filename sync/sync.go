@@ -1,13 +1,16 @@
-package main
+package sync
 
 import (
 	"fmt"
-	"os"
-	"syscall"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("sync", run)
+}
+
 const (
 	Help = `Usage: sync [OPTION]
 Force changed blocks to disk, update the super block.
@@ -28,15 +31,24 @@ Written by Eric Lagergren <ericscottlagergren@gmail.com>
 `
 )
 
-var version = flag.BoolP("version", "v", false, "")
-
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f       flag.FlagSet
+		version bool
+	)
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
-	flag.Parse()
 
-	// Nothing can fail.
-	syscall.Sync()
+	if version {
+		fmt.Fprintf(ctx.Stdout, "%s", Version)
+		return nil
+	}
+	if err := syncAll(ctx); err != nil {
+		fmt.Fprintf(ctx.Stderr, "sync: %v\n", err)
+		return err
+	}
+	return nil
 }
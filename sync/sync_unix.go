@@ -0,0 +1,15 @@
+// +build !windows
+
+package sync
+
+import (
+	"syscall"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+func syncAll(ctx coreutils.Context) error {
+	// Nothing can fail.
+	syscall.Sync()
+	return nil
+}
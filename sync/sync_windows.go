@@ -1,50 +1,20 @@
-package main
+package sync
 
 import (
-	"fmt"
-	"log"
 	"os"
 	"path/filepath"
 	"syscall"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
 )
 
-const (
-	Help = `Usage: sync [OPTION]
-Force changed blocks to disk, update the super block.
-
-      --help     display this help and exit
-      --version  output version information and exit
-
-Report wc bugs to ericscottlagergren@gmail.com
-Go coreutils home page: <https://www.github.com/EricLagergren/go-coreutils/>
-`
-	Version = `sync (coreutils) 1
-Copyright (C) 2015 Eric Lagergren.
-License GPLv3+: GNU GPL version 3 or later <http://gnu.org/licenses/gpl.html>.
-This is free software: you are free to change and redistribute it.
-There is NO WARRANTY, to the extent permitted by law.
-
-Written by Eric Lagergren <ericscottlagergren@gmail.com>
-`
-)
-
-var (
-	version = flag.BoolP("version", "v", false, "")
-	fatal   = log.New(os.Stderr, "", 0)
-)
-
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
-	}
-	flag.Parse()
-
-	dir, err := os.Getwd()
-	if err != nil {
-		fatal.Fatalln(err)
+func syncAll(ctx coreutils.Context) error {
+	dir := ctx.Dir
+	if dir == "" {
+		var err error
+		if dir, err = os.Getwd(); err != nil {
+			return err
+		}
 	}
 
 	// "To flush all open files on a volume, call FlushFileBuffers with a handle to the volume.
@@ -53,11 +23,8 @@ func main() {
 	fp := filepath.VolumeName(dir)
 	file, err := os.Open(fp)
 	if err != nil {
-		fatal.Fatalln(err)
-	}
-
-	err = syscall.Fsync(syscall.Handle(file.Fd()))
-	if err != nil {
-		fatal.Fatalln(err)
+		return err
 	}
+	defer file.Close()
+	return syscall.Fsync(syscall.Handle(file.Fd()))
 }
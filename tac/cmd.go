@@ -0,0 +1,137 @@
+package tac
+
+import (
+	"bufio"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"regexp"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("tac", run)
+}
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.before, "before", "b", false, "attach the separator before instead of after")
+	c.f.BoolVarP(&c.regex, "regex", "r", false, "interpret the separator as a regular expression")
+	c.f.StringVarP(&c.separator, "separator", "s", "\n", "use STRING as the separator instead of newline")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f         flag.FlagSet
+	before    bool
+	regex     bool
+	separator string
+	version   bool
+}
+
+var errNonFatal = errors.New("at least one non-fatal error occurred")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "tac (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errNonFatal {
+			fmt.Fprintf(ctx.Stderr, "tac: %v\n", err)
+		}
+	}()
+
+	if c.separator == "" {
+		return errors.New("separator cannot be empty")
+	}
+	r := &Reverser{
+		Separator: c.separator,
+		Before:    c.before,
+		TempDir:   getEnv(ctx, "TMPDIR"),
+	}
+	if c.regex {
+		if r.Regexp, err = regexp.Compile(c.separator); err != nil {
+			return err
+		}
+		if r.Regexp.Match(nil) {
+			return fmt.Errorf("separator '%s' matches the empty string", c.separator)
+		}
+	}
+
+	names := c.f.Args()
+	if len(names) == 0 {
+		names = []string{"-"}
+	}
+
+	// Records come out of the reverser unbuffered, so anything that isn't
+	// a file, which writev can't be used on, is buffered.
+	out := ctx.Stdout
+	var bw *bufio.Writer
+	if _, ok := out.(*os.File); !ok {
+		bw = bufio.NewWriterSize(out, 64*1024)
+		out = bw
+	}
+
+	var nerrs int
+	for _, name := range names {
+		var in io.Reader = ctx.Stdin
+		if name != "-" {
+			f, err := os.Open(name)
+			if err != nil {
+				fmt.Fprintf(ctx.Stderr, "tac: failed to open '%s' for reading: %v\n", name, unwrap(err))
+				nerrs++
+				continue
+			}
+			in = f
+		}
+		err := r.Reverse(out, in)
+		if f, ok := in.(*os.File); ok && name != "-" {
+			f.Close()
+		}
+		if we, ok := err.(*WriteError); ok {
+			// Nothing more can be written, and the input isn't to blame.
+			return fmt.Errorf("write error: %v", unwrap(we.Err))
+		}
+		if err != nil {
+			if bw != nil {
+				bw.Flush()
+			}
+			fmt.Fprintf(ctx.Stderr, "tac: %s: %v\n", name, unwrap(err))
+			nerrs++
+		}
+	}
+	if bw != nil {
+		if err := bw.Flush(); err != nil {
+			return fmt.Errorf("write error: %v", unwrap(err))
+		}
+	}
+	if nerrs > 0 {
+		return errNonFatal
+	}
+	return nil
+}
+
+func getEnv(ctx coreutils.Context, key string) string {
+	if ctx.GetEnv != nil {
+		return ctx.GetEnv(key)
+	}
+	return os.Getenv(key)
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
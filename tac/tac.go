@@ -1,3 +1,295 @@
-package main
+// Package tac writes files with their records, lines by default, in reverse.
+//
+// A regular file is read backwards from its end, a window at a time, mapped
+// where that's possible. Records are written straight from the window, a
+// batch at a time, with writev on Linux, so only short ones are copied. Other
+// inputs are first copied to a temporary file, as GNU tac does, so they
+// needn't fit in memory.
+//
+// A mapped file that's truncated while it's being reversed will crash the
+// program with SIGBUS. Files that are appended to are fine: only what was
+// there at the start is reversed.
+package tac
 
-func main() {}
+import (
+	"bytes"
+	"io"
+	"io/ioutil"
+	"os"
+	"regexp"
+
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+// windowSize is how much of a file is looked at, at first. A window is made
+// larger only when a record doesn't fit in it.
+const windowSize = 8 << 20
+
+// Reverser reverses the records in its input.
+type Reverser struct {
+	// Separator ends each record, or begins it with Before set.
+	Separator string
+
+	// Regexp, if not nil, matches the separators instead. Matches must
+	// not be empty. As with GNU tac, separators are found from the end:
+	// each is the longest match that starts furthest right, before the
+	// separator after it, so [0-9]+ splits 345 into three. Assertions
+	// such as \b and ^ can't see the text before where a match starts.
+	Regexp *regexp.Regexp
+
+	Before bool
+
+	// TempDir holds the copies of inputs that aren't regular files. If
+	// it's empty the default directory for temporary files is used.
+	TempDir string
+}
+
+// A WriteError is returned by Reverse when it's writing to w, rather than
+// reading, that failed.
+type WriteError struct {
+	Err error
+}
+
+func (e *WriteError) Error() string { return "write error: " + e.Err.Error() }
+
+// Reverse writes the records of in to w, last first.
+func (r *Reverser) Reverse(w io.Writer, in io.Reader) error {
+	if f, ok := in.(*os.File); ok {
+		info, err := f.Stat()
+		if err == nil && info.Mode().IsRegular() {
+			if off, err := f.Seek(0, io.SeekCurrent); err == nil {
+				if off > info.Size() {
+					off = info.Size()
+				}
+				return mmap.Guard(f, func() error {
+					return r.reverseFile(w, f, off, info.Size())
+				})
+			}
+		}
+	}
+
+	tmp, err := ioutil.TempFile(r.TempDir, "tac")
+	if err != nil {
+		return err
+	}
+	defer os.Remove(tmp.Name())
+	defer tmp.Close()
+	n, err := io.Copy(tmp, in)
+	if err != nil {
+		return err
+	}
+	return mmap.Guard(tmp, func() error { return r.reverseFile(w, tmp, 0, n) })
+}
+
+// reverseFile writes the records between start and end in f to w.
+func (r *Reverser) reverseFile(w io.Writer, f *os.File, start, end int64) error {
+	out := newVecWriter(w)
+	var back *regexp.Regexp
+	if r.Regexp != nil {
+		back = anchored(r.Regexp)
+	}
+	var (
+		buf  []byte // for windows that aren't mapped
+		size = int64(windowSize)
+		// Everything from pos on has been written, and the next
+		// separator is before lim, which is where the previous one
+		// started.
+		pos, lim = end, end
+	)
+	for pos > start {
+		off := pos - size
+		if off < start {
+			off = start
+		}
+		data, release, err := window(f, off, int(pos-off), &buf)
+		if err != nil {
+			return err
+		}
+
+		next := r.separators(data[:lim-off], back)
+		p, l := len(data), int(lim-off)
+		found := false
+		for {
+			i, n := next()
+			if i < 0 {
+				break
+			}
+			b := i + n
+			if r.Before {
+				b = i
+			}
+			out.add(data[b:p])
+			p, l, found = b, i, true
+		}
+		if off == start {
+			out.add(data[:p])
+			p = 0
+		}
+		err = out.flush()
+		release()
+		if err != nil {
+			return err
+		}
+
+		if !found && off > start {
+			// The record is longer than the window.
+			size *= 2
+			continue
+		}
+		pos, lim, size = off+int64(p), off+int64(l), windowSize
+	}
+	return nil
+}
+
+// separators returns a function that returns the index and length of each
+// separator in data, last first, and -1 once there are no more. With a
+// regular expression, back is it anchored as anchored returns.
+//
+// A regexp can't be run backwards, so it's run forwards over data once.
+// Every position a match could start at is then inside one of the matches
+// it finds: anywhere else the forward search would have matched too. Only
+// those positions are tried, right to left, with back.
+func (r *Reverser) separators(data []byte, back *regexp.Regexp) func() (int, int) {
+	if r.Regexp == nil {
+		sep := []byte(r.Separator)
+		return func() (int, int) {
+			i := bytes.LastIndex(data, sep)
+			if i >= 0 {
+				data = data[:i]
+			}
+			return i, len(sep)
+		}
+	}
+
+	all := r.Regexp.FindAllIndex(data, -1)
+	var (
+		lim   = len(data) // where the last separator found starts
+		i, lo = -1, 0     // the next position to try, down to lo
+	)
+	return func() (int, int) {
+		for {
+			if i < lo {
+				if len(all) == 0 {
+					return -1, 0
+				}
+				m := all[len(all)-1]
+				all = all[:len(all)-1]
+				lo, i = m[0], m[1]
+				if i > lim {
+					i = lim
+				}
+				i--
+				continue
+			}
+			p := i
+			i--
+			if m := back.FindIndex(data[p:lim]); m != nil && m[1] > 0 {
+				lim = p
+				return p, m[1]
+			}
+		}
+	}
+}
+
+// anchored returns re matching only at the start of the text, with the
+// longest match preferred, as in POSIX.
+func anchored(re *regexp.Regexp) *regexp.Regexp {
+	back := regexp.MustCompile(`^(?:` + re.String() + `)`)
+	back.Longest()
+	return back
+}
+
+// window returns n bytes of f from off, mapped if possible and otherwise
+// read into *buf, and a function to call once they're no longer needed.
+func window(f *os.File, off int64, n int, buf *[]byte) ([]byte, func(), error) {
+	if m, err := mmap.Map(f, off, n); err == nil {
+		return m.Bytes(), func() { m.Close() }, nil
+	}
+	if cap(*buf) < n {
+		*buf = make([]byte, n)
+	}
+	b := (*buf)[:n]
+	if _, err := f.ReadAt(b, off); err != nil {
+		return nil, nil, err
+	}
+	return b, func() {}, nil
+}
+
+// maxVecs is how many slices are written at once, Linux's IOV_MAX.
+const maxVecs = 1024
+
+// Records shorter than copyLimit are copied together, into a staging buffer
+// stageSize long, rather than written from the window: the kernel takes
+// longer over a slice of its own than copying that many bytes does.
+const (
+	copyLimit = 512
+	stageSize = 64 * 1024
+)
+
+// vecWriter gathers slices to write together. Errors stick, and are returned
+// by flush.
+type vecWriter struct {
+	w       io.Writer
+	bufs    [][]byte
+	stage   []byte
+	staging bool // the last of bufs is in stage
+	err     error
+	sys     sysVecs
+}
+
+func newVecWriter(w io.Writer) *vecWriter {
+	return &vecWriter{
+		w:     w,
+		bufs:  make([][]byte, 0, maxVecs),
+		stage: make([]byte, 0, stageSize),
+	}
+}
+
+// add queues b, which must stay valid until the next flush, to be written.
+func (v *vecWriter) add(b []byte) {
+	if len(b) == 0 {
+		return
+	}
+	if len(b) >= copyLimit {
+		v.bufs = append(v.bufs, b)
+		v.staging = false
+	} else {
+		if len(v.stage)+len(b) > cap(v.stage) {
+			v.flush()
+		}
+		start := len(v.stage)
+		v.stage = append(v.stage, b...)
+		if v.staging {
+			last := v.bufs[len(v.bufs)-1]
+			v.bufs[len(v.bufs)-1] = last[:len(last)+len(b)]
+		} else {
+			v.bufs = append(v.bufs, v.stage[start:])
+			v.staging = true
+		}
+	}
+	if len(v.bufs) == maxVecs {
+		v.flush()
+	}
+}
+
+func (v *vecWriter) flush() error {
+	if v.err == nil && len(v.bufs) > 0 {
+		if err := v.write(); err != nil {
+			v.err = &WriteError{Err: err}
+		}
+	}
+	v.bufs = v.bufs[:0]
+	v.stage = v.stage[:0]
+	v.staging = false
+	return v.err
+}
+
+// writeEach is write for writers that can't take several slices at once.
+func (v *vecWriter) writeEach() error {
+	for _, b := range v.bufs {
+		if _, err := v.w.Write(b); err != nil {
+			return err
+		}
+	}
+	return nil
+}
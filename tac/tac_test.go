@@ -0,0 +1,221 @@
+package tac
+
+import (
+	"bytes"
+	"errors"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"regexp"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils"
+)
+
+// reference returns data with its records reversed, the slow way.
+func reference(r *Reverser, data []byte) []byte {
+	var bounds [][]int
+	if r.Regexp != nil {
+		// Every position is tried, from the end.
+		back := anchored(r.Regexp)
+		for lim, p := len(data), len(data)-1; p >= 0; p-- {
+			if m := back.FindIndex(data[p:lim]); m != nil && m[1] > 0 {
+				bounds = append(bounds, []int{p, p + m[1]})
+				lim = p
+			}
+		}
+		for i, j := 0, len(bounds)-1; i < j; i, j = i+1, j-1 {
+			bounds[i], bounds[j] = bounds[j], bounds[i]
+		}
+	} else {
+		for i := 0; ; {
+			j := bytes.Index(data[i:], []byte(r.Separator))
+			if j < 0 {
+				break
+			}
+			bounds = append(bounds, []int{i + j, i + j + len(r.Separator)})
+			i += j + len(r.Separator)
+		}
+	}
+	var records [][]byte
+	p := 0
+	for _, b := range bounds {
+		at := b[1]
+		if r.Before {
+			at = b[0]
+		}
+		records = append(records, data[p:at])
+		p = at
+	}
+	records = append(records, data[p:])
+	var out []byte
+	for i := len(records) - 1; i >= 0; i-- {
+		out = append(out, records[i]...)
+	}
+	return out
+}
+
+func TestReverse(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "tac")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	name := filepath.Join(tmp, "in")
+
+	rng := rand.New(rand.NewSource(1))
+	words := []string{"", "x", "hello", "a,b", strings.Repeat("y", 700)}
+	seps := []string{"\n", "\n", ",", "ab", ";;"}
+	input := func(n int) []byte {
+		var b bytes.Buffer
+		for i := 0; i < n; i++ {
+			b.WriteString(words[rng.Intn(len(words))])
+			b.WriteString(seps[rng.Intn(len(seps))])
+		}
+		if rng.Intn(2) == 0 {
+			b.WriteString("end")
+		}
+		return b.Bytes()
+	}
+	inputs := [][]byte{nil, []byte("\n"), []byte("no separator")}
+	for i := 0; i < 20; i++ {
+		inputs = append(inputs, input(rng.Intn(5000)))
+	}
+	// Enough for several windows, with a record longer than one.
+	big := append(input(5000), bytes.Repeat([]byte{'z'}, windowSize+1)...)
+	inputs = append(inputs, append(big, input(5000)...))
+
+	reversers := []*Reverser{
+		{Separator: "\n"},
+		{Separator: "\n", Before: true},
+		{Separator: ","},
+		{Separator: "ab", Before: true},
+		{Regexp: regexp.MustCompile("[,;]+")},
+		{Regexp: regexp.MustCompile("a[bc]*"), Before: true},
+	}
+	for i, data := range inputs {
+		if err := ioutil.WriteFile(name, data, 0644); err != nil {
+			t.Fatal(err)
+		}
+		for _, r := range reversers {
+			if len(data) > windowSize && r.Regexp != nil {
+				continue // too slow
+			}
+			want := reference(r, data)
+
+			var got bytes.Buffer
+			r.TempDir = tmp
+			if err := r.Reverse(&got, bytes.NewReader(data)); err != nil || !bytes.Equal(got.Bytes(), want) {
+				t.Fatalf("input %d, %+v, stream: got %d bytes, want %d (%v)", i, r, got.Len(), len(want), err)
+			}
+
+			f, err := os.Open(name)
+			if err != nil {
+				t.Fatal(err)
+			}
+			got.Reset()
+			err = r.Reverse(&got, f)
+			f.Close()
+			if err != nil || !bytes.Equal(got.Bytes(), want) {
+				t.Fatalf("input %d, %+v, file: got %d bytes, want %d (%v)", i, r, got.Len(), len(want), err)
+			}
+		}
+	}
+	if left, _ := filepath.Glob(filepath.Join(tmp, "tac*")); len(left) > 0 {
+		t.Errorf("temporary files left: %q", left)
+	}
+}
+
+// TestRegexpBoundaries checks separators that overlap the ones GNU tac
+// finds, searching from the end.
+func TestRegexpBoundaries(t *testing.T) {
+	for _, tt := range []struct {
+		in, sep string
+		before  bool
+		want    string
+	}{
+		{"a12b345c6", "[0-9][0-9]*", false, "c654b32a1"},
+		{"x;;y,;z", "[,;]+", false, "z;y,;x;"},
+		{"abcxabbyac", "a[bc]*", true, "acabbyabcx"},
+		{"xabyabz", "a|ab", false, "zyabxab"},
+	} {
+		r := &Reverser{Regexp: regexp.MustCompile(tt.sep), Before: tt.before}
+		var got bytes.Buffer
+		if err := r.Reverse(&got, strings.NewReader(tt.in)); err != nil {
+			t.Fatal(err)
+		}
+		if got.String() != tt.want {
+			t.Errorf("%q, -s %q: got %q, want %q", tt.in, tt.sep, got.String(), tt.want)
+		}
+	}
+}
+
+// TestWritev checks the writes of slices straight to a file.
+func TestWritev(t *testing.T) {
+	f, err := ioutil.TempFile("", "tac")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	defer f.Close()
+
+	var want bytes.Buffer
+	v := newVecWriter(f)
+	rng := rand.New(rand.NewSource(1))
+	for i := 0; i < 5000; i++ {
+		b := bytes.Repeat([]byte{byte('a' + i%26)}, rng.Intn(2*copyLimit))
+		want.Write(b)
+		v.add(b)
+	}
+	if err := v.flush(); err != nil {
+		t.Fatal(err)
+	}
+	if got, _ := ioutil.ReadFile(f.Name()); !bytes.Equal(got, want.Bytes()) {
+		t.Errorf("got %d bytes, want %d", len(got), want.Len())
+	}
+}
+
+// failWriter fails every write.
+type failWriter struct{}
+
+func (failWriter) Write([]byte) (int, error) { return 0, errors.New("no space left on device") }
+
+// TestWriteError checks that a failed write is reported as one, not against
+// the input being read, and stops tac.
+func TestWriteError(t *testing.T) {
+	var stderr bytes.Buffer
+	ctx := coreutils.Context{
+		Stdin:  strings.NewReader("a\nb\n"),
+		Stdout: failWriter{},
+		Stderr: &stderr,
+	}
+	if err := run(ctx, "-", "-"); coreutils.Status(err) != 1 {
+		t.Errorf("got %v, want status 1", err)
+	}
+	if got, want := stderr.String(), "tac: write error: no space left on device\n"; got != want {
+		t.Errorf("got %q, want %q", got, want)
+	}
+}
+
+func BenchmarkReverse(b *testing.B) {
+	f, err := ioutil.TempFile("", "tac")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	defer f.Close()
+	for i := 0; i < 1000000; i++ {
+		f.WriteString("a line of the journal\n")
+	}
+	info, _ := f.Stat()
+	b.SetBytes(info.Size())
+
+	r := &Reverser{Separator: "\n"}
+	for i := 0; i < b.N; i++ {
+		if err := r.reverseFile(ioutil.Discard, f, 0, info.Size()); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
@@ -0,0 +1,74 @@
+package tac
+
+import (
+	"os"
+	"unsafe"
+
+	"golang.org/x/sys/unix"
+)
+
+// sysVecs is what writev is handed. It's kept from one write to the next
+// since, with short records, making it anew each time costs as much as the
+// writing.
+type sysVecs struct {
+	iovs []unix.Iovec
+}
+
+// write writes v.bufs with writev, if v.w is a file.
+func (v *vecWriter) write() error {
+	f, ok := v.w.(*os.File)
+	if !ok {
+		return v.writeEach()
+	}
+	rc, err := f.SyscallConn()
+	if err != nil {
+		return v.writeEach()
+	}
+	bufs := v.bufs
+	for len(bufs) > 0 {
+		iovs := v.sys.iovs[:0]
+		for _, b := range bufs {
+			iov := unix.Iovec{Base: &b[0]}
+			iov.SetLen(len(b))
+			iovs = append(iovs, iov)
+		}
+		v.sys.iovs = iovs
+
+		var (
+			n     uintptr
+			errno unix.Errno
+		)
+		err := rc.Write(func(fd uintptr) bool {
+			n, _, errno = unix.Syscall(unix.SYS_WRITEV, fd, uintptr(unsafe.Pointer(&iovs[0])), uintptr(len(iovs)))
+			return errno != unix.EAGAIN
+		})
+		if err == nil && errno != 0 {
+			err = errno
+		}
+		if err == unix.EINTR {
+			continue
+		}
+		if err == unix.EPIPE {
+			// The runtime only raises SIGPIPE for a write to a closed
+			// stdout when the write goes through the os package, not a
+			// raw syscall, so the write is made again that way.
+			if _, err = f.Write(bufs[0]); err == nil {
+				bufs = bufs[1:]
+				continue
+			}
+		}
+		if err != nil {
+			return err
+		}
+		// A short write can leave part of a slice.
+		for m := int(n); m > 0; {
+			if m < len(bufs[0]) {
+				bufs[0] = bufs[0][m:]
+				break
+			}
+			m -= len(bufs[0])
+			bufs = bufs[1:]
+		}
+	}
+	return nil
+}
@@ -0,0 +1,56 @@
+package tac
+
+import (
+	"bytes"
+	"io/ioutil"
+	"os"
+	"os/exec"
+	"strings"
+	"syscall"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils"
+)
+
+// TestBrokenPipe checks that tac dies of SIGPIPE, like GNU's, when writev
+// finds its output is a pipe nobody reads. The runtime raises SIGPIPE only
+// for the process's own stdout, so tac is run in a child to see it.
+func TestBrokenPipe(t *testing.T) {
+	if os.Getenv("TAC_TEST_BROKEN_PIPE") != "" {
+		ctx := coreutils.Context{Stdin: os.Stdin, Stdout: os.Stdout, Stderr: os.Stderr}
+		err := run(ctx, os.Args[len(os.Args)-1])
+		os.Exit(coreutils.Status(err))
+	}
+	f, err := ioutil.TempFile("", "tac")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	data := strings.Repeat("a record\n", 100000)
+	f.WriteString(data)
+	f.Close()
+
+	for _, name := range []string{f.Name(), "-"} {
+		r, w, err := os.Pipe()
+		if err != nil {
+			t.Fatal(err)
+		}
+		r.Close()
+		var stderr bytes.Buffer
+		cmd := exec.Command(os.Args[0], "-test.run=^TestBrokenPipe$", "--", name)
+		cmd.Env = append(os.Environ(), "TAC_TEST_BROKEN_PIPE=1")
+		cmd.Stdin = strings.NewReader(data)
+		cmd.Stdout = w
+		cmd.Stderr = &stderr
+		err = cmd.Run()
+		w.Close()
+		ee, ok := err.(*exec.ExitError)
+		if !ok {
+			t.Fatalf("%s: got %v, want SIGPIPE", name, err)
+		}
+		ws := ee.Sys().(syscall.WaitStatus)
+		if !ws.Signaled() || ws.Signal() != syscall.SIGPIPE || stderr.Len() > 0 {
+			t.Errorf("%s: got %v, %q, want SIGPIPE and no message", name, err, stderr.String())
+		}
+	}
+}
@@ -0,0 +1,9 @@
+// +build !linux
+
+package tac
+
+type sysVecs struct{}
+
+func (v *vecWriter) write() error {
+	return v.writeEach()
+}
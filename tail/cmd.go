@@ -0,0 +1,268 @@
+package tail
+
+import (
+	"bufio"
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"strconv"
+	"time"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("tail", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -F but not --F.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.StringVarP(&c.bytes, "bytes", "c", "", `output the last NUM bytes; or use -c +NUM to
+                             output starting with byte NUM of each file`)
+	c.f.StringVarP(&c.follow, "follow", "f", "", `output appended data as the file grows;
+                             an absent option argument means 'descriptor'`)
+	c.f.Lookup("follow").NoOptDefVal = "descriptor"
+	c.f.BoolVarP(&c.followName, bad1, "F", false, "same as --follow=name --retry")
+	c.f.StringVarP(&c.lines, "lines", "n", "10", `output the last NUM lines, instead of the last 10;
+                             or use -n +NUM to output starting with line NUM`)
+	c.f.IntVar(&c.pid, "pid", 0, "with -f, terminate after process ID, PID dies")
+	c.f.BoolVarP(&c.quiet, "quiet", "q", false, "never output headers giving file names")
+	c.f.BoolVar(&c.quiet, "silent", false, "same as --quiet")
+	c.f.BoolVar(&c.retry, "retry", false, "keep trying to open a file if it is inaccessible")
+	c.f.Float64VarP(&c.sleep, "sleep-interval", "s", 1, `with -f, check for changes at least once every
+                             N seconds; with --pid=P, check process P as often`)
+	c.f.BoolVarP(&c.verbose, "verbose", "v", false, "always output headers giving file names")
+	c.f.BoolVarP(&c.zero, "zero-terminated", "z", false, "line delimiter is NUL, not newline")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f          flag.FlagSet
+	bytes      string
+	follow     string
+	followName bool
+	lines      string
+	pid        int
+	quiet      bool
+	retry      bool
+	sleep      float64
+	verbose    bool
+	zero       bool
+	version    bool
+}
+
+var errNonFatal = errors.New("at least one non-fatal error occurred")
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(obsolete(args)); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "tail (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil && err != errNonFatal {
+			fmt.Fprintf(ctx.Stderr, "tail: %v\n", err)
+		}
+	}()
+
+	t := Tailer{ZeroTerminated: c.zero}
+	arg, what := c.lines, "lines"
+	if c.f.Changed("bytes") {
+		arg, what, t.Bytes = c.bytes, "bytes", true
+	}
+	if t.Count, t.FromStart, err = parseCount(arg); err != nil {
+		return fmt.Errorf("invalid number of %s: '%s'", what, arg)
+	}
+
+	following := c.f.Changed("follow") || c.followName
+	byName := false
+	switch {
+	case c.followName:
+		byName, c.retry = true, true
+	case c.follow == "name":
+		byName = true
+	case c.follow == "descriptor" || !following:
+	default:
+		return fmt.Errorf("invalid argument '%s' for '--follow'", c.follow)
+	}
+	if c.sleep < 0 || math.IsNaN(c.sleep) {
+		return fmt.Errorf("invalid number of seconds: '%v'", c.sleep)
+	}
+
+	out := bufio.NewWriterSize(ctx.Stdout, blockSize)
+	fw := &follower{
+		byName:   byName,
+		retry:    c.retry,
+		interval: time.Duration(c.sleep * float64(time.Second)),
+		pid:      c.pid,
+		out:      out,
+		stderr:   ctx.Stderr,
+	}
+	switch {
+	case c.retry && !following:
+		fw.warn("warning: --retry ignored; --retry is useful only when following")
+	case c.retry && !byName:
+		fw.warn("warning: --retry only effective for the initial open")
+	}
+	if c.pid != 0 && !following {
+		fw.warn("warning: PID ignored; --pid=PID is useful only when following")
+	}
+
+	names := c.f.Args()
+	if len(names) == 0 {
+		names = []string{"-"}
+	}
+	fw.headers = !c.quiet && (c.verbose || len(names) > 1)
+
+	var nerrs int
+	for _, name := range names {
+		f := &followed{name: name, display: name}
+		var r io.Reader
+		if name == "-" {
+			f.display = "standard input"
+			r = ctx.Stdin
+			f.f, _ = r.(*os.File)
+		} else {
+			file, err := os.Open(name)
+			if err != nil {
+				fw.warn("cannot open '%s' for reading: %v", name, unwrap(err))
+				nerrs++
+				if following && c.retry {
+					f.missing = true
+					fw.files = append(fw.files, f)
+				}
+				continue
+			}
+			r, f.f = file, file
+		}
+
+		fw.header(f)
+		if err := t.Tail(out, r); err != nil {
+			fw.warn("error reading '%s': %v", f.display, unwrap(err))
+			nerrs++
+			f.f = nil
+		}
+		if following && f.f != nil && fw.followable(f) {
+			fw.files = append(fw.files, f)
+		} else if f.f != nil && name != "-" {
+			f.f.Close()
+		}
+	}
+	if err := out.Flush(); err != nil {
+		return err
+	}
+
+	if following {
+		if len(fw.files) == 0 && nerrs > 0 {
+			return errNoFiles
+		}
+		if len(fw.files) > 0 {
+			cctx := ctx.Context
+			if cctx == nil {
+				cctx = context.Background()
+			}
+			if err := fw.run(cctx); err != nil {
+				return err
+			}
+		}
+	}
+	if nerrs > 0 {
+		return errNonFatal
+	}
+	return nil
+}
+
+// followable reports whether f, which has just been tailed, can be followed,
+// and records where it was left.
+func (fw *follower) followable(f *followed) bool {
+	info, err := f.f.Stat()
+	if err != nil || info.Mode()&os.ModeNamedPipe != 0 {
+		// Nothing more can be written to a pipe that's been read to
+		// its end.
+		return false
+	}
+	if f.name == "-" && fw.byName {
+		fw.warn("warning: following standard input by name is ineffective")
+		return false
+	}
+	f.info = info
+	f.off, _ = f.f.Seek(0, io.SeekCurrent)
+	return true
+}
+
+// obsolete rewrites the obsolete "tail -NUM" as "tail -n NUM".
+func obsolete(args []string) []string {
+	if len(args) == 0 || len(args[0]) < 2 || args[0][0] != '-' {
+		return args
+	}
+	for _, c := range args[0][1:] {
+		if c < '0' || c > '9' {
+			return args
+		}
+	}
+	return append([]string{"-n", args[0][1:]}, args[1:]...)
+}
+
+var multipliers = map[string]int64{
+	"":    1,
+	"b":   512,
+	"kB":  1000,
+	"K":   1 << 10,
+	"KiB": 1 << 10,
+	"MB":  1000 * 1000,
+	"M":   1 << 20,
+	"MiB": 1 << 20,
+	"GB":  1000 * 1000 * 1000,
+	"G":   1 << 30,
+	"GiB": 1 << 30,
+	"TB":  1000 * 1000 * 1000 * 1000,
+	"T":   1 << 40,
+	"TiB": 1 << 40,
+	"PB":  1000 * 1000 * 1000 * 1000 * 1000,
+	"P":   1 << 50,
+	"PiB": 1 << 50,
+	"EB":  1000 * 1000 * 1000 * 1000 * 1000 * 1000,
+	"E":   1 << 60,
+	"EiB": 1 << 60,
+}
+
+// parseCount parses the argument to -n or -c: a number with an optional
+// multiplier suffix, and a leading + to count from the start. Numbers too
+// large to represent are taken as the largest that is.
+func parseCount(arg string) (n int64, fromStart bool, err error) {
+	s := arg
+	if s != "" && (s[0] == '+' || s[0] == '-') {
+		fromStart = s[0] == '+'
+		s = s[1:]
+	}
+	i := 0
+	for i < len(s) && '0' <= s[i] && s[i] <= '9' {
+		i++
+	}
+	mult, ok := multipliers[s[i:]]
+	if i == 0 || !ok {
+		return 0, false, fmt.Errorf("invalid number: '%s'", arg)
+	}
+	n, err = strconv.ParseInt(s[:i], 10, 64)
+	if err != nil || n > math.MaxInt64/mult {
+		return math.MaxInt64, fromStart, nil
+	}
+	return n * mult, fromStart, nil
+}
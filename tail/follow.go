@@ -0,0 +1,337 @@
+package tail
+
+import (
+	"bufio"
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"syscall"
+	"time"
+)
+
+// maxRead is the most read from one file before the others get a turn.
+const maxRead = 1 << 20
+
+// errNoFiles is returned once none of the files can be followed.
+var errNoFiles = errors.New("no files remaining")
+
+// followed is a file being followed.
+type followed struct {
+	name    string   // as given
+	display string   // in headers and messages
+	f       *os.File // nil while the file can't be opened
+	info    os.FileInfo
+	off     int64 // how much of f has been written
+	missing bool  // it's been reported as inaccessible
+	dirty   bool  // it's due to be checked
+	dropped bool  // it's no longer followed
+}
+
+// A watcher waits for followed files to change.
+type watcher interface {
+	// add watches f's open file, and, following by name or if the
+	// file isn't open, the directory it's in.
+	add(f *followed) error
+
+	// remove stops watching f's open file. It's called before the file is
+	// closed.
+	remove(f *followed)
+
+	// wait waits at most timeout for files to change, and returns those
+	// that might have. They may be returned more than once.
+	wait(timeout time.Duration) ([]*followed, error)
+
+	close() error
+}
+
+// follower writes what's appended to files, as it's appended.
+type follower struct {
+	byName   bool // reopen files that are renamed or removed
+	retry    bool // keep trying files that can't be opened
+	interval time.Duration
+	pid      int // stop once this process has exited
+	headers  bool
+
+	out    *bufio.Writer
+	stderr io.Writer
+	files  []*followed
+	last   *followed // whose output was written last
+	w      watcher
+	buf    []byte
+}
+
+// header writes f's header, if it's not f's output that was written last.
+func (fw *follower) header(f *followed) {
+	if !fw.headers || fw.last == f {
+		return
+	}
+	if fw.last != nil {
+		fw.out.WriteByte('\n')
+	}
+	fmt.Fprintf(fw.out, "==> %s <==\n", f.display)
+	fw.last = f
+}
+
+func (fw *follower) warn(format string, args ...interface{}) {
+	fw.out.Flush()
+	fmt.Fprintf(fw.stderr, "tail: "+format+"\n", args...)
+}
+
+// run follows fw.files until ctx is done or the process fw.pid has exited.
+func (fw *follower) run(ctx context.Context) error {
+	if fw.interval <= 0 {
+		fw.interval = time.Second
+	}
+	fw.buf = make([]byte, blockSize)
+	var err error
+	if fw.w, err = newWatcher(fw.byName); err != nil {
+		fw.warn("%v; reverting to polling", err)
+		fw.w = newPoller()
+	}
+	defer func() { fw.w.close() }()
+	// Anything written before the watches were set up is read now.
+	for _, f := range fw.files {
+		fw.watch(f)
+		f.dirty = true
+	}
+	pending := append([]*followed(nil), fw.files...)
+	lastPoll := time.Now()
+	for {
+		var more []*followed
+		for _, f := range pending {
+			if !f.dirty || f.dropped {
+				continue
+			}
+			f.dirty = false
+			if fw.check(f) {
+				f.dirty = true
+				more = append(more, f)
+			}
+		}
+		if err := fw.out.Flush(); err != nil {
+			return err
+		}
+		fw.prune()
+		if len(fw.files) == 0 {
+			return errNoFiles
+		}
+
+		select {
+		case <-ctx.Done():
+			return nil
+		default:
+		}
+		if fw.pid != 0 && !alive(fw.pid) {
+			// Whatever the process wrote before it exited is still
+			// printed.
+			for _, f := range fw.files {
+				fw.check(f)
+			}
+			return fw.out.Flush()
+		}
+
+		timeout := fw.interval
+		if len(more) > 0 {
+			timeout = 0
+		}
+		changed, err := fw.w.wait(timeout)
+		if err != nil {
+			return err
+		}
+		pending = append(more, changed...)
+		// Files that can't be opened might be in directories that
+		// can't be watched, so they're also tried now and then.
+		if time.Since(lastPoll) >= fw.interval {
+			for _, f := range fw.files {
+				if f.f == nil {
+					pending = append(pending, f)
+				}
+			}
+			lastPoll = time.Now()
+		}
+		for _, f := range pending {
+			f.dirty = true
+		}
+	}
+}
+
+// watch adds f to the watcher, falling back to polling if it can't be.
+func (fw *follower) watch(f *followed) {
+	if err := fw.w.add(f); err != nil {
+		if _, ok := fw.w.(*poller); ok {
+			return
+		}
+		fw.warn("%v; reverting to polling", err)
+		fw.w.close()
+		fw.w = newPoller()
+		for _, f := range fw.files {
+			fw.w.add(f)
+		}
+	}
+}
+
+// prune drops the files that are no longer followed.
+func (fw *follower) prune() {
+	files := fw.files[:0]
+	for _, f := range fw.files {
+		if f.f != nil || fw.retry {
+			files = append(files, f)
+		} else {
+			f.dropped = true
+		}
+	}
+	fw.files = files
+}
+
+// check reopens f if needs be, then writes anything new in it. It reports
+// whether there's more to read than was.
+func (fw *follower) check(f *followed) bool {
+	if fw.byName || f.f == nil {
+		fw.reopen(f)
+	}
+	if f.f == nil {
+		return false
+	}
+	more, err := fw.read(f, maxRead)
+	if err != nil {
+		fw.warn("error reading '%s': %v", f.display, unwrap(err))
+		fw.w.remove(f)
+		f.f.Close()
+		f.f = nil
+	}
+	return more
+}
+
+// read writes up to max bytes appended to f since it was last read, and
+// reports whether it stopped short of the end.
+func (fw *follower) read(f *followed, max int) (bool, error) {
+	if info, err := f.f.Stat(); err == nil && info.Mode().IsRegular() && info.Size() < f.off {
+		fw.warn("%s: file truncated", f.display)
+		if _, err := f.f.Seek(0, io.SeekStart); err != nil {
+			return false, err
+		}
+		f.off = 0
+	}
+	for n := 0; n < max; {
+		m, err := f.f.Read(fw.buf)
+		if m > 0 {
+			fw.header(f)
+			fw.out.Write(fw.buf[:m])
+			f.off += int64(m)
+			n += m
+		}
+		if err == io.EOF || m == 0 {
+			return false, nil
+		}
+		if err != nil {
+			return false, err
+		}
+	}
+	return true, nil
+}
+
+// reopen checks whether f's name still refers to the file that's open, and
+// if not, switches to whatever it refers to now.
+func (fw *follower) reopen(f *followed) {
+	info, err := os.Stat(f.name)
+	if err == nil && f.f != nil && os.SameFile(info, f.info) {
+		return
+	}
+	var nf *os.File
+	if err == nil {
+		nf, err = os.Open(f.name)
+	}
+	if err != nil {
+		if f.f != nil || !f.missing {
+			fw.warn("'%s' has become inaccessible: %v", f.display, unwrap(err))
+		}
+		f.missing = true
+		fw.close(f)
+		return
+	}
+	if info, err = nf.Stat(); err != nil {
+		nf.Close()
+		return
+	}
+
+	if f.f != nil {
+		fw.warn("'%s' has been replaced;  following new file", f.display)
+	} else {
+		fw.warn("'%s' has appeared;  following new file", f.display)
+	}
+	fw.close(f)
+	f.f, f.info, f.off, f.missing = nf, info, 0, false
+	fw.watch(f)
+}
+
+// close stops following f's open file, after writing what's left in it.
+func (fw *follower) close(f *followed) {
+	if f.f == nil {
+		return
+	}
+	fw.read(f, int(^uint(0)>>1))
+	fw.w.remove(f)
+	f.f.Close()
+	f.f = nil
+}
+
+// alive reports whether the process pid is still running.
+func alive(pid int) bool {
+	p, err := os.FindProcess(pid)
+	return err == nil && p.Signal(syscall.Signal(0)) != os.ErrProcessDone
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
+
+func contains(files []*followed, f *followed) bool {
+	for _, g := range files {
+		if g == f {
+			return true
+		}
+	}
+	return false
+}
+
+func without(files []*followed, f *followed) []*followed {
+	for i, g := range files {
+		if g == f {
+			return append(files[:i], files[i+1:]...)
+		}
+	}
+	return files
+}
+
+// poller is the watcher of last resort: every file is checked every time.
+type poller struct {
+	files map[*followed]bool
+}
+
+func newPoller() *poller {
+	return &poller{files: make(map[*followed]bool)}
+}
+
+func (p *poller) add(f *followed) error {
+	p.files[f] = true
+	return nil
+}
+
+// remove keeps f, which still has to be checked for being reopened.
+func (p *poller) remove(f *followed) {}
+
+func (p *poller) wait(timeout time.Duration) ([]*followed, error) {
+	time.Sleep(timeout)
+	changed := make([]*followed, 0, len(p.files))
+	for f := range p.files {
+		changed = append(changed, f)
+	}
+	return changed, nil
+}
+
+func (p *poller) close() error { return nil }
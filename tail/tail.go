@@ -1,3 +1,234 @@
-package main
+// Package tail prints the last part of files, and follows files as they
+// grow.
+//
+// The last lines of a regular file are found by reading it backwards from
+// the end, a block at a time, so the cost depends on how much is printed and
+// not on how large the file is. Inputs that can't seek are read from the
+// front, keeping only the blocks that might be printed.
+//
+// Followed files are watched with inotify on Linux and kqueue on the BSDs
+// and macOS, all from one event loop, so a file is only read once it has
+// changed. Elsewhere they're polled.
+package tail
 
-func main() {}
+import (
+	"bytes"
+	"io"
+	"os"
+)
+
+// blockSize is how much is read at a time.
+const blockSize = 128 * 1024
+
+// Tailer selects the part of its input to print.
+type Tailer struct {
+	Count          int64 // of lines, or bytes
+	Bytes          bool  // Count is in bytes, not lines
+	FromStart      bool  // print from the Count'th line or byte on
+	ZeroTerminated bool  // lines end with NUL, not newline
+}
+
+func (t *Tailer) delim() byte {
+	if t.ZeroTerminated {
+		return 0
+	}
+	return '\n'
+}
+
+// Tail writes the selected part of r to w. If r is a file, it's left at the
+// end of what was read.
+func (t *Tailer) Tail(w io.Writer, r io.Reader) error {
+	if t.FromStart {
+		return t.skip(w, r)
+	}
+	if f, ok := r.(*os.File); ok {
+		if done, err := t.tailFile(w, f); done {
+			return err
+		}
+	}
+	return t.tailStream(w, r)
+}
+
+// tailFile writes the end of f, if it's a regular file, seeking to it. The
+// file is read from its current offset, as it's in "tail < file", on.
+func (t *Tailer) tailFile(w io.Writer, f *os.File) (done bool, err error) {
+	info, err := f.Stat()
+	if err != nil || !info.Mode().IsRegular() {
+		return false, nil
+	}
+	cur, err := f.Seek(0, io.SeekCurrent)
+	if err != nil {
+		return false, nil
+	}
+	size := info.Size()
+	if size < cur {
+		size = cur
+	}
+
+	var start int64
+	if t.Bytes {
+		start = cur
+		if t.Count < size-cur {
+			start = size - t.Count
+		}
+	} else if start, err = t.lastLines(f, cur, size); err != nil {
+		return true, err
+	}
+	if _, err := f.Seek(start, io.SeekStart); err != nil {
+		return true, err
+	}
+	_, err = io.Copy(w, f)
+	return true, err
+}
+
+// lastLines returns the offset of the last t.Count lines between off and end
+// in r, scanning backwards from end a block at a time.
+func (t *Tailer) lastLines(r io.ReaderAt, off, end int64) (int64, error) {
+	n := t.Count
+	if n <= 0 {
+		return end, nil
+	}
+	delim := t.delim()
+	buf := make([]byte, blockSize)
+	last := true
+	for end > off {
+		start := end - blockSize
+		if start < off {
+			start = off
+		}
+		b := buf[:end-start]
+		if m, err := r.ReadAt(b, start); m < len(b) {
+			if err == nil {
+				err = io.ErrUnexpectedEOF
+			}
+			return 0, err
+		}
+		// The delimiter ending the last line doesn't start another.
+		if last {
+			if b[len(b)-1] == delim {
+				b = b[:len(b)-1]
+			}
+			last = false
+		}
+		for {
+			i := bytes.LastIndexByte(b, delim)
+			if i < 0 {
+				break
+			}
+			if n--; n == 0 {
+				return start + int64(i) + 1, nil
+			}
+			b = b[:i]
+		}
+		end = start
+	}
+	return off, nil
+}
+
+// skip discards r up to the t.Count'th line or byte, and copies the rest to
+// w.
+func (t *Tailer) skip(w io.Writer, r io.Reader) error {
+	n := t.Count - 1
+	if n > 0 && t.Bytes {
+		if s, ok := r.(io.Seeker); ok {
+			// A pipe's Seek fails, and it's read instead.
+			if _, err := s.Seek(n, io.SeekCurrent); err == nil {
+				n = 0
+			}
+		}
+	}
+	delim := t.delim()
+	buf := make([]byte, blockSize)
+	for n > 0 {
+		m, err := r.Read(buf)
+		b := buf[:m]
+		if t.Bytes {
+			if int64(len(b)) <= n {
+				n -= int64(len(b))
+				b = nil
+			} else {
+				b, n = b[n:], 0
+			}
+		} else {
+			for n > 0 {
+				i := bytes.IndexByte(b, delim)
+				if i < 0 {
+					b = nil
+					break
+				}
+				b, n = b[i+1:], n-1
+			}
+		}
+		if len(b) > 0 {
+			if _, err := w.Write(b); err != nil {
+				return err
+			}
+		}
+		if err == io.EOF {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+	}
+	_, err := io.Copy(w, r)
+	return err
+}
+
+// tailStream writes the end of r, which is read from the front. Blocks are
+// dropped once those after them hold enough to print.
+func (t *Tailer) tailStream(w io.Writer, r io.Reader) error {
+	delim := t.delim()
+	var (
+		blocks [][]byte
+		counts []int64 // of lines or bytes in each block
+		total  int64
+		free   []byte
+	)
+	for {
+		b := free
+		if b == nil {
+			b = make([]byte, blockSize)
+		}
+		free = nil
+		m, err := io.ReadFull(r, b)
+		if m > 0 {
+			b = b[:m]
+			n := int64(m)
+			if !t.Bytes {
+				n = int64(bytes.Count(b, []byte{delim}))
+			}
+			blocks, counts = append(blocks, b), append(counts, n)
+			total += n
+			// Counting lines, one more delimiter than lines is needed
+			// in case the last one ends the input.
+			need := t.Count
+			if !t.Bytes {
+				need++
+			}
+			for len(blocks) > 1 && total-counts[0] >= need {
+				total -= counts[0]
+				free = blocks[0][:cap(blocks[0])]
+				blocks, counts = blocks[1:], counts[1:]
+			}
+		}
+		if err == io.EOF || err == io.ErrUnexpectedEOF {
+			break
+		}
+		if err != nil {
+			return err
+		}
+	}
+
+	data := bytes.Join(blocks, nil)
+	var start int64
+	if t.Bytes {
+		if start = int64(len(data)) - t.Count; start < 0 {
+			start = 0
+		}
+	} else {
+		start, _ = t.lastLines(bytes.NewReader(data), 0, int64(len(data)))
+	}
+	_, err := w.Write(data[start:])
+	return err
+}
@@ -0,0 +1,244 @@
+package tail
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+// reference returns what t should select from data, the slow way.
+func reference(t Tailer, data []byte) []byte {
+	if t.Bytes {
+		switch {
+		case t.FromStart && t.Count <= 1:
+			return data
+		case t.FromStart:
+			if t.Count-1 >= int64(len(data)) {
+				return nil
+			}
+			return data[t.Count-1:]
+		case t.Count >= int64(len(data)):
+			return data
+		default:
+			return data[int64(len(data))-t.Count:]
+		}
+	}
+	var lines [][]byte
+	for len(data) > 0 {
+		i := bytes.IndexByte(data, t.delim()) + 1
+		if i == 0 {
+			i = len(data)
+		}
+		lines, data = append(lines, data[:i]), data[i:]
+	}
+	switch {
+	case t.FromStart && t.Count <= 1:
+	case t.FromStart:
+		if t.Count-1 >= int64(len(lines)) {
+			return nil
+		}
+		lines = lines[t.Count-1:]
+	case t.Count < int64(len(lines)):
+		lines = lines[int64(len(lines))-t.Count:]
+	}
+	return bytes.Join(lines, nil)
+}
+
+func TestTail(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "tail")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	name := filepath.Join(tmp, "in")
+
+	rng := rand.New(rand.NewSource(1))
+	for i := 0; i < 50; i++ {
+		// Lines long and short enough to straddle several blocks.
+		var buf bytes.Buffer
+		for n := rng.Intn(3000); n > 0; n-- {
+			buf.WriteString(strings.Repeat("x", rng.Intn(300)))
+			buf.WriteByte('\n')
+		}
+		if rng.Intn(2) == 0 {
+			buf.WriteString("no newline")
+		}
+		data := buf.Bytes()
+		if err := ioutil.WriteFile(name, data, 0644); err != nil {
+			t.Fatal(err)
+		}
+
+		for j := 0; j < 10; j++ {
+			tl := Tailer{
+				Count:     []int64{0, 1, 2, 10, 1000, 1 << 20}[rng.Intn(6)],
+				Bytes:     rng.Intn(2) == 0,
+				FromStart: rng.Intn(3) == 0,
+			}
+			want := reference(tl, data)
+
+			var got bytes.Buffer
+			if err := tl.Tail(&got, bytes.NewReader(data)); err != nil || !bytes.Equal(got.Bytes(), want) {
+				t.Fatalf("%+v, stream: got %d bytes, want %d (%v)", tl, got.Len(), len(want), err)
+			}
+
+			f, err := os.Open(name)
+			if err != nil {
+				t.Fatal(err)
+			}
+			got.Reset()
+			err = tl.Tail(&got, f)
+			f.Close()
+			if err != nil || !bytes.Equal(got.Bytes(), want) {
+				t.Fatalf("%+v, file: got %d bytes, want %d (%v)", tl, got.Len(), len(want), err)
+			}
+		}
+	}
+}
+
+func TestParseCount(t *testing.T) {
+	for _, tc := range []struct {
+		arg       string
+		n         int64
+		fromStart bool
+	}{
+		{"10", 10, false},
+		{"-10", 10, false},
+		{"+10", 10, true},
+		{"2b", 1024, false},
+		{"+1kB", 1000, true},
+		{"3K", 3 << 10, false},
+		{"1MiB", 1 << 20, false},
+		{"99999999999999999999", 1<<63 - 1, false},
+		{"9E", 1<<63 - 1, false},
+	} {
+		n, fromStart, err := parseCount(tc.arg)
+		if err != nil || n != tc.n || fromStart != tc.fromStart {
+			t.Errorf("%q: got %d, %t, %v", tc.arg, n, fromStart, err)
+		}
+	}
+	for _, arg := range []string{"", "+", "x", "1x", "1 ", "--1"} {
+		if _, _, err := parseCount(arg); err == nil {
+			t.Errorf("%q: no error", arg)
+		}
+	}
+}
+
+// syncBuffer is written by the follower while the test reads it.
+type syncBuffer struct {
+	mu sync.Mutex
+	b  bytes.Buffer
+}
+
+func (b *syncBuffer) Write(p []byte) (int, error) {
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	return b.b.Write(p)
+}
+
+func (b *syncBuffer) String() string {
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	return b.b.String()
+}
+
+func TestFollow(t *testing.T) {
+	tmp, err := ioutil.TempDir("", "tail")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	name := filepath.Join(tmp, "log")
+	if err := ioutil.WriteFile(name, []byte("one\n"), 0644); err != nil {
+		t.Fatal(err)
+	}
+	appendTo := func(name, s string) {
+		f, err := os.OpenFile(name, os.O_WRONLY|os.O_APPEND|os.O_CREATE, 0644)
+		if err != nil {
+			t.Fatal(err)
+		}
+		f.WriteString(s)
+		f.Close()
+	}
+
+	var stdout, stderr syncBuffer
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan error)
+	go func() {
+		done <- run(coreutils.Context{
+			Context: ctx,
+			Stdout:  &stdout,
+			Stderr:  &stderr,
+		}, "-F", "-s", "0.05", name)
+	}()
+	wait := func(want string) {
+		for deadline := time.Now().Add(5 * time.Second); time.Now().Before(deadline); {
+			if stdout.String() == want {
+				return
+			}
+			time.Sleep(10 * time.Millisecond)
+		}
+		t.Fatalf("got %q, want %q (%s)", stdout.String(), want, stderr.String())
+	}
+
+	wait("one\n")
+	appendTo(name, "two\n")
+	wait("one\ntwo\n")
+	// Following by name, a replaced file is switched to.
+	if err := os.Rename(name, name+".old"); err != nil {
+		t.Fatal(err)
+	}
+	appendTo(name, "three\n")
+	wait("one\ntwo\nthree\n")
+	if err := os.Truncate(name, 0); err != nil {
+		t.Fatal(err)
+	}
+	appendTo(name, "four\n")
+	wait("one\ntwo\nthree\nfour\n")
+
+	cancel()
+	if err := <-done; err != nil {
+		t.Fatal(err)
+	}
+	for _, msg := range []string{"following new file", "file truncated"} {
+		if !strings.Contains(stderr.String(), msg) {
+			t.Errorf("no %q in %q", msg, stderr.String())
+		}
+	}
+}
+
+func BenchmarkTailLines(b *testing.B) {
+	tmp, err := ioutil.TempDir("", "tail")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(tmp)
+	name := filepath.Join(tmp, "in")
+	var buf bytes.Buffer
+	for i := 0; i < 1000000; i++ {
+		fmt.Fprintf(&buf, "line %d of the file\n", i)
+	}
+	if err := ioutil.WriteFile(name, buf.Bytes(), 0644); err != nil {
+		b.Fatal(err)
+	}
+	tl := Tailer{Count: 1000}
+	for i := 0; i < b.N; i++ {
+		f, err := os.Open(name)
+		if err != nil {
+			b.Fatal(err)
+		}
+		if err := tl.Tail(ioutil.Discard, f); err != nil {
+			b.Fatal(err)
+		}
+		f.Close()
+	}
+}
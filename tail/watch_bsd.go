@@ -0,0 +1,128 @@
+// +build darwin dragonfly freebsd netbsd openbsd
+
+package tail
+
+import (
+	"os"
+	"path/filepath"
+	"time"
+
+	"golang.org/x/sys/unix"
+)
+
+const (
+	fileNotes = unix.NOTE_WRITE | unix.NOTE_EXTEND | unix.NOTE_ATTRIB | unix.NOTE_DELETE | unix.NOTE_RENAME
+	dirNotes  = unix.NOTE_WRITE
+)
+
+// kqueue watches every file with one kqueue. Files are watched through
+// their descriptors, and directories through descriptors of their own,
+// which only say that something in them changed.
+type kqueue struct {
+	kq     int
+	byName bool
+	files  map[int][]*followed // by descriptor
+	fds    map[*followed]int
+	dirs   map[int][]*followed // files in each watched directory
+	dirFDs map[string]int
+	events [64]unix.Kevent_t
+}
+
+func newWatcher(byName bool) (watcher, error) {
+	kq, err := unix.Kqueue()
+	if err != nil {
+		return nil, os.NewSyscallError("kqueue", err)
+	}
+	unix.CloseOnExec(kq)
+	return &kqueue{
+		kq:     kq,
+		byName: byName,
+		files:  make(map[int][]*followed),
+		fds:    make(map[*followed]int),
+		dirs:   make(map[int][]*followed),
+		dirFDs: make(map[string]int),
+	}, nil
+}
+
+func (w *kqueue) register(fd int, flags int, notes uint32) error {
+	var ev unix.Kevent_t
+	unix.SetKevent(&ev, fd, unix.EVFILT_VNODE, flags)
+	ev.Fflags = notes
+	_, err := unix.Kevent(w.kq, []unix.Kevent_t{ev}, nil, nil)
+	return err
+}
+
+func (w *kqueue) add(f *followed) error {
+	if f.f != nil {
+		if _, ok := w.fds[f]; !ok {
+			fd := int(f.f.Fd())
+			if len(w.files[fd]) == 0 {
+				if err := w.register(fd, unix.EV_ADD|unix.EV_CLEAR, fileNotes); err != nil {
+					return os.NewSyscallError("kevent", err)
+				}
+			}
+			w.files[fd] = append(w.files[fd], f)
+			w.fds[f] = fd
+		}
+	}
+	if w.byName || f.f == nil {
+		dir := filepath.Dir(f.name)
+		fd, ok := w.dirFDs[dir]
+		if !ok {
+			var err error
+			if fd, err = unix.Open(dir, unix.O_RDONLY|unix.O_CLOEXEC, 0); err != nil {
+				// f is still tried now and then.
+				return nil
+			}
+			if err := w.register(fd, unix.EV_ADD|unix.EV_CLEAR, dirNotes); err != nil {
+				unix.Close(fd)
+				return nil
+			}
+			w.dirFDs[dir] = fd
+		}
+		if !contains(w.dirs[fd], f) {
+			w.dirs[fd] = append(w.dirs[fd], f)
+		}
+	}
+	return nil
+}
+
+func (w *kqueue) remove(f *followed) {
+	fd, ok := w.fds[f]
+	if !ok {
+		return
+	}
+	delete(w.fds, f)
+	if w.files[fd] = without(w.files[fd], f); len(w.files[fd]) == 0 {
+		delete(w.files, fd)
+		w.register(fd, unix.EV_DELETE, 0)
+	}
+}
+
+func (w *kqueue) wait(timeout time.Duration) ([]*followed, error) {
+	ts := unix.NsecToTimespec(int64(timeout))
+	n, err := unix.Kevent(w.kq, nil, w.events[:], &ts)
+	if n <= 0 || err == unix.EINTR {
+		return nil, nil
+	}
+	if err != nil {
+		return nil, os.NewSyscallError("kevent", err)
+	}
+	var changed []*followed
+	for _, ev := range w.events[:n] {
+		fd := int(ev.Ident)
+		if files, ok := w.dirs[fd]; ok {
+			changed = append(changed, files...)
+		} else {
+			changed = append(changed, w.files[fd]...)
+		}
+	}
+	return changed, nil
+}
+
+func (w *kqueue) close() error {
+	for _, fd := range w.dirFDs {
+		unix.Close(fd)
+	}
+	return unix.Close(w.kq)
+}
@@ -0,0 +1,153 @@
+package tail
+
+import (
+	"bytes"
+	"fmt"
+	"os"
+	"path/filepath"
+	"time"
+	"unsafe"
+
+	"golang.org/x/sys/unix"
+)
+
+const (
+	fileEvents = unix.IN_MODIFY | unix.IN_ATTRIB | unix.IN_DELETE_SELF | unix.IN_MOVE_SELF
+	dirEvents  = unix.IN_CREATE | unix.IN_MOVED_TO | unix.IN_MOVED_FROM | unix.IN_DELETE | unix.IN_ATTRIB
+)
+
+// inotify watches every file with one inotify instance. Files are watched
+// through their descriptors, so a watch stays with the file it was set up
+// for, and directories are watched for names coming and going.
+type inotify struct {
+	fd     int
+	byName bool
+	files  map[int32][]*followed // by watch descriptor
+	wds    map[*followed]int32
+	dirs   map[int32][]*followed // files in each watched directory
+	dirWDs map[string]int32
+	buf    [64 * 1024]byte
+}
+
+func newWatcher(byName bool) (watcher, error) {
+	fd, err := unix.InotifyInit1(unix.IN_CLOEXEC | unix.IN_NONBLOCK)
+	if err != nil {
+		return nil, os.NewSyscallError("inotify", err)
+	}
+	return &inotify{
+		fd:     fd,
+		byName: byName,
+		files:  make(map[int32][]*followed),
+		wds:    make(map[*followed]int32),
+		dirs:   make(map[int32][]*followed),
+		dirWDs: make(map[string]int32),
+	}, nil
+}
+
+func (w *inotify) add(f *followed) error {
+	if f.f != nil {
+		if _, ok := w.wds[f]; !ok {
+			path := fmt.Sprintf("/proc/self/fd/%d", f.f.Fd())
+			wd, err := unix.InotifyAddWatch(w.fd, path, fileEvents)
+			if err == unix.ENOENT {
+				// No /proc.
+				wd, err = unix.InotifyAddWatch(w.fd, f.name, fileEvents)
+			}
+			if err != nil {
+				return fmt.Errorf("cannot watch '%s': %v", f.display, err)
+			}
+			w.files[int32(wd)] = append(w.files[int32(wd)], f)
+			w.wds[f] = int32(wd)
+		}
+	}
+	if w.byName || f.f == nil {
+		dir := filepath.Dir(f.name)
+		wd, ok := w.dirWDs[dir]
+		if !ok {
+			n, err := unix.InotifyAddWatch(w.fd, dir, dirEvents)
+			if err != nil {
+				// f is still tried now and then.
+				return nil
+			}
+			wd = int32(n)
+			w.dirWDs[dir] = wd
+		}
+		if !contains(w.dirs[wd], f) {
+			w.dirs[wd] = append(w.dirs[wd], f)
+		}
+	}
+	return nil
+}
+
+func (w *inotify) remove(f *followed) {
+	wd, ok := w.wds[f]
+	if !ok {
+		return
+	}
+	delete(w.wds, f)
+	if w.files[wd] = without(w.files[wd], f); len(w.files[wd]) == 0 {
+		delete(w.files, wd)
+		unix.InotifyRmWatch(w.fd, uint32(wd))
+	}
+}
+
+func (w *inotify) wait(timeout time.Duration) ([]*followed, error) {
+	fds := []unix.PollFd{{Fd: int32(w.fd), Events: unix.POLLIN}}
+	n, err := unix.Poll(fds, int(timeout/time.Millisecond))
+	if n <= 0 || err == unix.EINTR {
+		return nil, nil
+	}
+	if err != nil {
+		return nil, os.NewSyscallError("poll", err)
+	}
+	n, err = unix.Read(w.fd, w.buf[:])
+	if err == unix.EINTR || err == unix.EAGAIN {
+		return nil, nil
+	}
+	if err != nil {
+		return nil, os.NewSyscallError("read", err)
+	}
+
+	var changed []*followed
+	for off := 0; off+unix.SizeofInotifyEvent <= n; {
+		ev := (*unix.InotifyEvent)(unsafe.Pointer(&w.buf[off]))
+		name := w.buf[off+unix.SizeofInotifyEvent : off+unix.SizeofInotifyEvent+int(ev.Len)]
+		if i := bytes.IndexByte(name, 0); i >= 0 {
+			name = name[:i]
+		}
+		off += unix.SizeofInotifyEvent + int(ev.Len)
+
+		if ev.Mask&unix.IN_Q_OVERFLOW != 0 {
+			// Events were lost, so anything might have changed.
+			for _, files := range w.files {
+				changed = append(changed, files...)
+			}
+			for _, files := range w.dirs {
+				changed = append(changed, files...)
+			}
+			continue
+		}
+		if files, ok := w.dirs[ev.Wd]; ok {
+			for _, f := range files {
+				if filepath.Base(f.name) == string(name) {
+					changed = append(changed, f)
+				}
+			}
+			continue
+		}
+		files := w.files[ev.Wd]
+		changed = append(changed, files...)
+		if ev.Mask&unix.IN_IGNORED != 0 {
+			// The file's gone, and the watch with it.
+			for _, f := range files {
+				delete(w.wds, f)
+			}
+			delete(w.files, ev.Wd)
+		}
+	}
+	return changed, nil
+}
+
+func (w *inotify) close() error {
+	return unix.Close(w.fd)
+}
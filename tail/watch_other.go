@@ -0,0 +1,8 @@
+// +build !linux,!darwin,!dragonfly,!freebsd,!netbsd,!openbsd
+
+package tail
+
+// newWatcher returns a poller, since there's nothing better here.
+func newWatcher(byName bool) (watcher, error) {
+	return newPoller(), nil
+}
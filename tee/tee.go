@@ -12,34 +12,73 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
-
-import "os"
-import "fmt"
-import "io/ioutil"
-import flag "github.com/ogier/pflag"
-import "log"
-
-func main() {
-	flagAppend := flag.BoolP("append", "a", false, "append to file")
-	flag.Parse()
-	bytes, _ := ioutil.ReadAll(os.Stdin)
-	for i := 0; i < len(flag.Args()); i++ {
-		if *flagAppend {
-			f, err := os.OpenFile(flag.Args()[i], os.O_WRONLY|os.O_CREATE|os.O_APPEND, 0644)
-			if err != nil {
-				log.Fatal(err)
-			}
-			f.Write(bytes)
-			f.Close()
-		} else {
-			f, err := os.OpenFile(flag.Args()[i], os.O_WRONLY|os.O_CREATE, 0644)
-			if err != nil {
-				log.Fatal(err)
+package tee
+
+import (
+	"fmt"
+	"io"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("tee", run)
+}
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f        flag.FlagSet
+		appendTo bool
+	)
+	f.BoolVarP(&appendTo, "append", "a", false, "append to file")
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "tee: %v\n", err)
+		}
+	}()
+
+	mode := os.O_WRONLY | os.O_CREATE | os.O_TRUNC
+	if appendTo {
+		mode = os.O_WRONLY | os.O_CREATE | os.O_APPEND
+	}
+	outs := []io.Writer{ctx.Stdout}
+	for _, name := range f.Args() {
+		file, err := os.OpenFile(name, mode, 0666)
+		if err != nil {
+			return err
+		}
+		defer file.Close()
+		outs = append(outs, file)
+	}
+
+	// The input's copied as it comes, through one buffer, rather than
+	// read in full first.
+	buf := ctx.Buffer()
+	defer ctx.PutBuffer(buf)
+	for {
+		n, rerr := ctx.Stdin.Read(buf)
+		for _, w := range outs {
+			if _, err := w.Write(buf[:n]); err != nil {
+				return err
 			}
-			f.Write(bytes)
-			f.Close()
+		}
+		if rerr == io.EOF {
+			break
+		}
+		if rerr != nil {
+			return rerr
+		}
+	}
+	for _, w := range outs[1:] {
+		if err := w.(*os.File).Close(); err != nil {
+			return err
 		}
 	}
-	fmt.Printf("%s", string(bytes))
+	return nil
 }
@@ -17,17 +17,21 @@
 	Written by Robert Deusser <iamthemuffinman@outlook.com>
 */
 
-package main
+package touch
 
 import (
 	"fmt"
-	"log"
 	"os"
 	"time"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("touch", run)
+}
+
 const (
 	Help = `
 Usage: touch [OPTION]... FILE...
@@ -69,37 +73,44 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	nocreate = flag.BoolP("no-create", "c", false, "")
-	version  = flag.BoolP("version", "v", false, "")
-)
-
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
+func run(ctx coreutils.Context, args ...string) (err error) {
+	var (
+		f        flag.FlagSet
+		nocreate bool
+		version  bool
+	)
+	f.BoolVarP(&nocreate, "no-create", "c", false, "")
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
-	flag.Parse()
 
-	if *version {
-		fmt.Fprintf(os.Stdout, "%s", Version)
-		os.Exit(0)
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "touch: %v\n", err)
+		}
+	}()
+
+	if version {
+		fmt.Fprintf(ctx.Stdout, "%s", Version)
+		return nil
 	}
 
-	if len(flag.Args()) > 0 {
-		for i := 0; i < len(flag.Args()); i++ {
-			filename := flag.Arg(i)
-			_, err := os.Stat(filename)
-			if err == nil {
-				now := time.Now()
-				os.Chtimes(filename, now, now)
-			} else if !(*nocreate) {
-				f, err := os.OpenFile(filename, os.O_WRONLY|os.O_CREATE, 0644)
-				f.Close()
-				if err != nil {
-					log.Fatal(err)
-				}
+	for _, filename := range f.Args() {
+		_, err := os.Stat(filename)
+		if err == nil {
+			now := time.Now()
+			if err := os.Chtimes(filename, now, now); err != nil {
+				return err
+			}
+		} else if !nocreate {
+			file, err := os.OpenFile(filename, os.O_WRONLY|os.O_CREATE, 0644)
+			if err != nil {
+				return err
 			}
+			file.Close()
 		}
 	}
+	return nil
 }
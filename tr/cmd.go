@@ -0,0 +1,110 @@
+package tr
+
+import (
+	"errors"
+	"fmt"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("tr", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -n but not --n.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.complement, "complement", "c", false, "use the complement of ARRAY1")
+	c.f.BoolVarP(&c.complement, bad1, "C", false, "use the complement of ARRAY1")
+	c.f.BoolVarP(&c.delete, "delete", "d", false, "delete characters in ARRAY1, do not translate")
+	c.f.BoolVarP(&c.squeeze, "squeeze-repeats", "s", false, `replace each sequence of a repeated character
+                            that is listed in the last specified ARRAY,
+                            with a single occurrence of that character`)
+	c.f.BoolVarP(&c.truncate, "truncate-set1", "t", false, "first truncate ARRAY1 to length of ARRAY2")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	// As in GNU tr, options stop at the first set.
+	c.f.SetInterspersed(false)
+	return &c
+}
+
+type cmd struct {
+	f          flag.FlagSet
+	complement bool
+	delete     bool
+	squeeze    bool
+	truncate   bool
+	version    bool
+}
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "tr (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "tr: %v\n", err)
+		}
+	}()
+
+	sets := c.f.Args()
+	min, max := 1, 2
+	if c.delete == c.squeeze {
+		min = 2
+	}
+	if c.delete && !c.squeeze {
+		max = 1
+	}
+	switch {
+	case len(sets) == 0:
+		return errors.New("missing operand")
+	case len(sets) < min:
+		msg := "Two strings must be given when translating."
+		if c.squeeze {
+			msg = "Two strings must be given when both deleting and squeezing repeats."
+		}
+		return fmt.Errorf("missing operand after '%s'\n%s", sets[len(sets)-1], msg)
+	case len(sets) > max:
+		if len(sets) == 2 {
+			return fmt.Errorf("extra operand '%s'\nOnly one string may be given when deleting without squeezing repeats.", sets[max])
+		}
+		return fmt.Errorf("extra operand '%s'", sets[max])
+	}
+
+	t, err := Compile(Options{
+		Complement: c.complement,
+		Delete:     c.delete,
+		Squeeze:    c.squeeze,
+		Truncate:   c.truncate,
+		Warn: func(msg string) {
+			fmt.Fprintf(ctx.Stderr, "tr: %s\n", msg)
+		},
+	}, sets...)
+	if err != nil {
+		return err
+	}
+	if err := t.Translate(ctx.Stdout, ctx.Stdin); err != nil {
+		if pe, ok := err.(*os.PathError); ok {
+			if pe.Op == "write" {
+				return fmt.Errorf("write error: %v", pe.Err)
+			}
+			return fmt.Errorf("read error: %v", pe.Err)
+		}
+		return err
+	}
+	return nil
+}
@@ -0,0 +1,334 @@
+package tr
+
+import (
+	"errors"
+	"fmt"
+	"strconv"
+	"strings"
+)
+
+// span is a byte repeated n times, which is how a set is kept once it's
+// expanded: [c*n] can ask for far more bytes than are worth spelling out.
+type span struct {
+	c byte
+	n uint64
+}
+
+// set is an expanded SET1 or SET2.
+type set struct {
+	spans []span
+	len   uint64
+
+	// cases are where each [:upper:] or [:lower:] starts.
+	cases []uint64
+	// class is whether there's a character class in it, and other whether
+	// there's one other than [:upper:] or [:lower:].
+	class, other bool
+	equiv        bool
+	// fill is the [c*] to be given as many bytes as it takes to make the
+	// set as long as SET1, if there is one.
+	fill    *span
+	fillAt  int // where in spans it goes
+	fills   int
+	fillPos uint64
+}
+
+func (s *set) add(c byte, n uint64) {
+	s.spans = append(s.spans, span{c, n})
+	s.len += n
+}
+
+// classes are the character classes, in the C locale.
+var classes = map[string]func(c byte) bool{
+	"alnum":  func(c byte) bool { return isAlpha(c) || isDigit(c) },
+	"alpha":  isAlpha,
+	"blank":  func(c byte) bool { return c == ' ' || c == '\t' },
+	"cntrl":  func(c byte) bool { return c < ' ' || c == 0x7f },
+	"digit":  isDigit,
+	"graph":  func(c byte) bool { return c > ' ' && c < 0x7f },
+	"lower":  func(c byte) bool { return c >= 'a' && c <= 'z' },
+	"print":  func(c byte) bool { return c >= ' ' && c < 0x7f },
+	"punct":  func(c byte) bool { return c > ' ' && c < 0x7f && !isAlpha(c) && !isDigit(c) },
+	"space":  func(c byte) bool { return c == ' ' || c >= '\t' && c <= '\r' },
+	"upper":  func(c byte) bool { return c >= 'A' && c <= 'Z' },
+	"xdigit": func(c byte) bool { return isDigit(c) || c|0x20 >= 'a' && c|0x20 <= 'f' },
+}
+
+func isAlpha(c byte) bool { return c|0x20 >= 'a' && c|0x20 <= 'z' }
+func isDigit(c byte) bool { return c >= '0' && c <= '9' }
+
+// unescape interprets the backslash escapes in s, and reports which bytes
+// of what it returns were escaped, which don't start or end constructs.
+func unescape(s string, warn func(string)) ([]byte, []bool) {
+	b := make([]byte, 0, len(s))
+	esc := make([]bool, 0, len(s))
+	for i := 0; i < len(s); i++ {
+		c := s[i]
+		if c != '\\' {
+			b, esc = append(b, c), append(esc, false)
+			continue
+		}
+		if i+1 == len(s) {
+			warn("warning: an unescaped backslash at end of string is not portable")
+			b, esc = append(b, '\\'), append(esc, false)
+			continue
+		}
+		i++
+		switch c = s[i]; c {
+		case 'a':
+			c = '\a'
+		case 'b':
+			c = '\b'
+		case 'f':
+			c = '\f'
+		case 'n':
+			c = '\n'
+		case 'r':
+			c = '\r'
+		case 't':
+			c = '\t'
+		case 'v':
+			c = '\v'
+		case '0', '1', '2', '3', '4', '5', '6', '7':
+			// Up to three octal digits, as long as they fit in a byte.
+			v := int(c - '0')
+			for k := 0; k < 2 && i+1 < len(s) && s[i+1] >= '0' && s[i+1] <= '7'; k++ {
+				w := v*8 + int(s[i+1]-'0')
+				if w > 0xff {
+					warn(fmt.Sprintf("warning: the ambiguous octal escape \\%c%c%c is being\n\tinterpreted as the 2-byte sequence \\0%c%c, %c",
+						s[i-1], s[i], s[i+1], s[i-1], s[i], s[i+1]))
+					break
+				}
+				v = w
+				i++
+			}
+			c = byte(v)
+		}
+		b, esc = append(b, c), append(esc, true)
+	}
+	return b, esc
+}
+
+// parseSet parses and expands a SET1 or SET2, except for a [c*], which is
+// expanded by fillTo.
+func parseSet(str string, warn func(string)) (*set, error) {
+	p, esc := unescape(str, warn)
+	is := func(i int, c byte) bool { return i < len(p) && p[i] == c && !esc[i] }
+	s := &set{}
+
+	i := 0
+	for ; i+2 < len(p); i++ {
+		if is(i, '[') {
+			if n, err := s.bracket(p, esc, i); err != nil {
+				return nil, err
+			} else if n > 0 {
+				i += n - 1
+				continue
+			}
+		}
+		if is(i+1, '-') {
+			lo, hi := p[i], p[i+2]
+			if lo > hi {
+				return nil, fmt.Errorf("range-endpoints of '%s-%s' are in reverse collating sequence order",
+					printable(lo), printable(hi))
+			}
+			for c := int(lo); c <= int(hi); c++ {
+				s.add(byte(c), 1)
+			}
+			i += 2
+			continue
+		}
+		s.add(p[i], 1)
+	}
+	for ; i < len(p); i++ {
+		s.add(p[i], 1)
+	}
+	return s, nil
+}
+
+// bracket adds the [:class:], [=c=] or [c*n] at p[i], and returns how long
+// it is, or 0 if there isn't one there and the bracket is just a bracket.
+func (s *set) bracket(p []byte, esc []bool, i int) (int, error) {
+	is := func(i int, c byte) bool { return i < len(p) && p[i] == c && !esc[i] }
+
+	if d := p[i+1]; (d == ':' || d == '=') && !esc[i+1] {
+		for j := i + 2; j+1 < len(p); j++ {
+			if !is(j, d) || !is(j+1, ']') {
+				continue
+			}
+			name := string(p[i+2 : j])
+			switch {
+			case name == "" && d == ':':
+				return 0, errors.New("missing character class name '[::]'")
+			case name == "":
+				return 0, errors.New("missing equivalence class character '[==]'")
+			case d == '=':
+				if len(name) != 1 {
+					return 0, fmt.Errorf("%s: equivalence class operand must be a single character", name)
+				}
+				// In the C locale, a byte is only equivalent to itself.
+				s.equiv = true
+				s.add(name[0], 1)
+			default:
+				in, ok := classes[name]
+				if !ok {
+					return 0, fmt.Errorf("invalid character class '%s'", name)
+				}
+				s.class = true
+				if name == "upper" || name == "lower" {
+					s.cases = append(s.cases, s.len)
+				} else {
+					s.other = true
+				}
+				for c := 0; c < 256; c++ {
+					if in(byte(c)) {
+						s.add(byte(c), 1)
+					}
+				}
+			}
+			return j + 2 - i, nil
+		}
+		// Maybe it's [:*n] or [=*n].
+	}
+
+	if !is(i+2, '*') {
+		return 0, nil
+	}
+	for j := i + 3; j < len(p) && !esc[j]; j++ {
+		if p[j] != ']' {
+			continue
+		}
+		c, digits := p[i+1], string(p[i+3:j])
+		var n uint64
+		if digits != "" {
+			base := 10
+			if digits[0] == '0' {
+				base = 8
+			}
+			// As with strtoumax, spaces and a plus sign can come first.
+			num := strings.TrimLeft(digits, " \t\n\v\f\r")
+			if num != "" && num[0] == '+' {
+				num = num[1:]
+			}
+			var err error
+			if n, err = strconv.ParseUint(num, base, 64); err != nil {
+				return 0, fmt.Errorf("invalid repeat count '%s' in [c*n] construct", printableString(digits))
+			}
+		}
+		if n == 0 {
+			s.fills++
+			s.fill = &span{c: c}
+			s.fillAt = len(s.spans)
+			s.fillPos = s.len
+		} else {
+			s.add(c, n)
+		}
+		return j + 1 - i, nil
+	}
+	return 0, nil
+}
+
+// fillTo expands s's [c*], if it has one, so that s is n long.
+func (s *set) fillTo(n uint64) {
+	if s.fill == nil {
+		return
+	}
+	if n > s.len {
+		s.fill.n = n - s.len
+	}
+	s.spans = append(s.spans[:s.fillAt], append([]span{*s.fill}, s.spans[s.fillAt:]...)...)
+	s.len += s.fill.n
+	for i, at := range s.cases {
+		if at >= s.fillPos {
+			s.cases[i] += s.fill.n
+		}
+	}
+	s.fill = nil
+}
+
+// complement returns the bytes not in s, in order.
+func (s *set) complement() *set {
+	var in [256]bool
+	for _, r := range s.spans {
+		in[r.c] = true
+	}
+	c := &set{class: s.class}
+	for b := 0; b < 256; b++ {
+		if !in[b] {
+			c.add(byte(b), 1)
+		}
+	}
+	return c
+}
+
+// truncate drops what's in s past n.
+func (s *set) truncate(n uint64) {
+	if s.len <= n {
+		return
+	}
+	var at uint64
+	for i, r := range s.spans {
+		if at+r.n >= n {
+			s.spans[i].n = n - at
+			s.spans = s.spans[:i+1]
+			break
+		}
+		at += r.n
+	}
+	s.len = n
+}
+
+// bytes returns every byte in s.
+func (s *set) bytes() *[256]bool {
+	var in [256]bool
+	for _, r := range s.spans {
+		if r.n > 0 {
+			in[r.c] = true
+		}
+	}
+	return &in
+}
+
+// homogeneous reports whether s is one byte over and over.
+func (s *set) homogeneous() bool {
+	for _, r := range s.spans {
+		if r.c != s.spans[0].c {
+			return false
+		}
+	}
+	return true
+}
+
+// printable returns c as GNU tr shows it in messages.
+func printable(c byte) string {
+	switch c {
+	case '\a':
+		return `\a`
+	case '\b':
+		return `\b`
+	case '\f':
+		return `\f`
+	case '\n':
+		return `\n`
+	case '\r':
+		return `\r`
+	case '\t':
+		return `\t`
+	case '\v':
+		return `\v`
+	case '\\':
+		return `\\`
+	}
+	if c < ' ' || c >= 0x7f {
+		return fmt.Sprintf(`\%03o`, c)
+	}
+	return string(c)
+}
+
+func printableString(s string) string {
+	var b strings.Builder
+	for i := 0; i < len(s); i++ {
+		b.WriteString(printable(s[i]))
+	}
+	return b.String()
+}
@@ -1,3 +1,296 @@
-package main
+// Package tr translates, deletes and squeezes bytes.
+//
+// SET1 and SET2 are compiled once into tables indexed by byte: what each
+// byte becomes, whether it's deleted, and whether runs of it are squeezed.
+// Input is then read in large buffers that are changed in place. With only
+// a translation, that's a table lookup for each byte; with only deletion,
+// each byte is copied down and the output advanced by whether it's kept,
+// without a branch; deleting a single byte, as in tr -d '\r', copies the
+// runs between bytes found with bytes.IndexByte.
+package tr
 
-func main() {}
+import (
+	"bytes"
+	"errors"
+	"io"
+)
+
+// Options are the flags that change what's done with the sets.
+type Options struct {
+	// Complement uses every byte not in SET1, in order, instead.
+	Complement bool
+	// Delete deletes the bytes in SET1, rather than translating them.
+	Delete bool
+	// Squeeze replaces each run of a byte in the last set given with one
+	// of it, after translating or deleting.
+	Squeeze bool
+	// Truncate cuts SET1 down to the length of SET2, instead of extending
+	// SET2 by repeating its last byte.
+	Truncate bool
+	// Warn, if not nil, is called with warnings about the sets, such as
+	// "\400" being taken as "\040" and "0".
+	Warn func(string)
+}
+
+type mode int
+
+const (
+	copyAll mode = iota
+	translate
+	deleteOne
+	deleteSome
+	squeeze
+)
+
+// Translator applies compiled sets to its input. It keeps the last byte
+// written, to squeeze runs across calls.
+type Translator struct {
+	mode   mode
+	xlate  [256]byte
+	keep   [256]byte // 0 or 1
+	sq     [256]bool
+	delete byte // for deleteOne
+	last   int  // the last byte written, or -1
+}
+
+// Compile compiles sets, which are SET1 and, if given, SET2, as tr takes
+// them. It doesn't check that the right number are given for opts.
+func Compile(opts Options, sets ...string) (*Translator, error) {
+	warn := opts.Warn
+	if warn == nil {
+		warn = func(string) {}
+	}
+	if len(sets) == 0 || len(sets) > 2 {
+		return nil, errors.New("one or two sets must be given")
+	}
+	s1, err := parseSet(sets[0], warn)
+	if err != nil {
+		return nil, err
+	}
+	var s2 *set
+	if len(sets) == 2 {
+		if s2, err = parseSet(sets[1], warn); err != nil {
+			return nil, err
+		}
+	}
+	if s1.fills > 0 {
+		return nil, errors.New("the [c*] repeat construct may not appear in string1")
+	}
+	if opts.Complement {
+		s1 = s1.complement()
+	}
+
+	translating := s2 != nil && !opts.Delete
+	if s2 != nil {
+		switch {
+		case s2.fills > 1:
+			return nil, errors.New("only one [c*] repeat construct may appear in string2")
+		case translating && s2.equiv:
+			return nil, errors.New("[=c=] expressions may not appear in string2 when translating")
+		case translating && s2.other:
+			return nil, errors.New("when translating, the only character classes that may appear in string2 are 'upper' and 'lower'")
+		case !translating && s2.fills > 0:
+			return nil, errors.New("the [c*] construct may appear in string2 only when translating")
+		}
+		s2.fillTo(s1.len)
+	}
+
+	t := &Translator{last: -1}
+	for i := range t.xlate {
+		t.xlate[i] = byte(i)
+		t.keep[i] = 1
+	}
+
+	if translating {
+		if !opts.Complement && !aligned(s1, s2) {
+			return nil, errors.New("misaligned [:upper:] and/or [:lower:] construct")
+		}
+		if s1.len > s2.len && !opts.Truncate {
+			if s2.len == 0 {
+				return nil, errors.New("when not truncating set1, string2 must be non-empty")
+			}
+			s2.add(s2.spans[len(s2.spans)-1].c, s1.len-s2.len)
+		}
+		if opts.Complement && s1.class && (s2.len != s1.len || !s2.homogeneous()) {
+			return nil, errors.New("when translating with complemented character classes,\nstring2 must map all characters in the domain to one")
+		}
+		s1.truncate(s2.len)
+		// Walk both sets a span at a time: over any stretch where both
+		// stay the same, the byte from SET1 becomes the one from SET2.
+		r1, r2 := s1.spans, s2.spans
+		var n1, n2 uint64
+		for len(r1) > 0 && len(r2) > 0 {
+			if n1 == 0 {
+				n1 = r1[0].n
+			}
+			if n2 == 0 {
+				n2 = r2[0].n
+			}
+			n := n1
+			if n2 < n {
+				n = n2
+			}
+			if n > 0 {
+				t.xlate[r1[0].c] = r2[0].c
+			}
+			if n1 -= n; n1 == 0 {
+				r1 = r1[1:]
+			}
+			if n2 -= n; n2 == 0 {
+				r2 = r2[1:]
+			}
+		}
+	} else if opts.Delete {
+		for c, in := range s1.bytes() {
+			if in {
+				t.keep[c] = 0
+			}
+		}
+	}
+
+	if opts.Squeeze {
+		sq := s1
+		if s2 != nil {
+			sq = s2
+		}
+		t.sq = *sq.bytes()
+	}
+
+	t.mode = copyAll
+	deleted := 0
+	for c := range t.keep {
+		if t.keep[c] == 0 {
+			deleted++
+			t.delete = byte(c)
+		}
+		if t.xlate[c] != byte(c) {
+			t.mode = translate
+		}
+	}
+	switch {
+	case opts.Squeeze && t.sq != [256]bool{}:
+		t.mode = squeeze
+	case deleted == 1:
+		t.mode = deleteOne
+	case deleted > 1:
+		t.mode = deleteSome
+	}
+	return t, nil
+}
+
+// aligned reports whether each [:upper:] or [:lower:] in s2 is lined up
+// with one in s1, as it has to be for one to be translated to the other.
+// That's only checked up to where s1 ends.
+func aligned(s1, s2 *set) bool {
+	for _, at := range s2.cases {
+		if at > s1.len {
+			break
+		}
+		found := false
+		for _, at1 := range s1.cases {
+			found = found || at1 == at
+		}
+		if !found {
+			return false
+		}
+	}
+	return true
+}
+
+// bufSize is the size of the buffer input is read into.
+const bufSize = 128 * 1024
+
+// Translate writes r to w, translated.
+func (t *Translator) Translate(w io.Writer, r io.Reader) error {
+	buf := make([]byte, bufSize)
+	for {
+		n, err := r.Read(buf)
+		if n > 0 {
+			if _, werr := w.Write(t.Apply(buf[:n])); werr != nil {
+				return werr
+			}
+		}
+		if err == io.EOF {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+	}
+}
+
+// Apply translates p in place, and returns what's left of it.
+func (t *Translator) Apply(p []byte) []byte {
+	switch t.mode {
+	case translate:
+		t.translate(p)
+	case deleteOne:
+		p = t.deleteOne(p)
+	case deleteSome:
+		p = t.deleteSome(p)
+	case squeeze:
+		p = t.squeeze(p)
+	}
+	return p
+}
+
+func (t *Translator) translate(p []byte) {
+	x := &t.xlate
+	for len(p) >= 8 {
+		p[0], p[1], p[2], p[3] = x[p[0]], x[p[1]], x[p[2]], x[p[3]]
+		p[4], p[5], p[6], p[7] = x[p[4]], x[p[5]], x[p[6]], x[p[7]]
+		p = p[8:]
+	}
+	for i, c := range p {
+		p[i] = x[c]
+	}
+}
+
+func (t *Translator) deleteOne(p []byte) []byte {
+	i := bytes.IndexByte(p, t.delete)
+	if i < 0 {
+		return p
+	}
+	j := i
+	for i++; i < len(p); {
+		k := bytes.IndexByte(p[i:], t.delete)
+		if k < 0 {
+			k = len(p) - i
+		}
+		j += copy(p[j:], p[i:i+k])
+		i += k + 1
+	}
+	return p[:j]
+}
+
+func (t *Translator) deleteSome(p []byte) []byte {
+	keep := &t.keep
+	j := 0
+	for _, c := range p {
+		p[j] = c
+		j += int(keep[c])
+	}
+	return p[:j]
+}
+
+// squeeze deletes, translates, and squeezes, in that order. Like
+// deleteSome, it writes every byte and only advances past those kept.
+func (t *Translator) squeeze(p []byte) []byte {
+	keep, x, sq := &t.keep, &t.xlate, &t.sq
+	last := t.last
+	j := 0
+	for _, c := range p {
+		k := int(keep[c])
+		c = x[c]
+		if int(c) == last && sq[c] {
+			k = 0
+		}
+		p[j] = c
+		j += k
+		if k != 0 {
+			last = int(c)
+		}
+	}
+	t.last = last
+	return p[:j]
+}
@@ -0,0 +1,112 @@
+package tr
+
+import (
+	"io/ioutil"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+func TestRun(t *testing.T) {
+	const in = "Hello [World] -123- aa\\\r\n\tzzz  \n"
+	for _, tc := range []struct {
+		args []string
+		want string
+	}{
+		{[]string{"a-z", "A-Z"}, "HELLO [WORLD] -123- AA\\\r\n\tZZZ  \n"},
+		{[]string{"[:lower:]", "[:upper:]"}, "HELLO [WORLD] -123- AA\\\r\n\tZZZ  \n"},
+		{[]string{"xyz[:upper:]", "XYZ[:lower:]"}, "hello [world] -123- aa\\\r\n\tZZZ  \n"},
+		{[]string{"-d", `\r`}, "Hello [World] -123- aa\\\n\tzzz  \n"},
+		{[]string{"-d", "a-z"}, "H [W] -123- \\\r\n\t  \n"},
+		{[]string{"-cd", "[:alpha:]"}, "HelloWorldaazzz"},
+		{[]string{"-s", "z "}, "Hello [World] -123- aa\\\r\n\tz \n"},
+		{[]string{"-s", "a-z", "A-Z"}, "HELO [WORLD] -123- A\\\r\n\tZ  \n"},
+		{[]string{"-ds", "H", "l"}, "elo [World] -123- aa\\\r\n\tzzz  \n"},
+		{[]string{"-c", "a-z\n", "[x*]y"}, "xelloxxxorldxxxxxxxxaaxx\nxzzzxx\n"},
+		{[]string{"-t", "abcdefl", "xy"}, "Hello [World] -123- xx\\\r\n\tzzz  \n"},
+		{[]string{"l", "[x*010]"}, "Hexxo [Worxd] -123- aa\\\r\n\tzzz  \n"},
+		{[]string{"[:digit:][:digit:]", "ab"}, "Hello [World] -bbb- aa\\\r\n\tzzz  \n"},
+		{[]string{"[]*2]", "x"}, "Hello [Worldx -123- aa\\\r\n\tzzz  \n"},
+		{[]string{"[:]", "x"}, "Hello xWorldx -123- aa\\\r\n\tzzz  \n"},
+		{[]string{"--", "-a", "xy"}, "Hello [World] x123x yy\\\r\n\tzzz  \n"},
+		{[]string{`\\\055`, "xy"}, "Hello [World] y123y aax\r\n\tzzz  \n"},
+		{[]string{"[a*1000000000000]z", "xy"}, "Hello [World] -123- yy\\\r\n\tyyy  \n"},
+		{[]string{"a", "a"}, in},
+	} {
+		got, stderr, err := cmdtest.Run(run, in, tc.args...)
+		if err != nil || got != tc.want {
+			t.Errorf("%q: got %q, %v (%q), want %q", tc.args, got, err, stderr, tc.want)
+		}
+	}
+
+	for _, tc := range []struct {
+		args []string
+		err  string
+	}{
+		{nil, "missing operand"},
+		{[]string{"a"}, "missing operand after 'a'"},
+		{[]string{"-d", "a", "b"}, "extra operand 'b'"},
+		{[]string{"-d", "a", "-s"}, "extra operand '-s'"},
+		{[]string{"z-a", "x"}, "range-endpoints of 'z-a' are in reverse collating sequence order"},
+		{[]string{`\200-\1`, "x"}, `range-endpoints of '\200-\001' are`},
+		{[]string{"[:foo:]", "x"}, "invalid character class 'foo'"},
+		{[]string{"[::]", "x"}, "missing character class name"},
+		{[]string{"[=ab=]", "x"}, "equivalence class operand must be a single character"},
+		{[]string{"a", "[=b=]"}, "[=c=] expressions may not appear in string2"},
+		{[]string{"a", "[:digit:]"}, "the only character classes"},
+		{[]string{"a-z", "[:upper:]"}, "misaligned"},
+		{[]string{"[:lower:]", "[:upper:][:upper:]"}, "misaligned"},
+		{[]string{"[a*]", "x"}, "may not appear in string1"},
+		{[]string{"a", "[b*]c[d*]"}, "only one [c*]"},
+		{[]string{"-ds", "a", "[b*]"}, "only when translating"},
+		{[]string{"l", "[x*08]"}, "invalid repeat count '08'"},
+		{[]string{"lo", ""}, "string2 must be non-empty"},
+		{[]string{"-c", "[:lower:]", "xy"}, "complemented character classes"},
+		{[]string{"-ct", "[:lower:]", "x"}, "complemented character classes"},
+	} {
+		_, stderr, err := cmdtest.Run(run, in, tc.args...)
+		if err == nil || !strings.Contains(stderr, tc.err) {
+			t.Errorf("%q: got %q, %v, want %q", tc.args, stderr, err, tc.err)
+		}
+	}
+
+	_, stderr, err := cmdtest.Run(run, "", `\400`, "x")
+	if err != nil || !strings.Contains(stderr, `interpreted as the 2-byte sequence \040, 0`) {
+		t.Errorf("got %q, %v", stderr, err)
+	}
+}
+
+// TestApply checks that runs are squeezed across calls.
+func TestApply(t *testing.T) {
+	tr, err := Compile(Options{Squeeze: true}, "a")
+	if err != nil {
+		t.Fatal(err)
+	}
+	var got []byte
+	for _, s := range []string{"aa", "ab", "", "aaa", "a"} {
+		got = append(got, tr.Apply([]byte(s))...)
+	}
+	if string(got) != "aba" {
+		t.Fatalf("got %q", got)
+	}
+}
+
+func benchmarkTr(b *testing.B, opts Options, sets ...string) {
+	tr, err := Compile(opts, sets...)
+	if err != nil {
+		b.Fatal(err)
+	}
+	in := []byte(strings.Repeat("The quick brown fox jumps over the lazy dog.\r\n", 1<<14))
+	buf := make([]byte, len(in))
+	b.SetBytes(int64(len(in)))
+	for i := 0; i < b.N; i++ {
+		copy(buf, in)
+		ioutil.Discard.Write(tr.Apply(buf))
+	}
+}
+
+func BenchmarkTranslate(b *testing.B)  { benchmarkTr(b, Options{}, "a-z", "A-Z") }
+func BenchmarkDeleteOne(b *testing.B)  { benchmarkTr(b, Options{Delete: true}, `\r`) }
+func BenchmarkDeleteSome(b *testing.B) { benchmarkTr(b, Options{Delete: true}, "aeiou") }
+func BenchmarkSqueeze(b *testing.B)    { benchmarkTr(b, Options{Squeeze: true}, " ") }
@@ -1,8 +1,9 @@
-package main
+package true
 
 import (
 	"fmt"
-	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
 )
 
 const (
@@ -25,14 +26,19 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-func main() {
-	if len(os.Args) == 2 {
-		if os.Args[1] == "--help" {
-			fmt.Printf("%s", Help)
+func init() {
+	coreutils.Register("true", run)
+}
+
+func run(ctx coreutils.Context, args ...string) error {
+	if len(args) == 1 {
+		if args[0] == "--help" {
+			fmt.Fprintf(ctx.Stdout, "%s", Help)
 		}
 
-		if os.Args[1] == "--version" {
-			fmt.Printf("%s", Version)
+		if args[0] == "--version" {
+			fmt.Fprintf(ctx.Stdout, "%s", Version)
 		}
 	}
+	return nil
 }
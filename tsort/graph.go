@@ -0,0 +1,191 @@
+package tsort
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"sort"
+)
+
+// none is the nil ID.
+const none = -1
+
+// graph is the partial ordering read from the input. Every token is interned
+// to a dense ID, in the order it was first seen, and the relations are kept
+// in flat arrays indexed by ID, so sorting never chases a pointer.
+type graph struct {
+	ids   map[string]int32
+	names []string // their text is in arena
+	arena arena
+
+	// Relations as read, until build turns them into rows.
+	from, to []int32
+
+	// After build, the successors of node i are succ[off[i]:off[i+1]], in
+	// the reverse of the order their relations were read. Relations
+	// removed to break a loop are set to none.
+	off   []int32
+	succ  []int32
+	count []int32 // predecessors not yet output
+
+	// order holds every ID, sorted by name. Nodes with no predecessors
+	// are output, and loops looked for, in this order.
+	order []int32
+}
+
+func newGraph() *graph {
+	return &graph{ids: make(map[string]int32)}
+}
+
+// intern returns the ID of the token b. Only tokens seen for the first time
+// are copied.
+func (g *graph) intern(b []byte) int32 {
+	if id, ok := g.ids[string(b)]; ok {
+		return id
+	}
+	s := g.arena.copy(b)
+	id := int32(len(g.names))
+	g.ids[s] = id
+	g.names = append(g.names, s)
+	return id
+}
+
+// relate records that j comes before k.
+func (g *graph) relate(j, k int32) {
+	if j != k {
+		g.from = append(g.from, j)
+		g.to = append(g.to, k)
+	}
+}
+
+// build lays out the relations read so far as rows of successors.
+func (g *graph) build() {
+	n := len(g.names)
+	g.off = make([]int32, n+1)
+	g.count = make([]int32, n)
+	for i, j := range g.from {
+		g.off[j+1]++
+		g.count[g.to[i]]++
+	}
+	for i := 0; i < n; i++ {
+		g.off[i+1] += g.off[i]
+	}
+
+	// Rows are filled from the back, so the latest relation comes first.
+	g.succ = make([]int32, len(g.to))
+	next := make([]int32, n)
+	copy(next, g.off[1:])
+	for i, j := range g.from {
+		next[j]--
+		g.succ[next[j]] = g.to[i]
+	}
+	g.from, g.to = nil, nil
+
+	g.order = make([]int32, n)
+	for i := range g.order {
+		g.order[i] = int32(i)
+	}
+	sort.Slice(g.order, func(a, b int) bool {
+		return g.names[g.order[a]] < g.names[g.order[b]]
+	})
+}
+
+// sort writes the nodes to w in an order consistent with the relations. Each
+// time it finds a loop it reports it to stderr, breaks it and carries on. It
+// returns 1 if there were any loops, otherwise 0.
+func (g *graph) sort(w, stderr io.Writer) int {
+	g.build()
+
+	bw := bufio.NewWriter(w)
+	n := len(g.names)
+	done := make([]bool, n)
+	queue := make([]int32, 0, n)
+	left := n
+	status := 0
+
+	for left > 0 {
+		// Kahn's algorithm, seeded with the nodes that have no
+		// predecessors left.
+		queue = queue[:0]
+		for _, k := range g.order {
+			if g.count[k] == 0 && !done[k] {
+				queue = append(queue, k)
+			}
+		}
+		for len(queue) > 0 {
+			k := queue[0]
+			queue = queue[1:]
+
+			bw.WriteString(g.names[k])
+			bw.WriteByte('\n')
+			done[k] = true
+			left--
+
+			for _, s := range g.succ[g.off[k]:g.off[k+1]] {
+				if s == none {
+					continue
+				}
+				if g.count[s]--; g.count[s] == 0 {
+					queue = append(queue, s)
+				}
+			}
+		}
+
+		if left > 0 {
+			bw.Flush()
+			fmt.Fprintln(stderr, "tsort: input contains a loop:")
+			status = 1
+			g.breakLoop(stderr)
+		}
+	}
+	bw.Flush()
+	return status
+}
+
+// breakLoop finds a loop among the nodes still waiting on predecessors,
+// reports it, and removes one of its relations.
+//
+// It looks for it the way GNU tsort does, so the same loop is reported, in
+// the same order: the nodes are visited by name, over and over, building a
+// chain back from the first one with predecessors left. A node whose relation
+// points at the head of the chain is added to it, until one that is already
+// in the chain is found.
+func (g *graph) breakLoop(stderr io.Writer) {
+	qlink := make([]int32, len(g.names))
+	for i := range qlink {
+		qlink[i] = none
+	}
+	loop := int32(none)
+
+	for {
+		for _, k := range g.order {
+			if g.count[k] <= 0 {
+				continue
+			}
+			if loop == none {
+				loop = k
+				continue
+			}
+			row := g.succ[g.off[k]:g.off[k+1]]
+			for i, s := range row {
+				if s != loop {
+					continue
+				}
+				if qlink[k] == none {
+					qlink[k] = loop
+					loop = k
+					break
+				}
+
+				for loop != k {
+					fmt.Fprintf(stderr, "tsort: %s\n", g.names[loop])
+					loop = qlink[loop]
+				}
+				fmt.Fprintf(stderr, "tsort: %s\n", g.names[k])
+				g.count[s]--
+				row[i] = none
+				return
+			}
+		}
+	}
+}
@@ -0,0 +1,143 @@
+package tsort
+
+import (
+	"io"
+	"os"
+	"unicode"
+	"unicode/utf8"
+	"unsafe"
+
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+// readBufSize is the size of the buffer used for input that isn't a file.
+const readBufSize = 256 * 1024
+
+// arenaBlockSize is the size of the blocks the arena copies tokens into.
+const arenaBlockSize = 1 << 20
+
+// isSpace is the set of ASCII bytes unicode.IsSpace reports as space.
+var isSpace = [utf8.RuneSelf]bool{
+	'\t': true, '\n': true, '\v': true, '\f': true, '\r': true, ' ': true,
+}
+
+// arena holds the text of every distinct token. Tokens are copied into large
+// blocks that are never modified or freed, so a token costs one copy and no
+// allocation of its own.
+type arena struct {
+	block []byte
+}
+
+// copy returns a string holding a copy of b.
+func (a *arena) copy(b []byte) string {
+	if len(b) == 0 {
+		return ""
+	}
+	if cap(a.block)-len(a.block) < len(b) {
+		n := arenaBlockSize
+		if len(b) > n {
+			n = len(b)
+		}
+		a.block = make([]byte, 0, n)
+	}
+	start := len(a.block)
+	a.block = append(a.block, b...)
+	p := a.block[start:len(a.block):len(a.block)]
+	return *(*string)(unsafe.Pointer(&p))
+}
+
+// words calls fn with each whitespace-separated token read from r, splitting
+// them exactly like bufio.ScanWords but without its limit on token length.
+// Tokens are handed to fn straight from the read buffer or, for files, from
+// a mapping of the file, and are only valid until fn returns.
+func words(r io.Reader, fn func([]byte)) error {
+	if f, ok := r.(*os.File); ok {
+		mr := mmap.NewReader(f)
+		defer mr.Close()
+		return mmap.Guard(f, func() error { return scan(mr.Next, fn) })
+	}
+	buf := make([]byte, readBufSize)
+	return scan(func() ([]byte, error) {
+		n, err := r.Read(buf)
+		if n > 0 {
+			err = nil
+		}
+		return buf[:n], err
+	}, fn)
+}
+
+// scan is words, for the chunks next returns.
+func scan(next func() ([]byte, error), fn func([]byte)) error {
+	// carry holds a token, or the start of a rune, cut off by the end of a
+	// chunk.
+	var carry []byte
+	for {
+		p, err := next()
+		if err == io.EOF {
+			break
+		}
+		if err != nil {
+			return err
+		}
+		if len(carry) > 0 {
+			// Move everything up to the first ASCII space over to carry.
+			// No rune runs across one, so carry can be split on its own.
+			i := 0
+			for i < len(p) && (p[i] >= utf8.RuneSelf || !isSpace[p[i]]) {
+				i++
+			}
+			if i == len(p) {
+				carry = append(carry, p...)
+				continue
+			}
+			carry = append(carry, p[:i+1]...)
+			split(carry, true, fn)
+			carry = carry[:0]
+			p = p[i+1:]
+		}
+		carry = append(carry, split(p, false, fn)...)
+	}
+	split(carry, true, fn)
+	return nil
+}
+
+// split calls fn with each token in p and returns what's left of p after the
+// last complete one. If atEOF is set, the end of p ends a token.
+func split(p []byte, atEOF bool, fn func([]byte)) []byte {
+	start := -1 // of the current token
+	for i := 0; i < len(p); {
+		c := p[i]
+		size := 1
+		space := false
+		if c < utf8.RuneSelf {
+			space = isSpace[c]
+		} else {
+			if !atEOF && !utf8.FullRune(p[i:]) {
+				if start < 0 {
+					start = i
+				}
+				return p[start:]
+			}
+			var r rune
+			r, size = utf8.DecodeRune(p[i:])
+			space = unicode.IsSpace(r)
+		}
+		if space {
+			if start >= 0 {
+				fn(p[start:i])
+				start = -1
+			}
+		} else if start < 0 {
+			start = i
+		}
+		i += size
+	}
+	if start < 0 {
+		return nil
+	}
+	if atEOF {
+		fn(p[start:])
+		return nil
+	}
+	return p[start:]
+}
@@ -17,21 +17,23 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-package main
+package tsort
 
 import (
-	"bufio"
+	"errors"
 	"fmt"
 	"io"
-	"log"
 	"os"
-	"strings"
 
-	"golang.org/x/sys/unix"
-
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/sys"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("tsort", run)
+}
+
 const (
 	Help = `Usage: tsort [OPTION] [FILE]
 Write totally ordered list consistent with the partial ordering in FILE.
@@ -51,390 +53,78 @@ There is NO WARRANTY, to the extent permitted by law.
 `
 )
 
-var (
-	version = flag.BoolP("version", "v", false, "")
-
-	fatal = log.New(os.Stderr, "", 0)
-)
-
-type successor struct {
-	suc  *item
-	next *successor
-}
-
-type item struct {
-	str     string
-	left    *item
-	right   *item
-	balance int // -1, 0, or +1
-	count   int64
-	qlink   *item
-	top     *successor
-}
-
-type action func(*item) bool
-
-var (
-	head  *item // Head of list
-	zeros *item // Tail of the list of 'zeros' (no predecessors)
-	loop  *item // Used for loop detection
-
-	numStrings int64 // Strings to sort
-)
-
-func newItem(str string) *item { return &item{str: str} }
-
-// Search binary tree for STR. If ROOT is nil, create a new tree.
-func (root *item) searchItem(str string) *item {
-	var (
-		p = new(item)
-		q = new(item)
-		r = new(item)
-		s = new(item)
-		t = new(item)
-	)
-
-	if root.right == nil {
-		root.right = newItem(str)
-		return root.right
-	}
-
-	t = root
-	p = root.right
-	s = p
-
-	for {
-		a := strings.Compare(str, p.str)
-		if a == 0 {
-			return p
-		}
-
-		if a < 0 {
-			q = p.left
-		} else {
-			q = p.right
-		}
-
-		if q == nil {
-			q = newItem(str)
-
-			if a < 0 {
-				p.left = q
-			} else {
-				p.right = q
-			}
-
-			if strings.Compare(str, s.str) < 0 {
-				p = s.left
-				r = p
-				a = -1
-			} else {
-				p = s.right
-				r = p
-				a = 1
-			}
+// tsort writes the tokens read from r to w, sorted, and reports loops to
+// stderr. The status is 1 if there were any.
+func tsort(r io.Reader, w, stderr io.Writer) (int, error) {
+	g := newGraph()
 
-			for p != q {
-				if strings.Compare(str, p.str) < 0 {
-					p.balance = -1
-					p = p.left
-				} else {
-					p.balance = 1
-					p = p.right
-				}
-			}
-
-			if s.balance == 0 || s.balance == -a {
-				s.balance += a
-				return q
-			}
-
-			if r.balance == a {
-
-				p = r
-				if a < 0 {
-					s.left = r.right
-					r.right = s
-				} else {
-					s.right = r.left
-					r.left = s
-				}
-				r.balance = 0
-				s.balance = r.balance
-			} else {
-				if a < 0 {
-					p = r.right
-					r.right = p.left
-					p.left = r
-					s.left = p.right
-					p.right = s
-				} else {
-					p = r.left
-					r.left = p.right
-					p.right = r
-					s.right = p.left
-					p.left = s
-				}
-
-				s.balance = 0
-				r.balance = 0
-
-				if p.balance == a {
-					s.balance = -a
-				} else if p.balance == -a {
-					r.balance = a
-				}
-
-				p.balance = 0
-			}
-
-			if s == t.right {
-				t.right = p
-			} else {
-				t.left = p
-			}
-
-			return q
-
-		}
-
-		if q.balance > 0 {
-			t = p
-			s = q
-		}
-
-		p = q
+	if file, ok := r.(*os.File); ok {
+		sys.Fadvise(int(file.Fd()))
 	}
-}
 
-func recordRelation(j, k *item) {
-	if j.str != k.str {
-		k.count++
-		p := &successor{
-			suc:  k,
-			next: j.top,
+	j := int32(none)
+	err := words(r, func(tok []byte) {
+		k := g.intern(tok)
+		if j == none {
+			j = k
+			return
 		}
-		j.top = p
+		g.relate(j, k)
+		j = none
+	})
+	if err != nil {
+		return 1, err
 	}
-}
-
-func countItems(_ *item) bool {
-	numStrings++
-	return false
-}
 
-func scanZeros(k *item) bool {
-	if k.count == 0 && k.str != "" {
-		if head == nil {
-			head = k
-		} else {
-			zeros.qlink = k
-		}
-
-		zeros = k
+	if j != none {
+		return 1, errors.New("input contains an odd number of tokens")
 	}
 
-	return false
+	return g.sort(w, stderr), nil
 }
 
-// Try and detect loops. e.g.,
-// 1 2
-// 2 1
-// If any are found, print to stderr.
-func detectLoop(k *item) bool {
-	if k.count > 0 {
-		if loop == nil {
-			loop = k
-		} else {
-			p := &k.top
-
-			for *p != nil {
-				if (*p).suc == loop {
-					if k.qlink != nil {
-
-						for loop != nil {
-							tmp := loop.qlink
-
-							fatal.Printf("tsort: %s", loop.str)
-
-							if loop == k {
-								(*p).suc.count--
-								*p = (*p).next
-								break
-							}
-
-							loop.qlink = nil
-							loop = tmp
-						}
-
-						for loop != nil {
-							tmp := loop.qlink
-
-							loop.qlink = nil
-							loop = tmp
-						}
-
-						return true
-					}
-
-					k.qlink = loop
-					loop = k
-					break
-				}
-				p = &(*p).next
-			}
-		}
-	}
-
-	return false
-}
-
-// Recurse the tree at ROOT, calling ACTION for each node
-func (root *item) recurseTree(fn action) bool {
-	if root.left == nil && root.right == nil {
-		return fn(root)
-	}
-
-	if root.left != nil {
-		if root.left.recurseTree(fn) {
-			return true
-		}
-	}
-
-	if fn(root) {
-		return true
-	}
-
-	if root.right != nil {
-		if root.right.recurseTree(fn) {
-			return true
-		}
-	}
-
-	return false
-}
-
-// Walk the tree at ROOT, calling ACTION for each node
-func (root *item) walkTree(fn action) {
-	if root.right != nil {
-		root.right.recurseTree(fn)
-	}
-}
-
-func tsort(rw io.ReadWriter) int {
-
+func run(ctx coreutils.Context, args ...string) (err error) {
 	var (
-		root = newItem("")
-
-		j *item
-		k *item
-
-		ok int
+		f       flag.FlagSet
+		version bool
 	)
-
-	scanner := bufio.NewScanner(rw)
-	scanner.Split(bufio.ScanWords)
-
-	// https://talks.golang.org/2015/tricks.slide#16
-	if file, ok := rw.(interface {
-		Fd() uintptr
-	}); ok {
-		unix.Fadvise(int(file.Fd()), 0, 0, unix.FADV_SEQUENTIAL)
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
 
-	for scanner.Scan() {
-		k = root.searchItem(scanner.Text())
-
-		if j != nil {
-			recordRelation(j, k)
-			k = nil
+	defer func() {
+		if _, ok := err.(coreutils.ExitCode); err != nil && !ok {
+			fmt.Fprintf(ctx.Stderr, "tsort: %v\n", err)
 		}
+	}()
 
-		j = k
+	if version {
+		fmt.Fprintf(ctx.Stdout, "%s\n", Version)
+		return nil
 	}
 
-	if k != nil {
-		fatal.Fatalln("input contains an odd number of tokens")
+	if f.NArg() > 1 {
+		return fmt.Errorf("extra operand %s", f.Arg(1))
 	}
 
-	root.walkTree(countItems)
-
-	for numStrings > 0 {
-
-		root.walkTree(scanZeros)
-
-		for head != nil {
-			p := head.top
-
-			fmt.Fprintln(rw, head.str)
-
-			head.str = ""
-			numStrings--
-
-			for p != nil {
-				p.suc.count--
-				if p.suc.count == 0 {
-					zeros.qlink = p.suc
-					zeros = p.suc
-				}
-
-				p = p.next
-			}
-
-			head = head.qlink
-		}
-
-		if numStrings > 0 {
-			fatal.Print("tsort: input contains a loop:")
-			ok = 1
-
-			for {
-				root.walkTree(detectLoop)
-
-				if loop == nil {
-					break
-				}
-			}
-		}
-	}
-
-	return ok
-}
-
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(1)
-	}
-	flag.Parse()
-
-	if *version {
-		fmt.Printf("%s\n", Version)
-		os.Exit(0)
-	}
-
-	if flag.NArg() > 1 {
-		fatal.Fatalf("extra operand %s", flag.Arg(1))
-	}
-
-	file := os.Stdin
-	if (flag.Arg(0) != "-" &&
-		flag.Arg(0) != "") ||
-		flag.NArg() != 0 {
-
-		var err error
-		file, err = os.Open(flag.Arg(0))
+	r := ctx.Stdin
+	if f.NArg() == 1 && f.Arg(0) != "-" {
+		file, err := os.Open(f.Arg(0))
 		if err != nil {
-			fatal.Fatalln(err)
+			return err
 		}
 		defer file.Close()
+		r = file
 	}
 
-	os.Exit(tsort(struct {
-		io.Reader
-		io.Writer
-	}{
-		file,
-		os.Stdout,
-	}))
+	status, err := tsort(r, ctx.Stdout, ctx.Stderr)
+	if err != nil {
+		return err
+	}
+	if status != 0 {
+		return coreutils.ExitCode(status)
+	}
+	return nil
 }
@@ -1,8 +1,17 @@
-package main
+package tsort
 
 import (
+	"bufio"
 	"bytes"
+	"fmt"
+	"io"
+	"io/ioutil"
+	"reflect"
+	"strings"
 	"testing"
+	"testing/iotest"
+
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
 )
 
 var (
@@ -58,10 +67,87 @@ func TestTsort(t *testing.T) {
 
 		buf.WriteString(unsorted)
 
-		tsort(&buf)
+		tsort(&buf, &buf, &buf)
 
 		if buf.String() != sorted {
 			t.Errorf("Got: %q\n\nWanted: %q", buf.String(), sorted)
 		}
 	}
 }
+
+func TestTsortLoop(t *testing.T) {
+	var stderr bytes.Buffer
+
+	var buf bytes.Buffer
+	buf.WriteString("1 2\n2 3\n3 1\n3 4\n4 5\n5 4\na b\n")
+	if status, _ := tsort(&buf, &buf, &stderr); status != 1 {
+		t.Error("loop wasn't reported")
+	}
+	if want := "a\nb\n1\n2\n3\n4\n5\n"; buf.String() != want {
+		t.Errorf("Got: %q\n\nWanted: %q", buf.String(), want)
+	}
+	const want = `tsort: input contains a loop:
+tsort: 1
+tsort: 2
+tsort: 3
+tsort: input contains a loop:
+tsort: 4
+tsort: 5
+`
+	if stderr.String() != want {
+		t.Errorf("Got: %q\n\nWanted: %q", stderr.String(), want)
+	}
+}
+
+func TestWords(t *testing.T) {
+	const text = "  a bb\tccc\n dd e　\xff\xfe f\xe3\x80 " +
+		"日本 g\u0085\r\nlast"
+	in := text + " " + strings.Repeat("x", 70000) + "\n"
+
+	var want []string
+	sc := bufio.NewScanner(strings.NewReader(text))
+	sc.Split(bufio.ScanWords)
+	for sc.Scan() {
+		want = append(want, sc.Text())
+	}
+	want = append(want, strings.Repeat("x", 70000))
+
+	for name, r := range map[string]func() io.Reader{
+		"whole":  func() io.Reader { return strings.NewReader(in) },
+		"bytes":  func() io.Reader { return iotest.OneByteReader(strings.NewReader(in)) },
+		"halves": func() io.Reader { return iotest.HalfReader(strings.NewReader(in)) },
+	} {
+		var got []string
+		if err := words(r(), func(b []byte) { got = append(got, string(b)) }); err != nil {
+			t.Fatal(err)
+		}
+		if !reflect.DeepEqual(got, want) {
+			t.Errorf("%s: got %q, want %q", name, got, want)
+		}
+	}
+}
+
+func BenchmarkTsort(b *testing.B) {
+	var in bytes.Buffer
+	for i := 0; i < 100000; i++ {
+		fmt.Fprintf(&in, "node%d node%d\n", i/2, i+1)
+	}
+	b.SetBytes(int64(in.Len()))
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		tsort(bytes.NewReader(in.Bytes()), ioutil.Discard, ioutil.Discard)
+	}
+}
+
+// BenchmarkTsortGraph sorts the generated graph bench.bash gives GNU tsort,
+// whose nodes each have one or two that come before them.
+func BenchmarkTsortGraph(b *testing.B) {
+	in := benchdata.Graph(200000)
+	b.SetBytes(int64(len(in)))
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		if status, err := tsort(bytes.NewReader(in), ioutil.Discard, ioutil.Discard); status != 0 || err != nil {
+			b.Fatal(status, err)
+		}
+	}
+}
@@ -0,0 +1,167 @@
+package uniq
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"os"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
+
+func init() {
+	coreutils.Register("uniq", run)
+}
+
+// Sentinal flags for flags with single-character options and without
+// multi-character options. (e.g., if we want -D but not --D.)
+const (
+	uniNonChar = 0xFDD0
+	bad1       = string(rune(uniNonChar + 1))
+)
+
+func newCommand() *cmd {
+	var c cmd
+	c.f.BoolVarP(&c.count, "count", "c", false, "prefix lines by the number of occurrences")
+	c.f.BoolVarP(&c.repeated, "repeated", "d", false, "only print duplicate lines, one for each group")
+	c.f.BoolVarP(&c.allRepeated, bad1, "D", false, "print all duplicate lines")
+	c.f.StringVar(&c.allMethod, "all-repeated", "", `like -D, but allow separating groups with an
+                             empty line; METHOD={none(default),prepend,separate}`)
+	c.f.Lookup("all-repeated").NoOptDefVal = "none"
+	c.f.IntVarP(&c.skipFields, "skip-fields", "f", 0, "avoid comparing the first N fields")
+	c.f.StringVar(&c.group, "group", "", `show all items, separating groups with an empty line;
+                             METHOD={separate(default),prepend,append,both}`)
+	c.f.Lookup("group").NoOptDefVal = "separate"
+	c.f.BoolVarP(&c.ignoreCase, "ignore-case", "i", false, "ignore differences in case when comparing")
+	c.f.IntVarP(&c.skipChars, "skip-chars", "s", 0, "avoid comparing the first N characters")
+	c.f.BoolVarP(&c.unique, "unique", "u", false, "only print unique lines")
+	c.f.BoolVarP(&c.zero, "zero-terminated", "z", false, "line delimiter is NUL, not newline")
+	c.f.IntVarP(&c.checkChars, "check-chars", "w", -1, "compare no more than N characters in lines")
+	c.f.BoolVar(&c.version, "version", false, "output version information and exit")
+	return &c
+}
+
+type cmd struct {
+	f           flag.FlagSet
+	count       bool
+	repeated    bool
+	allRepeated bool
+	allMethod   string
+	skipFields  int
+	group       string
+	ignoreCase  bool
+	skipChars   int
+	unique      bool
+	zero        bool
+	checkChars  int
+	version     bool
+}
+
+func run(ctx coreutils.Context, args ...string) (err error) {
+	c := newCommand()
+	if err := c.f.Parse(args); err != nil {
+		return err
+	}
+
+	if c.version {
+		fmt.Fprintf(ctx.Stdout, "uniq (go-coreutils) 1.0")
+		return nil
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "uniq: %v\n", err)
+		}
+	}()
+
+	f := NewFilter()
+	f.Count = c.count
+	f.Repeated = c.repeated
+	f.Unique = c.unique
+	f.IgnoreCase = c.ignoreCase
+	f.ZeroTerminated = c.zero
+	switch {
+	case c.skipFields < 0:
+		return fmt.Errorf("invalid number of fields to skip: '%d'", c.skipFields)
+	case c.skipChars < 0:
+		return fmt.Errorf("invalid number of bytes to skip: '%d'", c.skipChars)
+	case c.f.Changed("check-chars") && c.checkChars < 0:
+		return fmt.Errorf("invalid number of bytes to compare: '%d'", c.checkChars)
+	}
+	f.SkipFields, f.SkipChars, f.CheckChars = c.skipFields, c.skipChars, c.checkChars
+
+	if c.allRepeated || c.f.Changed("all-repeated") {
+		f.All = true
+		switch c.allMethod {
+		case "", "none":
+		case "prepend":
+			f.Delimit = DelimitPrepend
+		case "separate":
+			f.Delimit = DelimitSeparate
+		default:
+			return fmt.Errorf("invalid argument '%s' for '--all-repeated'", c.allMethod)
+		}
+	}
+	if c.f.Changed("group") {
+		f.Group = true
+		switch c.group {
+		case "separate":
+			f.Delimit = DelimitSeparate
+		case "prepend":
+			f.Delimit = DelimitPrepend
+		case "append":
+			f.Delimit = DelimitAppend
+		case "both":
+			f.Delimit = DelimitBoth
+		default:
+			return fmt.Errorf("invalid argument '%s' for '--group'", c.group)
+		}
+		if f.Count || f.Repeated || f.All || f.Unique {
+			return errors.New("--group is mutually exclusive with -c/-d/-D/-u")
+		}
+	}
+	if f.All && f.Count {
+		return errors.New("printing all duplicated lines and repeat counts is meaningless")
+	}
+
+	names := c.f.Args()
+	if len(names) > 2 {
+		return fmt.Errorf("extra operand '%s'", names[2])
+	}
+
+	var in io.Reader = ctx.Stdin
+	if len(names) > 0 && names[0] != "-" {
+		file, err := os.Open(names[0])
+		if err != nil {
+			return fmt.Errorf("%s: %v", names[0], unwrap(err))
+		}
+		defer file.Close()
+		in = file
+	}
+	out := ctx.Stdout
+	if len(names) > 1 && names[1] != "-" {
+		file, err := os.Create(names[1])
+		if err != nil {
+			return fmt.Errorf("%s: %v", names[1], unwrap(err))
+		}
+		defer func() {
+			if cerr := file.Close(); err == nil && cerr != nil {
+				err = cerr
+			}
+		}()
+		out = file
+	}
+
+	if err := f.Run(out, in); err != nil {
+		return unwrap(err)
+	}
+	return nil
+}
+
+func unwrap(err error) error {
+	if pe, ok := err.(*os.PathError); ok {
+		return pe.Err
+	}
+	return err
+}
@@ -1,3 +1,232 @@
-package main
+// Package uniq reports or omits repeated lines.
+//
+// Lines are read with internal/lines, which keeps the previous line valid
+// while the next is read, so each line is compared with the one before it
+// where it lies in the read buffer. Only -c, which prints the first line of
+// a group after counting it, copies anything, and that's once per group.
+package uniq
 
-func main() {}
+import (
+	"bufio"
+	"bytes"
+	"io"
+	"strconv"
+
+	"github.com/ericlagergren/go-coreutils/internal/lines"
+)
+
+// Delimit says how groups of lines are set apart, with an empty line, by
+// -D and --group.
+type Delimit int
+
+const (
+	DelimitNone     Delimit = iota
+	DelimitPrepend          // before each group
+	DelimitSeparate         // between groups
+	DelimitAppend           // after each group
+	DelimitBoth             // before and after each group
+)
+
+// Filter selects lines of its input.
+type Filter struct {
+	// Lines are compared after skipping SkipFields fields, then SkipChars
+	// characters, and only up to CheckChars characters, or all of them if
+	// CheckChars is negative. A field is blanks followed by non-blanks.
+	SkipFields int
+	SkipChars  int
+	CheckChars int
+	IgnoreCase bool
+
+	Count          bool // prefix lines by how often they occur
+	Repeated       bool // only print lines that are repeated
+	Unique         bool // only print lines that aren't
+	All            bool // print every line of the groups selected
+	Group          bool // print every line, with the groups delimited
+	Delimit        Delimit
+	ZeroTerminated bool
+}
+
+// NewFilter returns a Filter that prints one of each line.
+func NewFilter() *Filter {
+	return &Filter{CheckChars: -1}
+}
+
+func (f *Filter) delim() byte {
+	if f.ZeroTerminated {
+		return 0
+	}
+	return '\n'
+}
+
+// Run writes the lines of r that f selects to w.
+func (f *Filter) Run(w io.Writer, r io.Reader) error {
+	out := bufio.NewWriterSize(w, 64*1024)
+	delim := f.delim()
+	equal := f.equal()
+	in := lines.NewReader(r, delim)
+
+	// -d leaves out the lines that aren't repeated, and -u those that
+	// are, so with both nothing is left.
+	printRepeated := !f.Unique
+	printUnique := !f.Repeated
+
+	var (
+		prev   []byte
+		first  []byte // the group's first line, for -c
+		count  int64  // of lines in the group
+		groups int64
+		num    []byte
+		err    error
+	)
+	put := func(line []byte) {
+		out.Write(line)
+		out.WriteByte(delim)
+	}
+	// end finishes the group of count lines starting with line.
+	end := func(line []byte) {
+		switch {
+		case count == 0, f.Group, f.All:
+		case count == 1 && !printUnique, count > 1 && !printRepeated:
+		case f.Count:
+			num = strconv.AppendInt(num[:0], count, 10)
+			for i := len(num); i < 7; i++ {
+				out.WriteByte(' ')
+			}
+			out.Write(num)
+			out.WriteByte(' ')
+			put(line)
+		case count == 1:
+			put(line)
+		}
+	}
+
+	for {
+		var line []byte
+		line, err = in.Next()
+		if err != nil {
+			break
+		}
+		if count > 0 && equal(prev, line) {
+			count++
+			switch {
+			case f.Group:
+				put(line)
+			case f.All:
+				if count == 2 {
+					if f.Delimit == DelimitPrepend || f.Delimit == DelimitSeparate && groups > 0 {
+						out.WriteByte(delim)
+					}
+					groups++
+					put(prev)
+				}
+				put(line)
+			case count == 2 && printRepeated && !f.Count:
+				// Printed as soon as it's known to be repeated, while
+				// the group's first line is still the previous one.
+				put(prev)
+			}
+			prev = line
+			continue
+		}
+
+		if f.Count {
+			end(first)
+		} else {
+			end(prev)
+		}
+		if f.Group {
+			// count is only 0 before the first group.
+			switch f.Delimit {
+			case DelimitPrepend, DelimitBoth:
+				out.WriteByte(delim)
+			case DelimitSeparate, DelimitAppend:
+				if count > 0 {
+					out.WriteByte(delim)
+				}
+			}
+			put(line)
+		}
+		if f.Count {
+			first = append(first[:0], line...)
+		}
+		prev, count = line, 1
+	}
+	if err != io.EOF {
+		out.Flush()
+		return err
+	}
+
+	if f.Count {
+		end(first)
+	} else {
+		end(prev)
+	}
+	if f.Group && count > 0 && (f.Delimit == DelimitAppend || f.Delimit == DelimitBoth) {
+		out.WriteByte(delim)
+	}
+	return out.Flush()
+}
+
+// equal returns the function that reports whether two lines are the same,
+// given f's options.
+func (f *Filter) equal() func(a, b []byte) bool {
+	eq := bytes.Equal
+	if f.IgnoreCase {
+		eq = equalFold
+	}
+	if f.SkipFields == 0 && f.SkipChars == 0 && f.CheckChars < 0 {
+		return eq
+	}
+	return func(a, b []byte) bool {
+		return eq(f.key(a), f.key(b))
+	}
+}
+
+// key returns the part of line that's compared.
+func (f *Filter) key(line []byte) []byte {
+	i := 0
+	for n := 0; n < f.SkipFields && i < len(line); n++ {
+		for i < len(line) && isBlank(line[i]) {
+			i++
+		}
+		for i < len(line) && !isBlank(line[i]) {
+			i++
+		}
+	}
+	if i += f.SkipChars; i > len(line) {
+		i = len(line)
+	}
+	line = line[i:]
+	if f.CheckChars >= 0 && f.CheckChars < len(line) {
+		line = line[:f.CheckChars]
+	}
+	return line
+}
+
+func isBlank(c byte) bool {
+	return c == ' ' || c == '\t' || c == '\n'
+}
+
+// equalFold reports whether a and b are the same, ignoring the case of ASCII
+// letters, as in the C locale.
+func equalFold(a, b []byte) bool {
+	if len(a) != len(b) {
+		return false
+	}
+	for i := range a {
+		c, d := a[i], b[i]
+		if c == d {
+			continue
+		}
+		if 'A' <= c && c <= 'Z' {
+			c += 'a' - 'A'
+		}
+		if 'A' <= d && d <= 'Z' {
+			d += 'a' - 'A'
+		}
+		if c != d {
+			return false
+		}
+	}
+	return true
+}
@@ -0,0 +1,65 @@
+package uniq
+
+import (
+	"bytes"
+	"fmt"
+	"io/ioutil"
+	"strings"
+	"testing"
+
+	"github.com/ericlagergren/go-coreutils/internal/cmdtest"
+)
+
+func TestUniq(t *testing.T) {
+	const in = "a\na\nA\nb\nc 1\nc 2\nd\nd\nd\n"
+	for _, tc := range []struct {
+		args []string
+		want string
+	}{
+		{nil, "a\nA\nb\nc 1\nc 2\nd\n"},
+		{[]string{"-c"}, "      2 a\n      1 A\n      1 b\n      1 c 1\n      1 c 2\n      3 d\n"},
+		{[]string{"-d"}, "a\nd\n"},
+		{[]string{"-u"}, "A\nb\nc 1\nc 2\n"},
+		{[]string{"-du"}, ""},
+		{[]string{"-D"}, "a\na\nd\nd\nd\n"},
+		{[]string{"--all-repeated=separate"}, "a\na\n\nd\nd\nd\n"},
+		{[]string{"--group=both"}, "\na\na\n\nA\n\nb\n\nc 1\n\nc 2\n\nd\nd\nd\n\n"},
+		{[]string{"-ic"}, "      3 a\n      1 b\n      1 c 1\n      1 c 2\n      3 d\n"},
+		{[]string{"-f1"}, "a\nc 1\nc 2\nd\n"},
+		{[]string{"-s2", "-c"}, "      4 a\n      1 c 1\n      1 c 2\n      3 d\n"},
+		{[]string{"-w1", "-c"}, "      2 a\n      1 A\n      1 b\n      2 c 1\n      3 d\n"},
+	} {
+		got, _, err := cmdtest.Run(run, in, tc.args...)
+		if err != nil || got != tc.want {
+			t.Errorf("%q: got %q, %v, want %q", tc.args, got, err, tc.want)
+		}
+	}
+
+	got, _, err := cmdtest.Run(run, strings.Replace(in, "\n", "\x00", -1), "-zd")
+	if err != nil || got != "a\x00d\x00" {
+		t.Errorf("-zd: got %q, %v", got, err)
+	}
+	for _, args := range [][]string{{"-Dc"}, {"--group", "-u"}, {"--all-repeated=x"}, {"a", "b", "c"}} {
+		if _, _, err := cmdtest.Run(run, in, args...); err == nil {
+			t.Errorf("%q: no error", args)
+		}
+	}
+}
+
+func BenchmarkCount(b *testing.B) {
+	var buf bytes.Buffer
+	for i := 0; buf.Len() < 10<<20; i++ {
+		line := fmt.Sprintf("user%08d event\n", i)
+		for j := 0; j < i%17; j++ {
+			buf.WriteString(line)
+		}
+	}
+	b.SetBytes(int64(buf.Len()))
+	f := NewFilter()
+	f.Count = true
+	for i := 0; i < b.N; i++ {
+		if err := f.Run(ioutil.Discard, bytes.NewReader(buf.Bytes())); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
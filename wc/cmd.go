@@ -9,6 +9,7 @@ import (
 	"math"
 	"math/bits"
 	"os"
+	"runtime"
 	"unicode"
 
 	coreutils "github.com/ericlagergren/go-coreutils"
@@ -30,6 +31,10 @@ func newCommand() *cmd {
                              NUL-terminated names in file F;
                              If F is - then read names from standard input`)
 	c.f.Int64VarP(&c.tabWidth, "tab", "t", 8, "change the tab width")
+	c.f.IntVarP(&c.threads, "threads", "j", 1, `count large regular files using N threads;
+                             0 means one per CPU`)
+	c.f.IntVarP(&c.parallel, "parallel", "P", 1, `count up to N files at once;
+                             0 means one per CPU`)
 	c.f.BoolVarP(&c.unicode, "unicode-version", "u", false, "display unicode version and exit")
 	c.f.BoolVar(&c.version, "version", false, "display version information and exit")
 	return &c
@@ -40,6 +45,8 @@ type cmd struct {
 	lines, words, chars, bytes, maxLength bool
 	filesFrom                             string
 	tabWidth                              int64
+	threads                               int
+	parallel                              int
 	unicode                               bool
 	version                               bool
 }
@@ -84,14 +91,18 @@ func run(ctx coreutils.Context, args ...string) error {
 		opts = Lines | Words | Bytes
 	}
 
-	ctr := NewCounter(opts)
-	ctr.TabWidth = c.tabWidth
-
-	var s interface {
-		Scan() bool
-		Text() string
+	if c.threads <= 0 {
+		c.threads = runtime.NumCPU()
 	}
-	var hint int // To keep from allocating, if possible.
+	if c.parallel <= 0 {
+		c.parallel = runtime.NumCPU()
+	}
+	ctx.Stdout = ctx.Stats.Writer(ctx.Stdout)
+	ctr := c.newCounter(ctx, opts)
+
+	var s scanner
+	var hint int       // To keep from allocating, if possible.
+	var known []string // Every name s will return, if known up front.
 	if c.filesFrom == "" {
 		if c.f.NArg() == 0 {
 			res, err := ctr.Count(ctx.Stdin)
@@ -108,19 +119,40 @@ func run(ctx coreutils.Context, args ...string) error {
 		}
 		s = &sliceScanner{s: c.f.Args()}
 		hint = c.f.NArg()
+		known = c.f.Args()
 	} else {
 		if c.f.NArg() > 0 {
 			fmt.Fprintln(ctx.Stderr, errMixedArgs)
 			return errMixedArgs
 		}
-		file, err := os.Open(c.filesFrom)
-		if err != nil {
-			fmt.Fprintln(ctx.Stderr, err)
-			return err
+		var file io.Reader = ctx.Stdin
+		if c.filesFrom != "-" {
+			f, err := os.Open(c.filesFrom)
+			if err != nil {
+				fmt.Fprintln(ctx.Stderr, err)
+				return err
+			}
+			defer f.Close()
+			file = f
 		}
-		defer file.Close()
 		s = bufio.NewScanner(file)
 		s.(*bufio.Scanner).Split(filesFromSplit)
+
+		// A list in a regular file can be read in full so the column width is
+		// known before the first count is written. Names from anything else
+		// are counted as they arrive.
+		if f, ok := file.(*os.File); ok && c.parallel > 1 {
+			if stat, err := f.Stat(); err == nil && stat.Mode().IsRegular() {
+				for s.Scan() {
+					known = append(known, s.Text())
+				}
+				s = &sliceScanner{s: known}
+			}
+		}
+	}
+
+	if c.parallel > 1 {
+		return c.countFiles(ctx, s, known, opts)
 	}
 
 	var (
@@ -172,23 +204,43 @@ func run(ctx coreutils.Context, args ...string) error {
 		}
 	}
 
+	width := numberWidth(maxBytes, minWidth)
+	for i, r := range results {
+		writeCounts(ctx.Stdout, width, opts, r, names[i])
+	}
+	if len(results) > 1 {
+		writeCounts(ctx.Stdout, width, opts, total, "total")
+	}
+	return nil
+}
+
+func (c *cmd) newCounter(ctx coreutils.Context, opts uint8) *Counter {
+	ctr := NewCounter(opts)
+	ctr.TabWidth = c.tabWidth
+	ctr.Threads = c.threads
+	ctr.Stats = ctx.Stats
+	return ctr
+}
+
+// numberWidth returns the width of the count columns, which is the number of
+// digits in maxBytes or minWidth, whichever is larger.
+func numberWidth(maxBytes int64, minWidth int) int {
 	// Fast integer log 10. The call to math.Pow and subsequent comparison can
 	// be dropped in favor of simply adding +1 to width if it's alright for the
 	// result to be +1 too large for some numbers.
 	width := int((bits.Len64(uint64(maxBytes)) * 1233) >> 12)
-	if int64(math.Pow10(width)) < maxBytes {
+	if int64(math.Pow10(width)) <= maxBytes {
 		width++
 	}
 	if width < minWidth {
 		width = minWidth
 	}
-	for i, r := range results {
-		writeCounts(ctx.Stdout, width, opts, r, names[i])
-	}
-	if len(results) > 1 {
-		writeCounts(ctx.Stdout, width, opts, total, "total")
-	}
-	return nil
+	return width
+}
+
+type scanner interface {
+	Scan() bool
+	Text() string
 }
 
 type sliceScanner struct{ s []string }
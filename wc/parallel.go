@@ -0,0 +1,154 @@
+package wc
+
+import (
+	"io"
+	"math"
+	"os"
+	"sync"
+)
+
+// minRange is the smallest byte range countParallel will hand to a single
+// goroutine. Anything smaller isn't worth the extra goroutine and preads.
+var minRange int64 = 8 << 20
+
+// countParallel counts the remainder of the regular file f using up to
+// c.Threads goroutines. ok is false if f isn't a regular file or is too small
+// to be worth splitting, in which case res and err are meaningless and the
+// caller should count f serially.
+//
+// The file is cut into roughly equal byte ranges, but each range's start is
+// moved forward to the next "sync" byte: a byte whose effect on the count's
+// state doesn't depend on anything that came before it. For -l and -c every
+// byte qualifies. For -m any ASCII byte does, since ASCII bytes never occur
+// inside a multi-byte UTF-8 sequence, so decoding re-aligns there. For -w the
+// byte must also be whitespace, which always ends the current word. For -L
+// only '\n', '\r' and '\f' qualify, because they're the only bytes that reset
+// the line position. Since each range then starts from the same state as a fresh
+// Counter, words, runes and line lengths that cross a boundary are finished
+// by the range on the left and the per-range Results merge by simple sums and
+// a max.
+func (c *Counter) countParallel(f *os.File) (res Results, ok bool, err error) {
+	stat, err := f.Stat()
+	if err != nil || !stat.Mode().IsRegular() {
+		return res, false, nil
+	}
+	start, err := f.Seek(0, io.SeekCurrent)
+	if err != nil {
+		return res, false, nil
+	}
+	size := stat.Size() - start
+
+	n := c.Threads
+	if max := size / minRange; int64(n) > max {
+		n = int(max)
+	}
+	if n < 2 {
+		return res, false, nil
+	}
+
+	isSync := syncFunc(c.opts)
+
+	// bounds[i] is where range i starts. The last range is left open so that
+	// anything appended to the file while we're counting is still seen, just
+	// like the serial path.
+	bounds := make([]int64, n+1)
+	bounds[0] = start
+	bounds[n] = math.MaxInt64
+
+	var (
+		wg   sync.WaitGroup
+		errs = make([]error, n)
+	)
+	if isSync != nil {
+		for i := 1; i < n; i++ {
+			wg.Add(1)
+			go func(i int) {
+				defer wg.Done()
+				off := start + size/int64(n)*int64(i)
+				bounds[i], errs[i] = findSync(f, off, isSync)
+			}(i)
+		}
+		wg.Wait()
+		for _, err := range errs {
+			if err != nil {
+				return res, true, err
+			}
+		}
+	} else {
+		for i := 1; i < n; i++ {
+			bounds[i] = start + size/int64(n)*int64(i)
+		}
+	}
+
+	results := make([]Results, n)
+	for i := 0; i < n; i++ {
+		// A long line can push a sync point past the next range's nominal
+		// start, leaving two ranges starting at the same offset.
+		if bounds[i+1] == bounds[i] {
+			continue
+		}
+		wg.Add(1)
+		go func(i int) {
+			defer wg.Done()
+			ctr := Counter{TabWidth: c.TabWidth, Stats: c.Stats, opts: c.opts}
+			sr := io.NewSectionReader(f, bounds[i], bounds[i+1]-bounds[i])
+			results[i], errs[i] = ctr.Count(sr)
+		}(i)
+	}
+	wg.Wait()
+
+	for i, r := range results {
+		if errs[i] != nil {
+			return res, true, errs[i]
+		}
+		res.Lines += r.Lines
+		res.Words += r.Words
+		res.Chars += r.Chars
+		res.Bytes += r.Bytes
+		if r.MaxLength > res.MaxLength {
+			res.MaxLength = r.MaxLength
+		}
+	}
+
+	// Leave f where a serial count would have: at EOF.
+	_, err = f.Seek(0, io.SeekEnd)
+	return res, true, err
+}
+
+// syncFunc returns a function reporting whether a byte is a valid place to
+// start counting a range for the given options, or nil if any byte is.
+func syncFunc(opts uint8) func(byte) bool {
+	switch {
+	case opts&MaxLength != 0:
+		return func(b byte) bool { return b == '\n' || b == '\r' || b == '\f' }
+	case opts&Words != 0:
+		return func(b byte) bool {
+			return b == ' ' || b == '\t' || b == '\n' || b == '\v' || b == '\f' || b == '\r'
+		}
+	case opts&Chars != 0:
+		return func(b byte) bool { return b < 0x80 }
+	default:
+		return nil
+	}
+}
+
+// findSync returns the offset of the first byte at or after off for which
+// isSync returns true, or the offset of EOF if there isn't one.
+func findSync(f io.ReaderAt, off int64, isSync func(byte) bool) (int64, error) {
+	var buf [1 << 15]byte
+	for {
+		n, err := f.ReadAt(buf[:], off)
+		for i, b := range buf[:n] {
+			if isSync(b) {
+				return off + int64(i), nil
+			}
+		}
+		off += int64(n)
+		if err != nil {
+			if err == io.EOF {
+				return off, nil
+			}
+			return off, err
+		}
+	}
+}
@@ -0,0 +1,91 @@
+package wc
+
+import (
+	"bytes"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"testing"
+)
+
+// pieces are glued together at random to build inputs full of words, runes,
+// tabs and line breaks that straddle range boundaries.
+var pieces = []string{
+	"a", "word", " ", "  ", "\t", "\n", "\r\n", "\f", "\v", "日本語", "ü",
+	" ", "　", "\xe2\x82", "\xff", "longlonglonglonglonglong", "\x00",
+}
+
+func genInput(rng *rand.Rand, size int) []byte {
+	var b bytes.Buffer
+	for b.Len() < size {
+		b.WriteString(pieces[rng.Intn(len(pieces))])
+	}
+	return b.Bytes()
+}
+
+func TestCountParallel(t *testing.T) {
+	defer func(n int64) { minRange = n }(minRange)
+	minRange = 1 << 10
+
+	dir, err := ioutil.TempDir("", "wc")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	rng := rand.New(rand.NewSource(1))
+	opts := []uint8{
+		Lines, Bytes, Lines | Bytes, Words, Chars, MaxLength,
+		Lines | Words | Bytes, Lines | Words | Chars | Bytes | MaxLength,
+	}
+	for i, size := range []int{1 << 10, 5000, 1 << 16, 300001} {
+		data := genInput(rng, size)
+		name := dir + "/in"
+		if err := ioutil.WriteFile(name, data, 0644); err != nil {
+			t.Fatal(err)
+		}
+		for _, o := range opts {
+			want, err := NewCounter(o).Count(bytes.NewReader(data))
+			if err != nil {
+				t.Fatal(err)
+			}
+			for _, threads := range []int{2, 3, 7, 64} {
+				f, err := os.Open(name)
+				if err != nil {
+					t.Fatal(err)
+				}
+				c := NewCounter(o)
+				c.Threads = threads
+				got, err := c.Count(f)
+				f.Close()
+				if err != nil {
+					t.Fatal(err)
+				}
+				if got, want := mask(got, o), mask(want, o); got != want {
+					t.Errorf("#%d: opts %#x, %d threads: got %+v, want %+v",
+						i, o, threads, got, want)
+				}
+			}
+		}
+	}
+}
+
+// mask zeroes the counts in r that opts didn't ask for.
+func mask(r Results, opts uint8) Results {
+	if opts&Lines == 0 {
+		r.Lines = 0
+	}
+	if opts&Words == 0 {
+		r.Words = 0
+	}
+	if opts&Chars == 0 {
+		r.Chars = 0
+	}
+	if opts&Bytes == 0 {
+		r.Bytes = 0
+	}
+	if opts&MaxLength == 0 {
+		r.MaxLength = 0
+	}
+	return r
+}
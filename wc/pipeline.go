@@ -0,0 +1,181 @@
+package wc
+
+import (
+	"fmt"
+	"os"
+	"sync"
+	"sync/atomic"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+type job struct {
+	i    int
+	name string
+}
+
+type result struct {
+	job
+	res Results
+	err error
+}
+
+// countFiles counts every file named by s using up to c.parallel goroutines,
+// each with its own Counter, and writes the counts (and a total, if there's
+// more than one file) in the order s returned the names. Counts are written
+// as soon as every file before them has been written, so at most a few
+// results per goroutine are held at any one time.
+//
+// Since counting finishes out of order, the column width can't come from the
+// largest count like it does in the serial path. If known holds every name s
+// will return, the width is computed from the files' sizes, which are
+// stat'd concurrently with the counting. Otherwise, the counts are written
+// unpadded, like GNU wc does when it can't know its inputs ahead of time.
+func (c *cmd) countFiles(ctx coreutils.Context, s scanner, known []string, opts uint8) error {
+	var (
+		n       = c.parallel
+		jobs    = make(chan job)
+		results = make(chan result, n)
+		done    = make(chan struct{})
+		// window limits how far the workers can get ahead of the file
+		// that's next to be written.
+		window = make(chan struct{}, 4*n)
+
+		width = 1
+		sized = make(chan struct{}) // closed once width is known
+	)
+	defer close(done)
+
+	if known != nil {
+		go func() {
+			width = statWidth(known, n)
+			close(sized)
+		}()
+	} else {
+		close(sized)
+	}
+
+	go func() {
+		defer close(jobs)
+		for i := 0; s.Scan(); i++ {
+			select {
+			case window <- struct{}{}:
+			case <-done:
+				return
+			}
+			select {
+			case jobs <- job{i: i, name: s.Text()}:
+			case <-done:
+				return
+			}
+		}
+	}()
+
+	var wg sync.WaitGroup
+	for k := 0; k < n; k++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			ctr := c.newCounter(ctx, opts)
+			for j := range jobs {
+				r := result{job: j}
+				r.res, r.err = countFile(ctr, j.name)
+				select {
+				case results <- r:
+				case <-done:
+					return
+				}
+			}
+		}()
+	}
+	go func() {
+		wg.Wait()
+		close(results)
+	}()
+
+	<-sized
+
+	var (
+		pending = make(map[int]result, cap(window))
+		next    int
+		total   Results
+	)
+	for r := range results {
+		pending[r.i] = r
+		for {
+			r, ok := pending[next]
+			if !ok {
+				break
+			}
+			delete(pending, next)
+			next++
+			<-window
+
+			if r.err != nil {
+				fmt.Fprintln(ctx.Stderr, r.err)
+				return r.err
+			}
+			writeCounts(ctx.Stdout, width, opts, r.res, r.name)
+
+			total.Lines += r.res.Lines
+			total.Words += r.res.Words
+			total.Chars += r.res.Chars
+			total.Bytes += r.res.Bytes
+			if r.res.MaxLength > total.MaxLength {
+				total.MaxLength = r.res.MaxLength
+			}
+		}
+	}
+	if next > 1 {
+		writeCounts(ctx.Stdout, width, opts, total, "total")
+	}
+	return nil
+}
+
+func countFile(ctr *Counter, name string) (Results, error) {
+	file, err := os.Open(name)
+	if err != nil {
+		return Results{}, err
+	}
+	res, err := ctr.Count(file)
+	if cerr := file.Close(); err == nil {
+		err = cerr
+	}
+	return res, err
+}
+
+// statWidth returns the column width for names, stat'ing up to n of them at
+// once. It matches the serial path's width as long as the files don't change
+// size while they're being counted, except that the size of anything that
+// isn't a regular file can't be known and is ignored.
+func statWidth(names []string, n int) int {
+	var (
+		mu       sync.Mutex
+		maxBytes int64
+		minWidth = 1
+		next     = int64(-1)
+		wg       sync.WaitGroup
+	)
+	for k := 0; k < n; k++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for {
+				i := atomic.AddInt64(&next, 1)
+				if i >= int64(len(names)) {
+					return
+				}
+				stat, err := os.Stat(names[i])
+				mu.Lock()
+				if err != nil || !stat.Mode().IsRegular() {
+					minWidth = 7
+				} else if stat.Size() > maxBytes {
+					maxBytes = stat.Size()
+				}
+				mu.Unlock()
+			}
+		}()
+	}
+	wg.Wait()
+	return numberWidth(maxBytes, minWidth)
+}
@@ -0,0 +1,58 @@
+package wc
+
+import (
+	"bytes"
+	"fmt"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+)
+
+func TestCountFiles(t *testing.T) {
+	dir, err := ioutil.TempDir("", "wc")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.RemoveAll(dir)
+
+	rng := rand.New(rand.NewSource(3))
+	var names []string
+	for i := 0; i < 100; i++ {
+		name := filepath.Join(dir, fmt.Sprintf("f%d", i))
+		if err := ioutil.WriteFile(name, genInput(rng, rng.Intn(20000)), 0644); err != nil {
+			t.Fatal(err)
+		}
+		names = append(names, name)
+	}
+	list := filepath.Join(dir, "list")
+	if err := ioutil.WriteFile(list, []byte(strings.Join(names, "\x00")), 0644); err != nil {
+		t.Fatal(err)
+	}
+
+	wc := func(args ...string) string {
+		var stdout, stderr bytes.Buffer
+		ctx := coreutils.Context{Stdout: &stdout, Stderr: &stderr}
+		if err := run(ctx, args...); err != nil {
+			t.Fatalf("wc %v: %v: %s", args, err, stderr.String())
+		}
+		return stdout.String()
+	}
+	for _, flags := range [][]string{nil, {"-l"}, {"-lwmcL"}} {
+		want := wc(append(flags, names...)...)
+		for _, p := range []string{"2", "7", "200"} {
+			args := append([]string{"-P", p}, flags...)
+			if got := wc(append(args, names...)...); got != want {
+				t.Errorf("wc %v: got\n%s\nwant\n%s", args, got, want)
+			}
+			args = append(args, "--files0-from", list)
+			if got := wc(args...); got != want {
+				t.Errorf("wc %v: got\n%s\nwant\n%s", args, got, want)
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+package wc
+
+import "math/bits"
+
+// SWAR ("SIMD within a register") helpers for countComplicated's ASCII fast
+// path. Each function works on eight bytes packed little-endian into a uint64
+// and returns a mask with the high bit of every matching byte set. They're
+// only exact when every byte of w is ASCII (below 0x80), which the caller
+// checks first.
+
+const (
+	ones     = 0x0101010101010101
+	lowBits  = 0x7f7f7f7f7f7f7f7f
+	highBits = 0x8080808080808080
+)
+
+// eq marks the bytes of w equal to b.
+func eq(w uint64, b byte) uint64 {
+	v := w ^ (ones * uint64(b))
+	return ^(((v & lowBits) + lowBits) | v) & highBits
+}
+
+// ge marks the bytes of w greater than or equal to b, which must be in the
+// range [1, 0x80].
+func ge(w uint64, b byte) uint64 {
+	return (w + ones*uint64(0x80-b)) & highBits
+}
+
+// wordEnds returns the number of words that end inside a block of eight
+// bytes, given the masks of its space and word (printable, non-space) bytes.
+// carry is 0x80 if the byte just before the block was part of a word and 0
+// otherwise, and wordEnds returns the carry for the next block.
+//
+// Bytes that are neither spaces nor printable (control characters, DEL) don't
+// change whether we're in a word, so each one takes on the state of the byte
+// to its left. That's a prefix computation, done here as a three-step
+// parallel scan instead of a byte-by-byte loop.
+func wordEnds(space, word, carry uint64) (n int64, next uint64) {
+	p := highBits &^ (space | word)
+	s := word | p&carry
+	s |= p & (s << 8)
+	p &= p << 8
+	s |= p & (s << 16)
+	p &= p << 16
+	s |= p & (s << 32)
+	return int64(bits.OnesCount64(space & (s<<8 | carry))), s >> 56
+}
@@ -0,0 +1,123 @@
+package wc
+
+import (
+	"bytes"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"testing"
+	"unicode"
+	"unicode/utf8"
+
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+)
+
+// countReference is countComplicated without the ASCII fast path, decoding
+// every rune of data.
+func countReference(data []byte, tabWidth int64) (res Results) {
+	var (
+		pos    int64
+		inWord bool
+	)
+	for len(data) > 0 {
+		r, s := utf8.DecodeRune(data)
+		data = data[s:]
+		switch {
+		case r == '\n' || r == '\r' || r == '\f':
+			if r == '\n' {
+				res.Lines++
+			}
+			if pos > res.MaxLength {
+				res.MaxLength = pos
+			}
+			pos = 0
+		case r == '\t':
+			pos += tabWidth - (pos % tabWidth)
+		case unicode.IsPrint(r):
+			pos++
+		}
+		// Like countComplicated, only printable runes and the ASCII spaces
+		// affect words.
+		switch {
+		case r == '\t' || r == '\n' || r == '\v' || r == '\f' || r == '\r' || r == ' ',
+			unicode.IsPrint(r) && unicode.IsSpace(r):
+			if inWord {
+				res.Words++
+			}
+			inWord = false
+		case unicode.IsPrint(r):
+			inWord = true
+		}
+		res.Chars++
+	}
+	if pos > res.MaxLength {
+		res.MaxLength = pos
+	}
+	if inWord {
+		res.Words++
+	}
+	return res
+}
+
+func TestCountComplicated(t *testing.T) {
+	rng := rand.New(rand.NewSource(2))
+	var ascii bytes.Buffer
+	for i := 0; i < 128; i++ {
+		ascii.WriteByte(byte(i))
+	}
+	for i := 0; i < 200; i++ {
+		data := genInput(rng, rng.Intn(1<<12))
+		// Sprinkle in every ASCII byte, control characters included.
+		for j := rng.Intn(16); j > 0; j-- {
+			k := rng.Intn(len(data) + 1)
+			data = append(data[:k], append(ascii.Bytes()[rng.Intn(128):], data[k:]...)...)
+		}
+		want := countReference(data, 8)
+		want.Bytes = int64(len(data))
+		for _, o := range []uint8{Lines | Words | Chars | MaxLength, Words, Chars} {
+			got, err := NewCounter(o).Count(bytes.NewReader(data))
+			if err != nil {
+				t.Fatal(err)
+			}
+			if got, want := mask(got, o), mask(want, o); got != want {
+				t.Fatalf("#%d: opts %#x: got %+v, want %+v\ninput: %q", i, o, got, want, data)
+			}
+		}
+	}
+}
+
+// TestCountMapped maps its input with tiny windows so that runes, words and
+// SWAR blocks are split between chunks.
+func TestCountMapped(t *testing.T) {
+	defer func(t int64, w int) { mmap.Threshold, mmap.WindowSize = t, w }(mmap.Threshold, mmap.WindowSize)
+	mmap.Threshold = 1
+
+	f, err := ioutil.TempFile("", "wc")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer os.Remove(f.Name())
+	defer f.Close()
+
+	data := genInput(rand.New(rand.NewSource(4)), 50000)
+	if _, err := f.Write(data); err != nil {
+		t.Fatal(err)
+	}
+	want := countReference(data, 8)
+	want.Bytes = int64(len(data))
+	for _, size := range []int{1, 2, 3, 7, 4097} {
+		mmap.WindowSize = size
+		for _, o := range []uint8{Lines | Words | Chars | Bytes | MaxLength, Words, Chars, Lines} {
+			if _, err := f.Seek(0, 0); err != nil {
+				t.Fatal(err)
+			}
+			got, err := NewCounter(o).Count(f)
+			if err != nil {
+				t.Fatal(err)
+			}
+			if got, want := mask(got, o), mask(want, o); got != want {
+				t.Errorf("window %d: opts %#x: got %+v, want %+v", size, o, got, want)
+			}
+		}
+	}
+}
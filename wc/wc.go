@@ -2,12 +2,16 @@ package wc
 
 import (
 	"bytes"
+	"encoding/binary"
 	"io"
+	"math/bits"
 	"os"
 	"unicode"
 	"unicode/utf8"
 
-	"github.com/ericlagergren/go-coreutils/wc/internal/sys"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/mmap"
+	"github.com/ericlagergren/go-coreutils/internal/sys"
 )
 
 type Results struct {
@@ -21,6 +25,14 @@ type Results struct {
 type Counter struct {
 	TabWidth int64
 
+	// Threads, if greater than 1, allows Count to split large regular files
+	// into byte ranges that are counted concurrently. Each range is read with
+	// pread, so the file's offset is not shared between goroutines.
+	Threads int
+
+	// Stats, if non-nil, counts the reads and the fast paths Count takes.
+	Stats *coreutils.Stats
+
 	buf  [1 << 17]byte
 	opts uint8
 }
@@ -37,12 +49,25 @@ func NewCounter(opts uint8) *Counter {
 	return &Counter{opts: opts, TabWidth: 8}
 }
 
-func (c *Counter) read(r io.Reader) (int64, error) {
-	n, err := r.Read(c.buf[:])
-	if err != nil {
-		return 0, err
+// chunks returns a function that reads r a chunk at a time. A mapped file's
+// chunks come straight from the mapping; anything else is read into c.buf.
+func (c *Counter) chunks(r io.Reader) func() ([]byte, error) {
+	if mr, ok := r.(*mmap.Reader); ok {
+		if c.Stats != nil {
+			return func() ([]byte, error) {
+				p, err := mr.Next()
+				c.Stats.AddMapped(int64(len(p)))
+				return p, err
+			}
+		}
+		return mr.Next
+	}
+	return func() ([]byte, error) {
+		start := c.Stats.Start()
+		n, err := r.Read(c.buf[:])
+		c.Stats.AddRead(n, start)
+		return c.buf[:n], err
 	}
-	return int64(n), nil
 }
 
 var newLine = []byte{'\n'}
@@ -51,16 +76,38 @@ func (c *Counter) Count(r io.Reader) (res Results, err error) {
 	if file, ok := r.(*os.File); ok {
 		if c.opts == Bytes {
 			if n, ok := statSize(file); ok {
+				c.Stats.Took("statSize")
 				return Results{Bytes: n}, nil
 			}
 		}
 		sys.Fadvise(int(file.Fd()))
+		if c.Threads > 1 {
+			if res, ok, err := c.countParallel(file); ok {
+				c.Stats.Took("parallel")
+				return res, err
+			}
+		}
+		if mr := mmap.NewReader(file); mr.Mapped() {
+			c.Stats.Took("mmap")
+			err = mmap.Guard(file, func() (err error) {
+				res, err = c.count(c.chunks(mr))
+				return err
+			})
+			if cerr := mr.Close(); err == nil {
+				err = cerr
+			}
+			return res, err
+		}
 	}
+	return c.count(c.chunks(r))
+}
+
+func (c *Counter) count(next func() ([]byte, error)) (res Results, err error) {
 	switch c.opts {
 	case Bytes:
 		for {
-			n, err := c.read(r)
-			res.Bytes += n
+			p, err := next()
+			res.Bytes += int64(len(p))
 			if err != nil {
 				if err == io.EOF {
 					return res, nil
@@ -70,9 +117,9 @@ func (c *Counter) Count(r io.Reader) (res Results, err error) {
 		}
 	case Lines, Lines | Bytes:
 		for {
-			n, err := c.read(r)
-			res.Bytes += n
-			res.Lines += int64(bytes.Count(c.buf[:n], newLine))
+			p, err := next()
+			res.Bytes += int64(len(p))
+			res.Lines += int64(bytes.Count(p, newLine))
 			if err != nil {
 				if err == io.EOF {
 					return res, nil
@@ -81,28 +128,113 @@ func (c *Counter) Count(r io.Reader) (res Results, err error) {
 			}
 		}
 	default:
-		return c.countComplicated(r)
+		return c.countComplicated(next)
 	}
 }
 
-func (c *Counter) countComplicated(r io.Reader) (res Results, err error) {
+// scanState is what countComplicated needs to remember between chunks.
+type scanState struct {
+	res    Results
+	pos    int64
+	inWord bool
+}
+
+func (c *Counter) countComplicated(next func() ([]byte, error)) (Results, error) {
 	var (
-		pos    int64
-		inWord bool
+		st scanState
+		// A rune split between two chunks is finished in tmp: its leading
+		// bytes are kept from the previous chunk and the rest appended from
+		// the next one.
+		tmp [2 * utf8.UTFMax]byte
+		off int
 	)
-
 	for {
-		n, err := c.read(r)
-		res.Bytes += n
-		if err != nil {
-			if err == io.EOF {
+		p, err := next()
+		st.res.Bytes += int64(len(p))
+		if err != nil && err != io.EOF {
+			return st.res, err
+		}
+		eof := err == io.EOF
+
+		if off > 0 {
+			k := copy(tmp[off:], p)
+			used := c.scan(&st, tmp[:off+k], eof && k == len(p))
+			if used < off {
+				// p was too short to finish the rune.
+				off = copy(tmp[:], tmp[used:off+k])
+				continue
+			}
+			p = p[used-off:]
+		}
+		used := c.scan(&st, p, eof)
+		off = copy(tmp[:], p[used:])
+		if eof {
+			break
+		}
+	}
+	if st.pos > st.res.MaxLength {
+		st.res.MaxLength = st.pos
+	}
+	if st.inWord {
+		st.res.Words++
+	}
+	return st.res, nil
+}
+
+// scan counts p and returns how much of it was used. Unless eof is set, an
+// incomplete rune at the end of p is left for the caller to finish once it
+// has the rest.
+func (c *Counter) scan(st *scanState, p []byte, eof bool) int {
+	var (
+		res    = st.res
+		pos    = st.pos
+		inWord = st.inWord
+		n      = len(p)
+		bp     int
+
+		trackPos = c.opts&MaxLength != 0
+	)
+buf:
+	for bp < n {
+		// Pure ASCII is counted eight bytes at a time, see swar.go. Tabs and
+		// line breaks make the line position depend on each byte's column,
+		// so with -L those blocks go through the slow path.
+		var carry uint64
+		if inWord {
+			carry = 0x80
+		}
+		for ; n-bp >= 8; bp += 8 {
+			w := binary.LittleEndian.Uint64(p[bp:])
+			if w&highBits != 0 {
 				break
 			}
-			return res, err
+			var (
+				sp    = eq(w, ' ')
+				print = ge(w, ' ') &^ eq(w, 0x7f)
+				space = sp | ge(w, '\t')&^ge(w, '\r'+1)
+			)
+			if trackPos {
+				// Tabs and line breaks.
+				if space&^(sp|eq(w, '\v')) != 0 {
+					break
+				}
+				pos += int64(bits.OnesCount64(print))
+			}
+			var ends int64
+			ends, carry = wordEnds(space, print&^sp, carry)
+			res.Words += ends
+			res.Lines += int64(bits.OnesCount64(eq(w, '\n')))
+			res.Chars += 8
 		}
+		inWord = carry != 0
 
-		for bp := 0; int64(bp) < n; {
-			r, s := utf8.DecodeRune(c.buf[bp:])
+		// Everything else goes through the rune decoder, at least up to the
+		// end of the block the fast path turned down.
+		for stop := bp + 8; bp < n && bp < stop; {
+			if !eof && n-bp < utf8.UTFMax && !utf8.FullRune(p[bp:]) {
+				break buf
+			}
+			r, s := utf8.DecodeRune(p[bp:])
 			switch r {
 			case '\n':
 				res.Lines++
@@ -149,13 +281,8 @@ func (c *Counter) countComplicated(r io.Reader) (res Results, err error) {
 			bp += s
 		}
 	}
-	if pos > res.MaxLength {
-		res.MaxLength = pos
-	}
-	if inWord {
-		res.Words++
-	}
-	return res, nil
+	st.res, st.pos, st.inWord = res, pos, inWord
+	return bp
 }
 
 func statSize(file *os.File) (n int64, ok bool) {
@@ -1,13 +1,16 @@
-// +build ignore
-
 package wc
 
 import (
 	"bytes"
+	"fmt"
 	"io"
+	"io/ioutil"
 	"os"
-	"os/exec"
+	"path/filepath"
 	"testing"
+
+	coreutils "github.com/ericlagergren/go-coreutils"
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
 )
 
 var flist = []string{
@@ -17,64 +20,139 @@ var flist = []string{
 	"_testdata/coreutils_man_en.txt",
 }
 
-var buf bytes.Buffer
+// opts are the option masks the benchmarks are run with: each count alone,
+// wc's default, and everything.
+var opts = []struct {
+	name string
+	opts uint8
+}{
+	{"l", Lines},
+	{"w", Words},
+	{"m", Chars},
+	{"c", Bytes},
+	{"L", MaxLength},
+	{"default", Lines | Words | Bytes},
+	{"all", Lines | Words | Chars | Bytes | MaxLength},
+}
 
 func TestWC(t *testing.T) {
+	for _, name := range flist {
+		data, err := ioutil.ReadFile(name)
+		if err != nil {
+			t.Fatal(err)
+		}
+		want := countReference(data, 8)
+		want.Bytes = int64(len(data))
+		for _, o := range opts {
+			f, err := os.Open(name)
+			if err != nil {
+				t.Fatal(err)
+			}
+			got, err := NewCounter(o.opts).Count(f)
+			f.Close()
+			if err != nil {
+				t.Fatal(err)
+			}
+			if got, want := mask(got, o.opts), mask(want, o.opts); got != want {
+				t.Errorf("%s: -%s: got %+v, want %+v", name, o.name, got, want)
+			}
+		}
+	}
+}
 
-	fs := getFileStatus(flist)
-	numberWidth = findNumberWidth(fs)
-
-	*printLines = true
-	*printWords = true
-	*printChars = true
-	*printBytes = true
-	*printLineLength = true
-
-	// set up our capture of stdout
-	stdout := os.Stdout
-	r, w, err := os.Pipe()
+func TestCountStats(t *testing.T) {
+	data, err := ioutil.ReadFile(flist[1])
 	if err != nil {
 		t.Fatal(err)
 	}
-	os.Stdout = w
-
-	// now output stdout
-	for i, file := range flist {
-		wcFile(file, fs[i])
-	}
-	writeCounts(totalLines, totalWords,
-		totalChars, totalBytes, maxLineLength, "total")
-
-	// capture the stdout
-	outC := make(chan string)
-	go func() {
-		var b bytes.Buffer
-		_, err := io.Copy(&b, r)
-		r.Close()
-		if err != nil {
+	for _, tt := range []struct {
+		opts  uint8
+		file  bool
+		path  string
+		bytes int64
+	}{
+		{Bytes, true, "statSize", 0},
+		{Lines, true, "", int64(len(data))},
+		{Bytes, false, "", int64(len(data))},
+	} {
+		s := new(coreutils.Stats)
+		c := NewCounter(tt.opts)
+		c.Stats = s
+		var r io.Reader = bytes.NewReader(data)
+		if tt.file {
+			f, err := os.Open(flist[1])
+			if err != nil {
+				t.Fatal(err)
+			}
+			defer f.Close()
+			r = f
+		}
+		if _, err := c.Count(r); err != nil {
 			t.Fatal(err)
 		}
-		outC <- b.String()
-	}()
+		paths := s.FastPaths()
+		if s.BytesRead != tt.bytes || (tt.bytes > 0) != (s.Reads > 0) || (tt.path != "") != (paths[tt.path] == 1) {
+			t.Errorf("opts %#x, file %t: read %d bytes in %d calls, fast paths %v", tt.opts, tt.file, s.BytesRead, s.Reads, paths)
+		}
+	}
+}
 
-	// now get stdout of native wc
-	wc := exec.Command("wc", "-lwmcL",
-		flist[0], flist[1], flist[2], flist[3])
+// BenchmarkCount counts text that's only in memory, so it's the counting
+// that's measured and not the reading.
+func BenchmarkCount(b *testing.B) {
+	for _, k := range benchdata.Kinds {
+		data := benchdata.Text(k, 4<<20)
+		for _, o := range opts {
+			b.Run(fmt.Sprintf("%s/%s", k, o.name), func(b *testing.B) {
+				c := NewCounter(o.opts)
+				b.SetBytes(int64(len(data)))
+				for i := 0; i < b.N; i++ {
+					if _, err := c.Count(bytes.NewReader(data)); err != nil {
+						b.Fatal(err)
+					}
+				}
+			})
+		}
+	}
+}
 
-	b, err := wc.Output()
+// BenchmarkCountFile counts a file, which is mapped, read in parallel or, for
+// just -c, not read at all.
+func BenchmarkCountFile(b *testing.B) {
+	dir, err := ioutil.TempDir("", "wc")
 	if err != nil {
-		t.Fatal(err)
+		b.Fatal(err)
 	}
-	buf.Write(b)
-
-	// stop capturing of stdout
-	w.Close()
-	os.Stdout = stdout
-	out := <-outC
-
-	// check strings
-	if out != buf.String() {
-		t.Fatalf("Got:\n%s\n\nExpected:\n%s\n", out, buf.String())
+	defer os.RemoveAll(dir)
+	if err := benchdata.Write(dir, 16<<20, 0); err != nil {
+		b.Fatal(err)
 	}
 
+	for _, k := range benchdata.Kinds {
+		name := filepath.Join(dir, string(k)+".txt")
+		fi, err := os.Stat(name)
+		if err != nil {
+			b.Fatal(err)
+		}
+		for _, o := range opts {
+			for _, threads := range []int{1, 4} {
+				b.Run(fmt.Sprintf("%s/%s/threads=%d", k, o.name, threads), func(b *testing.B) {
+					c := NewCounter(o.opts)
+					c.Threads = threads
+					b.SetBytes(fi.Size())
+					for i := 0; i < b.N; i++ {
+						f, err := os.Open(name)
+						if err != nil {
+							b.Fatal(err)
+						}
+						_, err = c.Count(f)
+						f.Close()
+						if err != nil {
+							b.Fatal(err)
+						}
+					}
+				})
+			}
+		}
+	}
 }
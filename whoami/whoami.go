@@ -20,16 +20,19 @@
 /* Equivalent to 'id -un'. */
 /* Written by Eric Lagergren and mattn */
 
-package main
+package whoami
 
 import (
 	"fmt"
-	"log"
-	"os"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("whoami", run)
+}
+
 const (
 	Help = `Usage: whoami [OPTION]...
 Print the user name associated with the current effective user ID.
@@ -50,24 +53,27 @@ There is NO WARRANTY, to the extent permitted by law.
 Written by Eric Lagergren`
 )
 
-var (
-	version = flag.BoolP("version", "v", false, "")
-	fatal   = log.New(os.Stderr, "", 0)
-)
-
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s", Help)
-		os.Exit(0)
+func run(ctx coreutils.Context, args ...string) error {
+	var (
+		f       flag.FlagSet
+		version bool
+	)
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
-	flag.Parse()
 
-	if *version {
-		fmt.Fprintf(os.Stderr, "%s", Version)
-		os.Exit(0)
+	if version {
+		fmt.Fprintf(ctx.Stderr, "%s", Version)
+		return nil
 	}
 
-	// This function call *should* be inlined on both
-	// Windows and Unix
-	fmt.Println(getUser())
+	name, err := getUser()
+	if err != nil {
+		fmt.Fprintf(ctx.Stderr, "whoami: %v\n", err)
+		return err
+	}
+	_, err = fmt.Fprintln(ctx.Stdout, name)
+	return err
 }
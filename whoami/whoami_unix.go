@@ -22,19 +22,20 @@
 /* Equivalent to 'id -un'. */
 /* Written by Eric Lagergren */
 
-package main
+package whoami
 
 import (
+	"fmt"
 	"os"
 	"os/user"
 	"strconv"
 )
 
-func getUser() string {
+func getUser() (string, error) {
 	uid := strconv.Itoa(os.Geteuid())
 	u, err := user.LookupId(uid)
 	if err != nil {
-		fatal.Fatalf("cannot find name for user ID %s\n", uid)
+		return "", fmt.Errorf("cannot find name for user ID %s", uid)
 	}
-	return u.Username
+	return u.Username, nil
 }
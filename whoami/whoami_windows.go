@@ -20,15 +20,18 @@
 /* Equivalent to 'id -un'. */
 /* Written by Eric Lagergren and mattn */
 
-package main
+package whoami
 
-import "os/user"
+import (
+	"errors"
+	"os/user"
+)
 
-func getUser() string {
+func getUser() (string, error) {
 	u, err := user.Current()
 	// TODO(eric): Have this output match whoami_unix.go
 	if err != nil {
-		fatal.Fatalln("cannot find name for current user")
+		return "", errors.New("cannot find name for current user")
 	}
-	return u.Username
+	return u.Username, nil
 }
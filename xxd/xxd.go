@@ -9,19 +9,27 @@
 	Current version (c) 2014-2015 Eric Lagergren and Felix Geisendörfer
 */
 
-package main
+package xxd
 
 import (
 	"bufio"
+	"bytes"
+	"errors"
 	"fmt"
 	"io"
-	"log"
+	"io/ioutil"
 	"os"
 	"strconv"
+	"strings"
 
-	flag "github.com/ogier/pflag"
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
 )
 
+func init() {
+	coreutils.Register("xxd", run)
+}
+
 const (
 	Help = `Usage:
        xxd [options] [infile [outfile]]
@@ -49,26 +57,35 @@ Options:
 	Version = `xxd v2.0 2014-17-01 by Felix Geisendörfer and Eric Lagergren`
 )
 
-var (
-	autoskip   = flag.BoolP("autoskip", "a", false, "toggle autoskip (* replaces nul lines")
-	bars       = flag.BoolP("bars", "B", false, "print |ascii| instead of ascii")
-	binary     = flag.BoolP("binary", "b", false, "binary dump, incompatible with -ps, -i, -r")
-	columns    = flag.IntP("cols", "c", -1, "format <cols> octets per line")
-	ebcdic     = flag.BoolP("ebcdic", "E", false, "use EBCDIC instead of ASCII")
-	group      = flag.IntP("group", "g", -1, "num of octets per group")
-	cfmt       = flag.BoolP("include", "i", false, "output in C include format")
-	length     = flag.Int64P("len", "l", -1, "stop after len octets")
-	postscript = flag.BoolP("ps", "p", false, "output in postscript plain hd style")
-	reverse    = flag.BoolP("reverse", "r", false, "convert hex to binary")
-	offset     = flag.Int("off", 0, "revert with offset")
-	seek       = flag.StringP("seek", "s", "", "start at seek bytes abs")
-	upper      = flag.BoolP("uppercase", "u", false, "use uppercase hex letters")
-	version    = flag.BoolP("version", "v", false, "print version")
-)
+// options are what the flags ask for. Each run has its own, so xxd can be
+// run more than once at a time in one process.
+type options struct {
+	autoskip bool
+	bars     bool
+	columns  int
+	ebcdic   bool
+	group    int
+	length   int64
+	offset   int
+	upper    bool
+
+	dumpType int
+
+	// seekOffset is where in the input the dump starts, so the offsets
+	// printed match the file's.
+	seekOffset int64
+}
 
 // constants used in xxd()
 const (
 	ebcdicOffset = 0x40
+
+	// blockSize is roughly how much input is read, and turned into one
+	// write of output, at a time.
+	blockSize = 256 * 1024
+
+	// badHex marks bytes that aren't hex digits in unhex.
+	badHex = 0xff
 )
 
 // dumpType enum
@@ -79,27 +96,6 @@ const (
 	dumpPostscript
 )
 
-// variables used in xxd*
-var (
-	dumpType int
-
-	space        = []byte(" ")
-	doubleSpace  = []byte("  ")
-	dot          = []byte(".")
-	newLine      = []byte("\n")
-	zeroHeader   = []byte("0000000: ")
-	unsignedChar = []byte("unsigned char ")
-	unsignedInt  = []byte("};\nunsigned int ")
-	lenEquals    = []byte("_len = ")
-	brackets     = []byte("[] = {")
-	asterisk     = []byte("*")
-	hexPrefix    = []byte("0x")
-	commaSpace   = []byte(", ")
-	comma        = []byte(",")
-	semiColonNl  = []byte(";\n")
-	bar          = []byte("|")
-)
-
 // ascii -> ebcdic lookup table
 var ebcdicTable = []byte{
 	0040, 0240, 0241, 0242, 0243, 0244, 0245, 0246,
@@ -128,119 +124,48 @@ var ebcdicTable = []byte{
 	0070, 0071, 0372, 0373, 0374, 0375, 0376, 0377,
 }
 
-// convert a byte into its binary representation
-func binaryEncode(dst, src []byte) {
-	d := uint(0)
-	for i := 7; i >= 0; i-- {
-		if src[0]&(1<<d) == 0 {
-			dst[i] = '0'
-		} else {
-			dst[i] = '1'
-		}
-		d++
-	}
-}
-
-// returns -1 on success
-// returns k > -1 if space found where k is index of space byte
-func binaryDecode(dst, src []byte) int {
-	var d byte
-
-	for i, v := range src {
-		d <<= 1
-		if isSpace(&v) { // found a space, so between groups
-			if i == 0 {
-				return 1
-			}
-			return i
-		}
-		if v == '1' {
-			d ^= 1
-		} else if v != '0' {
-			return i // will catch issues like "000000: "
-		}
-	}
-
-	dst[0] = d
-	return -1
-}
-
 // hex lookup table for hex encoding
 const (
 	ldigits = "0123456789abcdef"
 	udigits = "0123456789ABCDEF"
 )
 
-func cfmtEncode(dst, src []byte, hextable string) {
-	dst[0] = '0'
-	dst[1] = 'x'
-	for i, v := range src {
-		dst[i+1*2] = hextable[v>>4]
-		dst[i+1*2+1] = hextable[v&0x0f]
-	}
-}
-
-// copied from encoding/hex package in order to add support for uppercase hex
-func hexEncode(dst, src []byte, hextable string) {
-	for i, v := range src {
-		dst[i*2] = hextable[v>>4]
-		dst[i*2+1] = hextable[v&0x0f]
-	}
-}
-
-// copied from encoding/hex package
-// returns -1 on bad byte or space (\t \s \n)
-// returns -2 on two consecutive spaces
-// returns 0 on success
-func hexDecode(dst, src []byte) int {
-	if isSpace(&src[0]) {
-		if isSpace(&src[1]) {
-			return -2
-		}
-		return -1
-	}
-
-	if isPrefix(src[0:2]) {
-		src = src[2:]
-	}
+// Lookup tables for every byte value, so each byte of input costs one
+// load per field instead of shifting and branching.
+var (
+	hexLower     [256][2]byte
+	hexUpper     [256][2]byte
+	binDigits    [256][8]byte
+	asciiGutter  [256]byte
+	ebcdicGutter [256]byte
+	unhex        [256]byte
+)
 
-	for i := 0; i < len(src)/2; i++ {
-		a, ok := fromHexChar(src[i*2])
-		if !ok {
-			return -1
+func init() {
+	for i := 0; i < 256; i++ {
+		hexLower[i] = [2]byte{ldigits[i>>4], ldigits[i&0x0f]}
+		hexUpper[i] = [2]byte{udigits[i>>4], udigits[i&0x0f]}
+		for j := uint(0); j < 8; j++ {
+			binDigits[i][j] = '0' + byte(i>>(7-j))&1
 		}
-		b, ok := fromHexChar(src[i*2+1])
-		if !ok {
-			return -1
+		asciiGutter[i] = printable(byte(i))
+		ebcdicGutter[i] = '.'
+		if i >= ebcdicOffset {
+			ebcdicGutter[i] = printable(ebcdicTable[i-ebcdicOffset])
 		}
-
-		dst[0] = (a << 4) | b
+		unhex[i] = badHex
 	}
-	return 0
-}
-
-// copied from encoding/hex package
-func fromHexChar(c byte) (byte, bool) {
-	switch {
-	case '0' <= c && c <= '9':
-		return c - '0', true
-	case 'a' <= c && c <= 'f':
-		return c - 'a' + 10, true
-	case 'A' <= c && c <= 'F':
-		return c - 'A' + 10, true
+	for i := 0; i < 16; i++ {
+		unhex[ldigits[i]] = byte(i)
+		unhex[udigits[i]] = byte(i)
 	}
-
-	return 0, false
 }
 
-// check if entire line is full of empty []byte{0} bytes (nul in C)
-func empty(b []byte) bool {
-	for _, v := range b {
-		if v != 0 {
-			return false
-		}
+func printable(c byte) byte {
+	if c > 0x1f && c < 0x7f {
+		return c
 	}
-	return true
+	return '.'
 }
 
 // quick binary tree check
@@ -306,199 +231,388 @@ func parseSpecifier(b string) float64 {
 }
 
 // parses *seek input
-func parseSeek(s string) int64 {
+func parseSeek(s string) (int64, error) {
 	var (
 		sl    = len(s)
 		split int
 	)
 
-	if sl >= 2 {
-		if sl == 2 {
-			split = 1
-		} else {
-			split = 2
-		}
-	} else if sl != 0 {
-		split = 0
-	} else {
-		log.Fatalln("seek string somehow has len of 0")
+	if sl == 0 {
+		return 0, errors.New("seek string somehow has len of 0")
+	}
+
+	// The unit is whatever trailing letters there are, at most two.
+	for split < 2 && split < sl && strings.IndexByte("kKmMgGbB", s[sl-split-1]) >= 0 {
+		split++
 	}
 
-	mod := parseSpecifier(s[sl-split:])
+	mod := float64(1)
+	if split > 0 {
+		mod = parseSpecifier(s[sl-split:])
+	}
 
 	ret, err := strconv.ParseFloat(s[:sl-split], 64) //64 bit float
 	if err != nil {
-		log.Fatalln(err)
+		return 0, err
+	}
+
+	return int64(ret * mod), nil
+}
+
+// blockLen returns the size of the blocks read for lines of cols bytes:
+// a whole number of lines, close to blockSize.
+func blockLen(cols int) int {
+	if cols >= blockSize {
+		return cols
+	}
+	return blockSize / cols * cols
+}
+
+// readBlocks calls fn with successive blocks of r, each n bytes long except
+// possibly the last.
+func readBlocks(r io.Reader, n int, fn func([]byte) error) error {
+	buf := make([]byte, n)
+	for {
+		m, err := io.ReadFull(r, buf)
+		if m > 0 {
+			if err := fn(buf[:m]); err != nil {
+				return err
+			}
+		}
+		if err == io.EOF || err == io.ErrUnexpectedEOF {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
 	}
+}
 
-	return int64(ret * mod)
+// appendOffset appends the "0000000: " that starts every line of a dump.
+func appendOffset(b []byte, off int64) []byte {
+	var tmp [16]byte
+	i := len(tmp)
+	for v := uint64(off); v != 0 || i > len(tmp)-7; v >>= 4 {
+		i--
+		tmp[i] = ldigits[v&0x0f]
+	}
+	b = append(b, tmp[i:]...)
+	return append(b, ':', ' ')
 }
 
-// is byte a space? (\t, \n, \s)
-func isSpace(b *byte) bool {
-	return *b == 32 || *b == 9 || *b == 12
+// dumper renders the hex and binary dumps. Every block of input becomes one
+// block of output, built in a buffer that's allocated once and big enough
+// for the longest lines a block can produce.
+type dumper struct {
+	w      io.Writer
+	cols   int
+	group  int
+	binary bool
+	bars   bool
+	field  int // width of the hex (or binary) field, group spaces included
+	hex    *[256][2]byte
+	gutter *[256]byte
+
+	off int64 // offset of the next line
+	out []byte
+
+	// Autoskip follows the original xxd: the first nul line of a run is
+	// printed, the second is held back and printed only if the run ends
+	// right after it, and longer runs are replaced by a "*" line. The last
+	// line of the input is always printed.
+	autoskip bool
+	zeroSeen int
+	held     []byte
+	zeros    []byte
 }
 
-// are the two bytes hex prefixes? (0x or 0X)
-func isPrefix(b []byte) bool {
-	return b[0] == '0' && (b[1] == 'x' || b[1] == 'X')
+func (o *options) newDumper(w io.Writer, cols, group int, binary bool) *dumper {
+	if group < 1 || group > cols {
+		group = cols
+	}
+	d := &dumper{
+		w:        w,
+		cols:     cols,
+		group:    group,
+		binary:   binary,
+		bars:     o.bars,
+		hex:      &hexLower,
+		gutter:   &asciiGutter,
+		off:      o.seekOffset,
+		autoskip: o.autoskip,
+	}
+	digits := 2
+	if binary {
+		digits = 8
+	}
+	d.field = digits*cols + (cols+group-1)/group
+	if o.upper {
+		d.hex = &hexUpper
+	}
+	if o.ebcdic {
+		d.gutter = &ebcdicGutter
+	}
+
+	// offset, hex field, separator, bars, gutter and newline
+	maxLine := 16 + 2 + d.field + 1 + 2 + cols + 1
+	// A block can show one line more than it has: the nul line held back
+	// from the previous block.
+	d.out = make([]byte, 0, (blockLen(cols)/cols+2)*maxLine)
+	if d.autoskip {
+		d.held = make([]byte, 0, maxLine)
+		d.zeros = make([]byte, cols)
+	}
+	return d
 }
 
-func xxdReverse(r io.Reader, w io.Writer) error {
-	var (
-		cols int
-		octs int
-		char = make([]byte, 1)
-	)
+// line appends the line for p, which is at offset off. b must have room for
+// it.
+func (d *dumper) line(b []byte, off int64, p []byte) []byte {
+	b = appendOffset(b, off)
+	o := len(b)
+	end := o + d.field
+	b = b[:end]
+
+	k := 0
+	if d.binary {
+		for _, c := range p {
+			copy(b[o:o+8], binDigits[c][:])
+			o += 8
+			if k++; k == d.group {
+				b[o] = ' '
+				o++
+				k = 0
+			}
+		}
+	} else {
+		hex := d.hex
+		for _, c := range p {
+			h := hex[c]
+			b[o] = h[0]
+			b[o+1] = h[1]
+			o += 2
+			if k++; k == d.group {
+				b[o] = ' '
+				o++
+				k = 0
+			}
+		}
+	}
+	// Short lines are padded so the gutter stays in its column.
+	for ; o < end; o++ {
+		b[o] = ' '
+	}
 
-	if *columns != -1 {
-		cols = *columns
+	b = append(b, ' ')
+	if d.bars {
+		b = append(b, '|')
+	}
+	o = len(b)
+	b = b[:o+len(p)]
+	gutter := d.gutter
+	for i, c := range p {
+		b[o+i] = gutter[c]
+	}
+	if d.bars {
+		b = append(b, '|')
 	}
+	return append(b, '\n')
+}
 
-	switch dumpType {
-	case dumpBinary:
-		octs = 8
-	case dumpCformat:
-		octs = 4
-	default:
-		octs = 2
+// skipLine appends the line for p when autoskip is on. nul is whether p is a
+// full line of nul bytes.
+func (d *dumper) skipLine(b, p []byte, nul bool) []byte {
+	off := d.off
+	d.off += int64(len(p))
+	if nul {
+		switch d.zeroSeen {
+		case 0:
+			b = d.line(b, off, p)
+		case 1:
+			d.held = d.line(d.held[:0], off, p)
+		}
+		d.zeroSeen++
+		return b
+	}
+	b = d.endRun(b, d.zeroSeen)
+	d.zeroSeen = 0
+	return d.line(b, off, p)
+}
+
+// endRun appends what stands for the unprinted lines of a run of n nul
+// lines.
+func (d *dumper) endRun(b []byte, n int) []byte {
+	switch {
+	case n == 2:
+		b = append(b, d.held...)
+	case n > 2:
+		b = append(b, '*', '\n')
 	}
+	return b
+}
 
-	if *length != -1 {
-		if *length < int64(cols) {
-			cols = int(*length)
+func (d *dumper) block(p []byte) error {
+	b := d.out[:0]
+	cols := d.cols
+	for len(p) > 0 {
+		n := cols
+		if n > len(p) {
+			n = len(p)
+		}
+		if d.autoskip {
+			// A short line can only be the last one, which is always
+			// printed.
+			b = d.skipLine(b, p[:n], n == cols && bytes.Equal(p[:n], d.zeros))
+		} else {
+			b = d.line(b, d.off, p[:n])
+			d.off += int64(n)
 		}
+		p = p[n:]
 	}
+	_, err := d.w.Write(b)
+	return err
+}
 
-	if octs < 1 {
-		octs = cols
+// finish prints the end of a run of nul lines the input ended with.
+func (d *dumper) finish() error {
+	if !d.autoskip || d.zeroSeen < 2 {
+		return nil
 	}
+	n := d.zeroSeen - 1 // the last line is printed either way
+	b := d.endRun(d.out[:0], n)
+	if n != 1 {
+		b = d.line(b, d.off-int64(d.cols), d.zeros)
+	} else {
+		// The held line is the last one.
+		b = append(b, d.held...)
+	}
+	_, err := d.w.Write(b)
+	return err
+}
 
-	c := int64(0) // number of characters
-	rd := bufio.NewReader(r)
-	for {
-		line, err := rd.ReadBytes('\n') // read up until a newline
-		n := len(line)
-		if err != nil && err != io.EOF && err != io.ErrUnexpectedEOF {
-			return err
-		}
-
-		if n == 0 {
-			return nil
-		}
+func (d *dumper) dump(r io.Reader) error {
+	if err := readBlocks(r, blockLen(d.cols), d.block); err != nil {
+		return err
+	}
+	return d.finish()
+}
 
-		if dumpType == dumpHex {
-			for i := 0; n >= octs; {
-				if rv := hexDecode(char, line[i:i+octs]); rv == 0 {
-					w.Write(char)
-					i += 2
-					n -= 2
-					c++
-				} else if rv == -1 {
-					i++
-					n--
-				} else { // if rv == -2
-					i += 2
-					n -= 2
-				}
-			}
-		} else if dumpType == dumpBinary {
-			for i := 0; n >= octs; {
-				if binaryDecode(char, line[i:i+octs]) != -1 {
-					i++
-					n--
-					continue
-				} else {
-					w.Write(char)
-					i += 8
-					n -= 8
-					c++
-				}
+// dumpPlain writes the postscript style dump: nothing but hex, cols bytes
+// to a line.
+func (o *options) dumpPlain(r io.Reader, w io.Writer, cols int) error {
+	hex := &hexLower
+	if o.upper {
+		hex = &hexUpper
+	}
+	n := blockLen(cols)
+	out := make([]byte, 0, n/cols*(2*cols+1))
+	return readBlocks(r, n, func(p []byte) error {
+		b := out[:0]
+		for len(p) > 0 {
+			n := cols
+			if n > len(p) {
+				n = len(p)
 			}
-		} else if dumpType == dumpPostscript {
-			for i := 0; n >= octs; i++ {
-				if hexDecode(char, line[i:i+octs]) == 0 {
-					w.Write(char)
-					c++
-				}
-				n--
-			}
-		} else if dumpType == dumpCformat {
-			for i := 0; n >= octs; {
-				if rv := hexDecode(char, line[i:i+octs]); rv == 0 {
-					w.Write(char)
-					i += 4
-					n -= 4
-					c++
-				} else if rv == -1 {
-					i++
-					n--
-				} else { // if rv == -2
-					i += 2
-					n -= 2
-				}
+			o := len(b)
+			b = b[:o+2*n]
+			for _, c := range p[:n] {
+				h := hex[c]
+				b[o] = h[0]
+				b[o+1] = h[1]
+				o += 2
 			}
+			b = append(b, '\n')
+			p = p[n:]
 		}
+		_, err := w.Write(b)
+		return err
+	})
+}
 
-		// For some reason "xxd FILE | xxd -r -c N" truncates the output,
-		// so we'll do it as well
-		// "xxd FILE | xxd -r -l N" doesn't truncate
-		if c == int64(cols) && cols > 0 {
-			return nil
+// cName turns a file name into the name of the array in a C include file.
+func cName(fname string) string {
+	name := []byte(fname)
+	for i, c := range name {
+		if !('a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' || '0' <= c && c <= '9') {
+			name[i] = '_'
 		}
 	}
+	if len(name) > 0 && '0' <= name[0] && name[0] <= '9' {
+		return "__" + string(name)
+	}
+	return string(name)
 }
 
-func xxd(r io.Reader, w io.Writer, fname string) error {
+// dumpCInclude writes the input as a C array. The declarations around it are
+// left out when there's no file name to name it after.
+func (o *options) dumpCInclude(r io.Reader, w io.Writer, fname string, cols int) error {
 	var (
-		lineOffset int64
-		hexOffset  = make([]byte, 6)
-		groupSize  int
-		cols       int
-		octs       int
-		caps       = ldigits
-		doCHeader  = true
-		doCEnd     bool
-		// enough room for "unsigned char NAME_FORMAT[] = {"
-		varDeclChar = make([]byte, 14+len(fname)+6)
-		// enough room for "unsigned int NAME_FORMAT = "
-		varDeclInt = make([]byte, 16+len(fname)+7)
-		nulLine    int64
-		totalOcts  int64
+		hex   = &hexLower
+		x     = byte('x')
+		name  = cName(fname)
+		total int64
 	)
+	if o.upper {
+		hex, x = &hexUpper, 'X'
+	}
 
-	// Generate the first and last line in the -i output:
-	// e.g. unsigned char foo_txt[] = { and unsigned int foo_txt_len =
-	if dumpType == dumpCformat {
-		// copy over "unnsigned char " and "unsigned int"
-		_ = copy(varDeclChar[0:14], unsignedChar[:])
-		_ = copy(varDeclInt[0:16], unsignedInt[:])
-
-		for i := 0; i < len(fname); i++ {
-			if fname[i] != '.' {
-				varDeclChar[14+i] = fname[i]
-				varDeclInt[16+i] = fname[i]
-			} else {
-				varDeclChar[14+i] = '_'
-				varDeclInt[16+i] = '_'
+	if name != "" {
+		if _, err := fmt.Fprintf(w, "unsigned char %s[] = {\n", name); err != nil {
+			return err
+		}
+	}
+
+	n := blockLen(cols)
+	// "  0xff" per line and ", 0xff" per byte after it, plus ",\n".
+	out := make([]byte, 0, n/cols*(6*cols+2))
+	err := readBlocks(r, n, func(p []byte) error {
+		b := out[:0]
+		for len(p) > 0 {
+			n := cols
+			if n > len(p) {
+				n = len(p)
+			}
+			if total > 0 {
+				b = append(b, ',', '\n')
+			}
+			for i, c := range p[:n] {
+				sep := byte(',')
+				if i == 0 {
+					sep = ' '
+				}
+				h := hex[c]
+				b = append(b, sep, ' ', '0', x, h[0], h[1])
 			}
+			total += int64(n)
+			p = p[n:]
 		}
-		// copy over "[] = {" and "_len = "
-		_ = copy(varDeclChar[14+len(fname):], brackets[:])
-		_ = copy(varDeclInt[16+len(fname):], lenEquals[:])
+		_, err := w.Write(b)
+		return err
+	})
+	if err != nil {
+		return err
 	}
 
-	// Switch between upper- and lower-case hex chars
-	if *upper {
-		caps = udigits
+	if total > 0 {
+		if _, err := w.Write([]byte{'\n'}); err != nil {
+			return err
+		}
+	}
+	if name != "" {
+		_, err = fmt.Fprintf(w, "};\nunsigned int %s_len = %d;\n", name, total)
 	}
+	return err
+}
+
+func (o *options) xxd(r io.Reader, w io.Writer, fname string) error {
+	var cols int
 
 	// xxd -bpi FILE outputs in binary format
 	// xxd -b -p -i FILE outputs in C format
 	// simply catch the last option since that's what I assume the author
 	// wanted...
-	if *columns == -1 {
-		switch dumpType {
+	if o.columns < 1 {
+		switch o.dumpType {
 		case dumpPostscript:
 			cols = 30
 		case dumpCformat:
@@ -509,307 +623,382 @@ func xxd(r io.Reader, w io.Writer, fname string) error {
 			cols = 16
 		}
 	} else {
-		cols = *columns
+		cols = o.columns
 	}
 
-	// See above comment
-	switch dumpType {
-	case dumpBinary:
-		octs = 8
-		groupSize = 1
-	case dumpPostscript:
-		octs = 0
-	case dumpCformat:
-		octs = 4
-	default:
-		octs = 2
-		groupSize = 2
+	if o.length != -1 {
+		r = io.LimitReader(r, o.length)
 	}
 
-	if *group != -1 {
-		groupSize = *group
+	switch o.dumpType {
+	case dumpPostscript:
+		return o.dumpPlain(r, w, cols)
+	case dumpCformat:
+		return o.dumpCInclude(r, w, fname, cols)
 	}
 
-	// If -l is smaller than the number of cols just truncate the cols
-	if *length != -1 {
-		if *length < int64(cols) {
-			cols = int(*length)
+	binary := o.dumpType == dumpBinary
+	group := o.group
+	if group == -1 {
+		group = 2
+		if binary {
+			group = 1
 		}
 	}
+	return o.newDumper(w, cols, group, binary).dump(r)
+}
+
+// unhexWriter collects the output of xxd -r and writes it a block at a time.
+type unhexWriter struct {
+	w   io.Writer
+	out []byte
+	pos int64 // bytes of output so far, written or not
+
+	offset int64 // added to the offset of each line
+}
+
+func (u *unhexWriter) flush() error {
+	_, err := u.w.Write(u.out)
+	u.out = u.out[:0]
+	return err
+}
 
-	if octs < 1 {
-		octs = cols
+// fill writes nul bytes up to off, for the gaps autoskip leaves in a dump.
+// Output can't go back, so lines for earlier offsets are written where they
+// stand.
+func (u *unhexWriter) fill(off int64) error {
+	for u.pos < off {
+		n := int64(cap(u.out) - len(u.out))
+		if n == 0 {
+			if err := u.flush(); err != nil {
+				return err
+			}
+			continue
+		}
+		if n > off-u.pos {
+			n = off - u.pos
+		}
+		o := len(u.out)
+		u.out = u.out[:o+int(n)]
+		for i := range u.out[o:] {
+			u.out[o+i] = 0
+		}
+		u.pos += n
 	}
+	return nil
+}
 
-	// These are bumped down from the beginning of the function in order to
-	// allow their sizes to be allocated based on the user's speficiations
+// unhexLine decodes a line of a hex or binary dump into u.out, which must
+// have room for it. The data ends at the first character that doesn't
+// belong to it, or at the two spaces in front of the gutter.
+func (u *unhexWriter) unhexLine(line []byte, binary bool, cols int) error {
 	var (
-		line = make([]byte, cols)
-		char = make([]byte, octs)
+		off int64
+		i   int
 	)
-
-	c := int64(0) // number of characters
-	nl := int64(0)
-	r = bufio.NewReader(r)
-	for {
-		n, err := io.ReadFull(r, line)
-		if err != nil && err != io.EOF && err != io.ErrUnexpectedEOF {
+	for ; i < len(line) && unhex[line[i]] != badHex; i++ {
+		off = off<<4 | int64(unhex[line[i]])
+	}
+	if i == 0 || i == len(line) || line[i] != ':' {
+		return nil // "*" lines and anything else that isn't a dump line
+	}
+	if err := u.fill(off + u.offset); err != nil {
+		return err
+	}
+	if cap(u.out)-len(u.out) < len(line) {
+		if err := u.flush(); err != nil {
 			return err
 		}
+	}
 
-		// Speed it up a bit ;)
-		if dumpType == dumpPostscript && n != 0 {
-			// Post script values
-			// Basically just raw hex output
-			for i := 0; i < n; i++ {
-				hexEncode(char, line[i:i+1], caps)
-				w.Write(char)
-				c++
+	o := len(u.out)
+	b := u.out[:cap(u.out)]
+	for i++; i < len(line) && cols > 0; {
+		if line[i] == ' ' {
+			if i+1 < len(line) && line[i+1] == ' ' {
+				break
 			}
+			i++
 			continue
 		}
-
-		if n == 0 {
-			if dumpType == dumpPostscript {
-				w.Write(newLine)
+		var v byte
+		if binary {
+			if i+8 > len(line) {
+				break
 			}
-
-			if dumpType == dumpCformat {
-				doCEnd = true
-			} else {
-				return nil // Hidden return!
+			var bad byte
+			for _, c := range line[i : i+8] {
+				d := c - '0'
+				bad |= d
+				v = v<<1 | d&1
 			}
-		}
-
-		if *length != -1 {
-			if totalOcts == *length {
+			if bad > 1 {
 				break
 			}
-			totalOcts += *length
-		}
-
-		if *autoskip && empty(line) {
-			if nulLine == 1 {
-				w.Write(asterisk)
-				w.Write(newLine)
+			i += 8
+		} else {
+			if i+2 > len(line) {
+				break
 			}
-
-			nulLine++
-
-			if nulLine > 1 {
-				lineOffset += int64(n) // continue to increment our offset
-				continue
+			hi, lo := unhex[line[i]], unhex[line[i+1]]
+			if hi == badHex || lo == badHex {
+				break
 			}
+			v = hi<<4 | lo
+			i += 2
 		}
+		b[o] = v
+		o++
+		cols--
+	}
+	u.pos += int64(o - len(u.out))
+	u.out = b[:o]
+	return nil
+}
 
-		if dumpType <= dumpBinary { // either hex or binary
-			// Line offset
-			hexOffset = strconv.AppendInt(hexOffset[0:0], lineOffset, 16)
-			w.Write(zeroHeader[0:(7 - len(hexOffset))])
-			w.Write(hexOffset)
-			w.Write(zeroHeader[7:])
-			lineOffset += int64(n)
-		} else if doCHeader {
-			w.Write(varDeclChar)
-			w.Write(newLine)
-			doCHeader = false
-		}
-
-		if dumpType == dumpBinary {
-			// Binary values
-			for i, k := 0, octs; i < n; i, k = i+1, k+octs {
-				binaryEncode(char, line[i:i+1])
-				w.Write(char)
-				c++
-
-				if k == octs*groupSize || i == cols-1 {
-					k = 0
-					w.Write(space)
-				}
-			}
-		} else if dumpType == dumpCformat {
-			// C values
-			if !doCEnd {
-				w.Write(doubleSpace)
-			}
-
-			for i := 0; i < n; i++ {
-				cfmtEncode(char, line[i:i+1], caps)
-				w.Write(char)
-				c++
-
-				// don't add spaces to EOL
-				if i != n-1 {
-					w.Write(commaSpace)
-				} else if doCEnd {
-					w.Write(comma)
-				}
+// unhexDump reverses a hex or binary dump, a line at a time.
+func (o *options) unhexDump(r io.Reader, w io.Writer, binary bool) error {
+	cols := o.columns
+	if cols < 1 {
+		cols = blockSize
+	}
+	br := bufio.NewReaderSize(r, blockSize)
+	u := &unhexWriter{w: w, out: make([]byte, 0, 2*blockSize), offset: int64(o.offset)}
+	for {
+		line, err := br.ReadSlice('\n')
+		if len(u.out) > blockSize {
+			if err := u.flush(); err != nil {
+				return err
 			}
-		} else {
-			// Hex values -- default xxd FILE output
-			for i, k := 0, octs; i < n; i, k = i+1, k+octs {
-				hexEncode(char, line[i:i+1], caps)
-				w.Write(char)
-				c++
-
-				if k == octs*groupSize || i == cols-1 {
-					k = 0 // reset counter
-					w.Write(space)
-				}
+		}
+		if len(line) > 0 {
+			if err := u.unhexLine(line, binary, cols); err != nil {
+				return err
 			}
 		}
-
-		if doCEnd {
-			w.Write(varDeclInt)
-			w.Write([]byte(strconv.FormatInt(c, 10)))
-			w.Write(semiColonNl)
-			return nil
+		// A line longer than the buffer is cut short.
+		for err == bufio.ErrBufferFull {
+			_, err = br.ReadSlice('\n')
 		}
+		if err == io.EOF {
+			return u.flush()
+		}
+		if err != nil {
+			return err
+		}
+	}
+}
 
-		// If we didn't read a full line, determine our position
-		// and fill the rest of the line with spaces.
-		if n < cols && dumpType <= dumpBinary {
-
-			lineLen := cols*octs + ((cols * octs) / (octs * groupSize))
-			pos := n*octs + ((n * octs) / (octs * groupSize))
-			for i := pos; i < lineLen; i++ {
-				w.Write(space)
+// unhexPlain reverses a postscript style dump, skipping anything that
+// isn't a hex digit.
+func unhexPlain(r io.Reader, w io.Writer) error {
+	var (
+		out  = make([]byte, blockSize/2+1)
+		hi   byte
+		half bool
+	)
+	return readBlocks(r, blockSize, func(p []byte) error {
+		o := 0
+		for _, c := range p {
+			v := unhex[c]
+			if v == badHex {
+				continue
 			}
+			if !half {
+				hi, half = v<<4, true
+				continue
+			}
+			out[o] = hi | v
+			o++
+			half = false
 		}
+		_, err := w.Write(out[:o])
+		return err
+	})
+}
 
-		if dumpType != dumpCformat {
-			w.Write(space)
-		}
+func isIdent(c byte) bool {
+	return 'a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' ||
+		'0' <= c && c <= '9' || c == '_'
+}
 
-		if dumpType <= dumpBinary {
-			// Character values
-			b := line[:n]
-			// |hello, world!| instead of hello, world!
-			if *bars {
-				w.Write(bar)
-			}
-			// EBCDIC
-			if *ebcdic {
-				for _, c := range b {
-					if c >= ebcdicOffset {
-						e := ebcdicTable[c-ebcdicOffset : c-ebcdicOffset+1]
-						if e[0] > 0x1f && e[0] < 0x7f {
-							w.Write(e)
-						} else {
-							w.Write(dot)
-						}
-					} else {
-						w.Write(dot)
-					}
+// unhexCInclude reverses a C include file by decoding each 0x constant in
+// it. Everything else, names and the _len line included, is skipped.
+func unhexCInclude(r io.Reader, w io.Writer) error {
+	const (
+		scan = iota
+		zero // saw a 0 starting a token
+		x    // saw 0x
+		one  // saw 0x and one digit
+	)
+	var (
+		out   = make([]byte, blockSize/2+1)
+		state = scan
+		ident bool // previous character was part of a name or number
+		hi    byte
+	)
+	err := readBlocks(r, blockSize, func(p []byte) error {
+		o := 0
+		for _, c := range p {
+			v := unhex[c]
+			switch state {
+			case zero:
+				if c == 'x' || c == 'X' {
+					state = x
+					continue
 				}
-				if *bars {
-					w.Write(bar)
+			case x:
+				if v != badHex {
+					hi, state = v, one
+					continue
 				}
-				// ASCII
-			} else {
-				for i, c := range b {
-					if c > 0x1f && c < 0x7f {
-						w.Write(line[i : i+1])
-					} else {
-						w.Write(dot)
-					}
+			case one:
+				if v != badHex {
+					out[o] = hi<<4 | v
+					o++
+					state = scan
+					ident = true
+					continue
 				}
+				out[o] = hi
+				o++
 			}
-			if *bars {
-				w.Write(bar)
+			state = scan
+			if c == '0' && !ident {
+				state = zero
 			}
+			ident = isIdent(c)
 		}
-		w.Write(newLine)
-		nl++
+		_, err := w.Write(out[:o])
+		return err
+	})
+	if err == nil && state == one {
+		_, err = w.Write([]byte{hi})
 	}
-	return nil
+	return err
 }
 
-func main() {
-	flag.Usage = func() {
-		fmt.Fprintf(os.Stderr, "%s\n", Help)
-		os.Exit(0)
-	}
-	flag.Parse()
-
-	if flag.NArg() == 0 {
-		fmt.Fprintf(os.Stderr, "no input file given\n%s\n", Help)
-		os.Exit(1)
-	}
-
-	if *version {
-		fmt.Fprintf(os.Stderr, "%s\n", Version)
-		os.Exit(0)
-	}
-
-	if flag.NArg() > 2 {
-		log.Fatalf("too many arguments after %s\n", flag.Arg(1))
+func (o *options) xxdReverse(r io.Reader, w io.Writer) error {
+	switch o.dumpType {
+	case dumpPostscript:
+		return unhexPlain(r, w)
+	case dumpCformat:
+		return unhexCInclude(r, w)
+	case dumpBinary:
+		return o.unhexDump(r, w, true)
+	default:
+		return o.unhexDump(r, w, false)
 	}
+}
 
+func run(ctx coreutils.Context, args ...string) (err error) {
 	var (
-		err  error
-		file string
+		f                flag.FlagSet
+		o                options
+		binary, cfmt, ps bool
+		reverse, version bool
+		seek             string
 	)
+	f.BoolVarP(&o.autoskip, "autoskip", "a", false, "toggle autoskip (* replaces nul lines")
+	f.BoolVarP(&o.bars, "bars", "B", false, "print |ascii| instead of ascii")
+	f.BoolVarP(&binary, "binary", "b", false, "binary dump, incompatible with -ps, -i, -r")
+	f.IntVarP(&o.columns, "cols", "c", -1, "format <cols> octets per line")
+	f.BoolVarP(&o.ebcdic, "ebcdic", "E", false, "use EBCDIC instead of ASCII")
+	f.IntVarP(&o.group, "group", "g", -1, "num of octets per group")
+	f.BoolVarP(&cfmt, "include", "i", false, "output in C include format")
+	f.Int64VarP(&o.length, "len", "l", -1, "stop after len octets")
+	f.BoolVarP(&ps, "ps", "p", false, "output in postscript plain hd style")
+	f.BoolVarP(&reverse, "reverse", "r", false, "convert hex to binary")
+	f.IntVar(&o.offset, "off", 0, "revert with offset")
+	f.StringVarP(&seek, "seek", "s", "", "start at seek bytes abs")
+	f.BoolVarP(&o.upper, "uppercase", "u", false, "use uppercase hex letters")
+	f.BoolVarP(&version, "version", "v", false, "print version")
+	f.Usage = func() { fmt.Fprintf(ctx.Stderr, "%s\n", Help) }
+	if err := f.Parse(args); err != nil {
+		return err
+	}
+
+	if version {
+		fmt.Fprintf(ctx.Stderr, "%s\n", Version)
+		return nil
+	}
+
+	if f.NArg() == 0 {
+		fmt.Fprintf(ctx.Stderr, "no input file given\n%s\n", Help)
+		return coreutils.ExitCode(1)
+	}
+
+	defer func() {
+		if err != nil {
+			fmt.Fprintf(ctx.Stderr, "xxd: %v\n", err)
+		}
+	}()
 
-	if flag.NArg() >= 1 {
-		file = flag.Arg(0)
-	} else {
-		file = "-"
+	if f.NArg() > 2 {
+		return fmt.Errorf("too many arguments after %s", f.Arg(1))
 	}
 
-	var inFile *os.File
+	file := f.Arg(0)
+	in := ctx.Stdin
 	if file == "-" {
-		inFile = os.Stdin
-		file = "stdin"
+		file = ""
 	} else {
-		inFile, err = os.Open(file)
+		inFile, err := os.Open(file)
 		if err != nil {
-			log.Fatalln(err)
+			return err
 		}
+		defer inFile.Close()
+		in = inFile
 	}
-	defer inFile.Close()
 
-	// Start *seek bytes into file
-	if *seek != "" {
-		sv := parseSeek(*seek)
-		_, err := inFile.Seek(sv, os.SEEK_SET)
+	// Start seek bytes into file
+	if seek != "" {
+		if o.seekOffset, err = parseSeek(seek); err != nil {
+			return err
+		}
+		s, ok := in.(io.Seeker)
+		if !ok {
+			err = errors.New("not seekable")
+		} else {
+			_, err = s.Seek(o.seekOffset, io.SeekStart)
+		}
 		if err != nil {
-			log.Fatalln(err)
+			// Pipes can't seek, so skip ahead by reading.
+			if _, err := io.CopyN(ioutil.Discard, in, o.seekOffset); err != nil {
+				return err
+			}
 		}
 	}
 
-	var outFile *os.File
-	if flag.NArg() == 2 {
-		outFile, err = os.OpenFile(flag.Arg(1), os.O_RDWR|os.O_CREATE, 0660)
+	outFile := ctx.Stdout
+	if f.NArg() == 2 {
+		file, err := os.OpenFile(f.Arg(1), os.O_RDWR|os.O_CREATE, 0660)
 		if err != nil {
-			log.Fatalln(err)
+			return err
 		}
-	} else {
-		outFile = os.Stdout
+		defer file.Close()
+		outFile = file
 	}
-	defer outFile.Close()
 
 	switch true {
-	case *binary:
-		dumpType = dumpBinary
-	case *cfmt:
-		dumpType = dumpCformat
-	case *postscript:
-		dumpType = dumpPostscript
+	case binary:
+		o.dumpType = dumpBinary
+	case cfmt:
+		o.dumpType = dumpCformat
+	case ps:
+		o.dumpType = dumpPostscript
 	default:
-		dumpType = dumpHex
+		o.dumpType = dumpHex
 	}
 
 	out := bufio.NewWriter(outFile)
-	defer out.Flush()
-
-	if *reverse {
-		if err := xxdReverse(inFile, out); err != nil {
-			log.Fatalln(err)
-		}
+	if reverse {
+		err = o.xxdReverse(in, out)
 	} else {
-		if err := xxd(inFile, out, file); err != nil {
-			log.Fatalln(err)
-		}
+		err = o.xxd(in, out, file)
+	}
+	if ferr := out.Flush(); err == nil {
+		err = ferr
 	}
+	return err
 }
@@ -1,4 +1,4 @@
-package main
+package xxd
 
 import (
 	"bytes"
@@ -11,6 +11,8 @@ import (
 	"strings"
 	"testing"
 	"testing/quick"
+
+	"github.com/ericlagergren/go-coreutils/internal/benchdata"
 )
 
 var xxdFile = flag.String("xxdFile", "", "File to test against.")
@@ -34,7 +36,7 @@ func TestXXD(t *testing.T) {
 			return strings.Split(out.String(), "\n")
 		}
 	}
-	if err := quick.CheckEqual(test(xxd), test(xxdNative), nil); err != nil {
+	if err := quick.CheckEqual(test(newOptions(dumpHex, -1, false).xxd), test(xxdNative), nil); err != nil {
 		cErr := err.(*quick.CheckEqualError)
 		size := cErr.In[0].(uint64) % uint64(len(data))
 		for i := range cErr.Out1[0].([]string) {
@@ -68,6 +70,85 @@ func (p *pathologicalReader) Read(b []byte) (int, error) {
 	return n, nil
 }
 
+var dumpTests = []struct {
+	dumpType int
+	cols     int
+	autoskip bool
+	name     string
+	in       string
+	want     string
+}{
+	{dumpHex, 8, false, "", "hello, world\n", `0000000: 6865 6c6c 6f2c 2077  hello, w
+0000008: 6f72 6c64 0a         orld.
+`},
+	{dumpHex, 16, true, "", "hi" + strings.Repeat("\x00", 78) + "x", `0000000: 6869 0000 0000 0000 0000 0000 0000 0000  hi..............
+0000010: 0000 0000 0000 0000 0000 0000 0000 0000  ................
+*
+0000050: 78                                       x
+`},
+	{dumpBinary, 4, false, "", "hello, world\n", `0000000: 01101000 01100101 01101100 01101100  hell
+0000004: 01101111 00101100 00100000 01110111  o, w
+0000008: 01101111 01110010 01101100 01100100  orld
+000000c: 00001010                             .
+`},
+	{dumpPostscript, 8, false, "", "hello, world\n", `68656c6c6f2c2077
+6f726c640a
+`},
+	{dumpCformat, 8, false, "g1", "hello, world\n", `unsigned char g1[] = {
+  0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x77,
+  0x6f, 0x72, 0x6c, 0x64, 0x0a
+};
+unsigned int g1_len = 13;
+`},
+}
+
+func newOptions(dt, cols int, skip bool) *options {
+	return &options{dumpType: dt, columns: cols, group: -1, length: -1, autoskip: skip}
+}
+
+func TestDump(t *testing.T) {
+	for _, tc := range dumpTests {
+		o := newOptions(tc.dumpType, tc.cols, tc.autoskip)
+		var out bytes.Buffer
+		if err := o.xxd(&pathologicalReader{[]byte(tc.in)}, &out, tc.name); err != nil {
+			t.Fatal(err)
+		}
+		if out.String() != tc.want {
+			t.Errorf("type %d, cols %d:\ngot:\n%s\nwant:\n%s", tc.dumpType, tc.cols, out.String(), tc.want)
+		}
+	}
+}
+
+func TestReverse(t *testing.T) {
+	data := make([]byte, 3*blockSize+1234)
+	if _, err := io.ReadFull(rand.Reader, data); err != nil {
+		t.Fatal(err)
+	}
+	// Runs of nul lines for autoskip to leave out.
+	for i := 1000; i < 1000+5*16; i++ {
+		data[i] = 0
+	}
+	for i := len(data) - 64; i < len(data); i++ {
+		data[i] = 0
+	}
+
+	for _, dt := range []int{dumpHex, dumpBinary, dumpPostscript, dumpCformat} {
+		for _, skip := range []bool{false, true} {
+			o := newOptions(dt, -1, skip)
+			var dump, out bytes.Buffer
+			if err := o.xxd(bytes.NewReader(data), &dump, "data"); err != nil {
+				t.Fatal(err)
+			}
+			if err := o.xxdReverse(&pathologicalReader{dump.Bytes()}, &out); err != nil {
+				t.Fatal(err)
+			}
+			if !bytes.Equal(out.Bytes(), data) {
+				t.Errorf("type %d, autoskip %t: reversed dump doesn't match", dt, skip)
+			}
+		}
+	}
+}
+
 func BenchmarkXXD(b *testing.B) {
 	b.StopTimer()
 	data := make([]byte, b.N)
@@ -76,7 +157,7 @@ func BenchmarkXXD(b *testing.B) {
 	}
 	buf := bytes.NewBuffer(data)
 	b.StartTimer()
-	if err := xxd(buf, ioutil.Discard, ""); err != nil {
+	if err := newOptions(dumpHex, -1, false).xxd(buf, ioutil.Discard, ""); err != nil {
 		b.Fatal(err)
 	}
 }
@@ -89,4 +170,62 @@ func xxdNative(r io.Reader, w io.Writer, s string) error {
 	return xxd.Run()
 }
 
-func main() {}
+func BenchmarkXXDReverse(b *testing.B) {
+	data := make([]byte, 1<<20)
+	if _, err := io.ReadFull(rand.Reader, data); err != nil {
+		b.Fatal(err)
+	}
+	o := newOptions(dumpHex, -1, false)
+	var dump bytes.Buffer
+	if err := o.xxd(bytes.NewReader(data), &dump, ""); err != nil {
+		b.Fatal(err)
+	}
+	b.SetBytes(int64(len(data)))
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := o.xxdReverse(bytes.NewReader(dump.Bytes()), ioutil.Discard); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+// BenchmarkDump dumps each kind of text in each format, and reverses the hex
+// dumps again.
+func BenchmarkDump(b *testing.B) {
+	for _, k := range benchdata.Kinds {
+		data := benchdata.Text(k, 4<<20)
+		for _, bb := range []struct {
+			name string
+			dt   int
+		}{
+			{"hex", dumpHex},
+			{"bits", dumpBinary},
+			{"c", dumpCformat},
+			{"ps", dumpPostscript},
+		} {
+			b.Run(string(k)+"/"+bb.name, func(b *testing.B) {
+				o := newOptions(bb.dt, -1, false)
+				b.SetBytes(int64(len(data)))
+				for i := 0; i < b.N; i++ {
+					if err := o.xxd(bytes.NewReader(data), ioutil.Discard, "data"); err != nil {
+						b.Fatal(err)
+					}
+				}
+			})
+		}
+		b.Run(string(k)+"/reverse", func(b *testing.B) {
+			o := newOptions(dumpHex, -1, false)
+			var dump bytes.Buffer
+			if err := o.xxd(bytes.NewReader(data), &dump, ""); err != nil {
+				b.Fatal(err)
+			}
+			b.SetBytes(int64(len(data)))
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				if err := o.xxdReverse(bytes.NewReader(dump.Bytes()), ioutil.Discard); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
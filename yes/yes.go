@@ -1,20 +1,17 @@
-package main
+package yes
 
 import (
-	"bytes"
-	"flag"
 	"fmt"
-	"os"
-)
 
-var version bool
+	coreutils "github.com/ericlagergren/go-coreutils"
+	flag "github.com/spf13/pflag"
+)
 
-func main() {
-	flag.BoolVar(&version, "version", false, "")
-	flag.BoolVar(&version, "v", false, "")
+func init() {
+	coreutils.Register("yes", run)
+}
 
-	flag.Usage = func() {
-		fmt.Printf(`Usage: yes [STRING]...
+const usage = `Usage: yes [STRING]...
   or:  yes OPTION
 Repeatedly output a line with all specified STRING(s), or 'y'.
 
@@ -23,32 +20,56 @@ Repeatedly output a line with all specified STRING(s), or 'y'.
 
 Report yes bugs to eric@ericlagergren.com
 Go coreutils home page: <https://www.github.com/ericlagergren/go-coreutils/>
-`)
+`
+
+func run(ctx coreutils.Context, args ...string) error {
+	var (
+		f       flag.FlagSet
+		version bool
+	)
+	f.BoolVarP(&version, "version", "v", false, "")
+	f.Usage = func() { fmt.Fprint(ctx.Stdout, usage) }
+	if err := f.Parse(args); err != nil {
+		return err
 	}
-	flag.Parse()
 
 	if version {
-		fmt.Printf(`yes (Go coreutils) 1.1
+		fmt.Fprintf(ctx.Stdout, `yes (Go coreutils) 1.1
 Copyright (C) 2015-2017 Eric Lagergren.
 License GPLv3+: GNU GPL version 3 or later <http://gnu.org/licenses/gpl.html>.
 This is free software: you are free to change and redistribute it.
 There is NO WARRANTY, to the extent permitted by law.
 `)
-		return
+		return nil
 	}
 
-	var buf []byte
-	if flag.NArg() == 0 {
-		buf = bytes.Repeat([]byte{'y', '\n'}, 4096)
+	var line []byte
+	if f.NArg() == 0 {
+		line = []byte{'y', '\n'}
 	} else {
-		for _, arg := range flag.Args() {
-			buf = append(buf, arg...)
-			buf = append(buf, ' ')
+		for i, arg := range f.Args() {
+			if i > 0 {
+				line = append(line, ' ')
+			}
+			line = append(line, arg...)
 		}
-		buf = append(buf, '\n')
+		line = append(line, '\n')
 	}
 
+	// Fill a buffer with as many copies of the line as fit, so each write
+	// is a large one.
+	buf := ctx.Buffer()
+	defer ctx.PutBuffer(buf)
+	n := 0
+	for n+len(line) <= len(buf) {
+		n += copy(buf[n:], line)
+	}
+	if n == 0 {
+		buf, n = line, len(line)
+	}
 	for {
-		os.Stdout.Write(buf)
+		if _, err := ctx.Stdout.Write(buf[:n]); err != nil {
+			return err
+		}
 	}
 }